@@ -0,0 +1,38 @@
+#!/bin/bash
+
+OPT_DET_EXEC=../../build/src/optdet/scots_opt_det
+
+function ctrl_encode_stats() {
+   #Prepare variables
+   CTRL_FILE_TEMPL="models/${1}/scots/c_reo"
+   ENC_DIR="models/${1}/enc"
+   mkdir -p ${ENC_DIR}
+   ENC_FILE_TEMPL="${ENC_DIR}/c"
+   LOG_FILE_NAME="${ENC_FILE_TEMPL}.log"
+
+    echo "**** ${LOG_FILE_NAME} ****"
+
+   #Remove any old files
+   rm -rf ${ENC_FILE_TEMPL}*
+
+   #Store the ADD along with the other encodings into the same CUDD manager and verify them
+   CMD="${OPT_DET_EXEC} -s ${CTRL_FILE_TEMPL} -t ${ENC_FILE_TEMPL} -d ${2} -a local -l info -m -k -z -p 0.01 -v"
+   echo "Running: ${CMD}" > ${LOG_FILE_NAME}
+   ${CMD} >> ${LOG_FILE_NAME}
+   echo -e "\tExit code: $?"
+
+   #Get the statistics
+   grep "USAGE: The resulting " ${LOG_FILE_NAME} | sed 's/^USAGE: /\t/'
+   grep "ERROR" ${LOG_FILE_NAME}
+}
+
+ctrl_encode_stats "dcm/1" 2
+ctrl_encode_stats "dcm/25" 2
+
+ctrl_encode_stats "dcdc/1" 2
+ctrl_encode_stats "dcdc/200" 2
+
+ctrl_encode_stats "vehicle/1" 3
+ctrl_encode_stats "vehicle/5" 3
+
+ctrl_encode_stats "aircraft/1" 3
@@ -0,0 +1,53 @@
+#!/bin/bash
+
+FLAT_EXEC=../../build/src/optdet/scots_flat_bdd
+
+function ctrl_flat_stats() {
+   #Prepare variables
+   CTRL_FILE_TEMPL="models/${1}/${2}"
+   FLAT_DIR="models/${1}/flat"
+   mkdir -p ${FLAT_DIR}
+   FLAT_FILE_TEMPL="${FLAT_DIR}/${2}"
+   LOG_FILE_NAME="${FLAT_FILE_TEMPL}.log"
+
+    echo "**** ${LOG_FILE_NAME} ****"
+   
+   #Remove any opld files
+   rm -rf ${FLAT_FILE_TEMPL}*
+   
+   #Run the compiler and the benchmark
+   CMD="${FLAT_EXEC} -s ${CTRL_FILE_TEMPL} -t ${FLAT_FILE_TEMPL} -d ${3} -l info -b 100000"
+   echo "Running: ${CMD}" > ${LOG_FILE_NAME}
+   ${CMD} > ${LOG_FILE_NAME}
+   
+   #Get the statistics
+   ls -al ${CTRL_FILE_TEMPL}.bdd | awk '{print "\tOriginal controller size: " $5 }'
+   ls -al ${FLAT_FILE_TEMPL}.fbd | awk '{print "\tFlat controller size: " $5 }'
+   grep "The restriction took" ${LOG_FILE_NAME} | sed 's/^RESULT: /\t/'
+   grep "The flat BDD lookup took" ${LOG_FILE_NAME} | sed 's/^RESULT: /\t/'
+   grep "ERROR" ${LOG_FILE_NAME}
+}
+
+ctrl_flat_stats "dcm/1/det" "c_reo" 2
+ctrl_flat_stats "dcm/5/det" "c_reo" 2
+ctrl_flat_stats "dcm/10/det" "c_reo" 2
+ctrl_flat_stats "dcm/15/det" "c_reo" 2
+ctrl_flat_stats "dcm/20/det" "c_reo" 2
+ctrl_flat_stats "dcm/25/det" "c_reo" 2
+
+ctrl_flat_stats "dcdc/1/det" "c_reo" 2
+ctrl_flat_stats "dcdc/40/det" "c_reo" 2
+ctrl_flat_stats "dcdc/80/det" "c_reo" 2
+ctrl_flat_stats "dcdc/120/det" "c_reo" 2
+ctrl_flat_stats "dcdc/160/det" "c_reo" 2
+ctrl_flat_stats "dcdc/200/det" "c_reo" 2
+
+ctrl_flat_stats "vehicle/1/det" "c_reo" 3
+ctrl_flat_stats "vehicle/2/det" "c_reo" 3
+ctrl_flat_stats "vehicle/3/det" "c_reo" 3
+ctrl_flat_stats "vehicle/4/det" "c_reo" 3
+ctrl_flat_stats "vehicle/5/det" "c_reo" 3
+
+ctrl_flat_stats "aircraft/1/det" "c_reo" 3
+ctrl_flat_stats "aircraft/2/det" "c_reo" 3
+ctrl_flat_stats "aircraft/3/det" "c_reo" 3
@@ -0,0 +1,46 @@
+#!/bin/bash
+
+BENCH_EXEC=../../build/src/optdet/scots_bench
+BENCH_DIR="./bench"
+REPORT_FILE="${BENCH_DIR}/report.csv"
+BASELINE_FILE="${BENCH_DIR}/baseline.csv"
+LOG_FILE_NAME="${BENCH_DIR}/report.log"
+
+#The controller and its state-space dimensionality arguments
+CTRL_ARGS=""
+function add_ctrl() {
+    CTRL_ARGS="${CTRL_ARGS} -c models/${1}/scots/c_reo -d ${2}"
+}
+
+#Only the state-space parameters produced by generate.sh
+add_ctrl dcm/1 2
+add_ctrl dcm/15 2
+add_ctrl dcm/25 2
+add_ctrl dcdc/1 2
+add_ctrl dcdc/20 2
+add_ctrl dcdc/35 2
+add_ctrl dcdc_rec/1/35 2
+add_ctrl vehicle/1 3
+add_ctrl vehicle/3 3
+add_ctrl aircraft/1 3
+add_ctrl aircraft/2 3
+
+mkdir -p ${BENCH_DIR}
+
+#Compare with the baseline if there is one, copy
+#a good report into the baseline file to create it
+BASELINE_ARGS=""
+if [ -f ${BASELINE_FILE} ]; then
+    BASELINE_ARGS="-b ${BASELINE_FILE} -x 0.1"
+fi
+
+CMD="${BENCH_EXEC} ${CTRL_ARGS} -t ${BENCH_DIR}/c -o ${REPORT_FILE} -r 3 -u 1 ${BASELINE_ARGS}"
+echo "Running: ${CMD}"
+${CMD} > ${LOG_FILE_NAME}
+RESULT=$?
+
+grep "RESULT: models" ${LOG_FILE_NAME} | sed 's/^RESULT: /\t/'
+grep "WARN\|ERROR" ${LOG_FILE_NAME}
+echo "The report is in: ${REPORT_FILE}"
+
+exit ${RESULT}
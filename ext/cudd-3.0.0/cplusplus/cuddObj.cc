@@ -99,6 +99,7 @@ public:
     std::vector<char *> varnames;
     int ref;
     bool verbose;
+    unsigned long operations;
 };
 
 
@@ -118,6 +119,7 @@ Capsule::Capsule(
         errorHandler("Out of memory");
     verbose = 0; // initially terse
     ref = 1;
+    operations = 0;
 
 } // Capsule::Capsule
 
@@ -206,6 +208,7 @@ inline void
 DD::checkReturnValue(
   const void *result) const
 {
+    p->operations++;
     if (result == 0) {
 	DdManager *mgr = p->manager;
 	Cudd_ErrorType errType = Cudd_ReadErrorCode(mgr);
@@ -1891,6 +1894,21 @@ Cudd::ReadCacheHits() const
 } // Cudd::ReadCacheHits
 
 
+/**
+  @brief Returns the number of the top-level %DD operations.
+
+  @details Every operation of the DD classes returning a node is
+  counted, independently of whether %CUDD is built with DD_COUNT.
+
+*/
+unsigned long
+Cudd::ReadOperations() const
+{
+    return p->operations;
+
+} // Cudd::ReadOperations
+
+
 unsigned int
 Cudd::ReadMinHit() const
 {
@@ -531,6 +531,7 @@ public:
     double ReadCacheUsedSlots(void) const;
     double ReadCacheLookUps(void) const;
     double ReadCacheHits(void) const;
+    unsigned long ReadOperations(void) const;
     unsigned int ReadMinHit(void) const;
     void SetMinHit(unsigned int hr) const;
     unsigned int ReadLooseUpTo(void) const;
@@ -3323,7 +3323,7 @@ Cudd_PrintInfo(
 
   @details This number includes node on the free list. At the peak,
   the number of nodes on the free list is guaranteed to be less than
-  DD_MEM_CHUNK.
+  DD_NODE_CHUNK.
 
   @sideeffect None
 
@@ -3338,7 +3338,7 @@ Cudd_ReadPeakNodeCount(
     DdNodePtr *scan = dd->memoryList;
 
     while (scan != NULL) {
-	count += DD_MEM_CHUNK;
+	count += DD_NODE_CHUNK;
 	scan = (DdNodePtr *) *scan;
     }
     return(count);
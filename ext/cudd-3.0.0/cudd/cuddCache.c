@@ -111,7 +111,7 @@ cuddInitCache(
 {
     int i;
     unsigned int logSize;
-#ifndef DD_CACHE_PROFILE
+#if !defined(DD_CACHE_PROFILE) && !defined(DD_HUGE_PAGES)
     DdNodePtr *mem;
     ptruint offset;
 #endif
@@ -120,7 +120,12 @@ cuddInitCache(
     ** initial cache size. */
     logSize = cuddComputeFloorLog2(ddMax(cacheSize,unique->slots/2));
     cacheSize = 1U << logSize;
+#ifdef DD_HUGE_PAGES
+    /* The pages are aligned, no extra entry is needed for the alignment. */
+    unique->acache = cuddAllocPages(DdCache,cacheSize);
+#else
     unique->acache = ALLOC(DdCache,cacheSize+1);
+#endif
     if (unique->acache == NULL) {
 	unique->errorCode = CUDD_MEMORY_OUT;
 	return(0);
@@ -128,7 +133,7 @@ cuddInitCache(
     /* If the size of the cache entry is a power of 2, we want to
     ** enforce alignment to that power of two. This happens when
     ** DD_CACHE_PROFILE is not defined. */
-#ifdef DD_CACHE_PROFILE
+#if defined(DD_CACHE_PROFILE) || defined(DD_HUGE_PAGES)
     unique->cache = unique->acache;
     unique->memused += (cacheSize) * sizeof(DdCache);
 #else
@@ -843,7 +848,7 @@ cuddCacheResize(
     int moved = 0;
     extern DD_OOMFP MMoutOfMemory;
     DD_OOMFP saveHandler;
-#ifndef DD_CACHE_PROFILE
+#if !defined(DD_CACHE_PROFILE) && !defined(DD_HUGE_PAGES)
     ptruint misalignment;
     DdNodePtr *mem;
 #endif
@@ -864,7 +869,11 @@ cuddCacheResize(
 
     saveHandler = MMoutOfMemory;
     MMoutOfMemory = table->outOfMemCallback;
+#ifdef DD_HUGE_PAGES
+    table->acache = cache = cuddAllocPages(DdCache,slots);
+#else
     table->acache = cache = ALLOC(DdCache,slots+1);
+#endif
     MMoutOfMemory = saveHandler;
     /* If we fail to allocate the new table we just give up. */
     if (cache == NULL) {
@@ -881,7 +890,7 @@ cuddCacheResize(
     /* If the size of the cache entry is a power of 2, we want to
     ** enforce alignment to that power of two. This happens when
     ** DD_CACHE_PROFILE is not defined. */
-#ifdef DD_CACHE_PROFILE
+#if defined(DD_CACHE_PROFILE) || defined(DD_HUGE_PAGES)
     table->cache = cache;
 #else
     mem = (DdNodePtr *) cache;
@@ -920,7 +929,7 @@ cuddCacheResize(
 	}
     }
 
-    FREE(oldacache);
+    cuddFreePages(oldacache,DdCache,oldslots);
 
     /* Reinitialize measurements so as to avoid division by 0 and
     ** immediate resizing.
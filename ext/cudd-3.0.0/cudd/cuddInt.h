@@ -70,6 +70,14 @@
 					/* should be added when resizing */
 #define DD_MEM_CHUNK		1022
 
+#ifdef DD_HUGE_PAGES
+#define DD_HUGE_PAGE_SIZE	((size_t) 2 * 1024 * 1024)
+/* A node block fills one huge page, including the link to the next block */
+#define DD_NODE_CHUNK		((int) (DD_HUGE_PAGE_SIZE / sizeof(DdNode)) - 1)
+#else
+#define DD_NODE_CHUNK		DD_MEM_CHUNK
+#endif
+
 /* These definitions work for CUDD_VALUE_TYPE == double */
 #define DD_ONE_VAL		(1.0)
 #define DD_ZERO_VAL		(0.0)
@@ -646,6 +654,59 @@ struct DdLevelQueue {
     ((DdNode *)(node))->next = (unique)->nextFree; \
     (unique)->nextFree = (DdNode *)(node);
 
+/**
+  @brief Allocates the memory for the node blocks and the cache.
+
+  @details If DD_HUGE_PAGES is defined the memory is page aligned
+  and backed by huge pages when available; it must then be released
+  with cuddFreePages and the same number of elements.
+
+  @sideeffect None
+
+  @see cuddFreePages cuddHugeAlloc
+
+*/
+#ifdef DD_HUGE_PAGES
+#define cuddAllocPages(type,num) \
+    ((type *) cuddHugeAlloc(sizeof(type) * (size_t) (num)))
+#else
+#define cuddAllocPages(type,num) ALLOC(type,num)
+#endif
+
+/**
+  @brief Frees the memory allocated with cuddAllocPages.
+
+  @sideeffect The pointer is set to zero.
+
+  @see cuddAllocPages cuddHugeFree
+
+*/
+#ifdef DD_HUGE_PAGES
+#define cuddFreePages(obj,type,num) \
+    (cuddHugeFree((obj), sizeof(type) * (size_t) (num)), (obj) = 0)
+#else
+#define cuddFreePages(obj,type,num) FREE(obj)
+#endif
+
+/**
+  @brief Allocates the slots of a unique subtable.
+
+  @details If DD_HUGE_PAGES is defined the large subtables are huge
+  page aligned and advised to use transparent huge pages. The memory
+  is released with FREE in either case.
+
+  @sideeffect None
+
+  @see cuddHugeAllocTable
+
+*/
+#ifdef DD_HUGE_PAGES
+#define cuddAllocNodelist(slots) \
+    ((DdNodePtr *) cuddHugeAllocTable(sizeof(DdNodePtr) * (size_t) (slots)))
+#else
+#define cuddAllocNodelist(slots) ALLOC(DdNodePtr,slots)
+#endif
+
 
 /**
   @brief Increases the reference count of a node, if it is not
@@ -1182,6 +1243,11 @@ extern int cuddSymmSiftingConv(DdManager *table, int lower, int upper);
 extern DdNode * cuddAllocNode(DdManager *unique);
 extern DdManager * cuddInitTable(unsigned int numVars, unsigned int numVarsZ, unsigned int numSlots, unsigned int looseUpTo);
 extern void cuddFreeTable(DdManager *unique);
+#ifdef DD_HUGE_PAGES
+extern void * cuddHugeAlloc(size_t size);
+extern void cuddHugeFree(void *p, size_t size);
+extern void * cuddHugeAllocTable(size_t size);
+#endif
 extern int cuddGarbageCollect(DdManager *unique, int clearCache);
 extern DdNode * cuddZddGetNode(DdManager *zdd, int id, DdNode *T, DdNode *E);
 extern DdNode * cuddZddGetNodeIVO(DdManager *dd, int index, DdNode *g, DdNode *h);
@@ -371,7 +371,7 @@ cuddDynamicAllocNode(
 	/* Try to allocate a new block. */
 	saveHandler = MMoutOfMemory;
 	MMoutOfMemory = table->outOfMemCallback;
-	mem = (DdNodePtr *) ALLOC(DdNode, DD_MEM_CHUNK + 1);
+	mem = (DdNodePtr *) cuddAllocPages(DdNode,DD_NODE_CHUNK + 1);
 	MMoutOfMemory = saveHandler;
 	if (mem == NULL && table->stash != NULL) {
 	    FREE(table->stash);
@@ -382,14 +382,14 @@ cuddDynamicAllocNode(
 	    for (i = 0; i < table->size; i++) {
 		table->subtables[i].maxKeys <<= 2;
 	    }
-	    mem = (DdNodePtr *) ALLOC(DdNode,DD_MEM_CHUNK + 1);
+	    mem = (DdNodePtr *) cuddAllocPages(DdNode,DD_NODE_CHUNK + 1);
 	}
 	if (mem == NULL) {
 	    /* Out of luck. Call the default handler to do
 	    ** whatever it specifies for a failed malloc.  If this
 	    ** handler returns, then set error code, print
 	    ** warning, and return. */
-	    (*MMoutOfMemory)(sizeof(DdNode)*(DD_MEM_CHUNK + 1));
+	    (*MMoutOfMemory)(sizeof(DdNode)*(DD_NODE_CHUNK + 1));
 	    table->errorCode = CUDD_MEMORY_OUT;
 #ifdef DD_VERBOSE
 	    (void) fprintf(table->err,
@@ -400,7 +400,7 @@ cuddDynamicAllocNode(
 	    return(NULL);
 	} else {	/* successful allocation; slice memory */
 	    size_t offset;
-	    table->memused += (DD_MEM_CHUNK + 1) * sizeof(DdNode);
+	    table->memused += (DD_NODE_CHUNK + 1) * sizeof(DdNode);
 	    mem[0] = (DdNode *) table->memoryList;
 	    table->memoryList = mem;
 
@@ -419,10 +419,10 @@ cuddDynamicAllocNode(
 	    do {
 		list[i - 1].ref = 0;
 		list[i - 1].next = &list[i];
-	    } while (++i < DD_MEM_CHUNK);
+	    } while (++i < DD_NODE_CHUNK);
 
-	    list[DD_MEM_CHUNK-1].ref = 0;
-	    list[DD_MEM_CHUNK - 1].next = NULL;
+	    list[DD_NODE_CHUNK-1].ref = 0;
+	    list[DD_NODE_CHUNK - 1].next = NULL;
 
 	    table->nextFree = &list[0];
 	}
@@ -848,7 +848,7 @@ cuddSwapInPlace(
 	    /* Try to allocate new table. Be ready to back off. */
 	    saveHandler = MMoutOfMemory;
 	    MMoutOfMemory = table->outOfMemCallback;
-	    newxlist = ALLOC(DdNodePtr, newxslots);
+	    newxlist = cuddAllocNodelist(newxslots);
 	    MMoutOfMemory = saveHandler;
 	    if (newxlist == NULL) {
 		(void) fprintf(table->err, "Unable to resize subtable %d for lack of memory\n", i);
@@ -47,6 +47,13 @@
 #include "mtrInt.h"
 #include "cuddInt.h"
 
+#ifdef DD_HUGE_PAGES
+#include <sys/mman.h>
+#ifdef __linux__
+#include <linux/mman.h>
+#endif
+#endif
+
 /*---------------------------------------------------------------------------*/
 /* Constant declarations                                                     */
 /*---------------------------------------------------------------------------*/
@@ -211,7 +218,7 @@ Cudd_Reserve(
   @brief Fast storage allocation for DdNodes in the table.
 
   @details The first 4 bytes of a chunk contain a pointer to the next
-  block; the rest contains DD_MEM_CHUNK spaces for DdNodes.
+  block; the rest contains DD_NODE_CHUNK spaces for DdNodes.
 
   @return a pointer to a new node if successful; NULL is memory is
   full.
@@ -259,7 +266,7 @@ cuddAllocNode(
 	    /* Try to allocate a new block. */
 	    saveHandler = MMoutOfMemory;
 	    MMoutOfMemory = unique->outOfMemCallback;
-	    mem = (DdNodePtr *) ALLOC(DdNode,DD_MEM_CHUNK + 1);
+	    mem = (DdNodePtr *) cuddAllocPages(DdNode,DD_NODE_CHUNK + 1);
 	    MMoutOfMemory = saveHandler;
 	    if (mem == NULL) {
 		/* No more memory: Try collecting garbage. If this succeeds,
@@ -275,14 +282,14 @@ cuddAllocNode(
 			/* Inhibit resizing of tables. */
 			cuddSlowTableGrowth(unique);
 			/* Now try again. */
-			mem = (DdNodePtr *) ALLOC(DdNode,DD_MEM_CHUNK + 1);
+			mem = (DdNodePtr *) cuddAllocPages(DdNode,DD_NODE_CHUNK + 1);
 		    }
 		    if (mem == NULL) {
 			/* Out of luck. Call the default handler to do
 			** whatever it specifies for a failed malloc.
 			** If this handler returns, then set error code,
 			** print warning, and return. */
-			(*MMoutOfMemory)(sizeof(DdNode)*(DD_MEM_CHUNK + 1));
+			(*MMoutOfMemory)(sizeof(DdNode)*(DD_NODE_CHUNK + 1));
 			unique->errorCode = CUDD_MEMORY_OUT;
 #ifdef DD_VERBOSE
 			(void) fprintf(unique->err,
@@ -296,7 +303,7 @@ cuddAllocNode(
 	    }
 	    if (mem != NULL) {	/* successful allocation; slice memory */
 		ptruint offset;
-		unique->memused += (DD_MEM_CHUNK + 1) * sizeof(DdNode);
+		unique->memused += (DD_NODE_CHUNK + 1) * sizeof(DdNode);
 		mem[0] = (DdNodePtr) unique->memoryList;
 		unique->memoryList = mem;
 
@@ -311,10 +318,10 @@ cuddAllocNode(
 		do {
 		    list[i - 1].ref = 0;
 		    list[i - 1].next = &list[i];
-		} while (++i < DD_MEM_CHUNK);
+		} while (++i < DD_NODE_CHUNK);
 
-		list[DD_MEM_CHUNK-1].ref = 0;
-		list[DD_MEM_CHUNK-1].next = NULL;
+		list[DD_NODE_CHUNK-1].ref = 0;
+		list[DD_NODE_CHUNK-1].next = NULL;
 
 		unique->nextFree = &list[0];
 	    }
@@ -480,7 +487,7 @@ cuddInitTable(
 	unique->subtables[i].varHandled = 0;
 	unique->subtables[i].varToBeGrouped = CUDD_LAZY_NONE;
 
-	nodelist = unique->subtables[i].nodelist = ALLOC(DdNodePtr,slots);
+	nodelist = unique->subtables[i].nodelist = cuddAllocNodelist(slots);
 	if (nodelist == NULL) {
 	    for (j = 0; j < i; j++) {
 		FREE(unique->subtables[j].nodelist);
@@ -508,7 +515,7 @@ cuddInitTable(
 	unique->subtableZ[i].dead = 0;
         unique->subtableZ[i].next = i;
 	unique->subtableZ[i].maxKeys = slots * DD_MAX_SUBTABLE_DENSITY;
-	nodelist = unique->subtableZ[i].nodelist = ALLOC(DdNodePtr,slots);
+	nodelist = unique->subtableZ[i].nodelist = cuddAllocNodelist(slots);
 	if (nodelist == NULL) {
 	    for (j = 0; (unsigned) j < numVars; j++) {
 		FREE(unique->subtables[j].nodelist);
@@ -543,7 +550,7 @@ cuddInitTable(
     unique->constants.varHandled = 0;
     unique->constants.varToBeGrouped = CUDD_LAZY_NONE;
     unique->constants.maxKeys = slots * DD_MAX_SUBTABLE_DENSITY;
-    nodelist = unique->constants.nodelist = ALLOC(DdNodePtr,slots);
+    nodelist = unique->constants.nodelist = cuddAllocNodelist(slots);
     if (nodelist == NULL) {
 	for (j = 0; (unsigned) j < numVars; j++) {
 	    FREE(unique->subtables[j].nodelist);
@@ -676,7 +683,7 @@ cuddFreeTable(
     if (unique->univ != NULL) cuddZddFreeUniv(unique);
     while (memlist != NULL) {
 	next = (DdNodePtr *) memlist[0];	/* link to next block */
-	FREE(memlist);
+	cuddFreePages(memlist,DdNode,DD_NODE_CHUNK + 1);
 	memlist = next;
     }
     unique->nextFree = NULL;
@@ -691,7 +698,7 @@ cuddFreeTable(
     FREE(unique->constants.nodelist);
     FREE(unique->subtables);
     FREE(unique->subtableZ);
-    FREE(unique->acache);
+    cuddFreePages(unique->acache,DdCache,unique->cacheSlots);
     FREE(unique->perm);
     FREE(unique->permZ);
     FREE(unique->invperm);
@@ -720,6 +727,136 @@ cuddFreeTable(
 } /* end of cuddFreeTable */
 
 
+#ifdef DD_HUGE_PAGES
+/**
+  @brief Allocates memory from huge pages.
+
+  @details The blocks of at least DD_HUGE_PAGE_SIZE bytes are mapped
+  from the explicit 2 MB huge pages if the system has them reserved,
+  the page size is requested explicitly as the default one can differ
+  and the length must match it, otherwise from the anonymous memory
+  aligned to the huge page size
+  and advised to use the transparent huge pages. The smaller blocks
+  are allocated on the heap, aligned to a cache line. If the
+  allocation fails MMoutOfMemory is called, as for ALLOC.
+
+  @return a pointer to the memory if successful; NULL otherwise.
+
+  @sideeffect None
+
+  @see cuddHugeFree cuddHugeAllocTable
+
+*/
+void *
+cuddHugeAlloc(
+  size_t size)
+{
+    extern DD_OOMFP MMoutOfMemory;
+    void *mem;
+    char *aligned;
+    size_t length, head;
+
+    if (size < DD_HUGE_PAGE_SIZE) {
+	if (posix_memalign(&mem, 64, size) != 0) {
+	    if (MMoutOfMemory != 0) (*MMoutOfMemory)(size);
+	    return(NULL);
+	}
+	return(mem);
+    }
+    length = (size + DD_HUGE_PAGE_SIZE - 1) & ~(DD_HUGE_PAGE_SIZE - 1);
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_2MB)
+    mem = mmap(NULL, length, PROT_READ | PROT_WRITE,
+	       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+    if (mem != MAP_FAILED) {
+	return(mem);
+    }
+#endif
+    /* Map one huge page more and unmap the misaligned head and tail. */
+    mem = mmap(NULL, length + DD_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+	       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+	if (MMoutOfMemory != 0) (*MMoutOfMemory)(size);
+	return(NULL);
+    }
+    aligned = (char *) (((ptruint) mem + DD_HUGE_PAGE_SIZE - 1) &
+			~((ptruint) DD_HUGE_PAGE_SIZE - 1));
+    head = (size_t) (aligned - (char *) mem);
+    if (head > 0) {
+	(void) munmap(mem, head);
+    }
+    (void) munmap(aligned + length, DD_HUGE_PAGE_SIZE - head);
+#ifdef MADV_HUGEPAGE
+    (void) madvise(aligned, length, MADV_HUGEPAGE);
+#endif
+    return(aligned);
+
+} /* end of cuddHugeAlloc */
+
+
+/**
+  @brief Frees memory allocated by cuddHugeAlloc.
+
+  @details The size must be the one given to cuddHugeAlloc.
+
+  @sideeffect None
+
+  @see cuddHugeAlloc
+
+*/
+void
+cuddHugeFree(
+  void * p,
+  size_t size)
+{
+    if (p == NULL) return;
+    if (size < DD_HUGE_PAGE_SIZE) {
+	free(p);
+    } else {
+	(void) munmap(p, (size + DD_HUGE_PAGE_SIZE - 1) &
+		      ~(DD_HUGE_PAGE_SIZE - 1));
+    }
+
+} /* end of cuddHugeFree */
+
+
+/**
+  @brief Allocates memory for a table that is freed with FREE.
+
+  @details The tables of at least DD_HUGE_PAGE_SIZE bytes are aligned
+  to the huge page size and advised to use the transparent huge pages.
+  Unlike cuddHugeAlloc the explicit huge pages are not used, so that
+  the table can be released with FREE like the rest of the heap.
+
+  @return a pointer to the memory if successful; NULL otherwise.
+
+  @sideeffect None
+
+  @see cuddHugeAlloc
+
+*/
+void *
+cuddHugeAllocTable(
+  size_t size)
+{
+    extern DD_OOMFP MMoutOfMemory;
+    void *mem;
+
+    if (size < DD_HUGE_PAGE_SIZE) {
+	return(MMalloc(size));
+    }
+    if (posix_memalign(&mem, DD_HUGE_PAGE_SIZE, size) != 0) {
+	if (MMoutOfMemory != 0) (*MMoutOfMemory)(size);
+	return(NULL);
+    }
+#ifdef MADV_HUGEPAGE
+    (void) madvise(mem, size & ~(DD_HUGE_PAGE_SIZE - 1), MADV_HUGEPAGE);
+#endif
+    return(mem);
+
+} /* end of cuddHugeAllocTable */
+#endif
+
+
 /**
   @brief Performs garbage collection on the %BDD and %ZDD unique tables.
 
@@ -987,7 +1124,7 @@ cuddGarbageCollect(
 		    sentry = (sentry->next = &downTrav[k]);
 		}
 	    }
-	} while (++k < DD_MEM_CHUNK);
+	} while (++k < DD_NODE_CHUNK);
 	memListTrav = nxtNode;
     }
     sentry->next = NULL;
@@ -1637,7 +1774,7 @@ cuddRehash(
 
 	saveHandler = MMoutOfMemory;
 	MMoutOfMemory = unique->outOfMemCallback;
-	nodelist = ALLOC(DdNodePtr, slots);
+	nodelist = cuddAllocNodelist(slots);
 	MMoutOfMemory = saveHandler;
 	if (nodelist == NULL) {
 	    (void) fprintf(unique->err,
@@ -1704,7 +1841,7 @@ cuddRehash(
 	shift = oldshift - 1;
 	saveHandler = MMoutOfMemory;
 	MMoutOfMemory = unique->outOfMemCallback;
-	nodelist = ALLOC(DdNodePtr, slots);
+	nodelist = cuddAllocNodelist(slots);
 	MMoutOfMemory = saveHandler;
 	if (nodelist == NULL) {
 	    (void) fprintf(unique->err,
@@ -1779,7 +1916,7 @@ cuddShrinkSubtable(
     slots = oldslots >> 1;
     saveHandler = MMoutOfMemory;
     MMoutOfMemory = unique->outOfMemCallback;
-    nodelist = ALLOC(DdNodePtr, slots);
+    nodelist = cuddAllocNodelist(slots);
     MMoutOfMemory = saveHandler;
     if (nodelist == NULL) {
 	return;
@@ -1914,7 +2051,7 @@ cuddInsertSubtables(
 	    unique->perm[oldsize+i] = level + i;
 	    unique->invperm[level+i] = oldsize + i;
 	    newnodelist = unique->subtables[level+i].nodelist =
-		ALLOC(DdNodePtr, numSlots);
+		cuddAllocNodelist(numSlots);
 	    if (newnodelist == NULL) {
 		unique->errorCode = CUDD_MEMORY_OUT;
 		return(0);
@@ -2020,7 +2157,7 @@ cuddInsertSubtables(
 
 	    newperm[oldsize + i - level] = i;
 	    newinvperm[i] = oldsize + i - level;
-	    newnodelist = newsubtables[i].nodelist = ALLOC(DdNodePtr, numSlots);
+	    newnodelist = newsubtables[i].nodelist = cuddAllocNodelist(numSlots);
 	    if (newnodelist == NULL) {
 		/* We are going to leak some memory.  We should clean up. */
 		unique->errorCode = CUDD_MEMORY_OUT;
@@ -2331,7 +2468,7 @@ cuddResizeTableZdd(
 	    unique->permZ[i] = i;
 	    unique->invpermZ[i] = i;
 	    newnodelist = unique->subtableZ[i].nodelist =
-		ALLOC(DdNodePtr, numSlots);
+		cuddAllocNodelist(numSlots);
 	    if (newnodelist == NULL) {
 		unique->errorCode = CUDD_MEMORY_OUT;
 		return(0);
@@ -2401,7 +2538,7 @@ cuddResizeTableZdd(
             newsubtables[i].next = i;
 	    newperm[i] = i;
 	    newinvperm[i] = i;
-	    newnodelist = newsubtables[i].nodelist = ALLOC(DdNodePtr, numSlots);
+	    newnodelist = newsubtables[i].nodelist = cuddAllocNodelist(numSlots);
 	    if (newnodelist == NULL) {
 		unique->errorCode = CUDD_MEMORY_OUT;
 		return(0);
@@ -2525,7 +2662,7 @@ ddRehashZdd(
 
     saveHandler = MMoutOfMemory;
     MMoutOfMemory = unique->outOfMemCallback;
-    nodelist = ALLOC(DdNodePtr, slots);
+    nodelist = cuddAllocNodelist(slots);
     MMoutOfMemory = saveHandler;
     if (nodelist == NULL) {
 	(void) fprintf(unique->err,
@@ -2622,7 +2759,7 @@ ddResizeTable(
 	    unique->perm[i] = i;
 	    unique->invperm[i] = i;
 	    newnodelist = unique->subtables[i].nodelist =
-		ALLOC(DdNodePtr, numSlots);
+		cuddAllocNodelist(numSlots);
 	    if (newnodelist == NULL) {
 		for (j = oldsize; j < i; j++) {
 		    FREE(unique->subtables[j].nodelist);
@@ -2743,7 +2880,7 @@ ddResizeTable(
 
 	    newperm[i] = i;
 	    newinvperm[i] = i;
-	    newnodelist = newsubtables[i].nodelist = ALLOC(DdNodePtr, numSlots);
+	    newnodelist = newsubtables[i].nodelist = cuddAllocNodelist(numSlots);
 	    if (newnodelist == NULL) {
 		unique->errorCode = CUDD_MEMORY_OUT;
 		return(0);
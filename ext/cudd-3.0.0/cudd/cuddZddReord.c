@@ -1392,7 +1392,7 @@ zddReorderPostprocess(
 	slots = oldslots >> 1;
 	saveHandler = MMoutOfMemory;
 	MMoutOfMemory = table->outOfMemCallback;
-	nodelist = ALLOC(DdNodePtr, slots);
+	nodelist = cuddAllocNodelist(slots);
 	MMoutOfMemory = saveHandler;
 	if (nodelist == NULL) {
 	    return(1);
@@ -1105,6 +1105,10 @@ DddmpCuddDdArrayLoad (
         break;
      }
 
+    /* The node construction fails if the manager runs out of memory */
+    Dddmp_CheckAndGotoLabel (pnodes[i]==NULL, "Error building the DD node.",
+      failure);
+
     cuddRef (pnodes[i]);
   }
 
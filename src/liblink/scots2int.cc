@@ -36,19 +36,39 @@
 #include "scots.hh"
 
 #include "input_output.hh"
+#include "ctrl_sessions.hh"
 
 using namespace std;
 using namespace scots;
 using namespace tud::ctrl::scots::optimal;
 
 /*Define the global variables*/
-static Cudd * pCuddMgr = NULL; //Stores the CUDD manager
-static BDD * pBDD = NULL; //Stores the BDD of the controller
-static SymbolicSet * pCtr = NULL; //Stores the Symbolic set of the controller
+static ctrl_sessions sessions; //Stores the loaded controllers
 
 /*Data type for the state space and input values*/
 using data_type = std::vector<double>;
 
+/**
+ * Allows to get the loaded controller by its handle, the handle is the first argument
+ * @param libData the library data object
+ * @param Argc the number of arguments
+ * @param Args the arguments, the first one stores the controller handle
+ * @return the pointer to the controller session or NULL if it is not loaded
+ */
+static inline ctrl_session * get_session(WolframLibraryData & libData, mint Argc, MArgument * Args) {
+    if(Argc < 1) {
+        libData->Message("inc_num_arg");
+        return NULL;
+    }
+    try {
+        return &sessions.get((ctrl_handle) MArgument_getInteger(Args[0]));
+    } catch (tud_exception & ex) {
+        //The controller is not loaded
+        libData->Message("missing_ctrl");
+        return NULL;
+    }
+}
+
 /**
  * Allows to copy the data from a vector to the tensor
  * @param libData the library data object
@@ -99,9 +119,11 @@ DLLEXPORT int WolframLibrary_initialize(WolframLibraryData /* unused */) {
 }
 
 /**
- * Allows to load the SCOTS v2.0 BDD controller
+ * Allows to load the SCOTS v2.0 BDD controller, the controllers defined
+ * on the same grid share the CUDD manager. If the memory cap is set then
+ * the least recently used controllers might get unloaded.
  * @param file_name the C-string name of the controller file without ".scs" extention
- * @result 0 if everything went fine, otherwise an error
+ * @result the handle of the loaded controller
  */
 EXTERN_C DLLEXPORT int load_controller_bdd(WolframLibraryData libData, mint Argc,
                                            MArgument *Args, MArgument Res)
@@ -116,32 +138,72 @@ EXTERN_C DLLEXPORT int load_controller_bdd(WolframLibraryData libData, mint Argc
         //Get the file name as a string
         string file_name(s);
     
-        /*Re-allocate the data structures*/
-        if(pCtr) {
-            delete pCtr;
-        }
-        pCtr = new SymbolicSet();
-        if(pBDD) {
-            delete pBDD;
-        }
-        pBDD = new BDD();
-        if(pCuddMgr) {
-            delete pCuddMgr;
-        }
-        pCuddMgr = new Cudd();
-        //Disable automatic variable ordering
-        pCuddMgr->AutodynDisable();
-
         //Releaser the string memory
         libData->UTF8String_disown(s);
     
         /* read controller from file */
-        if(!read_from_file(*pCuddMgr, *pCtr, *pBDD, file_name.c_str())) {
+        try {
+            //Get the controller handle and set as a result
+            MArgument_setInteger(Res, sessions.load(file_name));
+        } catch (tud_exception & ex) {
             libData->Message("file_read_error");
             err = LIBRARY_FUNCTION_ERROR;
+        }
+    } else {
+        libData->Message("inc_num_arg");
+        err = LIBRARY_FUNCTION_ERROR;
+    }
+    
+    //Return the result code
+    return err;
+}
+
+/**
+ * Allows to unload the SCOTS v2.0 BDD controller
+ * @param handle the controller handle
+ * @result 0 if everything went fine, otherwise an error
+ */
+EXTERN_C DLLEXPORT int unload_controller_bdd(WolframLibraryData libData, mint Argc,
+                                             MArgument *Args, MArgument /* unused */)
+{
+    //The error code
+    int err = LIBRARY_NO_ERROR;
+    
+    if( Argc == 1 ) {
+        if(!sessions.unload((ctrl_handle) MArgument_getInteger(Args[0]))) {
+            //The controller is not loaded
+            libData->Message("missing_ctrl");
+            err = LIBRARY_FUNCTION_ERROR;
+        }
+    } else {
+        libData->Message("inc_num_arg");
+        err = LIBRARY_FUNCTION_ERROR;
+    }
+    
+    //Return the result code
+    return err;
+}
+
+/**
+ * Allows to set the memory cap for the loaded controllers. Once the estimated
+ * size of the loaded controllers exceeds the cap, the least recently used
+ * controllers are unloaded.
+ * @param mem_cap_mb the memory cap in MB, zero means no cap
+ * @result 0 if everything went fine, otherwise an error
+ */
+EXTERN_C DLLEXPORT int set_memory_cap(WolframLibraryData libData, mint Argc,
+                                      MArgument *Args, MArgument /* unused */)
+{
+    //The error code
+    int err = LIBRARY_NO_ERROR;
+    
+    if( Argc == 1 ) {
+        const mint mem_cap_mb = MArgument_getInteger(Args[0]);
+        if(mem_cap_mb >= 0) {
+            sessions.set_mem_cap(((size_t) mem_cap_mb) * 1024 * 1024);
         } else {
-            //Get the number of BDD nodes and set as a result
-            MArgument_setInteger(Res, pBDD->nodeCount());
+            libData->Message("inc_mem_cap");
+            err = LIBRARY_FUNCTION_ERROR;
         }
     } else {
         libData->Message("inc_num_arg");
@@ -152,24 +214,52 @@ EXTERN_C DLLEXPORT int load_controller_bdd(WolframLibraryData libData, mint Argc
     return err;
 }
 
+/**
+ * Allows to get the number of BDD nodes of the controller
+ * @param handle the controller handle
+ * @param Res will store the number of BDD nodes
+ * @result 0 if everything went fine, otherwise an error
+ */
+EXTERN_C DLLEXPORT int get_node_count(WolframLibraryData libData, mint Argc,
+                                      MArgument *Args, MArgument Res) {
+    //The error code
+    int err = LIBRARY_NO_ERROR;
+    
+    //Get the controller by its handle
+    ctrl_session * pSes = get_session(libData, Argc, Args);
+    
+    if(pSes) {
+        //Get the number of BDD nodes and set as a result
+        MArgument_setInteger(Res, pSes->m_ctrl_bdd.nodeCount());
+    } else {
+        err = LIBRARY_FUNCTION_ERROR;
+    }
+    
+    //Return the result code
+    return err;
+}
+
 /**
  * Allows to get the number of dimensions of the controller.
  * This is the sum of the state space dimensions and input
  * signal dimensions.
+ * @param handle the controller handle
  * @param Res will store the integer value that is the length of the domain + co-domain
  * @return 0 if the controller is not loaded, otherwise the number of dimensions
  */
-EXTERN_C DLLEXPORT int get_dim(WolframLibraryData libData, mint /* unused */,
-                               MArgument * /* unused */, MArgument Res) {
+EXTERN_C DLLEXPORT int get_dim(WolframLibraryData libData, mint Argc,
+                               MArgument *Args, MArgument Res) {
     //The error code
     int err = LIBRARY_NO_ERROR;
     
-    if(pCtr) {
+    //Get the controller by its handle
+    ctrl_session * pSes = get_session(libData, Argc, Args);
+    
+    if(pSes) {
         //Get the dimensions and set as a result
-        MArgument_setInteger(Res, pCtr->get_dim());
+        MArgument_setInteger(Res, pSes->m_ctrl_set.get_dim());
     } else {
-        //The controller is not loaded yet
-        libData->Message("missing_ctrl");
+        //The controller is not loaded
         err = LIBRARY_FUNCTION_ERROR;
     }
     
@@ -179,22 +269,25 @@ EXTERN_C DLLEXPORT int get_dim(WolframLibraryData libData, mint /* unused */,
 
 /**
  * Allows to get the list of discretization values per dimension
+ * @param handle the controller handle
  * @return the list of discretization parameters
  */
-EXTERN_C DLLEXPORT int get_eta(WolframLibraryData libData, mint /* unused */,
-                               MArgument * /* unused */, MArgument Res) {
+EXTERN_C DLLEXPORT int get_eta(WolframLibraryData libData, mint Argc,
+                               MArgument *Args, MArgument Res) {
     //The error code
     int err = LIBRARY_NO_ERROR;
     
-    if(pCtr) {
+    //Get the controller by its handle
+    ctrl_session * pSes = get_session(libData, Argc, Args);
+    
+    if(pSes) {
         //Get the eta vector and then return it to Mathematica
-        data_type data = pCtr->get_eta();
+        data_type data = pSes->m_ctrl_set.get_eta();
         
         //Copy the data to the tensor and set as the result
         err = set_result_tensor(libData, data, Res);
     } else {
-        //The controller is not loaded yet
-        libData->Message("missing_ctrl");
+        //The controller is not loaded
         err = LIBRARY_FUNCTION_ERROR;
     }
     
@@ -204,24 +297,27 @@ EXTERN_C DLLEXPORT int get_eta(WolframLibraryData libData, mint /* unused */,
 
 /**
  * Allows to get the position of the lower-left point of the grid
+ * @param handle the controller handle
  * @param tens a rank one tensor that will store the resulting point
  *             of the length of domain+co-domain.
  * @return the lower-left point of the grid
  */
-EXTERN_C DLLEXPORT int get_lower_left(WolframLibraryData libData, mint /* unused */,
-                                      MArgument */* unused */, MArgument Res) {
+EXTERN_C DLLEXPORT int get_lower_left(WolframLibraryData libData, mint Argc,
+                                      MArgument *Args, MArgument Res) {
     //The error code
     int err = LIBRARY_NO_ERROR;
     
-    if(pCtr) {
+    //Get the controller by its handle
+    ctrl_session * pSes = get_session(libData, Argc, Args);
+    
+    if(pSes) {
         //Get the lower left vector and then return it to Mathematica
-        data_type data = pCtr->get_lower_left();
+        data_type data = pSes->m_ctrl_set.get_lower_left();
         
         //Copy the data to the tensor and set as the result
         err = set_result_tensor(libData, data, Res);
     } else {
-        //The controller is not loaded yet
-        libData->Message("missing_ctrl");
+        //The controller is not loaded
         err = LIBRARY_FUNCTION_ERROR;
     }
     
@@ -231,24 +327,27 @@ EXTERN_C DLLEXPORT int get_lower_left(WolframLibraryData libData, mint /* unused
 
 /**
  * Allows to get the position of the upper-right point of the grid
+ * @param handle the controller handle
  * @param tens a rank one tensor that will store the resulting point
  *             of the length of domain+co-domain.
  * @return the upper-right point of the grid
  */
-EXTERN_C DLLEXPORT int get_upper_right(WolframLibraryData libData, mint /* unused */,
-                                       MArgument */* unused */, MArgument Res) {
+EXTERN_C DLLEXPORT int get_upper_right(WolframLibraryData libData, mint Argc,
+                                       MArgument *Args, MArgument Res) {
     //The error code
     int err = LIBRARY_NO_ERROR;
     
-    if(pCtr) {
+    //Get the controller by its handle
+    ctrl_session * pSes = get_session(libData, Argc, Args);
+    
+    if(pSes) {
         //Get the upper right vector and then return it to Mathematica
-        data_type data = pCtr->get_upper_right();
+        data_type data = pSes->m_ctrl_set.get_upper_right();
         
         //Copy the data to the tensor and set as the result
         err = set_result_tensor(libData, data, Res);
     } else {
-        //The controller is not loaded yet
-        libData->Message("missing_ctrl");
+        //The controller is not loaded
         err = LIBRARY_FUNCTION_ERROR;
     }
     
@@ -260,22 +359,25 @@ EXTERN_C DLLEXPORT int get_upper_right(WolframLibraryData libData, mint /* unuse
  *  The return vector is of size (number of grid points) x n where n is the dimension.
  *  The grid points are stacked on top of each other, i.e., the first n
  *  entries of the return vector represent the first grid point.
+ *  @param handle the controller handle
  *  @return the list of grid points
  **/
-EXTERN_C DLLEXPORT int get_grid_points(WolframLibraryData libData, mint /* unused */,
-                                       MArgument * /* unused */, MArgument Res) {
+EXTERN_C DLLEXPORT int get_grid_points(WolframLibraryData libData, mint Argc,
+                                       MArgument *Args, MArgument Res) {
     //The error code
     int err = LIBRARY_NO_ERROR;
     
-    if(pCtr) {
+    //Get the controller by its handle
+    ctrl_session * pSes = get_session(libData, Argc, Args);
+    
+    if(pSes) {
         //Obtaian the grid points data
-        data_type data = pCtr->bdd_to_grid_points(*pCuddMgr, *pBDD);
+        data_type data = pSes->m_ctrl_set.bdd_to_grid_points(*pSes->m_cudd_mgr, pSes->m_ctrl_bdd);
         
         //Copy the data to the tensor and set as the result
         err = set_result_tensor(libData, data, Res);
     } else {
-        //The controller is not loaded yet
-        libData->Message("missing_ctrl");
+        //The controller is not loaded
         err = LIBRARY_FUNCTION_ERROR;
     }
     
@@ -285,35 +387,42 @@ EXTERN_C DLLEXPORT int get_grid_points(WolframLibraryData libData, mint /* unuse
 
 /**
  * Allows to get the available input signal values per state
- * NOTE-1: Must get the one perameter as specified, the latter
- * is not checked in the code for the sped purposes!
- * NOTE-2: Must have the controller loaded, the latter
+ * NOTE: Must get the two perameters as specified, the latter
  * is not checked in the code for the sped purposes!
+ * @param handle the controller handle
  * @param dom_point a rank one tensor
  * @return the list of input signal values
  */
 
-EXTERN_C DLLEXPORT int restriction(WolframLibraryData libData, mint /* unused */,
+EXTERN_C DLLEXPORT int restriction(WolframLibraryData libData, mint Argc,
                                    MArgument *Args, MArgument Res) {
     //The error code
     int err = LIBRARY_NO_ERROR;
     
-    //Obtain the domain tensor from the parameters
-    MTensor tens_dom = MArgument_getMTensor(Args[0]);
-    
-    //Get the data and the data length
-    double * point = libData->MTensor_getRealData(tens_dom);
-    int len = libData->MTensor_getFlattenedLength(tens_dom);
+    //Get the controller by its handle
+    ctrl_session * pSes = get_session(libData, Argc, Args);
     
-    //Initialize a vector to use in restriction
-    data_type point_x;
-    point_x.assign(point, point + len);
-    
-    //Get the restriction
-    data_type data = pCtr->restriction(*pCuddMgr, *pBDD, point_x);
-
-    //Copy the data to the tensor and set as the result
-    err = set_result_tensor(libData, data, Res);
+    if(pSes) {
+        //Obtain the domain tensor from the parameters
+        MTensor tens_dom = MArgument_getMTensor(Args[1]);
+        
+        //Get the data and the data length
+        double * point = libData->MTensor_getRealData(tens_dom);
+        int len = libData->MTensor_getFlattenedLength(tens_dom);
+        
+        //Initialize a vector to use in restriction
+        data_type point_x;
+        point_x.assign(point, point + len);
+        
+        //Get the restriction
+        data_type data = pSes->m_ctrl_set.restriction(*pSes->m_cudd_mgr, pSes->m_ctrl_bdd, point_x);
+        
+        //Copy the data to the tensor and set as the result
+        err = set_result_tensor(libData, data, Res);
+    } else {
+        //The controller is not loaded
+        err = LIBRARY_FUNCTION_ERROR;
+    }
     
     //Return the result code
     return err;
@@ -323,6 +432,7 @@ EXTERN_C DLLEXPORT int restriction(WolframLibraryData libData, mint /* unused */
 /**
  * Allows to store the controller in a bdd form with the inputs being the control functional ids.
  * Note that, the functionals corresponding to the controller ids are to be stored separately.
+ * @param handle the controller handle, the source of the state-space grid and BDD variables
  * @param num_ctl the number of fontrol modes (controller ids) used in the controller.
  * @param data the tensor rank two storing the controller points in a form
  *             {{state_point, controller_id}, ... {state_point, controller_id}}.
@@ -337,16 +447,16 @@ EXTERN_C DLLEXPORT int store_controller_bdd(WolframLibraryData libData, mint Arg
     //The error code
     int err = LIBRARY_NO_ERROR;
     
-    if( Argc == 4 ) {
+    if( Argc == 5 ) {
         //Get the number of controllers
-        const mint num_ctl = MArgument_getInteger(Args[0]);
+        const mint num_ctl = MArgument_getInteger(Args[1]);
         
         //Get the tensor data storing the controllers
-        MTensor data = MArgument_getMTensor(Args[1]);
+        MTensor data = MArgument_getMTensor(Args[2]);
         const mint rank = libData->MTensor_getRank(data);
 
         //Get the string storing the controller name
-        char* file_name = MArgument_getUTF8String(Args[2]);
+        char* file_name = MArgument_getUTF8String(Args[3]);
         
         //Make the log file
         string log_file_name(file_name);
@@ -370,22 +480,25 @@ EXTERN_C DLLEXPORT int store_controller_bdd(WolframLibraryData libData, mint Arg
             
             //The state space dimensionality is to be positive
             if(state_dim > 0) {
+                //Get the source controller by its handle
+                ctrl_session * pSes = get_session(libData, Argc, Args);
+                
                 //Check if the scots controller is loaded
-                if(pCtr) {
+                if(pSes) {
                     //Check if one needs optimization of variable orders
-                    const mbool is_opt = MArgument_getBoolean(Args[3]);
+                    const mbool is_opt = MArgument_getBoolean(Args[4]);
                     //Create symbolic set for the state space using new BDD varibales
-                    //scots::SymbolicSet ss_state(*pCuddMgr, state_dim,
-                    //                            pCtr->get_lower_left(),
-                    //                            pCtr->get_upper_right(),
-                    //                            pCtr->get_eta());
+                    //scots::SymbolicSet ss_state(*pSes->m_cudd_mgr, state_dim,
+                    //                            pSes->m_ctrl_set.get_lower_left(),
+                    //                            pSes->m_ctrl_set.get_upper_right(),
+                    //                            pSes->m_ctrl_set.get_eta());
                     
                     //Create symbolic set for the state space re-using exisintg BDD varibales
                     UniformGrid ss_grid(state_dim,
-                                        pCtr->get_lower_left(),
-                                        pCtr->get_upper_right(),
-                                        pCtr->get_eta());
-                    std::vector<IntegerInterval<abs_type>> ints = pCtr->get_bdd_intervals();
+                                        pSes->m_ctrl_set.get_lower_left(),
+                                        pSes->m_ctrl_set.get_upper_right(),
+                                        pSes->m_ctrl_set.get_eta());
+                    std::vector<IntegerInterval<abs_type>> ints = pSes->m_ctrl_set.get_bdd_intervals();
                     auto first = ints.begin();
                     auto last = first + state_dim;
                     std::vector<IntegerInterval<abs_type>> sub_ints(first, last);
@@ -393,13 +506,13 @@ EXTERN_C DLLEXPORT int store_controller_bdd(WolframLibraryData libData, mint Arg
                     
                     //Create symbolic set for the input signals
                     data_type ill = {1}, iur = {(double)num_ctl}, ieta = {1.0};
-                    scots::SymbolicSet ss_input(*pCuddMgr, 1, ill, iur, ieta);
+                    scots::SymbolicSet ss_input(*pSes->m_cudd_mgr, 1, ill, iur, ieta);
                     
                     //Create the common symbolic set for the state and inpout spaces
                     scots::SymbolicSet ctrl_info(ss_state, ss_input);
                     
                     //Initialize the controller BDD
-                    BDD ctrl_bdd = pCuddMgr->bddZero();
+                    BDD ctrl_bdd = pSes->m_cudd_mgr->bddZero();
                     
                     //Create the controller bdd from data
                     double * points = libData->MTensor_getRealData(data);
@@ -436,11 +549,11 @@ EXTERN_C DLLEXPORT int store_controller_bdd(WolframLibraryData libData, mint Arg
                     try{
                         if(is_opt) {
                             //Perform optimization and store the minimized bdd
-                            store_min_controller(*pCuddMgr, ctrl_info, ctrl_bdd,
+                            store_min_controller(*pSes->m_cudd_mgr, ctrl_info, ctrl_bdd,
                                                  file_name, store_type_enum::reorder);
                         } else {
                             //Store the original controller
-                            store_controller(*pCuddMgr, ctrl_info, ctrl_bdd, file_name);
+                            store_controller(*pSes->m_cudd_mgr, ctrl_info, ctrl_bdd, file_name);
                         }
                     }catch(...){
                         //The controller could not be written
@@ -450,8 +563,7 @@ EXTERN_C DLLEXPORT int store_controller_bdd(WolframLibraryData libData, mint Arg
                     
                     logfile << "Work is finished!\n" << std::flush;
                 } else {
-                    //The controller is not loaded yet
-                    libData->Message("missing_ctrl");
+                    //The controller is not loaded
                     err = LIBRARY_FUNCTION_ERROR;
                 }
             } else {
@@ -0,0 +1,64 @@
+/*
+ * File:   alloc_stats.cc
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 25, 2018, 10:52 AM
+ */
+
+#include <new>
+#include <cstddef>
+
+#include "alloc_stats.hh"
+
+/**
+ * The replacements of the global allocation functions, counting the allocations
+ */
+void * operator new(size_t size) {
+    return tud::utils::monitor::alloc_stats::allocate_or_throw(size);
+}
+
+void * operator new[](size_t size) {
+    return tud::utils::monitor::alloc_stats::allocate_or_throw(size);
+}
+
+void * operator new(size_t size, const std::nothrow_t &) noexcept {
+    return tud::utils::monitor::alloc_stats::allocate(size);
+}
+
+void * operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return tud::utils::monitor::alloc_stats::allocate(size);
+}
+
+void operator delete(void * p_mem) noexcept {
+    tud::utils::monitor::alloc_stats::deallocate(p_mem);
+}
+
+void operator delete[](void * p_mem) noexcept {
+    tud::utils::monitor::alloc_stats::deallocate(p_mem);
+}
+
+void operator delete(void * p_mem, const std::nothrow_t &) noexcept {
+    tud::utils::monitor::alloc_stats::deallocate(p_mem);
+}
+
+void operator delete[](void * p_mem, const std::nothrow_t &) noexcept {
+    tud::utils::monitor::alloc_stats::deallocate(p_mem);
+}
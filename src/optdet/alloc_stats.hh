@@ -0,0 +1,200 @@
+/*
+ * File:   alloc_stats.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 25, 2018, 10:17 AM
+ */
+
+#ifndef ALLOC_STATS_HPP
+#define ALLOC_STATS_HPP
+
+#include <new>
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <cstddef>
+
+#include "logger.hh"
+
+using namespace std;
+
+using namespace tud::utils::logging;
+
+namespace tud {
+    namespace utils {
+        namespace monitor {
+
+            //The size of the header storing the allocated size, keeps the maximum alignment
+#define ALLOC_STATS_HEADER_SIZE (sizeof(max_align_t))
+
+            /**
+             * This structure stores the allocation statistics
+             */
+            struct alloc_usage {
+                //The number of allocations
+                uint64_t m_count;
+                //The number of allocated bytes
+                uint64_t m_bytes;
+                //The number of live bytes
+                uint64_t m_live;
+                //The peak number of live bytes
+                uint64_t m_peak;
+            };
+
+            /**
+             * This class counts the allocations done through the global operator new,
+             * it is only used in the build with ALLOC_STATS defined, where
+             * alloc_stats.cc replaces the global operator new and delete. The peak number
+             * of live bytes is tracked per phase: the phase start resets it to the
+             * current live bytes and the phase end restores the enclosing phase's peak.
+             * The counters are global, so the phases running concurrently on different
+             * threads see each other's allocations.
+             */
+            class alloc_stats {
+            public:
+
+                /**
+                 * Allows to allocate the memory and to count the allocation
+                 * @param size the number of bytes to allocate
+                 * @return the pointer to the memory or NULL if out of memory
+                 */
+                static inline void * allocate(const size_t size) {
+                    char * const p_base = static_cast<char *> (malloc(size + ALLOC_STATS_HEADER_SIZE));
+                    if (p_base == NULL) {
+                        return NULL;
+                    }
+                    *reinterpret_cast<size_t *> (p_base) = size;
+
+                    counters & cnt = get_counters();
+                    cnt.m_count.fetch_add(1, memory_order_relaxed);
+                    cnt.m_bytes.fetch_add(size, memory_order_relaxed);
+                    const uint64_t live = cnt.m_live.fetch_add(size, memory_order_relaxed) + size;
+                    uint64_t peak = cnt.m_peak.load(memory_order_relaxed);
+                    while ((live > peak) && !cnt.m_peak.compare_exchange_weak(peak, live, memory_order_relaxed)) {
+                    }
+
+                    return p_base + ALLOC_STATS_HEADER_SIZE;
+                }
+
+                /**
+                 * Allows to allocate the memory for operator new
+                 * @param size the number of bytes to allocate
+                 * @return the pointer to the memory
+                 */
+                static inline void * allocate_or_throw(const size_t size) {
+                    void * p_mem = NULL;
+                    while ((p_mem = allocate(size)) == NULL) {
+                        const new_handler handler = get_new_handler();
+                        if (handler == NULL) {
+                            throw bad_alloc();
+                        }
+                        handler();
+                    }
+                    return p_mem;
+                }
+
+                /**
+                 * Allows to free the memory allocated by allocate
+                 * @param p_mem the pointer to the memory, may be NULL
+                 */
+                static inline void deallocate(void * p_mem) {
+                    if (p_mem != NULL) {
+                        char * const p_base = static_cast<char *> (p_mem) - ALLOC_STATS_HEADER_SIZE;
+                        get_counters().m_live.fetch_sub(*reinterpret_cast<size_t *> (p_base), memory_order_relaxed);
+                        free(p_base);
+                    }
+                }
+
+                /**
+                 * Allows to start the phase
+                 * @param start the phase start statistics to be filled in,
+                 *              its peak is the enclosing phase's peak
+                 */
+                static inline void start_phase(alloc_usage & start) {
+                    counters & cnt = get_counters();
+                    start.m_count = cnt.m_count.load(memory_order_relaxed);
+                    start.m_bytes = cnt.m_bytes.load(memory_order_relaxed);
+                    start.m_live = cnt.m_live.load(memory_order_relaxed);
+                    start.m_peak = cnt.m_peak.exchange(start.m_live, memory_order_relaxed);
+                }
+
+                /**
+                 * Allows to end the phase
+                 * @param start the phase start statistics
+                 * @param phase the phase statistics to be filled in, the live
+                 *              bytes are the change over the phase
+                 */
+                static inline void end_phase(const alloc_usage & start, alloc_usage & phase) {
+                    counters & cnt = get_counters();
+                    phase.m_count = cnt.m_count.load(memory_order_relaxed) - start.m_count;
+                    phase.m_bytes = cnt.m_bytes.load(memory_order_relaxed) - start.m_bytes;
+                    phase.m_live = cnt.m_live.load(memory_order_relaxed) - start.m_live;
+                    phase.m_peak = cnt.m_peak.load(memory_order_relaxed);
+                    //Restore the enclosing phase's peak, if it was larger
+                    uint64_t peak = phase.m_peak;
+                    while ((start.m_peak > peak) && !cnt.m_peak.compare_exchange_weak(peak, start.m_peak, memory_order_relaxed)) {
+                    }
+                }
+
+                /**
+                 * Allows to report the phase statistics
+                 * @param action the phase name
+                 * @param phase the phase statistics
+                 */
+                static inline void report(const string & action, const alloc_usage & phase) {
+                    LOG_USAGE << action << " did " << phase.m_count << " allocations of "
+                            << phase.m_bytes << " bytes, live bytes change: "
+                            << static_cast<int64_t> (phase.m_live) << ", peak live bytes: "
+                            << phase.m_peak << END_LOG;
+                }
+
+            private:
+
+                /**
+                 * This structure stores the global counters
+                 */
+                struct counters {
+                    //The number of allocations
+                    atomic<uint64_t> m_count;
+                    //The number of allocated bytes
+                    atomic<uint64_t> m_bytes;
+                    //The number of live bytes
+                    atomic<uint64_t> m_live;
+                    //The peak number of live bytes
+                    atomic<uint64_t> m_peak;
+                };
+
+                /**
+                 * Allows to get the global counters, these are zero
+                 * initialized before any allocation can take place
+                 * @return the counters
+                 */
+                static inline counters & get_counters() {
+                    static counters s_counters;
+                    return s_counters;
+                }
+            };
+        }
+    }
+}
+
+#endif /* ALLOC_STATS_HPP */
@@ -0,0 +1,556 @@
+/* 
+ * File:   async_logger.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 20, 2018, 14:05 PM
+ */
+
+#ifndef ASYNC_LOGGER_HPP
+#define ASYNC_LOGGER_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <streambuf>
+
+using namespace std;
+
+namespace tud {
+    namespace utils {
+        namespace logging {
+
+            //The per thread log ring buffer size in bytes, must be a power of two
+#define ASYNC_LOG_RING_SIZE (1u << 20)
+
+            //The period of the writer thread draining the ring buffers, in milli seconds
+#define ASYNC_LOG_PERIOD_MS 2
+
+            /**
+             * This class is a single producer single consumer lock free ring buffer
+             * of the log messages. A message is stored as its sequence number, its
+             * length and its characters, the ring never grows and the messages not
+             * fitting into the free space are rejected. While a message is being
+             * pushed the ring exposes a lower bound of its sequence number.
+             */
+            class log_ring {
+            public:
+
+                /**
+                 * This structure stores the message popped from the ring
+                 */
+                struct log_record {
+                    //The message sequence number
+                    uint64_t m_seq;
+                    //The message position in the popped characters
+                    size_t m_pos;
+                    //The message length
+                    uint32_t m_len;
+                };
+
+                /**
+                 * The basic constructor
+                 * @param size the ring size in bytes, must be a power of two
+                 */
+                log_ring(const size_t size)
+                : m_data(size), m_mask(size - 1), m_head(0), m_tail(0), m_in_flight(NO_IN_FLIGHT) {
+                }
+
+                /**
+                 * Allows to announce the push, to be called by the producer thread
+                 * before taking the message sequence number
+                 * @param min_seq the lower bound of the message sequence number
+                 */
+                inline void begin_push(const uint64_t min_seq) {
+                    m_in_flight.store(min_seq);
+                }
+
+                /**
+                 * Allows to finish the push, to be called by the producer thread
+                 * once the message is pushed or rejected
+                 */
+                inline void end_push() {
+                    m_in_flight.store(NO_IN_FLIGHT, memory_order_release);
+                }
+
+                /**
+                 * Allows to get the lower bound of the sequence number of the message being pushed
+                 * @return the lower bound of the sequence number or NO_IN_FLIGHT if there is none
+                 */
+                inline uint64_t get_in_flight() const {
+                    return m_in_flight.load();
+                }
+
+                /**
+                 * Allows to push the message, to be called by the producer thread only
+                 * @param seq the message sequence number
+                 * @param msg the message characters
+                 * @param len the message length
+                 * @return true if the message was pushed, false if it did not fit
+                 */
+                inline bool push(const uint64_t seq, const char * msg, const uint32_t len) {
+                    const size_t rec_len = HEADER_LEN + len;
+                    const size_t head = m_head.load(memory_order_relaxed);
+                    const size_t tail = m_tail.load(memory_order_acquire);
+                    if (rec_len > (m_data.size() - (head - tail))) {
+                        return false;
+                    }
+                    write(head, &seq, sizeof (seq));
+                    write(head + sizeof (seq), &len, sizeof (len));
+                    write(head + HEADER_LEN, msg, len);
+                    m_head.store(head + rec_len, memory_order_release);
+                    return true;
+                }
+
+                /**
+                 * Allows to pop all the messages, to be called by the consumer only
+                 * @param records the records to append the messages to
+                 * @param chars the characters to append the messages to
+                 */
+                inline void pop_all(vector<log_record> & records, string & chars) {
+                    const size_t head = m_head.load(memory_order_acquire);
+                    size_t tail = m_tail.load(memory_order_relaxed);
+                    while (tail < head) {
+                        log_record record = {0, chars.size(), 0};
+                        read(tail, &record.m_seq, sizeof (record.m_seq));
+                        read(tail + sizeof (record.m_seq), &record.m_len, sizeof (record.m_len));
+                        chars.resize(record.m_pos + record.m_len);
+                        read(tail + HEADER_LEN, &chars[record.m_pos], record.m_len);
+                        records.push_back(record);
+                        tail += HEADER_LEN + record.m_len;
+                    }
+                    m_tail.store(tail, memory_order_release);
+                }
+
+                /**
+                 * Allows to check if the ring is empty, to be called by the consumer only
+                 * @return true if the ring is empty
+                 */
+                inline bool is_empty() const {
+                    return m_head.load(memory_order_acquire) == m_tail.load(memory_order_relaxed);
+                }
+
+                //The sequence number value meaning there is no message being pushed
+                static constexpr uint64_t NO_IN_FLIGHT = UINT64_MAX;
+
+            private:
+                //The message header length: the sequence number and the length
+                static constexpr size_t HEADER_LEN = sizeof (uint64_t) + sizeof (uint32_t);
+
+                //The ring data
+                vector<char> m_data;
+                //The position mask
+                const size_t m_mask;
+                //The total number of bytes written, only changed by the producer
+                atomic<size_t> m_head;
+                //The total number of bytes read, only changed by the consumer
+                atomic<size_t> m_tail;
+                //The lower bound of the sequence number of the message being pushed
+                atomic<uint64_t> m_in_flight;
+
+                /**
+                 * Allows to write the data at the position, wraps around the end
+                 * @param pos the position
+                 * @param p_src the data
+                 * @param len the data length
+                 */
+                inline void write(const size_t pos, const void * p_src, const size_t len) {
+                    const size_t idx = pos & m_mask;
+                    const size_t first = min(len, m_data.size() - idx);
+                    memcpy(&m_data[idx], p_src, first);
+                    memcpy(&m_data[0], static_cast<const char *> (p_src) + first, len - first);
+                }
+
+                /**
+                 * Allows to read the data at the position, wraps around the end
+                 * @param pos the position
+                 * @param p_dst the data buffer
+                 * @param len the data length
+                 */
+                inline void read(const size_t pos, void * p_dst, const size_t len) const {
+                    const size_t idx = pos & m_mask;
+                    const size_t first = min(len, m_data.size() - idx);
+                    memcpy(p_dst, &m_data[idx], first);
+                    memcpy(static_cast<char *> (p_dst) + first, &m_data[0], len - first);
+                }
+            };
+
+            /**
+             * This class is the asynchronous logging backend. Once started the messages are
+             * formatted into the thread local streams, without locking, and on the END_LOG
+             * flush are copied into the thread's lock free ring buffer. The buffers are drained
+             * by the background writer thread into the standard output, in the order of the
+             * message sequence numbers. The messages with the sequence numbers above the one
+             * still being pushed by some thread are held back until the next drain, so the
+             * order is kept across the drains. A message not fitting into its thread's ring
+             * buffer is dropped and counted, the writer reports the number of dropped messages.
+             */
+            class async_logger {
+            public:
+
+                /**
+                 * Allows to start the asynchronous logging, does nothing if already started
+                 */
+                static inline void start() {
+                    backend_state & state = get_state();
+                    lock_guard<mutex> guard(state.m_run_mutex);
+                    if (!state.m_is_on.load()) {
+                        state.m_is_stop = false;
+                        state.m_writer = thread(&async_logger::writer_loop);
+                        state.m_is_on.store(true);
+                    }
+                }
+
+                /**
+                 * Allows to stop the asynchronous logging, all the pending
+                 * messages are written out, does nothing if not started
+                 */
+                static inline void stop() {
+                    get_state().stop_writer();
+                }
+
+                /**
+                 * Allows to check if the asynchronous logging is on
+                 * @return true if the asynchronous logging is on
+                 */
+                static inline bool is_on() {
+                    return get_state().m_is_on.load(memory_order_relaxed);
+                }
+
+                /**
+                 * Allows to write out all the pending messages from the calling thread,
+                 * is to be used before writing into the standard output directly
+                 */
+                static inline void flush() {
+                    if (is_on()) {
+                        drain_all();
+                    }
+                }
+
+                /**
+                 * Allows to get the number of dropped messages
+                 * @return the number of dropped messages
+                 */
+                static inline uint64_t get_num_dropped() {
+                    return get_state().m_num_dropped.load();
+                }
+
+                /**
+                 * Allows to get the thread local logging stream
+                 * @return the thread local logging stream
+                 */
+                static inline ostream & get_stream() {
+                    static thread_local thread_stream stream;
+                    return stream.m_stream;
+                }
+
+            private:
+
+                /**
+                 * This class is the stream buffer pushing its content
+                 * into the thread's ring buffer on synchronization
+                 */
+                class ring_buf : public streambuf {
+                public:
+
+                    /**
+                     * The basic constructor
+                     * @param p_ring the ring buffer to push the messages into
+                     */
+                    ring_buf(const shared_ptr<log_ring> & p_ring)
+                    : m_p_ring(p_ring), m_buf(INITIAL_BUF_LEN) {
+                        setp(&m_buf[0], &m_buf[0] + m_buf.size());
+                    }
+
+                protected:
+
+                    /**
+                     * Grows the buffer if it is full
+                     * @param chr the character to put
+                     * @return the put character
+                     */
+                    virtual int_type overflow(int_type chr) override {
+                        if (chr != traits_type::eof()) {
+                            const size_t len = pptr() - pbase();
+                            m_buf.resize(2 * m_buf.size());
+                            setp(&m_buf[0], &m_buf[0] + m_buf.size());
+                            pbump(static_cast<int> (len));
+                            *pptr() = traits_type::to_char_type(chr);
+                            pbump(1);
+                        }
+                        return traits_type::not_eof(chr);
+                    }
+
+                    /**
+                     * Pushes the buffered message into the ring buffer
+                     * @return zero
+                     */
+                    virtual int sync() override {
+                        const size_t len = pptr() - pbase();
+                        if (len > 0) {
+                            backend_state & state = get_state();
+                            //Announce the push before the sequence number is taken
+                            m_p_ring->begin_push(state.m_next_seq.load());
+                            const uint64_t seq = state.m_next_seq.fetch_add(1);
+                            if (!m_p_ring->push(seq, pbase(), static_cast<uint32_t> (len))) {
+                                state.m_num_dropped.fetch_add(1, memory_order_relaxed);
+                            }
+                            m_p_ring->end_push();
+                            setp(&m_buf[0], &m_buf[0] + m_buf.size());
+                        }
+                        return 0;
+                    }
+
+                private:
+                    //The initial message buffer length
+                    static constexpr size_t INITIAL_BUF_LEN = 256;
+
+                    //The thread's ring buffer
+                    shared_ptr<log_ring> m_p_ring;
+                    //The message buffer
+                    vector<char> m_buf;
+                };
+
+                /**
+                 * This structure stores the thread local logging stream
+                 */
+                struct thread_stream {
+                    //The thread's ring buffer
+                    shared_ptr<log_ring> m_p_ring;
+                    //The stream buffer
+                    ring_buf m_buf;
+                    //The stream
+                    ostream m_stream;
+
+                    /**
+                     * The basic constructor, registers the thread's ring buffer
+                     */
+                    thread_stream()
+                    : m_p_ring(make_shared<log_ring>(ASYNC_LOG_RING_SIZE)),
+                    m_buf(m_p_ring), m_stream(&m_buf) {
+                        backend_state & state = get_state();
+                        lock_guard<mutex> guard(state.m_rings_mutex);
+                        state.m_rings.push_back(m_p_ring);
+                    }
+                };
+
+                /**
+                 * This structure stores the backend state
+                 */
+                struct backend_state {
+                    //True if the asynchronous logging is on
+                    atomic<bool> m_is_on;
+                    //The next message sequence number
+                    atomic<uint64_t> m_next_seq;
+                    //The number of dropped messages
+                    atomic<uint64_t> m_num_dropped;
+                    //The number of dropped messages reported
+                    uint64_t m_num_reported;
+                    //The popped messages of the drain, the held back ones are kept
+                    vector<log_ring::log_record> m_records;
+                    //The popped characters of the drain, the held back ones are kept
+                    string m_chars;
+                    //The ordered output of the drain
+                    string m_out;
+                    //The held back messages of the drain
+                    vector<log_ring::log_record> m_held;
+                    //The held back characters of the drain
+                    string m_held_chars;
+                    //Guards the registered ring buffers
+                    mutex m_rings_mutex;
+                    //The registered ring buffers
+                    vector<shared_ptr<log_ring>> m_rings;
+                    //Serializes the draining
+                    mutex m_drain_mutex;
+                    //Serializes starting and stopping
+                    mutex m_run_mutex;
+                    //Guards the stop flag
+                    mutex m_cv_mutex;
+                    //Notifies the writer thread about stopping
+                    condition_variable m_cv;
+                    //The stop flag
+                    bool m_is_stop;
+                    //The writer thread
+                    thread m_writer;
+
+                    /**
+                     * The basic constructor
+                     */
+                    backend_state()
+                    : m_is_on(false), m_next_seq(0), m_num_dropped(0), m_num_reported(0),
+                    m_records(), m_chars(), m_out(), m_held(), m_held_chars(), m_rings_mutex(), m_rings(), m_drain_mutex(), m_run_mutex(),
+                    m_cv_mutex(), m_cv(), m_is_stop(false), m_writer() {
+                    }
+
+                    /**
+                     * The basic destructor, writes out the pending messages
+                     */
+                    ~backend_state() {
+                        stop_writer();
+                    }
+
+                    /**
+                     * Allows to stop the writer thread, it writes out the
+                     * pending messages before finishing, if running
+                     */
+                    void stop_writer() {
+                        lock_guard<mutex> guard(m_run_mutex);
+                        if (m_is_on.load()) {
+                            m_is_on.store(false);
+                            {
+                                lock_guard<mutex> cv_guard(m_cv_mutex);
+                                m_is_stop = true;
+                            }
+                            m_cv.notify_all();
+                            m_writer.join();
+                        }
+                    }
+                };
+
+                /**
+                 * Allows to get the backend state
+                 * @return the backend state
+                 */
+                static inline backend_state & get_state() {
+                    static backend_state state;
+                    return state;
+                }
+
+                /**
+                 * Allows to write out the pending messages, those above the lowest
+                 * sequence number still being pushed are held back
+                 * @return the lowest sequence number still to be written out
+                 */
+                static inline uint64_t drain() {
+                    backend_state & state = get_state();
+                    lock_guard<mutex> drain_guard(state.m_drain_mutex);
+
+                    //Get the lowest sequence number still being pushed, before popping
+                    uint64_t min_seq = state.m_next_seq.load();
+
+                    //Get the rings, forget the ones of the finished threads once empty
+                    vector<shared_ptr<log_ring>> rings;
+                    {
+                        lock_guard<mutex> guard(state.m_rings_mutex);
+                        for (auto iter = state.m_rings.begin(); iter != state.m_rings.end();) {
+                            min_seq = min(min_seq, (*iter)->get_in_flight());
+                            if ((iter->use_count() == 1) && (*iter)->is_empty()) {
+                                iter = state.m_rings.erase(iter);
+                            } else {
+                                rings.push_back(*iter);
+                                ++iter;
+                            }
+                        }
+                    }
+
+                    //Collect the messages, after the held back ones
+                    vector<log_ring::log_record> & records = state.m_records;
+                    string & chars = state.m_chars;
+                    const bool is_held = !records.empty();
+                    for (auto & p_ring : rings) {
+                        p_ring->pop_all(records, chars);
+                    }
+
+                    //Write them out in order, at once if there is only one ring
+                    if ((rings.size() > 1) || is_held) {
+                        sort(records.begin(), records.end(),
+                                [](const log_ring::log_record & first, const log_ring::log_record & second) {
+                                    return first.m_seq < second.m_seq; });
+                        string & out = state.m_out;
+                        vector<log_ring::log_record> & held = state.m_held;
+                        string & held_chars = state.m_held_chars;
+                        out.clear();
+                        held.clear();
+                        held_chars.clear();
+                        for (const auto & record : records) {
+                            if (record.m_seq < min_seq) {
+                                out.append(chars, record.m_pos, record.m_len);
+                            } else {
+                                held.push_back({record.m_seq, held_chars.size(), record.m_len});
+                                held_chars.append(chars, record.m_pos, record.m_len);
+                            }
+                        }
+                        cout.write(out.data(), out.size());
+                        records.swap(held);
+                        chars.swap(held_chars);
+                    } else {
+                        cout.write(chars.data(), chars.size());
+                        records.clear();
+                        chars.clear();
+                    }
+
+                    //Report the newly dropped messages
+                    const uint64_t num_dropped = state.m_num_dropped.load();
+                    if (num_dropped != state.m_num_reported) {
+                        cout << "WARNING: " << (num_dropped - state.m_num_reported)
+                                << " log messages were dropped, the log buffer was full!" << endl;
+                        state.m_num_reported = num_dropped;
+                    }
+                    cout.flush();
+
+                    return min_seq;
+                }
+
+                /**
+                 * Allows to write out all the messages taken before the call, waits
+                 * for the pushes of the held back messages to be finished
+                 */
+                static inline void drain_all() {
+                    const uint64_t end_seq = get_state().m_next_seq.load();
+                    while (drain() < end_seq) {
+                        this_thread::yield();
+                    }
+                }
+
+                /**
+                 * The writer thread's main loop
+                 */
+                static void writer_loop() {
+                    backend_state & state = get_state();
+                    bool is_stop = false;
+                    while (!is_stop) {
+                        {
+                            unique_lock<mutex> lock(state.m_cv_mutex);
+                            state.m_cv.wait_for(lock, chrono::milliseconds(ASYNC_LOG_PERIOD_MS),
+                                    [&] { return state.m_is_stop; });
+                            is_stop = state.m_is_stop;
+                        }
+                        if (is_stop) {
+                            drain_all();
+                        } else {
+                            drain();
+                        }
+                    }
+                }
+            };
+        }
+    }
+}
+
+#endif /* ASYNC_LOGGER_HPP */
@@ -29,6 +29,7 @@
 #include <map>
 #include <queue>
 #include <string>
+#include <fstream>
 #include <vector>
 #include <algorithm>
 
@@ -37,6 +38,7 @@
 #include "exceptions.hh"
 #include "logger.hh"
 #include "monitor.hh"
+#include "string_utils.hh"
 
 using namespace std;
 using namespace scots;
@@ -44,6 +46,7 @@ using namespace scots;
 using namespace tud::utils::exceptions;
 using namespace tud::utils::logging;
 using namespace tud::utils::monitor;
+using namespace tud::utils::text;
 
 namespace tud {
     namespace ctrl {
@@ -555,6 +558,66 @@ namespace tud {
                     vector<double> m_ur;
                 };
 
+                /**
+                 * Allows to read the controller bdd to extract the permutations
+                 * @param source_file_name the controller file name
+                 * @param perms the map to store the permutations
+                 */
+                static inline void read_bdd_permutations(const string source_file_name, permutations_map & perms) {
+                    const static string pids_marker = ".permids ";
+                    const static string ids_marker = ".ids ";
+                    const string bdd_file_name = source_file_name + ".bdd";
+
+                    LOG_DEBUG << "Start reading BDD permutations from: " << bdd_file_name << END_LOG;
+
+                    ifstream bdd_file(bdd_file_name);
+                    ASSERT_CONDITION_THROW(!bdd_file.is_open(), string("Error operning the BDD file: ") + bdd_file_name);
+                    
+                    //Look trough the file to find the BDD permutations
+                    bool is_ids_found = false, is_pids_found = false;
+                    string line, pids, ids;
+                    while(!(is_pids_found && is_ids_found) && getline(bdd_file, line)) {
+                        if(line.compare(0, ids_marker.length(), ids_marker) == 0) {
+                            ids = line.substr(ids_marker.length(), line.length() - ids_marker.length());
+                            is_ids_found = true;
+                        }
+                        if(line.compare(0, pids_marker.length(), pids_marker) == 0) {
+                            pids = line.substr(pids_marker.length(), line.length() - pids_marker.length());
+                            is_pids_found = true;
+                        }
+                    }
+                    
+                    ASSERT_CONDITION_THROW(bdd_file.bad(), string("Error reading the BDD file: ") + bdd_file_name);
+                    ASSERT_CONDITION_THROW(!is_pids_found, string("Could not find the perm. ids marker: ") +
+                                           ids_marker + string(" in the BDD file: ") + bdd_file_name);
+                    ASSERT_CONDITION_THROW(!is_ids_found, string("Could not find the ids marker: ") +
+                                           pids_marker + string(" in the BDD file: ") + bdd_file_name);
+                    
+                    //Parse the data into the permutations map
+                    size_t id_pos, pid_pos, bdd_id;
+                    ids = trim(ids);
+                    pids = trim(pids);
+                    do {
+                        id_pos = ids.find(" ");
+                        LOG_DEBUG << "The position of ' ' in '" << ids << "' is " << id_pos << END_LOG;
+                        pid_pos = pids.find(" ");
+                        LOG_DEBUG << "The position of ' ' in '" << pids << "' is " << pid_pos << END_LOG;
+                        
+                        if(id_pos == string::npos) {
+                            bdd_id = stoi(ids);
+                            perms[bdd_id] = stoi(pids);
+                        } else {
+                            bdd_id = stoi(ids.substr(0, id_pos));
+                            ids = ids.substr((id_pos + 1), ids.length() - (id_pos + 1));
+                            perms[bdd_id] = stoi(pids.substr(0, pid_pos));
+                            pids = pids.substr((pid_pos + 1), pids.length() - (pid_pos + 1));
+                        }
+                        LOG_DEBUG << "BDD variable: " << bdd_id << "\t<-->\t" << perms[bdd_id] << END_LOG;
+                    }while(id_pos != string::npos);
+                    
+                    LOG_DEBUG << "Finished reading BDD permutations from: " << bdd_file_name << END_LOG;
+                }
+
             }
         }
     }
@@ -0,0 +1,327 @@
+/*
+ * File:   bdd_restrictor.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on March 19, 2018, 14:32 PM
+ */
+
+#ifndef BDD_RESTRICTOR_HPP
+#define BDD_RESTRICTOR_HPP
+
+#include <vector>
+#include <algorithm>
+
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+
+#include "inputs_mgr.hh"
+#include "states_mgr.hh"
+#include "flat_bdd.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                //The marker of the BDD variables not used by the controller
+                static constexpr int32_t UNUSED_VAR = -1;
+
+                /**
+                 * This class allows to compute the controller's restriction, i.e. the
+                 * inputs available in a state, by walking the controller's BDD nodes.
+                 * Unlike SymbolicSet::restriction it does not create any new BDD nodes
+                 * and therefore can be used from several threads at once, as long as
+                 * the CUDD manager is not used by anyone else at the same time.
+                 */
+                class bdd_restrictor {
+                public:
+
+                    /**
+                     * The basic constructor
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD, must outlive the restrictor
+                     * @param ss_dim the number of state-space dimensions
+                     */
+                    bdd_restrictor(const SymbolicSet & ctrl_set, const BDD & ctrl_bdd, const int32_t ss_dim)
+                    : m_ss_dim(ss_dim), m_is_dim(ctrl_set.get_dim() - ss_dim),
+                    m_p_ss_set(NULL), m_p_is_set(NULL), m_ctrl_bdd(ctrl_bdd),
+                    m_one(Cudd_ReadOne(ctrl_bdd.manager())), m_ss_nn(),
+                    m_var_dof(), m_var_bit(), m_in_bit_dof(), m_in_bit_pos() {
+                        ASSERT_CONDITION_THROW((ss_dim <= 0) || (m_is_dim <= 0),
+                                string("Improper state-space dimensionality: ") + to_string(ss_dim));
+                        ASSERT_CONDITION_THROW((ss_dim > (int32_t) FLAT_MAX_DIM) || (m_is_dim > (int32_t) FLAT_MAX_DIM),
+                                string("The state- and input-space dimensionality may not exceed ") + to_string(FLAT_MAX_DIM));
+
+                        //Create the state and input space sets
+                        m_p_ss_set = states_mgr::get_states_set(ctrl_set, ss_dim);
+                        m_p_is_set = inputs_mgr::get_inputs_set(ctrl_set, ss_dim);
+                        m_ss_nn = m_p_ss_set->get_nn();
+
+                        //Map the BDD variables onto the dof bits, the first variable
+                        //of the interval represents the most significant bit
+                        vector<IntegerInterval<abs_type>> ints = ctrl_set.get_bdd_intervals();
+                        for (int32_t dof = 0; dof < ctrl_set.get_dim(); ++dof) {
+                            const vector<unsigned int> var_ids = ints[dof].get_bdd_var_ids();
+                            const size_t num_bits = var_ids.size();
+                            for (size_t idx = 0; idx < num_bits; ++idx) {
+                                const unsigned int var_id = var_ids[idx];
+                                if (var_id >= m_var_dof.size()) {
+                                    m_var_dof.resize(var_id + 1, UNUSED_VAR);
+                                    m_var_bit.resize(var_id + 1, 0);
+                                }
+                                const uint32_t bit_pos = num_bits - idx - 1;
+                                if (dof < ss_dim) {
+                                    //The state variable stores its dof bit position
+                                    m_var_dof[var_id] = dof;
+                                    m_var_bit[var_id] = bit_pos;
+                                } else {
+                                    //The input variable stores its global input bit index
+                                    m_var_dof[var_id] = dof;
+                                    m_var_bit[var_id] = m_in_bit_dof.size();
+                                    m_in_bit_dof.push_back(dof - ss_dim);
+                                    m_in_bit_pos.push_back(bit_pos);
+                                }
+                            }
+                        }
+
+                        ASSERT_CONDITION_THROW((m_in_bit_dof.size() > MAX_INPUT_BITS),
+                                string("Too many input-space BDD variables: ") +
+                                to_string(m_in_bit_dof.size()));
+                    }
+
+                    /**
+                     * The basic destructor
+                     */
+                    virtual ~bdd_restrictor() {
+                        if (m_p_ss_set != NULL) {
+                            delete m_p_ss_set;
+                            m_p_ss_set = NULL;
+                        }
+                        if (m_p_is_set != NULL) {
+                            delete m_p_is_set;
+                            m_p_is_set = NULL;
+                        }
+                    }
+
+                    /**
+                     * Allows to get the number of state-space dimensions
+                     * @return the number of state-space dimensions
+                     */
+                    inline int32_t get_ss_dim() const {
+                        return m_ss_dim;
+                    }
+
+                    /**
+                     * Allows to get the number of input-space dimensions
+                     * @return the number of input-space dimensions
+                     */
+                    inline int32_t get_is_dim() const {
+                        return m_is_dim;
+                    }
+
+                    /**
+                     * Allows to get the state-space set
+                     * @return the state-space set
+                     */
+                    inline const SymbolicSet & get_ss_set() const {
+                        return *m_p_ss_set;
+                    }
+
+                    /**
+                     * Allows to get the input-space set
+                     * @return the input-space set
+                     */
+                    inline const SymbolicSet & get_is_set() const {
+                        return *m_p_is_set;
+                    }
+
+                    /**
+                     * Allows to get the inputs available in the state, thread safe
+                     * @param state the state-space point, of the state-space dimensionality
+                     * @param input_ids the vector to be filled with the sorted input ids,
+                     *                  will be empty if the state is outside of the grid
+                     */
+                    inline void restrict(const double * state, vector<abs_type> & input_ids) const {
+                        abs_type ss_dofs[FLAT_MAX_DIM];
+                        abs_type * p_ss_dofs = ss_dofs;
+                        m_p_ss_set->xtois(state, p_ss_dofs);
+                        restrict_dofs(ss_dofs, input_ids);
+                    }
+
+                    /**
+                     * Allows to get the inputs available in the state, thread safe
+                     * @param ss_id the state-space grid point id
+                     * @param input_ids the vector to be filled with the sorted input ids
+                     */
+                    inline void restrict_id(abs_type ss_id, vector<abs_type> & input_ids) const {
+                        abs_type ss_dofs[FLAT_MAX_DIM];
+                        for (int32_t dof = m_ss_dim - 1; dof >= 0; --dof) {
+                            ss_dofs[dof] = ss_id / m_ss_nn[dof];
+                            ss_id = ss_id % m_ss_nn[dof];
+                        }
+                        restrict_dofs(ss_dofs, input_ids);
+                    }
+
+                    /**
+                     * Allows to get the inputs available in the state, thread safe
+                     * @param ss_dofs the state-space dof ids
+                     * @param input_ids the vector to be filled with the sorted input ids,
+                     *                  will be empty if the state is outside of the grid
+                     */
+                    inline void restrict_dofs(const abs_type * ss_dofs, vector<abs_type> & input_ids) const {
+                        input_ids.clear();
+                        if (m_p_ss_set->is_on_grid(const_cast<abs_type *> (ss_dofs))) {
+                            walk(m_ctrl_bdd.getNode(), ss_dofs, 0, 0, input_ids);
+                            sort(input_ids.begin(), input_ids.end());
+                            input_ids.erase(unique(input_ids.begin(), input_ids.end()), input_ids.end());
+                        }
+                    }
+
+                    /**
+                     * Allows to convert the input id into the input-space point
+                     * @param id the input id
+                     * @param input the vector to store the input-space point
+                     */
+                    inline void itox_input(const abs_type id, vector<double> & input) const {
+                        m_p_is_set->itox(id, input);
+                    }
+
+                private:
+                    //The maximum number of input-space BDD variables
+                    static constexpr size_t MAX_INPUT_BITS = 64;
+
+                    //Stores the number of state-space dimensions
+                    const int32_t m_ss_dim;
+                    //Stores the number of input-space dimensions
+                    const int32_t m_is_dim;
+                    //Stores the state-space set
+                    SymbolicSet * m_p_ss_set;
+                    //Stores the input-space set
+                    SymbolicSet * m_p_is_set;
+                    //Stores the reference to the controller's BDD
+                    const BDD & m_ctrl_bdd;
+                    //Stores the constant one node
+                    DdNode * const m_one;
+                    //Stores the state-space grid's dof multipliers
+                    vector<abs_type> m_ss_nn;
+                    //Stores the dof index per BDD variable index
+                    vector<int32_t> m_var_dof;
+                    //Stores the dof bit position for the state variables and
+                    //the global input bit index for the input variables
+                    vector<uint32_t> m_var_bit;
+                    //Stores the input dof index per global input bit index
+                    vector<uint32_t> m_in_bit_dof;
+                    //Stores the input dof bit position per global input bit index
+                    vector<uint32_t> m_in_bit_pos;
+
+                    /**
+                     * Allows to walk the BDD collecting the input cubes
+                     * @param node the current node, possibly complemented
+                     * @param ss_dofs the state-space dof ids
+                     * @param value the assigned input bit values
+                     * @param care the mask of the assigned input bits
+                     * @param input_ids the vector to collect the input ids
+                     */
+                    void walk(DdNode * node, const abs_type * ss_dofs, const uint64_t value,
+                            const uint64_t care, vector<abs_type> & input_ids) const {
+                        DdNode * reg = Cudd_Regular(node);
+                        if (Cudd_IsConstant(reg)) {
+                            if (node == m_one) {
+                                expand_cube(value, care, input_ids);
+                            }
+                            return;
+                        }
+
+                        //Get the then and else children taking the complement into account
+                        const bool is_compl = Cudd_IsComplement(node);
+                        DdNode * then_node = Cudd_NotCond(Cudd_T(reg), is_compl);
+                        DdNode * else_node = Cudd_NotCond(Cudd_E(reg), is_compl);
+
+                        const unsigned int var_id = Cudd_NodeReadIndex(reg);
+                        const int32_t dof = (var_id < m_var_dof.size()) ? m_var_dof[var_id] : UNUSED_VAR;
+                        if (dof == UNUSED_VAR) {
+                            //The foreign variable is existentially abstracted
+                            walk(then_node, ss_dofs, value, care, input_ids);
+                            walk(else_node, ss_dofs, value, care, input_ids);
+                        } else if (dof < m_ss_dim) {
+                            //The state variable is fixed by the state
+                            if ((ss_dofs[dof] >> m_var_bit[var_id]) & 1) {
+                                walk(then_node, ss_dofs, value, care, input_ids);
+                            } else {
+                                walk(else_node, ss_dofs, value, care, input_ids);
+                            }
+                        } else {
+                            //The input variable gets both of its values
+                            const uint64_t mask = ((uint64_t) 1) << m_var_bit[var_id];
+                            walk(then_node, ss_dofs, value | mask, care | mask, input_ids);
+                            walk(else_node, ss_dofs, value, care | mask, input_ids);
+                        }
+                    }
+
+                    /**
+                     * Allows to expand the input cube into the input ids
+                     * @param value the assigned input bit values
+                     * @param care the mask of the assigned input bits
+                     * @param input_ids the vector to collect the input ids
+                     */
+                    void expand_cube(const uint64_t value, const uint64_t care,
+                            vector<abs_type> & input_ids) const {
+                        const size_t num_bits = m_in_bit_dof.size();
+                        const uint64_t all = (num_bits == MAX_INPUT_BITS) ? ~((uint64_t) 0)
+                                : ((((uint64_t) 1) << num_bits) - 1);
+                        const uint64_t dont_care = all & ~care;
+
+                        //Iterate over all the subsets of the don't care bits
+                        abs_type is_dofs[FLAT_MAX_DIM];
+                        uint64_t sub = dont_care;
+                        while (true) {
+                            const uint64_t bits = value | sub;
+                            fill(is_dofs, is_dofs + m_is_dim, 0);
+                            for (size_t idx = 0; idx < num_bits; ++idx) {
+                                if ((bits >> idx) & 1) {
+                                    is_dofs[m_in_bit_dof[idx]] |= ((abs_type) 1) << m_in_bit_pos[idx];
+                                }
+                            }
+                            abs_type id;
+                            if (m_p_is_set->istoi(is_dofs, id)) {
+                                input_ids.push_back(id);
+                            }
+                            if (sub == 0) {
+                                break;
+                            }
+                            sub = (sub - 1) & dont_care;
+                        }
+                    }
+                };
+            }
+        }
+    }
+}
+
+#endif /* BDD_RESTRICTOR_HPP */
@@ -0,0 +1,378 @@
+/*
+ * File:   bench_report.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 17, 2018, 10:12 AM
+ */
+
+#ifndef BENCH_REPORT_HPP
+#define BENCH_REPORT_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <numeric>
+#include <cstdio>
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "monitor.hh"
+
+using namespace std;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+using namespace tud::utils::monitor;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                //The median wall time increases below this many seconds are
+                //dominated by the timer noise and are not reported as regressions
+#define BENCH_MIN_WALL_DIFF_SEC 0.005
+
+                /**
+                 * This structure stores the measurements of a single phase run
+                 */
+                struct phase_sample {
+                    //The wall time in seconds
+                    double m_wall;
+                    //The CPU time in seconds
+                    double m_cpu;
+                    //The peak resident set size in Kb
+                    int m_peak_rss;
+                    //The number of the resulting BDD nodes, if any
+                    size_t m_nodes;
+                    //The number of the resulting file bytes, if any
+                    size_t m_bytes;
+                };
+
+                /**
+                 * This class allows to measure a single phase run. The peak resident set
+                 * size is reset at the phase start if the kernel allows for that, via
+                 * /proc/self/clear_refs, otherwise it is the process peak so far.
+                 */
+                class phase_timer {
+                public:
+
+                    /**
+                     * Allows to start the measurements
+                     */
+                    inline void start() {
+                        //Reset the peak resident set size to the current one
+                        FILE * p_file = fopen("/proc/self/clear_refs", "w");
+                        if (p_file != NULL) {
+                            fputs("5", p_file);
+                            fclose(p_file);
+                        }
+                        m_start_cpu = stat_monitor::get_cpu_time();
+                        m_start_wall = chrono::steady_clock::now();
+                    }
+
+                    /**
+                     * Allows to stop the measurements
+                     * @param nodes the number of the resulting BDD nodes, if any
+                     * @param bytes the number of the resulting file bytes, if any
+                     * @return the phase measurements
+                     */
+                    inline phase_sample stop(const size_t nodes = 0, const size_t bytes = 0) {
+                        const chrono::duration<double> wall = chrono::steady_clock::now() - m_start_wall;
+                        const double cpu = stat_monitor::get_cpu_time() - m_start_cpu;
+                        TMemotyUsage mem_stat = {};
+                        stat_monitor::get_mem_stat(mem_stat);
+                        return {wall.count(), cpu, mem_stat.vmhwm, nodes, bytes};
+                    }
+
+                private:
+                    //Stores the start wall time
+                    chrono::steady_clock::time_point m_start_wall;
+                    //Stores the start CPU time
+                    double m_start_cpu;
+                };
+
+                /**
+                 * This structure stores the summary of the phase runs
+                 */
+                struct phase_summary {
+                    //The controller file name
+                    string m_ctrl;
+                    //The determinization algorithm name
+                    string m_alg;
+                    //The phase name
+                    string m_phase;
+                    //The number of the measured runs
+                    size_t m_runs;
+                    //The minimum wall time in seconds
+                    double m_wall_min;
+                    //The median wall time in seconds
+                    double m_wall_med;
+                    //The mean wall time in seconds
+                    double m_wall_mean;
+                    //The median CPU time in seconds
+                    double m_cpu_med;
+                    //The maximum peak resident set size in Kb
+                    int m_peak_rss;
+                    //The number of the resulting BDD nodes, if any
+                    size_t m_nodes;
+                    //The number of the resulting file bytes, if any
+                    size_t m_bytes;
+
+                    /**
+                     * Allows to get the unique phase key
+                     * @return the controller, algorithm and phase key
+                     */
+                    inline string get_key() const {
+                        return m_ctrl + string("|") + m_alg + string("|") + m_phase;
+                    }
+                };
+
+                /**
+                 * This class collects the phase measurements of the benchmark runs,
+                 * writes their summaries as JSON or CSV, and compares them with the
+                 * baseline written by an earlier run in either of the formats.
+                 */
+                class bench_report {
+                public:
+
+                    /**
+                     * Allows to add a phase run measurements
+                     * @param ctrl the controller file name
+                     * @param alg the determinization algorithm name
+                     * @param phase the phase name
+                     * @param sample the phase run measurements
+                     */
+                    inline void add_sample(const string & ctrl, const string & alg,
+                            const string & phase, const phase_sample & sample) {
+                        const string key = ctrl + string("|") + alg + string("|") + phase;
+                        auto iter = m_index.find(key);
+                        if (iter == m_index.end()) {
+                            iter = m_index.emplace(key, m_phases.size()).first;
+                            m_phases.push_back({ctrl, alg, phase, {}});
+                        }
+                        m_phases[iter->second].m_samples.push_back(sample);
+                    }
+
+                    /**
+                     * Allows to get the phase summaries in the order of the phases first runs
+                     * @param summaries the summaries to be filled in
+                     */
+                    inline void get_summaries(vector<phase_summary> & summaries) const {
+                        summaries.clear();
+                        for (const phase_runs & runs : m_phases) {
+                            vector<double> walls, cpus;
+                            phase_summary summary = {runs.m_ctrl, runs.m_alg, runs.m_phase,
+                                runs.m_samples.size(), 0.0, 0.0, 0.0, 0.0, 0, 0, 0};
+                            for (const phase_sample & sample : runs.m_samples) {
+                                walls.push_back(sample.m_wall);
+                                cpus.push_back(sample.m_cpu);
+                                summary.m_peak_rss = max(summary.m_peak_rss, sample.m_peak_rss);
+                                summary.m_nodes = max(summary.m_nodes, sample.m_nodes);
+                                summary.m_bytes = max(summary.m_bytes, sample.m_bytes);
+                            }
+                            summary.m_wall_min = *min_element(walls.begin(), walls.end());
+                            summary.m_wall_med = get_median(walls);
+                            summary.m_wall_mean = accumulate(walls.begin(), walls.end(), 0.0) / walls.size();
+                            summary.m_cpu_med = get_median(cpus);
+                            summaries.push_back(summary);
+                        }
+                    }
+
+                    /**
+                     * Allows to write the phase summaries into the file
+                     * @param file_name the file name
+                     * @param is_json true for JSON, false for CSV
+                     */
+                    inline void store(const string & file_name, const bool is_json) const {
+                        vector<phase_summary> summaries;
+                        get_summaries(summaries);
+
+                        ofstream file(file_name);
+                        ASSERT_CONDITION_THROW(!file.is_open(), string("Could not open the report file: ") + file_name);
+                        file.precision(9);
+                        if (is_json) {
+                            //One object per line, to keep the baseline parsing trivial
+                            file << "[" << endl;
+                            for (size_t idx = 0; idx < summaries.size(); ++idx) {
+                                const phase_summary & sum = summaries[idx];
+                                file << "{\"controller\": \"" << sum.m_ctrl << "\", \"algorithm\": \"" << sum.m_alg
+                                        << "\", \"phase\": \"" << sum.m_phase << "\", \"runs\": " << sum.m_runs
+                                        << ", \"wall_min\": " << sum.m_wall_min << ", \"wall_median\": " << sum.m_wall_med
+                                        << ", \"wall_mean\": " << sum.m_wall_mean << ", \"cpu_median\": " << sum.m_cpu_med
+                                        << ", \"peak_rss_kb\": " << sum.m_peak_rss << ", \"nodes\": " << sum.m_nodes
+                                        << ", \"bytes\": " << sum.m_bytes << "}"
+                                        << ((idx + 1 < summaries.size()) ? "," : "") << endl;
+                            }
+                            file << "]" << endl;
+                        } else {
+                            file << "controller,algorithm,phase,runs,wall_min,wall_median,wall_mean,"
+                                    << "cpu_median,peak_rss_kb,nodes,bytes" << endl;
+                            for (const phase_summary & sum : summaries) {
+                                file << sum.m_ctrl << "," << sum.m_alg << "," << sum.m_phase << "," << sum.m_runs
+                                        << "," << sum.m_wall_min << "," << sum.m_wall_med << "," << sum.m_wall_mean
+                                        << "," << sum.m_cpu_med << "," << sum.m_peak_rss << "," << sum.m_nodes
+                                        << "," << sum.m_bytes << endl;
+                            }
+                        }
+                        ASSERT_CONDITION_THROW(!file.good(), string("Could not write the report file: ") + file_name);
+                    }
+
+                    /**
+                     * Allows to compare the phase summaries with the baseline ones, the phase
+                     * is regressed if its median wall time exceeds the baseline one by more
+                     * than the threshold fraction and by more than BENCH_MIN_WALL_DIFF_SEC,
+                     * or if its result got more BDD nodes.
+                     * @param file_name the baseline file name, JSON or CSV as stored by this class
+                     * @param threshold the allowed fraction of the median wall time increase
+                     * @return the number of regressed phases
+                     */
+                    inline size_t compare(const string & file_name, const double threshold) const {
+                        map<string, phase_summary> baseline;
+                        load_baseline(file_name, baseline);
+
+                        vector<phase_summary> summaries;
+                        get_summaries(summaries);
+
+                        size_t num_regressed = 0, num_compared = 0;
+                        for (const phase_summary & sum : summaries) {
+                            const auto iter = baseline.find(sum.get_key());
+                            if (iter == baseline.end()) {
+                                LOG_INFO << "The phase " << sum.get_key() << " is not in the baseline" << END_LOG;
+                                continue;
+                            }
+                            const phase_summary & base = iter->second;
+                            ++num_compared;
+                            bool is_regressed = false;
+                            const double wall_diff = sum.m_wall_med - base.m_wall_med;
+                            if ((wall_diff > BENCH_MIN_WALL_DIFF_SEC) && (wall_diff > base.m_wall_med * threshold)) {
+                                LOG_WARNING << "The phase " << sum.get_key() << " median wall time regressed: "
+                                        << base.m_wall_med << " -> " << sum.m_wall_med << " sec." << END_LOG;
+                                is_regressed = true;
+                            }
+                            if (sum.m_nodes > base.m_nodes) {
+                                LOG_WARNING << "The phase " << sum.get_key() << " BDD nodes regressed: "
+                                        << base.m_nodes << " -> " << sum.m_nodes << END_LOG;
+                                is_regressed = true;
+                            }
+                            if (is_regressed) {
+                                ++num_regressed;
+                            }
+                        }
+                        LOG_RESULT << "Compared " << num_compared << " phases with the baseline '" << file_name
+                                << "', " << num_regressed << " regressed beyond the threshold" << END_LOG;
+                        return num_regressed;
+                    }
+
+                private:
+
+                    /**
+                     * This structure stores the runs of a single phase
+                     */
+                    struct phase_runs {
+                        //The controller file name
+                        string m_ctrl;
+                        //The determinization algorithm name
+                        string m_alg;
+                        //The phase name
+                        string m_phase;
+                        //The phase run measurements
+                        vector<phase_sample> m_samples;
+                    };
+
+                    //Stores the phase index per phase key
+                    map<string, size_t> m_index;
+                    //Stores the phases in the order of their first runs
+                    vector<phase_runs> m_phases;
+
+                    /**
+                     * Allows to get the median of the values
+                     * @param values the values, not empty
+                     * @return the median value
+                     */
+                    static inline double get_median(vector<double> values) {
+                        sort(values.begin(), values.end());
+                        const size_t mid = values.size() / 2;
+                        return (values.size() % 2) ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+                    }
+
+                    /**
+                     * Allows to split the CSV line or the JSON object line into the field values,
+                     * the JSON keys and the string quotes are dropped, the fields order is the
+                     * same in both formats
+                     * @param line the line to split
+                     * @param fields the field values to be filled in
+                     */
+                    static inline void split_fields(const string & line, vector<string> & fields) {
+                        fields.clear();
+                        const bool is_json = (line.find('{') != string::npos);
+                        string field;
+                        stringstream stream(line);
+                        while (getline(stream, field, ',')) {
+                            if (is_json) {
+                                const size_t colon = field.rfind(':');
+                                field = (colon == string::npos) ? string("") : field.substr(colon + 1);
+                                field.erase(remove_if(field.begin(), field.end(), [](const char chr) {
+                                    return (chr == '"') || (chr == '}') || (chr == ' ');
+                                }), field.end());
+                            }
+                            fields.push_back(field);
+                        }
+                    }
+
+                    /**
+                     * Allows to load the baseline phase summaries
+                     * @param file_name the baseline file name
+                     * @param baseline the phase summaries per phase key to be filled in
+                     */
+                    static inline void load_baseline(const string & file_name, map<string, phase_summary> & baseline) {
+                        ifstream file(file_name);
+                        ASSERT_CONDITION_THROW(!file.is_open(), string("Could not open the baseline file: ") + file_name);
+                        string line;
+                        vector<string> fields;
+                        while (getline(file, line)) {
+                            split_fields(line, fields);
+                            //Skip the CSV header, the JSON brackets and the malformed lines
+                            if ((fields.size() != 11) || (fields[0] == "controller")) {
+                                continue;
+                            }
+                            try {
+                                phase_summary sum = {fields[0], fields[1], fields[2], stoul(fields[3]),
+                                    stod(fields[4]), stod(fields[5]), stod(fields[6]), stod(fields[7]),
+                                    stoi(fields[8]), stoul(fields[9]), stoul(fields[10])};
+                                baseline[sum.get_key()] = sum;
+                            } catch (std::exception &) {
+                                LOG_WARNING << "Skipping the malformed baseline line: " << line << END_LOG;
+                            }
+                        }
+                        LOG_INFO << "Loaded " << baseline.size() << " baseline phases from '" << file_name << "'" << END_LOG;
+                    }
+                };
+            }
+        }
+    }
+}
+
+#endif /* BENCH_REPORT_HPP */
@@ -0,0 +1,549 @@
+/*
+ * File:   comp_decoder.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 3, 2018, 14:12 PM
+ */
+
+#ifndef COMP_DECODER_HPP
+#define COMP_DECODER_HPP
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "monitor.hh"
+
+#include "ctrl_data.hh"
+#include "inputs_mgr.hh"
+#include "states_mgr.hh"
+#include "bdd_decoder.hh"
+#include "input_output.hh"
+#include "flat_bdd.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+using namespace tud::utils::monitor;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                /**
+                 * This class represents the mapping between the grid point dof
+                 * ids and the BDD ids, i.e. the ids following the BDD variable
+                 * ordering. Unlike the bdd_decoder it does not need the CUDD
+                 * manager once it is set up.
+                 */
+                class bdd_id_map {
+                public:
+
+                    /**
+                     * The basic constructor
+                     */
+                    bdd_id_map() : m_shifts(), m_masks(), m_num_points(), m_to_bdd(), m_from_bdd() {
+                    }
+
+                    /**
+                     * Allows to set up the mapping for the symbolic set
+                     * @param cudd_mgr the CUDD manager the set is defined in
+                     * @param symb_set the symbolic set, of the states or of the inputs
+                     * @param perms the BDD permutations read from the controller's file
+                     */
+                    void set_up(const Cudd & cudd_mgr, const SymbolicSet & symb_set, permutations_map & perms) {
+                        bdd_decoder<false> decoder(cudd_mgr, &symb_set);
+                        decoder.read_bdd_reordering(&perms);
+
+                        //Compute the dof bit offsets within the un-ordered id, the lowest dof is in the lowest bits
+                        const vector<IntegerInterval<abs_type>> ints = symb_set.get_bdd_intervals();
+                        const vector<abs_type> nn = symb_set.get_nn();
+                        size_t shift = 0;
+                        for (int dof = 0; dof < symb_set.get_dim(); ++dof) {
+                            const size_t num_bits = ints[dof].get_bdd_var_ids().size();
+                            m_shifts.push_back(shift);
+                            m_masks.push_back((((abs_type) 1) << num_bits) - 1);
+                            m_num_points.push_back(symb_set.get_no_grid_points(dof));
+
+                            //Get the BDD id bit of each dof bit, the grid point with the only one bit set
+                            for (size_t bit = 0; bit < num_bits; ++bit) {
+                                const abs_type bdd_id = decoder.itob((((abs_type) 1) << bit) * nn[dof]);
+                                ASSERT_CONDITION_THROW((__builtin_popcountll(bdd_id) != 1),
+                                        string("Unable to map the bit ") + to_string(bit) +
+                                        string(" of dof ") + to_string(dof) + string(" into the BDD id"));
+                                m_to_bdd.push_back(bdd_id);
+                            }
+                            shift += num_bits;
+                        }
+
+                        //Create the inverse mapping
+                        m_from_bdd.resize(m_to_bdd.size(), 0);
+                        for (size_t bit = 0; bit < m_to_bdd.size(); ++bit) {
+                            const size_t bdd_bit = __builtin_ctzll(m_to_bdd[bit]);
+                            ASSERT_CONDITION_THROW((bdd_bit >= m_from_bdd.size()),
+                                    string("The BDD id bit ") + to_string(bdd_bit) + string(" is out of range"));
+                            m_from_bdd[bdd_bit] = ((abs_type) 1) << bit;
+                        }
+                    }
+
+                    /**
+                     * Allows to convert the grid point dof ids into the BDD id
+                     * @param dofs the dof ids
+                     * @return the BDD id
+                     */
+                    inline abs_type dtob(const abs_type * dofs) const {
+                        abs_type bdd_id = 0;
+                        for (size_t dof = 0; dof < m_shifts.size(); ++dof) {
+                            abs_type bits = dofs[dof];
+                            for (size_t bit = m_shifts[dof]; bits != 0; ++bit, bits >>= 1) {
+                                if (bits & 1) {
+                                    bdd_id |= m_to_bdd[bit];
+                                }
+                            }
+                        }
+                        return bdd_id;
+                    }
+
+                    /**
+                     * Allows to convert the BDD id into the grid point dof ids
+                     * @param bdd_id the BDD id
+                     * @param dofs the dof ids to be filled in
+                     * @return true if the BDD id is a grid point, otherwise false
+                     */
+                    inline bool btod(abs_type bdd_id, abs_type * dofs) const {
+                        abs_type ext_id = 0;
+                        for (size_t bit = 0; bdd_id != 0; ++bit, bdd_id >>= 1) {
+                            if (bdd_id & 1) {
+                                if (bit >= m_from_bdd.size()) {
+                                    return false;
+                                }
+                                ext_id |= m_from_bdd[bit];
+                            }
+                        }
+                        for (size_t dof = 0; dof < m_shifts.size(); ++dof) {
+                            dofs[dof] = (ext_id >> m_shifts[dof]) & m_masks[dof];
+                            if (dofs[dof] >= m_num_points[dof]) {
+                                return false;
+                            }
+                        }
+                        return true;
+                    }
+
+                    /**
+                     * Allows to get the number of bytes used by the mapping
+                     * @return the number of bytes
+                     */
+                    inline size_t get_size() const {
+                        return (m_shifts.size() * (sizeof (size_t) + 2 * sizeof (abs_type)))
+                                + (m_to_bdd.size() + m_from_bdd.size()) * sizeof (abs_type);
+                    }
+
+                private:
+                    //Stores the dof bit offsets within the un-ordered id
+                    vector<size_t> m_shifts;
+                    //Stores the dof bit masks
+                    vector<abs_type> m_masks;
+                    //Stores the number of grid points per dof
+                    vector<abs_type> m_num_points;
+                    //Stores the BDD id bit mask per un-ordered id bit
+                    vector<abs_type> m_to_bdd;
+                    //Stores the un-ordered id bit mask per BDD id bit
+                    vector<abs_type> m_from_bdd;
+                };
+
+                /**
+                 * This class represents the decoder of the compressed controllers, the ones
+                 * stored with the sco_const, sco_lin, bdd_const and bdd_lin store types. Such
+                 * a controller only stores the states where the input, or the input's line
+                 * angle, switches. The state ids are the SCOTS ids or the BDD ids, depending on
+                 * the store type. The decoder loads the controller once and extracts the sorted
+                 * switch points, after that the CUDD manager is not needed. A lookup is a binary
+                 * search over the switch points plus the linear extrapolation for the line
+                 * compression. The lookups are thread safe and allocation free.
+                 */
+                class comp_decoder {
+                public:
+
+                    /**
+                     * The basic constructor
+                     * @param file_name the compressed controller file name without (.scs/.bdd)
+                     * @param ss_dim the number of state-space dimensions
+                     * @param type the compression type, one of sco_const, sco_lin, bdd_const, bdd_lin
+                     */
+                    comp_decoder(const string & file_name, const int32_t ss_dim, const store_type_enum type)
+                    : m_is_bdd((type == store_type_enum::bdd_const) || (type == store_type_enum::bdd_lin)),
+                    m_is_lin((type == store_type_enum::sco_lin) || (type == store_type_enum::bdd_lin)),
+                    m_ss_dim(ss_dim), m_is_dim(0), m_ss_grid(), m_is_grid(), m_ss_nn(),
+                    m_ss_map(), m_is_map(), m_dum_value(0), m_keys(), m_values(), m_slopes() {
+                        ASSERT_CONDITION_THROW(((type != store_type_enum::sco_const) && (type != store_type_enum::sco_lin) &&
+                                (type != store_type_enum::bdd_const) && (type != store_type_enum::bdd_lin)),
+                                string("Unsupported compression algorithm type: ") + to_string(type));
+
+                        //Declare the statistics data
+                        DECLARE_MONITOR_STATS;
+
+                        //Get the beginning statistics data
+                        INITIALIZE_STATS;
+
+                        //The manager is only needed until the switch points are extracted
+                        Cudd cudd_mgr;
+                        cudd_mgr.AutodynDisable();
+                        ctrl_data ctrl;
+                        load_controller_bdd(cudd_mgr, file_name, ss_dim, ctrl);
+                        m_is_dim = ctrl.m_ctrl_set.get_dim() - ss_dim;
+                        ASSERT_CONDITION_THROW((ss_dim <= 0) || (m_is_dim <= 0) || (ss_dim > (int32_t) FLAT_MAX_DIM) ||
+                                (m_is_dim > (int32_t) FLAT_MAX_DIM), string("The state- and input-space dimensionality ") +
+                                string("must be within [1, ") + to_string(FLAT_MAX_DIM) + string("]"));
+
+                        //Get the grids, these are the grids of the compressed controller
+                        SymbolicSet * p_ss_set = states_mgr::get_states_set(ctrl.m_ctrl_set, ss_dim);
+                        SymbolicSet * p_is_set = inputs_mgr::get_inputs_set(ctrl.m_ctrl_set, ss_dim);
+                        m_ss_grid = *p_ss_set;
+                        m_is_grid = *p_is_set;
+                        m_ss_nn = m_ss_grid.get_nn();
+
+                        //Set up the BDD id mappings, the permutations are read from the file due to the CUDD bug
+                        if (m_is_bdd) {
+                            permutations_map perms;
+                            read_bdd_permutations(file_name, perms);
+                            m_ss_map.set_up(cudd_mgr, *p_ss_set, perms);
+                            m_is_map.set_up(cudd_mgr, *p_is_set, perms);
+                        }
+                        delete p_ss_set;
+                        delete p_is_set;
+
+                        //Get the dummy input marking the states without input, as used for compression
+                        abs_type dum_dofs[FLAT_MAX_DIM];
+                        abs_type * p_dum_dofs = dum_dofs;
+                        const vector<double> is_ur = m_is_grid.get_upper_right();
+                        m_is_grid.xtois(is_ur, p_dum_dofs);
+                        m_is_grid.istoi(dum_dofs, m_dum_value);
+                        if (m_is_bdd && m_is_lin) {
+                            m_dum_value = m_is_map.dtob(dum_dofs);
+                        }
+
+                        //Extract and sort the switch points
+                        extract_switches(cudd_mgr, ctrl);
+
+                        //Compute the line slopes, in the order of the switch points
+                        if (m_is_lin) {
+                            compute_slopes();
+                        }
+
+                        LOG_INFO << "The compressed controller has " << m_keys.size() << " switch points for "
+                                << m_ss_grid.size() << " states, the decoder uses " << get_size() << " bytes" << END_LOG;
+
+                        //Get the end stats and log them
+                        REPORT_STATS(string("Decoding the compressed controller"));
+                    }
+
+                    /**
+                     * Allows to get the input of the state, thread safe
+                     * @param state the state-space point, of the state-space dimensionality
+                     * @param input the array to store the input-space point, of the input-space dimensionality
+                     * @return true if the state has an input, false if the state is outside
+                     *         of the grid or of the controller's domain
+                     */
+                    inline bool lookup(const double * state, double * input) const {
+                        abs_type ss_dofs[FLAT_MAX_DIM];
+                        abs_type * p_ss_dofs = ss_dofs;
+                        abs_type ss_id;
+                        m_ss_grid.xtois(state, p_ss_dofs);
+                        if (m_ss_grid.istoi(ss_dofs, ss_id)) {
+                            abs_type is_id;
+                            if (get_input_id(get_key(ss_id, ss_dofs), is_id)) {
+                                m_is_grid.itox(is_id, input);
+                                return true;
+                            }
+                        }
+                        return false;
+                    }
+
+                    /**
+                     * Allows to get the input id of the state id, thread safe
+                     * @param ss_id the SCOTS state id
+                     * @param is_id the SCOTS input id, in the compressed controller's input grid
+                     * @return true if the state has an input, otherwise false
+                     */
+                    inline bool lookup(const abs_type ss_id, abs_type & is_id) const {
+                        abs_type ss_dofs[FLAT_MAX_DIM];
+                        if (m_is_bdd) {
+                            abs_type id = ss_id;
+                            for (int32_t dof = m_ss_dim - 1; dof >= 0; --dof) {
+                                ss_dofs[dof] = id / m_ss_nn[dof];
+                                id = id % m_ss_nn[dof];
+                            }
+                        }
+                        return (ss_id < m_ss_grid.size()) && get_input_id(get_key(ss_id, ss_dofs), is_id);
+                    }
+
+                    /**
+                     * Allows to convert the input id into the input-space point, thread safe
+                     * @param is_id the input id, in the compressed controller's input grid
+                     * @param input the array to store the input-space point, of the input-space dimensionality
+                     */
+                    inline void itox_input(const abs_type is_id, double * input) const {
+                        m_is_grid.itox(is_id, input);
+                    }
+
+                    /**
+                     * Allows to verify the decoder against the original controller on every state
+                     * @param cudd_mgr the CUDD manager of the original controller
+                     * @param ctrl_set the original controller's symbolic set
+                     * @param ctrl_bdd the original controller's BDD
+                     * @return the number of states where the decoded input is not among the original ones
+                     */
+                    size_t verify(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set, const BDD & ctrl_bdd) const {
+                        //Declare the statistics data
+                        DECLARE_MONITOR_STATS;
+
+                        LOG_USAGE << "Starting the compressed controller verification ..." << END_LOG;
+
+                        //Get the beginning statistics data
+                        INITIALIZE_STATS;
+
+                        size_t num_mismatches = 0;
+                        vector<double> state, input(m_is_dim);
+                        for (abs_type ss_id = 0; ss_id < m_ss_grid.size(); ++ss_id) {
+                            m_ss_grid.itox(ss_id, state);
+                            const vector<double> inputs = ctrl_set.restriction(cudd_mgr, ctrl_bdd, state);
+
+                            //The decoded input must be one of the original inputs
+                            abs_type is_id;
+                            bool is_match = !lookup(ss_id, is_id);
+                            if (is_match) {
+                                is_match = inputs.empty();
+                            } else {
+                                for (auto iter = inputs.begin(); !is_match && (iter != inputs.end()); iter += m_is_dim) {
+                                    input.assign(iter, iter + m_is_dim);
+                                    is_match = (m_is_grid.xtoi(input) == is_id);
+                                }
+                            }
+
+                            if (!is_match) {
+                                LOG_DEBUG << "The decoded input of state " << ss_id << " does not match: "
+                                        << vector_to_string(inputs) << END_LOG;
+                                ++num_mismatches;
+                            }
+                        }
+
+                        //Get the end stats and log them
+                        REPORT_STATS(string("Compressed controller verification"));
+
+                        return num_mismatches;
+                    }
+
+                    /**
+                     * Allows to get the number of switch points
+                     * @return the number of switch points
+                     */
+                    inline size_t get_num_switches() const {
+                        return m_keys.size();
+                    }
+
+                    /**
+                     * Allows to get the number of states of the grid
+                     * @return the number of states
+                     */
+                    inline abs_type get_num_states() const {
+                        return m_ss_grid.size();
+                    }
+
+                    /**
+                     * Allows to get the number of bytes used by the switch points and the mappings
+                     * @return the number of bytes
+                     */
+                    inline size_t get_size() const {
+                        return (m_keys.size() + m_values.size()) * sizeof (abs_type) +
+                                m_slopes.size() * sizeof (double) + m_ss_map.get_size() + m_is_map.get_size();
+                    }
+
+                private:
+                    //Stores the flag indicating the BDD id compression
+                    const bool m_is_bdd;
+                    //Stores the flag indicating the line compression
+                    const bool m_is_lin;
+                    //Stores the number of state-space dimensions
+                    const int32_t m_ss_dim;
+                    //Stores the number of input-space dimensions
+                    int32_t m_is_dim;
+                    //Stores the state-space grid
+                    UniformGrid m_ss_grid;
+                    //Stores the input-space grid, extended with the dummy input
+                    UniformGrid m_is_grid;
+                    //Stores the state-space grid dof multipliers
+                    vector<abs_type> m_ss_nn;
+                    //Stores the state-space BDD id mapping, for the BDD id compression
+                    bdd_id_map m_ss_map;
+                    //Stores the input-space BDD id mapping, for the BDD id compression
+                    bdd_id_map m_is_map;
+                    //Stores the dummy input value marking the states without input
+                    abs_type m_dum_value;
+                    //Stores the sorted switch point state keys, SCOTS or BDD ids
+                    vector<abs_type> m_keys;
+                    //Stores the switch point input values, SCOTS ids or for the BDD line compression BDD ids
+                    vector<abs_type> m_values;
+                    //Stores the switch point line slopes, for the line compression
+                    vector<double> m_slopes;
+
+                    /**
+                     * Allows to get the state key, the SCOTS or BDD id depending on the compression
+                     * @param ss_id the SCOTS state id
+                     * @param ss_dofs the state dof ids, only used for the BDD id compression
+                     * @return the state key
+                     */
+                    inline abs_type get_key(const abs_type ss_id, const abs_type * ss_dofs) const {
+                        return m_is_bdd ? m_ss_map.dtob(ss_dofs) : ss_id;
+                    }
+
+                    /**
+                     * Allows to get the input value of the state key from the first switch points
+                     * @param key the state key
+                     * @param num_switches the number of switch points to consider
+                     * @return the input value, the dummy input value if there is no input
+                     */
+                    inline int64_t get_value(const abs_type key, const size_t num_switches) const {
+                        //Find the last switch point not after the key
+                        const auto end = m_keys.begin() + num_switches;
+                        const auto iter = upper_bound(m_keys.begin(), end, key);
+                        if (iter == m_keys.begin()) {
+                            return m_dum_value;
+                        }
+                        const size_t idx = (iter - m_keys.begin()) - 1;
+                        if (!m_is_lin || (m_values[idx] == m_dum_value)) {
+                            return m_values[idx];
+                        }
+                        return ((int64_t) m_values[idx]) + llround((key - m_keys[idx]) * m_slopes[idx]);
+                    }
+
+                    /**
+                     * Allows to get the input id of the state key
+                     * @param key the state key
+                     * @param is_id the SCOTS input id
+                     * @return true if the state has an input, otherwise false
+                     */
+                    inline bool get_input_id(const abs_type key, abs_type & is_id) const {
+                        const int64_t value = get_value(key, m_keys.size());
+                        if ((value < 0) || (value == (int64_t) m_dum_value)) {
+                            return false;
+                        }
+                        if (m_is_bdd && m_is_lin) {
+                            abs_type is_dofs[FLAT_MAX_DIM];
+                            return m_is_map.btod(value, is_dofs) && m_is_grid.istoi(is_dofs, is_id);
+                        }
+                        is_id = value;
+                        return (is_id < m_is_grid.size());
+                    }
+
+                    /**
+                     * Allows to extract the switch points from the compressed controller
+                     * @param cudd_mgr the CUDD manager
+                     * @param ctrl the compressed controller
+                     */
+                    void extract_switches(const Cudd & cudd_mgr, const ctrl_data & ctrl) {
+                        const int32_t dim = ctrl.m_ctrl_set.get_dim();
+                        abs_type num_points = 0;
+                        abs_type * dofs = ctrl.m_ctrl_set.bdd_to_grid_point_ids(cudd_mgr, ctrl.m_ctrl_bdd, num_points);
+
+                        //Convert the points into the state keys and input values
+                        vector<pair<abs_type, abs_type>> switches(num_points);
+                        for (abs_type idx = 0; idx < num_points; ++idx) {
+                            const abs_type * ss_dofs = &dofs[idx * dim];
+                            const abs_type * is_dofs = ss_dofs + m_ss_dim;
+                            abs_type ss_id = 0, is_id = 0;
+                            m_ss_grid.istoi(ss_dofs, ss_id);
+                            m_is_grid.istoi(is_dofs, is_id);
+                            switches[idx].first = get_key(ss_id, ss_dofs);
+                            switches[idx].second = (m_is_bdd && m_is_lin) ? m_is_map.dtob(is_dofs) : is_id;
+                        }
+                        delete[] dofs;
+                        sort(switches.begin(), switches.end());
+
+                        //Store the switch points, there is one input per switch state
+                        m_keys.reserve(switches.size());
+                        m_values.reserve(switches.size());
+                        for (const auto & point : switches) {
+                            ASSERT_CONDITION_THROW((!m_keys.empty() && (m_keys.back() == point.first)),
+                                    string("The compressed controller is not deterministic in state: ") +
+                                    to_string(point.first));
+                            m_keys.push_back(point.first);
+                            m_values.push_back(point.second);
+                        }
+                    }
+
+                    /**
+                     * Allows to get the previous grid state key
+                     * @param key the state key
+                     * @param prev_key the previous state key
+                     * @return true if there is a previous state, otherwise false
+                     */
+                    inline bool get_prev_key(const abs_type key, abs_type & prev_key) const {
+                        if (m_is_bdd) {
+                            //Not every BDD id is a grid point, skip the ones that are not
+                            abs_type ss_dofs[FLAT_MAX_DIM];
+                            for (prev_key = key; prev_key > 0;) {
+                                if (m_ss_map.btod(--prev_key, ss_dofs)) {
+                                    return true;
+                                }
+                            }
+                            return false;
+                        }
+                        prev_key = key - 1;
+                        return (key > 0);
+                    }
+
+                    /**
+                     * Allows to compute the switch point line slopes. The compression stores
+                     * the first point of each line, with the angle computed relative to the
+                     * previous grid state, and the first state's previous input is the dummy.
+                     */
+                    void compute_slopes() {
+                        m_slopes.resize(m_keys.size(), 0.0);
+                        for (size_t idx = 0; idx < m_keys.size(); ++idx) {
+                            if (m_values[idx] != m_dum_value) {
+                                abs_type prev_key = 0;
+                                int64_t prev_value = m_dum_value;
+                                if (get_prev_key(m_keys[idx], prev_key)) {
+                                    prev_value = get_value(prev_key, idx);
+                                }
+                                if (prev_key != m_keys[idx]) {
+                                    m_slopes[idx] = (((int64_t) m_values[idx]) - prev_value) /
+                                            ((double) (m_keys[idx] - prev_key));
+                                }
+                            }
+                        }
+                    }
+                };
+            }
+        }
+    }
+}
+
+#endif /* COMP_DECODER_HPP */
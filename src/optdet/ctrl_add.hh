@@ -0,0 +1,333 @@
+/*
+ * File:   ctrl_add.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 12, 2018, 16:04 PM
+ */
+
+#ifndef CTRL_ADD_HPP
+#define CTRL_ADD_HPP
+
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#include <unordered_set>
+#include <unordered_map>
+#include <fstream>
+#include <iomanip>
+
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "monitor.hh"
+
+#include "inputs_mgr.hh"
+#include "flat_bdd.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+using namespace tud::utils::monitor;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                //The ADD terminal value of the states outside of the controller's domain
+                static constexpr double ADD_NO_INPUT = -1.0;
+                //The first token of the ADD file, followed by the number of nodes
+                static constexpr const char * ADD_FILE_TAG = "ADD1";
+
+                /**
+                 * This class represents the determinized controller encoded as an ADD over the
+                 * state variables only, with the input ids as terminals. A lookup is then a single
+                 * root-to-terminal walk, without the existential abstraction and the cube
+                 * enumeration needed for the relational BDD over the state and input variables.
+                 * The ADD is stored into the .add text file next to the controller's symbolic
+                 * set in the .scs file, one node per line with the children before the parents.
+                 * The dddmp ADD store and load are not used as they corrupt the constants table
+                 * of the CUDD manager, which then makes its garbage collection fail.
+                 */
+                class ctrl_add {
+                public:
+
+                    /**
+                     * The basic constructor
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_add the controller's ADD, shall be kept alive by the caller
+                     * @param ss_dim the number of state-space dimensions
+                     */
+                    ctrl_add(const SymbolicSet & ctrl_set, const ADD & ctrl_add, const int32_t ss_dim)
+                    : m_ss_dim(ss_dim), m_root(ctrl_add.getNode()), m_dims(), m_index_vars() {
+                        vector<flat_bdd_var> in_bits;
+                        get_flat_dims(ctrl_set, ss_dim, m_dims);
+                        get_flat_vars(ctrl_set, ss_dim, ctrl_add.manager(), m_index_vars, in_bits);
+                    }
+
+                    /**
+                     * Allows to get the input of the state, thread safe as long as the
+                     * CUDD manager is not used for anything else in the meanwhile
+                     * @param state the state-space point, of the state-space dimensionality
+                     * @param input_id the input id to be set
+                     * @return true if the state is in the controller's domain, otherwise false
+                     */
+                    inline bool lookup(const double * state, abs_type & input_id) const {
+                        abs_type ss_dofs[FLAT_MAX_DIM];
+                        for (int32_t dof = 0; dof < m_ss_dim; ++dof) {
+                            const flat_bdd_dim & dim = m_dims[dof];
+                            ss_dofs[dof] = static_cast<abs_type> (state[dof] * dim.m_eta_inv - dim.m_x2a_sh);
+                            if (ss_dofs[dof] >= dim.m_num_points) {
+                                return false;
+                            }
+                        }
+                        return lookup_dofs(ss_dofs, input_id);
+                    }
+
+                    /**
+                     * Allows to get the input of the state, thread safe as long as the
+                     * CUDD manager is not used for anything else in the meanwhile
+                     * @param ss_dofs the state-space dof ids, within the grid
+                     * @param input_id the input id to be set
+                     * @return true if the state is in the controller's domain, otherwise false
+                     */
+                    inline bool lookup_dofs(const abs_type * ss_dofs, abs_type & input_id) const {
+                        DdNode * node = m_root;
+                        while (!Cudd_IsConstant(node)) {
+                            const flat_bdd_var & var = m_index_vars[Cudd_NodeReadIndex(node)];
+                            node = ((ss_dofs[var.m_dof] >> var.m_bit) & 1) ? Cudd_T(node) : Cudd_E(node);
+                        }
+                        if (Cudd_V(node) == ADD_NO_INPUT) {
+                            return false;
+                        }
+                        input_id = static_cast<abs_type> (Cudd_V(node));
+                        return true;
+                    }
+
+                    /**
+                     * Allows to convert the relational BDD of the determinized controller into the ADD
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD over the state and input variables
+                     * @param ss_dim the number of state-space dimensions
+                     * @return the ADD over the state variables with the input ids as terminals
+                     * @throws tud_exception if the controller is not deterministic
+                     */
+                    static ADD from_relation(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set,
+                            const BDD & ctrl_bdd, const int32_t ss_dim) {
+                        //Declare the statistics data
+                        DECLARE_MONITOR_STATS;
+
+                        //Get the beginning statistics data
+                        INITIALIZE_STATS;
+
+                        unique_ptr<SymbolicSet> p_is_set(inputs_mgr::get_inputs_set(ctrl_set, ss_dim));
+                        const BDD is_cube = p_is_set->get_cube(cudd_mgr);
+                        const vector<IntegerInterval<abs_type>> ints = ctrl_set.get_bdd_intervals();
+                        const vector<abs_type> num_points = ctrl_set.get_no_gp_per_dim();
+
+                        //Sum up the input id bits, each bit is a function of the state
+                        ADD ids = cudd_mgr.addZero();
+                        abs_type nn = 1;
+                        for (int32_t dof = ss_dim; dof < ctrl_set.get_dim(); ++dof) {
+                            const vector<unsigned int> var_ids = ints[dof].get_bdd_var_ids();
+                            const size_t num_bits = var_ids.size();
+                            for (size_t idx = 0; idx < num_bits; ++idx) {
+                                const BDD var = cudd_mgr.bddVar(var_ids[idx]);
+                                const BDD is_one = (ctrl_bdd & var).ExistAbstract(is_cube);
+                                const BDD is_zero = (ctrl_bdd & !var).ExistAbstract(is_cube);
+                                ASSERT_CONDITION_THROW(((is_one & is_zero) != cudd_mgr.bddZero()),
+                                        "The controller is not deterministic, can not encode it as an ADD!");
+                                const double weight = (double) nn * (double) (((abs_type) 1) << (num_bits - idx - 1));
+                                ids += is_one.Add() * cudd_mgr.constant(weight);
+                            }
+                            nn *= num_points[dof];
+                        }
+
+                        //Mark the states outside of the domain
+                        const BDD dom_bdd = ctrl_bdd.ExistAbstract(is_cube);
+                        const ADD result = dom_bdd.Add().Ite(ids, cudd_mgr.constant(ADD_NO_INPUT));
+
+                        LOG_USAGE << "The ADD encoding has " << result.nodeCount() << " nodes v.s. "
+                                << ctrl_bdd.nodeCount() << " nodes of the BDD" << END_LOG;
+
+                        //Get the end stats and log them
+                        REPORT_STATS(string("Encoding the controller as an ADD"));
+
+                        return result;
+                    }
+
+                    /**
+                     * Allows to convert the ADD of the determinized controller into the relational BDD
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_add the controller's ADD
+                     * @param ss_dim the number of state-space dimensions
+                     * @return the controller's BDD over the state and input variables
+                     */
+                    static BDD to_relation(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set,
+                            const ADD & ctrl_add, const int32_t ss_dim) {
+                        unique_ptr<SymbolicSet> p_is_set(inputs_mgr::get_inputs_set(ctrl_set, ss_dim));
+
+                        //Collect the terminals
+                        set<double> values;
+                        unordered_set<DdNode *> visited;
+                        vector<DdNode *> nodes(1, ctrl_add.getNode());
+                        while (!nodes.empty()) {
+                            DdNode * node = nodes.back();
+                            nodes.pop_back();
+                            if (visited.insert(node).second) {
+                                if (Cudd_IsConstant(node)) {
+                                    values.insert(Cudd_V(node));
+                                } else {
+                                    nodes.push_back(Cudd_T(node));
+                                    nodes.push_back(Cudd_E(node));
+                                }
+                            }
+                        }
+
+                        //Join the states of each input with the input
+                        BDD ctrl_bdd = cudd_mgr.bddZero();
+                        for (const double value : values) {
+                            if (value != ADD_NO_INPUT) {
+                                ctrl_bdd |= ctrl_add.BddInterval(value, value) &
+                                        p_is_set->id_to_bdd(static_cast<abs_type> (value));
+                            }
+                        }
+                        return ctrl_bdd;
+                    }
+
+                    /**
+                     * Allows to store the ADD controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_add the controller's ADD
+                     * @param file_name the file name without (.scs/.add)
+                     */
+                    static void store(const SymbolicSet & ctrl_set, const ADD & ctrl_add,
+                            const string & file_name) {
+                        ASSERT_CONDITION_THROW(!write_to_file(ctrl_set, file_name),
+                                string("Controller file '") + file_name + string(".scs' could not be written!"));
+
+                        //Order the nodes so that the children come before their parents
+                        unordered_map<DdNode *, size_t> node_ids;
+                        vector<DdNode *> nodes;
+                        order_nodes(ctrl_add.getNode(), node_ids, nodes);
+
+                        const string add_fn = file_name + string(".add");
+                        ofstream file(add_fn, ios::out | ios::trunc);
+                        ASSERT_CONDITION_THROW(!file.is_open(), string("Could not open the ADD file: ") + add_fn);
+                        file << setprecision(17) << ADD_FILE_TAG << " " << nodes.size() << "\n";
+                        for (DdNode * node : nodes) {
+                            if (Cudd_IsConstant(node)) {
+                                file << "c " << Cudd_V(node) << "\n";
+                            } else {
+                                file << "n " << Cudd_NodeReadIndex(node) << " " << node_ids[Cudd_T(node)]
+                                        << " " << node_ids[Cudd_E(node)] << "\n";
+                            }
+                        }
+                        file.close();
+                        ASSERT_CONDITION_THROW(!file, string("Could not write the ADD file: ") + add_fn);
+                    }
+
+                    /**
+                     * Allows to load the ADD controller, the variables are matched by their ids
+                     * @param cudd_mgr the CUDD manager to load into
+                     * @param ctrl_set the controller's symbolic set to be loaded
+                     * @param ctrl_add the controller's ADD to be loaded
+                     * @param file_name the file name without (.scs/.add)
+                     */
+                    static void load(const Cudd & cudd_mgr, SymbolicSet & ctrl_set,
+                            ADD & ctrl_add, const string & file_name) {
+                        ASSERT_CONDITION_THROW(!read_from_file(cudd_mgr, ctrl_set, file_name),
+                                string("Controller file '") + file_name + string(".scs' could not be loaded!"));
+                        const string add_fn = file_name + string(".add");
+                        ifstream file(add_fn);
+                        ASSERT_CONDITION_THROW(!file.is_open(), string("Could not open the ADD file: ") + add_fn);
+
+                        string tag;
+                        size_t num_nodes = 0;
+                        file >> tag >> num_nodes;
+                        ASSERT_CONDITION_THROW((!file) || (tag != ADD_FILE_TAG) || (num_nodes == 0),
+                                string("The ADD file has a wrong header: ") + add_fn);
+
+                        //Re-build the nodes, the children are already there
+                        vector<ADD> nodes;
+                        nodes.reserve(num_nodes);
+                        for (size_t idx = 0; idx < num_nodes; ++idx) {
+                            string kind;
+                            file >> kind;
+                            if (kind == "c") {
+                                double value = 0.0;
+                                file >> value;
+                                ASSERT_CONDITION_THROW(!file, string("Could not read the ADD file: ") + add_fn);
+                                nodes.push_back(cudd_mgr.constant(value));
+                            } else {
+                                int var_idx = -1;
+                                size_t then_id = num_nodes, else_id = num_nodes;
+                                file >> var_idx >> then_id >> else_id;
+                                ASSERT_CONDITION_THROW((!file) || (kind != "n") || (var_idx < 0) ||
+                                        (then_id >= idx) || (else_id >= idx),
+                                        string("Could not read the ADD file: ") + add_fn);
+                                nodes.push_back(cudd_mgr.addVar(var_idx).Ite(nodes[then_id], nodes[else_id]));
+                            }
+                        }
+                        ctrl_add = nodes.back();
+                    }
+
+                private:
+
+                    /**
+                     * Allows to number the ADD nodes in the post order
+                     * @param node the ADD node to start from
+                     * @param node_ids the map from the node to its number
+                     * @param nodes the numbered nodes
+                     */
+                    static void order_nodes(DdNode * node, unordered_map<DdNode *, size_t> & node_ids,
+                            vector<DdNode *> & nodes) {
+                        if (node_ids.find(node) == node_ids.end()) {
+                            if (!Cudd_IsConstant(node)) {
+                                order_nodes(Cudd_T(node), node_ids, nodes);
+                                order_nodes(Cudd_E(node), node_ids, nodes);
+                            }
+                            node_ids[node] = nodes.size();
+                            nodes.push_back(node);
+                        }
+                    }
+
+                    //Stores the number of state-space dimensions
+                    const int32_t m_ss_dim;
+                    //Stores the ADD root
+                    DdNode * m_root;
+                    //Stores the grid dimensions, the state ones and then the input ones
+                    vector<flat_bdd_dim> m_dims;
+                    //Stores the variables per BDD variable index
+                    vector<flat_bdd_var> m_index_vars;
+                };
+            }
+        }
+    }
+}
+
+#endif /* CTRL_ADD_HPP */
@@ -0,0 +1,483 @@
+/*
+ * File:   ctrl_codegen.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 12, 2018, 10:10 AM
+ */
+
+#ifndef CTRL_CODEGEN_HPP
+#define CTRL_CODEGEN_HPP
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <cstdint>
+#include <cmath>
+
+#include "exceptions.hh"
+#include "logger.hh"
+
+#include "flat_batch.hh"
+
+using namespace std;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                //The generated code modes
+                enum codegen_mode_enum {
+                    //The static node tables walked in a loop, the smallest ROM size
+                    cg_table = 0,
+                    //The branches over the state bits, the fastest
+                    cg_branch = cg_table + 1,
+                    codegen_mode_enum_size = cg_branch + 1
+                };
+
+                //The maximum number of the emitted branch nodes, C compilers get very slow on larger functions
+                static constexpr size_t CODEGEN_MAX_BRANCH_NODES = 16384;
+
+                //The generated code languages
+                enum codegen_lang_enum {
+                    //The C99 header and source files
+                    cg_c99 = 0,
+                    //The C++ header file
+                    cg_cpp = cg_c99 + 1,
+                    codegen_lang_enum_size = cg_cpp + 1
+                };
+
+                /**
+                 * This class allows to generate the self-contained C99 or C++ source
+                 * code of the batch compiled controller. The generated lookup maps the
+                 * state into the smallest available input in a time bounded by the
+                 * number of the state-space BDD variables, it uses no dynamic memory.
+                 */
+                class ctrl_codegen {
+                public:
+
+                    /**
+                     * The basic constructor
+                     * @param batch the batch compiled controller, must outlive the generator
+                     * @param name the name prefix of the generated identifiers
+                     * @param mode the generated code mode, the branch mode falls back
+                     *             to the table mode for too many branch nodes
+                     */
+                    ctrl_codegen(const flat_batch & batch, const string & name, const codegen_mode_enum mode)
+                    : m_batch(batch), m_name(name), m_mode(mode), m_rom_size(0) {
+                        ASSERT_CONDITION_THROW(!is_identifier(name),
+                                string("The name '") + name + string("' is not a valid C identifier!"));
+                        if (m_mode == cg_branch) {
+                            size_t num_nodes = 0;
+                            for (size_t idx = 0; idx < m_batch.get_roots().size(); ++idx) {
+                                num_nodes += get_reached(idx).size();
+                            }
+                            if (num_nodes > CODEGEN_MAX_BRANCH_NODES) {
+                                LOG_WARNING << "The branch mode needs " << num_nodes << " branch nodes, more than "
+                                        << CODEGEN_MAX_BRANCH_NODES << ", falling back to the table mode!" << END_LOG;
+                                m_mode = cg_table;
+                            }
+                        }
+                    }
+
+                    /**
+                     * Allows to generate the code files
+                     * @param file_name the target file name without extension
+                     * @param lang the generated code language
+                     */
+                    void generate(const string & file_name, const codegen_lang_enum lang) {
+                        const string upper = get_upper(m_name);
+                        stringstream body;
+                        m_rom_size = 0;
+                        emit_body(body, lang);
+
+                        if (lang == cg_c99) {
+                            //The header declares the lookup function only
+                            stringstream header;
+                            emit_banner(header);
+                            header << "#ifndef " << upper << "_H\n#define " << upper << "_H\n\n";
+                            emit_defines(header, upper);
+                            header << "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n";
+                            emit_lookup_doc(header);
+                            header << "int " << m_name << "_lookup(const double * x, double * u);\n\n";
+                            header << "#ifdef __cplusplus\n}\n#endif\n\n#endif /* " << upper << "_H */\n";
+                            write_file(file_name + ".h", header.str());
+
+                            stringstream source;
+                            emit_banner(source);
+                            source << "#include <stdint.h>\n\n#include \"" << get_base_name(file_name) << ".h\"\n\n";
+                            source << body.str();
+                            write_file(file_name + ".c", source.str());
+                        } else {
+                            stringstream header;
+                            emit_banner(header);
+                            header << "#ifndef " << upper << "_HPP\n#define " << upper << "_HPP\n\n#include <cstdint>\n\n";
+                            emit_defines(header, upper);
+                            header << "namespace " << m_name << " {\n\n" << body.str() << "}\n\n#endif /* " << upper << "_HPP */\n";
+                            write_file(file_name + ".hpp", header.str());
+                        }
+                    }
+
+                    /**
+                     * Allows to get the estimated ROM size of the generated data and code
+                     * @return the estimated ROM size in bytes, the code size is not counted for the table mode
+                     */
+                    inline size_t get_rom_size() const {
+                        return m_rom_size;
+                    }
+
+                    /**
+                     * Allows to get the generated code mode
+                     * @return the generated code mode, can differ from the requested one
+                     */
+                    inline codegen_mode_enum get_mode() const {
+                        return m_mode;
+                    }
+
+                    /**
+                     * Allows to get the upper case version of the string
+                     * @param name the string
+                     * @return the upper case string
+                     */
+                    static inline string get_upper(string name) {
+                        for (char & chr : name) {
+                            chr = toupper(chr);
+                        }
+                        return name;
+                    }
+
+                private:
+                    //Stores the batch compiled controller
+                    const flat_batch & m_batch;
+                    //Stores the name prefix
+                    const string m_name;
+                    //Stores the generated code mode
+                    codegen_mode_enum m_mode;
+                    //Stores the estimated ROM size
+                    size_t m_rom_size;
+
+                    /**
+                     * Allows to check if the string is a valid C identifier
+                     * @param name the string to check
+                     * @return true if the string is a valid C identifier
+                     */
+                    static inline bool is_identifier(const string & name) {
+                        bool is_ok = !name.empty() && !isdigit(name[0]);
+                        for (const char chr : name) {
+                            is_ok = is_ok && (isalnum(chr) || (chr == '_'));
+                        }
+                        return is_ok;
+                    }
+
+                    /**
+                     * Allows to get the file name without the directory
+                     * @param file_name the file name
+                     * @return the base file name
+                     */
+                    static inline string get_base_name(const string & file_name) {
+                        const size_t pos = file_name.find_last_of('/');
+                        return (pos == string::npos) ? file_name : file_name.substr(pos + 1);
+                    }
+
+                    /**
+                     * Allows to get the exact literal of the double value
+                     * @param value the value
+                     * @return the literal
+                     */
+                    static inline string get_literal(const double value) {
+                        stringstream out;
+                        out << setprecision(numeric_limits<double>::max_digits10) << value;
+                        string literal = out.str();
+                        if (literal.find_first_of(".e") == string::npos) {
+                            literal += ".0";
+                        }
+                        return literal;
+                    }
+
+                    /**
+                     * Allows to get the smallest unsigned type for the values
+                     * @param max_value the maximum value
+                     * @param size the variable to store the type size in bytes
+                     * @return the type name
+                     */
+                    static inline string get_type(const uint64_t max_value, size_t & size) {
+                        size = (max_value <= UINT8_MAX) ? 1 : ((max_value <= UINT16_MAX) ? 2 : 4);
+                        return string("uint") + to_string(size * 8) + string("_t");
+                    }
+
+                    /**
+                     * Allows to write the file
+                     * @param file_name the file name
+                     * @param content the file content
+                     */
+                    static inline void write_file(const string & file_name, const string & content) {
+                        ofstream file(file_name, ios::out | ios::trunc);
+                        ASSERT_CONDITION_THROW(!file.is_open(), string("Could not open the file: ") + file_name);
+                        file << content;
+                        ASSERT_CONDITION_THROW(!file.good(), string("Could not write the file: ") + file_name);
+                        LOG_USAGE << "Generated file: '" << file_name << "'" << END_LOG;
+                    }
+
+                    /**
+                     * Allows to emit the banner comment
+                     * @param out the output stream
+                     */
+                    inline void emit_banner(ostream & out) const {
+                        out << "/*\n * Generated by scots_codegen, do not edit!\n *\n * The " << m_name
+                                << " controller: " << m_batch.get_ss_dim() << " state and "
+                                << m_batch.get_is_dim() << " input dimensions, "
+                                << ((m_mode == cg_table) ? "node table" : "branch") << " mode.\n */\n\n";
+                    }
+
+                    /**
+                     * Allows to emit the dimension defines
+                     * @param out the output stream
+                     * @param upper the upper case name prefix
+                     */
+                    inline void emit_defines(ostream & out, const string & upper) const {
+                        out << "/* The number of state-space dimensions */\n#define " << upper
+                                << "_SS_DIM " << m_batch.get_ss_dim() << "\n";
+                        out << "/* The number of input-space dimensions */\n#define " << upper
+                                << "_IS_DIM " << m_batch.get_is_dim() << "\n\n";
+                    }
+
+                    /**
+                     * Allows to emit the lookup function documentation
+                     * @param out the output stream
+                     */
+                    inline void emit_lookup_doc(ostream & out) const {
+                        out << "/*\n * Looks up the input for the state, the smallest one if there are several\n"
+                                << " * x - the state, of the state-space dimensionality\n"
+                                << " * u - the input, of the input-space dimensionality\n"
+                                << " * returns 1 if the input is found, 0 if the state is outside\n"
+                                << " * of the grid or of the controller's domain\n */\n";
+                    }
+
+                    /**
+                     * Allows to emit the array
+                     * @param out the output stream
+                     * @param qual the array qualifiers
+                     * @param name the array name suffix
+                     * @param values the array values
+                     */
+                    template<typename value_type>
+                    inline void emit_array(ostream & out, const string & qual, const string & name,
+                            const vector<value_type> & values) {
+                        uint64_t max_value = 0;
+                        for (const value_type value : values) {
+                            max_value = max(max_value, (uint64_t) value);
+                        }
+                        size_t size = 0;
+                        const string type = get_type(max_value, size);
+                        m_rom_size += size * values.size();
+                        out << qual << " " << type << " " << m_name << "_" << name << "[" << values.size() << "] = {";
+                        for (size_t idx = 0; idx < values.size(); ++idx) {
+                            out << ((idx % 16 == 0) ? "\n    " : " ") << values[idx]
+                                    << ((idx + 1 < values.size()) ? "," : "");
+                        }
+                        out << "\n};\n\n";
+                    }
+
+                    /**
+                     * Allows to emit the data and the functions
+                     * @param out the output stream
+                     * @param lang the generated code language
+                     */
+                    void emit_body(ostream & out, const codegen_lang_enum lang) {
+                        const string qual = (lang == cg_c99) ? "static const" : "static constexpr";
+                        const string func = (lang == cg_c99) ? "static int" : "static inline int";
+                        const int32_t ss_dim = m_batch.get_ss_dim();
+                        const int32_t is_dim = m_batch.get_is_dim();
+                        const vector<flat_bdd_dim> & dims = m_batch.get_dims();
+                        const vector<flat_bdd_var> & in_bits = m_batch.get_in_bits();
+                        const vector<uint32_t> & roots = m_batch.get_roots();
+
+                        //Emit the grid specific state to dofs conversion
+                        out << "/* Converts the state into the grid dofs, returns 0 if the state is outside of the grid */\n";
+                        out << func << " " << m_name << "_xtois(const double * x, uint32_t * d) {\n    double p;\n";
+                        for (int32_t dof = 0; dof < ss_dim; ++dof) {
+                            const double x2a_sh = dims[dof].m_x2a_sh;
+                            out << "    p = x[" << dof << "] * " << get_literal(dims[dof].m_eta_inv)
+                                    << ((x2a_sh < 0) ? " + " : " - ") << get_literal(abs(x2a_sh)) << ";\n";
+                            out << "    if (!((p > -1.0) && (p < " << dims[dof].m_num_points << ".0))) return 0;\n";
+                            out << "    d[" << dof << "] = (uint32_t) p;\n";
+                        }
+                        out << "    return 1;\n}\n\n";
+
+                        //Emit the functions of the state
+                        if (m_mode == cg_table) {
+                            emit_array(out, qual, "node_var", m_batch.get_node_vars());
+                            emit_array(out, qual, "node_then", m_batch.get_node_thens());
+                            emit_array(out, qual, "node_else", m_batch.get_node_elses());
+                            emit_array(out, qual, "var_dof", m_batch.get_var_dofs());
+                            emit_array(out, qual, "var_bit", m_batch.get_var_bits());
+                            emit_array(out, qual, "roots", roots);
+                            out << "/* Evaluates the function with the given root node on the state dofs */\n";
+                            out << func << " " << m_name << "_eval(uint32_t n, const uint32_t * d) {\n";
+                            out << "    while (n > 1) {\n";
+                            out << "        const uint32_t v = " << m_name << "_node_var[n];\n";
+                            out << "        n = ((d[" << m_name << "_var_dof[v]] >> " << m_name << "_var_bit[v]) & 1u) ? "
+                                    << m_name << "_node_then[n] : " << m_name << "_node_else[n];\n";
+                            out << "    }\n    return (int) n;\n}\n\n";
+                        } else {
+                            for (size_t idx = 0; idx < roots.size(); ++idx) {
+                                emit_branches(out, func, idx);
+                            }
+                        }
+
+                        //Emit the lookup function
+                        if (lang == cg_cpp) {
+                            emit_lookup_doc(out);
+                        }
+                        out << ((lang == cg_c99) ? "int " : "inline int ") << m_name << "_lookup(const double * x, double * u) {\n";
+                        out << "    uint32_t d[" << ss_dim << "];\n    uint32_t v[" << is_dim << "] = {0};\n";
+                        out << "    if (!" << m_name << "_xtois(x, d) || !" << get_call(0) << ") return 0;\n";
+                        for (size_t idx = 0; idx < in_bits.size(); ++idx) {
+                            out << "    if (" << get_call(idx + 1) << ") v[" << in_bits[idx].m_dof
+                                    << "] |= (uint32_t) 1u << " << in_bits[idx].m_bit << ";\n";
+                        }
+                        for (int32_t dof = 0; dof < is_dim; ++dof) {
+                            out << "    u[" << dof << "] = " << get_literal(dims[ss_dim + dof].m_first)
+                                    << " + v[" << dof << "] * " << get_literal(dims[ss_dim + dof].m_eta) << ";\n";
+                        }
+                        out << "    return 1;\n}\n\n";
+                    }
+
+                    /**
+                     * Allows to get the function call evaluating the given root
+                     * @param root_idx the root index
+                     * @return the function call
+                     */
+                    inline string get_call(const size_t root_idx) const {
+                        if (m_mode == cg_table) {
+                            return m_name + string("_eval(") + m_name + string("_roots[") +
+                                    to_string(root_idx) + string("], d)");
+                        } else {
+                            return m_name + string("_f") + to_string(root_idx) + string("(d)");
+                        }
+                    }
+
+                    /**
+                     * Allows to emit the function of the root as branches
+                     * @param out the output stream
+                     * @param func the function qualifiers
+                     * @param root_idx the root index
+                     */
+                    void emit_branches(ostream & out, const string & func, const size_t root_idx) {
+                        const vector<uint32_t> & node_vars = m_batch.get_node_vars();
+                        const vector<uint32_t> & node_thens = m_batch.get_node_thens();
+                        const vector<uint32_t> & node_elses = m_batch.get_node_elses();
+                        const vector<uint32_t> & var_dofs = m_batch.get_var_dofs();
+                        const vector<uint32_t> & var_bits = m_batch.get_var_bits();
+                        const uint32_t root = m_batch.get_roots()[root_idx];
+                        const vector<uint32_t> nodes = get_reached(root_idx);
+
+                        //Find the jump targets, the else child falls through if possible
+                        vector<bool> is_target(node_vars.size(), false);
+                        for (size_t idx = 0; idx < nodes.size(); ++idx) {
+                            const uint32_t next = (idx + 1 < nodes.size()) ? nodes[idx + 1] : UINT32_MAX;
+                            is_target[node_thens[nodes[idx]]] = true;
+                            is_target[node_elses[nodes[idx]]] = is_target[node_elses[nodes[idx]]] ||
+                                    (node_elses[nodes[idx]] != next);
+                        }
+
+                        //Emit the nodes, the root comes first
+                        out << "/* Evaluates the " << ((root_idx == 0) ? string("domain") : (string("input bit ") +
+                                to_string(root_idx - 1))) << " function on the state dofs */\n";
+                        out << func << " " << m_name << "_f" << root_idx << "(const uint32_t * d) {\n";
+                        for (size_t idx = 0; idx < nodes.size(); ++idx) {
+                            const uint32_t node = nodes[idx];
+                            const uint32_t var = node_vars[node];
+                            if (is_target[node]) {
+                                out << "n" << node << ":\n";
+                            }
+                            out << "    if ((d[" << var_dofs[var] << "] >> " << var_bits[var] << ") & 1u) "
+                                    << get_jump(node_thens[node]) << "\n";
+                            const uint32_t next = (idx + 1 < nodes.size()) ? nodes[idx + 1] : UINT32_MAX;
+                            if (node_elses[node] != next) {
+                                out << "    " << get_jump(node_elses[node]) << "\n";
+                            }
+                        }
+                        if (root <= FLAT_BDD_ONE) {
+                            out << "    (void) d;\n    return " << root << ";\n";
+                        }
+                        out << "}\n\n";
+                        m_rom_size += nodes.size() * BRANCH_NODE_SIZE;
+                    }
+
+                    /**
+                     * Allows to get the non-terminal nodes reachable from the root
+                     * @param root_idx the root index
+                     * @return the reachable nodes, their indexes are in the level order
+                     */
+                    vector<uint32_t> get_reached(const size_t root_idx) const {
+                        const vector<uint32_t> & node_thens = m_batch.get_node_thens();
+                        const vector<uint32_t> & node_elses = m_batch.get_node_elses();
+                        const uint32_t root = m_batch.get_roots()[root_idx];
+                        vector<bool> is_reached(m_batch.get_node_vars().size(), false);
+                        vector<uint32_t> stack(1, root);
+                        is_reached[root] = true;
+                        while (!stack.empty()) {
+                            const uint32_t node = stack.back();
+                            stack.pop_back();
+                            if (node > FLAT_BDD_ONE) {
+                                for (const uint32_t child : {node_thens[node], node_elses[node]}) {
+                                    if (!is_reached[child]) {
+                                        is_reached[child] = true;
+                                        stack.push_back(child);
+                                    }
+                                }
+                            }
+                        }
+                        vector<uint32_t> nodes;
+                        for (uint32_t node = FLAT_BDD_ONE + 1; node < is_reached.size(); ++node) {
+                            if (is_reached[node]) {
+                                nodes.push_back(node);
+                            }
+                        }
+                        return nodes;
+                    }
+
+                    /**
+                     * Allows to get the jump to the node
+                     * @param node the node index
+                     * @return the jump statement
+                     */
+                    static inline string get_jump(const uint32_t node) {
+                        return (node <= FLAT_BDD_ONE) ? (string("return ") + to_string(node) + string(";")) :
+                                (string("goto n") + to_string(node) + string(";"));
+                    }
+
+                    //The estimated code size of a branch node, in bytes
+                    static constexpr size_t BRANCH_NODE_SIZE = 16;
+                };
+            }
+        }
+    }
+}
+
+#endif /* CTRL_CODEGEN_HPP */
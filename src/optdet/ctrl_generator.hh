@@ -0,0 +1,412 @@
+/*
+ * File:   ctrl_generator.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 18, 2018, 10:21 AM
+ */
+
+#ifndef CTRL_GENERATOR_HPP
+#define CTRL_GENERATOR_HPP
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "monitor.hh"
+
+#include "ctrl_data.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+using namespace tud::utils::monitor;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                /**
+                 * The enumeration storing the spatial structure types of the generated controller
+                 */
+                enum gen_struct_enum {
+                    //The inputs are constant on the Voronoi regions of random seeds
+                    smooth = 0,
+                    //The inputs are random per state
+                    noise = smooth + 1,
+                    //The inputs alternate on the hyper-cubic cells
+                    checker = noise + 1,
+                    gen_struct_size = checker + 1
+                };
+
+                /**
+                 * The enumeration storing the inputs-per-state distribution types
+                 */
+                enum gen_dist_enum {
+                    //The rounded mean number of inputs for every state
+                    constant = 0,
+                    //The uniform number of inputs within [1, 2 * mean - 1]
+                    uniform = constant + 1,
+                    //The one plus the geometric number of inputs, of the given mean
+                    geometric = uniform + 1,
+                    gen_dist_size = geometric + 1
+                };
+
+                /**
+                 * This structure stores the generated controller configuration
+                 */
+                struct gen_config {
+                    //The number of grid points per state-space dimension
+                    vector<int32_t> m_ss_points;
+                    //The number of grid points per input-space dimension
+                    vector<int32_t> m_is_points;
+                    //The fraction of the grid states in the controller's domain
+                    double m_density;
+                    //The mean number of inputs per domain state
+                    double m_mean_inputs;
+                    //The inputs-per-state distribution
+                    gen_dist_enum m_dist;
+                    //The spatial structure
+                    gen_struct_enum m_struct;
+                    //The number of regions if smooth, the cell width if checker
+                    int32_t m_scale;
+                    //The random seed
+                    uint64_t m_seed;
+                };
+
+                /**
+                 * This class generates synthetic SCOTSv2.0 BDD controllers of arbitrary size. The
+                 * controller is given by a function from the state's grid coordinates to its set
+                 * of inputs, the empty one outside of the domain, and the BDD is built bottom up over
+                 * the state variables in their order, in time linear in the number of grid states,
+                 * instead of joining the per-state minterms one by one. The random choices are made
+                 * by hashing the state id with the seed, so they do not depend on the build order.
+                 */
+                class ctrl_generator {
+                public:
+
+                    /**
+                     * The basic constructor
+                     * @param cudd_mgr the CUDD manager to create the controller in,
+                     *                 shall have no variables yet
+                     * @param config the controller configuration
+                     */
+                    ctrl_generator(const Cudd & cudd_mgr, const gen_config & config)
+                    : m_cudd_mgr(cudd_mgr), m_config(config),
+                    m_ss_dim(config.m_ss_points.size()), m_num_inputs(1),
+                    m_ss_set(), m_is_set(), m_levels(), m_seeds(), m_seed_inputs(),
+                    m_num_states(0), m_num_pairs(0) {
+                        //Create the state and input sets, the state variables go first
+                        m_ss_set = create_set(config.m_ss_points);
+                        m_is_set = create_set(config.m_is_points);
+                        m_num_inputs = m_is_set.size();
+
+                        //Collect the state variables in their order, the most significant bits first
+                        const vector<IntegerInterval<abs_type>> ints = m_ss_set.get_bdd_intervals();
+                        for (size_t dof = 0; dof < m_ss_dim; ++dof) {
+                            const vector<unsigned int> var_ids = ints[dof].get_bdd_var_ids();
+                            for (size_t idx = 0; idx < var_ids.size(); ++idx) {
+                                m_levels.push_back({dof, ((abs_type) 1) << (var_ids.size() - idx - 1),
+                                    m_cudd_mgr.bddVar(var_ids[idx])});
+                            }
+                        }
+
+                        //Place the random seeds of the smooth regions
+                        if (m_config.m_struct == gen_struct_enum::smooth) {
+                            for (int32_t reg = 0; reg < m_config.m_scale; ++reg) {
+                                for (size_t dof = 0; dof < m_ss_dim; ++dof) {
+                                    m_seeds.push_back(get_unit(get_hash(reg, dof + 1)));
+                                }
+                                m_seed_inputs.push_back(get_hash(reg, 0) % m_num_inputs);
+                            }
+                        }
+                    }
+
+                    /**
+                     * Allows to generate the controller
+                     * @param ctrl the controller data to be filled in
+                     */
+                    void generate(ctrl_data & ctrl) {
+                        //Declare the statistics data
+                        DECLARE_MONITOR_STATS;
+
+                        //Get the beginning statistics data
+                        INITIALIZE_STATS;
+
+                        m_num_states = 0;
+                        m_num_pairs = 0;
+                        vector<abs_type> ss_dofs(m_ss_dim, 0);
+                        ctrl.m_ss_dim = m_ss_dim;
+                        ctrl.m_ctrl_set = SymbolicSet(m_ss_set, m_is_set);
+                        ctrl.m_ctrl_bdd = build(0, ss_dofs);
+
+                        LOG_RESULT << "Generated the controller with " << m_num_states << " domain states out of "
+                                << m_ss_set.size() << ", " << m_num_pairs << " state-input pairs and "
+                                << ctrl.m_ctrl_bdd.nodeCount() << " BDD nodes" << END_LOG;
+
+                        //Get the end stats and log them
+                        REPORT_STATS(string("Generating the controller"));
+                    }
+
+                    /**
+                     * Allows to get the generated number of domain states
+                     * @return the number of domain states
+                     */
+                    inline size_t get_num_states() const {
+                        return m_num_states;
+                    }
+
+                    /**
+                     * Allows to get the generated number of state-input pairs
+                     * @return the number of state-input pairs
+                     */
+                    inline size_t get_num_pairs() const {
+                        return m_num_pairs;
+                    }
+
+                private:
+
+                    /**
+                     * This structure stores the state variable data
+                     */
+                    struct gen_level {
+                        //The state-space dimension of the variable
+                        size_t m_dof;
+                        //The bit weight of the variable
+                        abs_type m_weight;
+                        //The variable
+                        BDD m_var;
+                    };
+
+                    //Stores the reference to the CUDD manager
+                    const Cudd & m_cudd_mgr;
+                    //Stores the controller configuration
+                    const gen_config m_config;
+                    //Stores the number of state-space dimensions
+                    const size_t m_ss_dim;
+                    //Stores the number of inputs
+                    abs_type m_num_inputs;
+                    //Stores the state-space set
+                    SymbolicSet m_ss_set;
+                    //Stores the input-space set
+                    SymbolicSet m_is_set;
+                    //Stores the state variables in their order
+                    vector<gen_level> m_levels;
+                    //Stores the unit cube coordinates of the smooth region seeds
+                    vector<double> m_seeds;
+                    //Stores the inputs of the smooth region seeds
+                    vector<abs_type> m_seed_inputs;
+                    //Stores the generated number of domain states
+                    size_t m_num_states;
+                    //Stores the generated number of state-input pairs
+                    size_t m_num_pairs;
+
+                    /**
+                     * Allows to create the unit step symbolic set starting at zero
+                     * @param points the number of grid points per dimension
+                     * @return the symbolic set
+                     */
+                    inline SymbolicSet create_set(const vector<int32_t> & points) const {
+                        vector<double> lb(points.size(), 0.0), ub(points.size()), eta(points.size(), 1.0);
+                        for (size_t dof = 0; dof < points.size(); ++dof) {
+                            ub[dof] = points[dof] - 1;
+                        }
+                        return SymbolicSet(m_cudd_mgr, points.size(), lb, ub, eta);
+                    }
+
+                    /**
+                     * Allows to hash the values with the seed, the splitmix64 finalizer
+                     * @param value the first value
+                     * @param salt the second value
+                     * @return the hash value
+                     */
+                    inline uint64_t get_hash(const uint64_t value, const uint64_t salt) const {
+                        uint64_t hash = m_config.m_seed + value * 0x9E3779B97F4A7C15ULL + salt * 0xD6E8FEB86659FD93ULL;
+                        hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                        hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+                        return hash ^ (hash >> 31);
+                    }
+
+                    /**
+                     * Allows to map the hash value into [0, 1)
+                     * @param hash the hash value
+                     * @return the unit interval value
+                     */
+                    static inline double get_unit(const uint64_t hash) {
+                        return (hash >> 11) * (1.0 / 9007199254740992.0);
+                    }
+
+                    /**
+                     * Allows to check if the state is in the domain, for the smooth and checker
+                     * structures the domain is the centered box of the density volume fraction
+                     * and for the noise structure the states are dropped at random
+                     * @param ss_dofs the state grid coordinates
+                     * @param ss_id the state id
+                     * @return true if the state is in the domain
+                     */
+                    inline bool is_in_domain(const vector<abs_type> & ss_dofs, const abs_type ss_id) const {
+                        if (m_config.m_density >= 1.0) {
+                            return true;
+                        }
+                        if (m_config.m_struct == gen_struct_enum::noise) {
+                            return get_unit(get_hash(ss_id, 1)) < m_config.m_density;
+                        }
+                        const double side = pow(m_config.m_density, 1.0 / m_ss_dim);
+                        for (size_t dof = 0; dof < m_ss_dim; ++dof) {
+                            const double half = m_config.m_ss_points[dof] / 2.0;
+                            if (fabs(ss_dofs[dof] + 0.5 - half) > side * half) {
+                                return false;
+                            }
+                        }
+                        return true;
+                    }
+
+                    /**
+                     * Allows to get the structure's input of the state
+                     * @param ss_dofs the state grid coordinates
+                     * @param ss_id the state id
+                     * @return the input id
+                     */
+                    inline abs_type get_main_input(const vector<abs_type> & ss_dofs, const abs_type ss_id) const {
+                        switch (m_config.m_struct) {
+                            case gen_struct_enum::smooth: {
+                                //Take the input of the nearest region seed
+                                double min_dist = INFINITY;
+                                abs_type input_id = 0;
+                                for (size_t reg = 0; reg < m_seed_inputs.size(); ++reg) {
+                                    double dist = 0.0;
+                                    for (size_t dof = 0; dof < m_ss_dim; ++dof) {
+                                        const double diff = (ss_dofs[dof] + 0.5) / m_config.m_ss_points[dof]
+                                                - m_seeds[reg * m_ss_dim + dof];
+                                        dist += diff * diff;
+                                    }
+                                    if (dist < min_dist) {
+                                        min_dist = dist;
+                                        input_id = m_seed_inputs[reg];
+                                    }
+                                }
+                                return input_id;
+                            }
+                            case gen_struct_enum::noise:
+                                return get_hash(ss_id, 2) % m_num_inputs;
+                            case gen_struct_enum::checker: {
+                                //Take the parity of the cell
+                                abs_type sum = 0;
+                                for (size_t dof = 0; dof < m_ss_dim; ++dof) {
+                                    sum += ss_dofs[dof] / m_config.m_scale;
+                                }
+                                return (sum % 2) % m_num_inputs;
+                            }
+                            default:
+                                THROW_EXCEPTION(string("Unsupported controller structure: ") + to_string(m_config.m_struct));
+                        }
+                    }
+
+                    /**
+                     * Allows to get the number of inputs of the state
+                     * @param ss_id the state id
+                     * @return the number of inputs, within [1, number of inputs]
+                     */
+                    inline abs_type get_num_state_inputs(const abs_type ss_id) const {
+                        const double mean = m_config.m_mean_inputs;
+                        const double unit = get_unit(get_hash(ss_id, 3));
+                        double num = 1.0;
+                        switch (m_config.m_dist) {
+                            case gen_dist_enum::constant:
+                                num = round(mean);
+                                break;
+                            case gen_dist_enum::uniform:
+                                num = 1.0 + floor(unit * round(2.0 * mean - 1.0));
+                                break;
+                            case gen_dist_enum::geometric:
+                                //The failures count of the success probability 1/mean
+                                num = (mean > 1.0) ? 1.0 + floor(log(1.0 - unit) / log((mean - 1.0) / mean)) : 1.0;
+                                break;
+                            default:
+                                THROW_EXCEPTION(string("Unsupported inputs distribution: ") + to_string(m_config.m_dist));
+                        }
+                        return min(static_cast<abs_type> (max(num, 1.0)), m_num_inputs);
+                    }
+
+                    /**
+                     * Allows to get the BDD of the state's inputs
+                     * @param ss_dofs the state grid coordinates
+                     * @return the inputs BDD, zero if the state is not in the domain
+                     */
+                    inline BDD get_inputs_bdd(const vector<abs_type> & ss_dofs) {
+                        abs_type ss_id = 0;
+                        m_ss_set.istoi(ss_dofs.data(), ss_id);
+                        if (!is_in_domain(ss_dofs, ss_id)) {
+                            return m_cudd_mgr.bddZero();
+                        }
+
+                        //Add the main input and then the extra random ones
+                        const abs_type main_id = get_main_input(ss_dofs, ss_id);
+                        BDD inputs = m_is_set.id_to_bdd(main_id);
+                        const abs_type num_inputs = get_num_state_inputs(ss_id);
+                        if (num_inputs > 1) {
+                            //Take the extra inputs as a random stride walk from the main one
+                            const abs_type start = get_hash(ss_id, 4) % (m_num_inputs - 1);
+                            for (abs_type idx = 0; idx < num_inputs - 1; ++idx) {
+                                const abs_type offset = 1 + (start + idx) % (m_num_inputs - 1);
+                                inputs |= m_is_set.id_to_bdd((main_id + offset) % m_num_inputs);
+                            }
+                        }
+                        ++m_num_states;
+                        m_num_pairs += num_inputs;
+                        return inputs;
+                    }
+
+                    /**
+                     * Allows to build the controller's BDD below the given state variable
+                     * @param level the state variable index
+                     * @param ss_dofs the state grid coordinates fixed so far
+                     * @return the controller's BDD
+                     */
+                    BDD build(const size_t level, vector<abs_type> & ss_dofs) {
+                        if (level == m_levels.size()) {
+                            return get_inputs_bdd(ss_dofs);
+                        }
+                        const gen_level & var = m_levels[level];
+                        const BDD low = build(level + 1, ss_dofs);
+                        BDD high = m_cudd_mgr.bddZero();
+                        //The high branch is outside of the grid if its smallest coordinate is
+                        ss_dofs[var.m_dof] += var.m_weight;
+                        if (ss_dofs[var.m_dof] < static_cast<abs_type> (m_config.m_ss_points[var.m_dof])) {
+                            high = build(level + 1, ss_dofs);
+                        }
+                        ss_dofs[var.m_dof] -= var.m_weight;
+                        return var.m_var.Ite(high, low);
+                    }
+                };
+            }
+        }
+    }
+}
+
+#endif /* CTRL_GENERATOR_HPP */
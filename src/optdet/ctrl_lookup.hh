@@ -0,0 +1,215 @@
+/*
+ * File:   ctrl_lookup.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on March 26, 2018, 09:48 AM
+ */
+
+#ifndef CTRL_LOOKUP_HPP
+#define CTRL_LOOKUP_HPP
+
+#include <vector>
+#include <algorithm>
+
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "monitor.hh"
+
+#include "bdd_restrictor.hh"
+#include "thread_pool.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+using namespace tud::utils::monitor;
+using namespace tud::utils::threads;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                /**
+                 * This class represents an immutable controller lookup table. It is
+                 * created from the controller's BDD once and then does not need the
+                 * CUDD manager any more. The domain state ids are stored sorted, with
+                 * the input ids of each state stored consecutively. All the lookups
+                 * are thread safe and allocation free.
+                 */
+                class ctrl_lookup {
+                public:
+
+                    /**
+                     * The basic constructor, uses the CUDD manager and the workers
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD
+                     * @param ss_dim the number of state-space dimensions
+                     * @param workers the worker threads to build the table with
+                     */
+                    ctrl_lookup(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set,
+                            const BDD & ctrl_bdd, const int32_t ss_dim, thread_pool & workers)
+                    : m_ss_dim(ss_dim), m_is_dim(ctrl_set.get_dim() - ss_dim),
+                    m_ss_grid(), m_is_grid(), m_state_ids(), m_offsets(), m_input_ids() {
+                        //Declare the statistics data
+                        DECLARE_MONITOR_STATS;
+
+                        //Get the beginning statistics data
+                        INITIALIZE_STATS;
+
+                        ASSERT_CONDITION_THROW((ss_dim <= 0) || (ss_dim > (int32_t) FLAT_MAX_DIM),
+                                string("The state-space dimensionality must be within [1, ") +
+                                to_string(FLAT_MAX_DIM) + string("]: ") + to_string(ss_dim));
+
+                        bdd_restrictor restr(ctrl_set, ctrl_bdd, ss_dim);
+                        m_ss_grid = restr.get_ss_set();
+                        m_is_grid = restr.get_is_set();
+
+                        //Get the controller's domain states, uses the CUDD manager so is sequential
+                        BDD dom_bdd = ctrl_bdd.ExistAbstract(restr.get_is_set().get_cube(cudd_mgr));
+                        abs_type num_states = 0;
+                        abs_type * ss_dofs = restr.get_ss_set().bdd_to_grid_point_ids(cudd_mgr, dom_bdd, num_states);
+
+                        //Order the domain states by their ids
+                        vector<pair<abs_type, abs_type>> id_idx(num_states);
+                        for (abs_type idx = 0; idx < num_states; ++idx) {
+                            m_ss_grid.istoi(&ss_dofs[idx * ss_dim], id_idx[idx].first);
+                            id_idx[idx].second = idx;
+                        }
+                        sort(id_idx.begin(), id_idx.end());
+
+                        //Compute the inputs per state in parallel
+                        vector<vector<abs_type>> input_ids(num_states);
+                        workers.parallel_for(num_states, [&](const size_t begin, const size_t end) {
+                            for (size_t idx = begin; idx < end; ++idx) {
+                                restr.restrict_dofs(&ss_dofs[id_idx[idx].second * ss_dim], input_ids[idx]);
+                            }
+                        });
+                        delete[] ss_dofs;
+
+                        //Store the table in the compact form
+                        m_state_ids.reserve(num_states);
+                        m_offsets.reserve(num_states + 1);
+                        m_offsets.push_back(0);
+                        for (abs_type idx = 0; idx < num_states; ++idx) {
+                            m_state_ids.push_back(id_idx[idx].first);
+                            m_input_ids.insert(m_input_ids.end(), input_ids[idx].begin(), input_ids[idx].end());
+                            m_offsets.push_back(m_input_ids.size());
+                        }
+
+                        LOG_INFO << "The lookup table has " << m_state_ids.size() << " states and "
+                                << m_input_ids.size() << " state-input pairs" << END_LOG;
+
+                        //Get the end stats and log them
+                        REPORT_STATS(string("Building the lookup table"));
+                    }
+
+                    /**
+                     * Allows to get the inputs available in the state, thread safe
+                     * @param state the state-space point, of the state-space dimensionality
+                     * @param p_inputs will point to the input ids, if any
+                     * @return the number of available inputs, zero if the state is
+                     *         outside of the grid or of the controller's domain
+                     */
+                    inline size_t lookup(const double * state, const abs_type * & p_inputs) const {
+                        abs_type ss_dofs[FLAT_MAX_DIM];
+                        abs_type * p_ss_dofs = ss_dofs;
+                        m_ss_grid.xtois(state, p_ss_dofs);
+                        abs_type ss_id;
+                        if (m_ss_grid.istoi(ss_dofs, ss_id)) {
+                            auto iter = lower_bound(m_state_ids.begin(), m_state_ids.end(), ss_id);
+                            if ((iter != m_state_ids.end()) && (*iter == ss_id)) {
+                                const size_t idx = iter - m_state_ids.begin();
+                                p_inputs = &m_input_ids[m_offsets[idx]];
+                                return m_offsets[idx + 1] - m_offsets[idx];
+                            }
+                        }
+                        p_inputs = NULL;
+                        return 0;
+                    }
+
+                    /**
+                     * Allows to convert the input id into the input-space point, thread safe
+                     * @param id the input id
+                     * @param input the array to store the input-space point, of the input-space dimensionality
+                     */
+                    inline void itox_input(const abs_type id, double * input) const {
+                        m_is_grid.itox(id, input);
+                    }
+
+                    /**
+                     * Allows to get the number of state-space dimensions
+                     * @return the number of state-space dimensions
+                     */
+                    inline int32_t get_ss_dim() const {
+                        return m_ss_dim;
+                    }
+
+                    /**
+                     * Allows to get the number of input-space dimensions
+                     * @return the number of input-space dimensions
+                     */
+                    inline int32_t get_is_dim() const {
+                        return m_is_dim;
+                    }
+
+                    /**
+                     * Allows to get the number of the controller's domain states
+                     * @return the number of domain states
+                     */
+                    inline size_t get_num_states() const {
+                        return m_state_ids.size();
+                    }
+
+                    /**
+                     * Allows to get the number of the controller's state-input pairs
+                     * @return the number of state-input pairs
+                     */
+                    inline size_t get_num_pairs() const {
+                        return m_input_ids.size();
+                    }
+
+                private:
+                    //Stores the number of state-space dimensions
+                    const int32_t m_ss_dim;
+                    //Stores the number of input-space dimensions
+                    const int32_t m_is_dim;
+                    //Stores the state-space grid
+                    UniformGrid m_ss_grid;
+                    //Stores the input-space grid
+                    UniformGrid m_is_grid;
+                    //Stores the sorted domain state ids
+                    vector<abs_type> m_state_ids;
+                    //Stores the offsets of the state's input ids, one more than states
+                    vector<size_t> m_offsets;
+                    //Stores the input ids of all the states
+                    vector<abs_type> m_input_ids;
+                };
+            }
+        }
+    }
+}
+
+#endif /* CTRL_LOOKUP_HPP */
@@ -0,0 +1,388 @@
+/*
+ * File:   ctrl_runtime.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 5, 2018, 10:21 AM
+ */
+
+#ifndef CTRL_RUNTIME_HPP
+#define CTRL_RUNTIME_HPP
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+
+#include "exceptions.hh"
+#include "logger.hh"
+
+#include "flat_bdd.hh"
+#include "latency_histogram.hh"
+
+using namespace std;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+using namespace tud::utils::monitor;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                //The maximum number of concurrent runtime readers
+                static constexpr size_t RUNTIME_MAX_READERS = 128;
+                //The runtime reader slot epoch value of an idle reader
+                static constexpr uint64_t RUNTIME_IDLE_EPOCH = 0;
+                //The default maximum number of inputs per lookup of the runtime reader
+                static constexpr size_t RUNTIME_MAX_INPUTS = 1 << 10;
+
+                /**
+                 * This structure represents the runtime reader slot, one per cache line
+                 */
+                struct alignas(64) runtime_slot {
+                    //The epoch the reader entered its lookup in, or idle
+                    atomic<uint64_t> m_epoch;
+                    //The slot is taken by a reader
+                    atomic<bool> m_is_used;
+                };
+
+                /**
+                 * This class represents the controller runtime allowing to replace the
+                 * controller, stored in the flat BDD form, while it is being queried.
+                 * The readers never block: a lookup announces the current epoch in the
+                 * reader's slot, reads the current controller version and leaves the slot
+                 * idle again. A new version is loaded and validated by the background
+                 * thread and then published with an atomic pointer swap. The previous
+                 * version is reclaimed once every reader slot is either idle or has
+                 * entered after the swap, so only the loader waits for the readers.
+                 */
+                class ctrl_runtime {
+                public:
+
+                    /**
+                     * This class represents the runtime reader, it takes one reader slot and
+                     * is to be used by a single thread. The lookups are wait free and use the
+                     * input ids buffer allocated once by the constructor.
+                     */
+                    class reader {
+                    public:
+
+                        /**
+                         * The basic constructor
+                         * @param runtime the runtime to read from
+                         * @param max_inputs the maximum number of inputs per lookup
+                         * @throws tud_exception if there are no free reader slots
+                         */
+                        reader(ctrl_runtime & runtime, const size_t max_inputs = RUNTIME_MAX_INPUTS)
+                        : m_runtime(runtime), m_p_slot(NULL), m_input_ids(max_inputs) {
+                            for (auto & slot : m_runtime.m_slots) {
+                                bool is_used = false;
+                                if (slot.m_is_used.compare_exchange_strong(is_used, true)) {
+                                    m_p_slot = &slot;
+                                    break;
+                                }
+                            }
+                            ASSERT_CONDITION_THROW((m_p_slot == NULL), string("There are more than ") +
+                                    to_string(RUNTIME_MAX_READERS) + string(" runtime readers!"));
+                        }
+
+                        /**
+                         * The basic destructor
+                         */
+                        virtual ~reader() {
+                            m_p_slot->m_epoch.store(RUNTIME_IDLE_EPOCH);
+                            m_p_slot->m_is_used.store(false);
+                        }
+
+                        /**
+                         * Allows to get the inputs available in the state, wait free
+                         * @param state the state-space point, of the state-space dimensionality
+                         * @param inputs the array to store the input-space points, one after another
+                         * @param max_inputs the maximum number of input-space points to store,
+                         *                   clamped to the reader's maximum number of inputs
+                         * @param p_version the pointer to store the version number used, or NULL
+                         * @return the number of available inputs, zero if the state is outside
+                         *         of the grid, can be larger than max_inputs
+                         */
+                        inline size_t lookup(const double * state, double * inputs,
+                                const size_t max_inputs, uint64_t * p_version = NULL) {
+                            const size_t num_stored = min(max_inputs, m_input_ids.size());
+
+                            //Enter, the epoch is announced before the version is read
+                            m_p_slot->m_epoch.store(m_runtime.m_epoch.load());
+                            const ctrl_version * p_curr = m_runtime.m_p_curr.load();
+
+                            const size_t num_inputs = p_curr->m_ctrl.lookup(state, m_input_ids.data(), num_stored);
+                            const size_t is_dim = p_curr->m_ctrl.get_is_dim();
+                            for (size_t idx = 0; idx < min(num_inputs, num_stored); ++idx) {
+                                p_curr->m_ctrl.itox_input(m_input_ids[idx], inputs + idx * is_dim);
+                            }
+                            if (p_version != NULL) {
+                                *p_version = p_curr->m_version;
+                            }
+
+                            //Leave, the version may be reclaimed from now on
+                            m_p_slot->m_epoch.store(RUNTIME_IDLE_EPOCH, memory_order_release);
+                            return num_inputs;
+                        }
+
+                    private:
+                        //Stores the runtime
+                        ctrl_runtime & m_runtime;
+                        //Stores the taken reader slot
+                        runtime_slot * m_p_slot;
+                        //Stores the input ids buffer of the lookups
+                        vector<abs_type> m_input_ids;
+                    };
+
+                    /**
+                     * The basic constructor, loads the initial version and starts the loader
+                     * @param file_name the initial flat BDD controller file name
+                     */
+                    ctrl_runtime(const string & file_name)
+                    : m_p_curr(NULL), m_epoch(RUNTIME_IDLE_EPOCH + 1), m_ss_dim(0), m_is_dim(0),
+                    m_num_versions(0), m_num_failed(0), m_swap_mutex(), m_mutex(), m_cv(),
+                    m_pending(), m_is_pending(false), m_is_stop(false), m_swap_latency(), m_loader() {
+                        for (auto & slot : m_slots) {
+                            slot.m_epoch.store(RUNTIME_IDLE_EPOCH);
+                            slot.m_is_used.store(false);
+                        }
+                        ctrl_version * p_first = load_version(file_name);
+                        m_ss_dim = p_first->m_ctrl.get_ss_dim();
+                        m_is_dim = p_first->m_ctrl.get_is_dim();
+                        m_p_curr.store(p_first);
+                        m_num_versions.fetch_add(1);
+                        m_loader = thread(&ctrl_runtime::loader_loop, this);
+                    }
+
+                    /**
+                     * The basic destructor, there shall be no readers left
+                     */
+                    virtual ~ctrl_runtime() {
+                        {
+                            lock_guard<mutex> lock(m_mutex);
+                            m_is_stop = true;
+                        }
+                        m_cv.notify_all();
+                        m_loader.join();
+                        delete m_p_curr.load();
+                    }
+
+                    /**
+                     * Allows to request the controller replacement, non blocking. The new version
+                     * is loaded by the background thread, an older pending request is dropped.
+                     * @param file_name the flat BDD controller file name
+                     */
+                    void request_swap(const string & file_name) {
+                        {
+                            lock_guard<mutex> lock(m_mutex);
+                            m_pending = file_name;
+                            m_is_pending = true;
+                        }
+                        m_cv.notify_all();
+                    }
+
+                    /**
+                     * Allows to replace the controller, blocking until the previous version is reclaimed
+                     * @param file_name the flat BDD controller file name
+                     * @return true if the new version is published, false if it could not be loaded
+                     */
+                    bool swap(const string & file_name) {
+                        lock_guard<mutex> swap_lock(m_swap_mutex);
+                        const auto start = chrono::steady_clock::now();
+                        try {
+                            ctrl_version * p_next = load_version(file_name);
+                            if ((p_next->m_ctrl.get_ss_dim() != m_ss_dim) || (p_next->m_ctrl.get_is_dim() != m_is_dim)) {
+                                delete p_next;
+                                THROW_EXCEPTION(string("The controller dimensions do not match: ") + file_name);
+                            }
+                            publish(p_next);
+                        } catch (std::exception & ex) {
+                            LOG_ERROR << "The controller version is rejected: " << ex.what() << END_LOG;
+                            m_num_failed.fetch_add(1);
+                            return false;
+                        }
+                        m_swap_latency.add(chrono::duration_cast<chrono::microseconds>(
+                                chrono::steady_clock::now() - start).count());
+                        return true;
+                    }
+
+                    /**
+                     * Allows to get the number of published versions, including the initial one
+                     * @return the number of published versions
+                     */
+                    inline uint64_t get_num_versions() const {
+                        return m_num_versions.load();
+                    }
+
+                    /**
+                     * Allows to get the number of rejected versions
+                     * @return the number of rejected versions
+                     */
+                    inline uint64_t get_num_failed() const {
+                        return m_num_failed.load();
+                    }
+
+                    /**
+                     * Allows to get the number of state-space dimensions, fixed for all versions
+                     * @return the number of state-space dimensions
+                     */
+                    inline int32_t get_ss_dim() const {
+                        return m_ss_dim;
+                    }
+
+                    /**
+                     * Allows to get the number of input-space dimensions, fixed for all versions
+                     * @return the number of input-space dimensions
+                     */
+                    inline int32_t get_is_dim() const {
+                        return m_is_dim;
+                    }
+
+                    /**
+                     * Allows to get the swap latency histogram, from the load start until reclaiming
+                     * @return the swap latency histogram in micro seconds
+                     */
+                    inline const latency_histogram & get_swap_latency() const {
+                        return m_swap_latency;
+                    }
+
+                private:
+
+                    /**
+                     * This structure represents the controller version
+                     */
+                    struct ctrl_version {
+                        //The controller
+                        flat_bdd m_ctrl;
+                        //The version number
+                        uint64_t m_version;
+
+                        /**
+                         * The basic constructor
+                         * @param file_name the flat BDD controller file name
+                         * @param version the version number
+                         */
+                        ctrl_version(const string & file_name, const uint64_t version)
+                        : m_ctrl(file_name), m_version(version) {
+                        }
+                    };
+
+                    //Stores the reader slots
+                    runtime_slot m_slots[RUNTIME_MAX_READERS];
+                    //Stores the current version
+                    atomic<const ctrl_version *> m_p_curr;
+                    //Stores the current epoch, incremented on every swap
+                    atomic<uint64_t> m_epoch;
+                    //Stores the number of state-space dimensions
+                    int32_t m_ss_dim;
+                    //Stores the number of input-space dimensions
+                    int32_t m_is_dim;
+                    //Stores the number of published versions
+                    atomic<uint64_t> m_num_versions;
+                    //Stores the number of rejected versions
+                    atomic<uint64_t> m_num_failed;
+                    //Serializes the swaps
+                    mutex m_swap_mutex;
+                    //Guards the pending request
+                    mutex m_mutex;
+                    //Notifies the loader about a pending request
+                    condition_variable m_cv;
+                    //Stores the pending request file name
+                    string m_pending;
+                    //Stores the pending request flag
+                    bool m_is_pending;
+                    //Stores the stop flag
+                    bool m_is_stop;
+                    //Stores the swap latencies
+                    latency_histogram m_swap_latency;
+                    //Stores the loader thread
+                    thread m_loader;
+
+                    /**
+                     * Allows to load and validate the controller version
+                     * @param file_name the flat BDD controller file name
+                     * @return the new version
+                     */
+                    ctrl_version * load_version(const string & file_name) {
+                        ctrl_version * p_version = new ctrl_version(file_name, m_num_versions.load() + 1);
+                        try {
+                            p_version->m_ctrl.validate();
+                        } catch (...) {
+                            delete p_version;
+                            throw;
+                        }
+                        LOG_INFO << "Loaded controller version " << p_version->m_version << " from '"
+                                << file_name << "', " << p_version->m_ctrl.get_num_nodes() << " nodes" << END_LOG;
+                        return p_version;
+                    }
+
+                    /**
+                     * Allows to publish the new version and to reclaim the previous one
+                     * @param p_next the new version
+                     */
+                    void publish(const ctrl_version * p_next) {
+                        const ctrl_version * p_prev = m_p_curr.exchange(p_next);
+                        const uint64_t epoch = m_epoch.fetch_add(1) + 1;
+                        m_num_versions.fetch_add(1);
+
+                        //Wait until no reader can still use the previous version
+                        for (auto & slot : m_slots) {
+                            uint64_t slot_epoch = slot.m_epoch.load();
+                            while ((slot_epoch != RUNTIME_IDLE_EPOCH) && (slot_epoch < epoch)) {
+                                this_thread::yield();
+                                slot_epoch = slot.m_epoch.load();
+                            }
+                        }
+                        delete p_prev;
+                    }
+
+                    /**
+                     * The loader thread's main loop
+                     */
+                    void loader_loop() {
+                        while (true) {
+                            string file_name;
+                            {
+                                unique_lock<mutex> lock(m_mutex);
+                                m_cv.wait(lock, [&] {
+                                    return m_is_stop || m_is_pending; });
+                                if (m_is_stop) {
+                                    return;
+                                }
+                                file_name = m_pending;
+                                m_is_pending = false;
+                            }
+                            swap(file_name);
+                        }
+                    }
+                };
+            }
+        }
+    }
+}
+
+#endif /* CTRL_RUNTIME_HPP */
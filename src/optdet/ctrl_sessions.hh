@@ -0,0 +1,347 @@
+/*
+ * File:   ctrl_sessions.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on March 12, 2018, 10:17 AM
+ */
+
+#ifndef CTRL_SESSIONS_HPP
+#define CTRL_SESSIONS_HPP
+
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <memory>
+#include <list>
+#include <unordered_map>
+
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                //The controller handle type, zero is never a valid handle
+                typedef uint32_t ctrl_handle;
+
+                //The size of the CUDD DdNode on 64-bit platforms, the type is opaque
+                static constexpr size_t CUDD_NODE_SIZE = 32;
+
+                /**
+                 * This structure stores a loaded SCOTSv2.0 BDD controller.
+                 * The CUDD manager is shared between all the controllers
+                 * defined on the same grid. Note that the manager must be
+                 * declared before the set and the BDD as it must outlive them.
+                 */
+                struct ctrl_session {
+                    //Stores the key of the controller's grid
+                    string m_grid_key;
+                    //Stores the possibly shared CUDD manager
+                    shared_ptr<Cudd> m_cudd_mgr;
+                    //Stores the Symbolic set of the controller
+                    SymbolicSet m_ctrl_set;
+                    //Stores the BDD of the controller
+                    BDD m_ctrl_bdd;
+                    //Stores the estimated memory size of the controller in bytes
+                    size_t m_mem_size;
+                    //Stores the position of the controller in the LRU list
+                    list<ctrl_handle>::iterator m_lru_it;
+                };
+
+                /**
+                 * This class manages a number of simultaneously loaded controllers.
+                 * Each loaded controller gets a handle to be used for accessing it.
+                 * The controllers that are defined on the same grid share one CUDD
+                 * manager. If the memory cap is set then the least recently used
+                 * controllers are evicted once the total estimated memory size of
+                 * the loaded controllers exceeds the cap.
+                 */
+                class ctrl_sessions {
+                public:
+
+                    /**
+                     * The basic constructor
+                     * @param mem_cap the memory cap in bytes, zero means no cap
+                     */
+                    ctrl_sessions(const size_t mem_cap = 0)
+                    : m_mem_cap(mem_cap), m_mem_size(0), m_next_id(1),
+                    m_sessions(), m_lru(), m_cudd_mgrs() {
+                    }
+
+                    /**
+                     * The basic destructor
+                     */
+                    virtual ~ctrl_sessions() {
+                        clear();
+                    }
+
+                    /**
+                     * Allows to load the SCOTS v2.0 BDD controller
+                     * @param file_name the controller's file name without ".scs" extension
+                     * @return the handle of the loaded controller
+                     * @throws tud_exception if the controller could not be loaded
+                     */
+                    ctrl_handle load(const string & file_name) {
+                        //Read the controller's grid and compute its key
+                        UniformGrid grid;
+                        if (!read_from_file(grid, file_name)) {
+                            THROW_EXCEPTION(string("Could not read controller's grid from: ") + file_name);
+                        }
+                        const string grid_key = get_grid_key(grid);
+
+                        //Create the new session with a possibly shared manager
+                        unique_ptr<ctrl_session> p_session(new ctrl_session());
+                        p_session->m_grid_key = grid_key;
+                        p_session->m_cudd_mgr = get_cudd_mgr(grid_key);
+
+                        //Read controller from file
+                        if (!read_from_file(*p_session->m_cudd_mgr, p_session->m_ctrl_set,
+                                p_session->m_ctrl_bdd, file_name)) {
+                            THROW_EXCEPTION(string("Could not read controller from: ") + file_name);
+                        }
+
+                        //Estimate the controller's memory size
+                        p_session->m_mem_size = estimate_mem_size(*p_session);
+
+                        //Register the session as the most recently used one
+                        const ctrl_handle id = m_next_id++;
+                        m_lru.push_front(id);
+                        p_session->m_lru_it = m_lru.begin();
+                        m_mem_size += p_session->m_mem_size;
+
+                        LOG_INFO << "Loaded controller " << file_name << " as handle "
+                                << id << ", estimated size: " << p_session->m_mem_size
+                                << " bytes" << END_LOG;
+
+                        m_sessions[id] = move(p_session);
+
+                        //Evict the least recently used controllers if needed
+                        evict(id);
+
+                        return id;
+                    }
+
+                    /**
+                     * Allows to get the controller by its handle, marks it as the most recently used one
+                     * @param id the controller's handle
+                     * @return the reference to the controller's session
+                     * @throws tud_exception if the controller is not loaded
+                     */
+                    inline ctrl_session & get(const ctrl_handle id) {
+                        auto iter = m_sessions.find(id);
+                        ASSERT_CONDITION_THROW((iter == m_sessions.end()),
+                                string("The controller handle ") + to_string(id) + " is not loaded");
+
+                        //Move the controller to the front of the LRU list
+                        m_lru.splice(m_lru.begin(), m_lru, iter->second->m_lru_it);
+
+                        return *iter->second;
+                    }
+
+                    /**
+                     * Allows to check if the controller with the given handle is loaded
+                     * @param id the controller's handle
+                     * @return true if the controller is loaded, otherwise false
+                     */
+                    inline bool is_loaded(const ctrl_handle id) const {
+                        return (m_sessions.find(id) != m_sessions.end());
+                    }
+
+                    /**
+                     * Allows to unload the controller
+                     * @param id the controller's handle
+                     * @return true if the controller was loaded, otherwise false
+                     */
+                    bool unload(const ctrl_handle id) {
+                        auto iter = m_sessions.find(id);
+                        if (iter != m_sessions.end()) {
+                            remove(iter);
+                            return true;
+                        } else {
+                            return false;
+                        }
+                    }
+
+                    /**
+                     * Allows to unload all the controllers
+                     */
+                    void clear() {
+                        while (!m_sessions.empty()) {
+                            remove(m_sessions.begin());
+                        }
+                    }
+
+                    /**
+                     * Allows to set the memory cap, evicts the least recently used controllers if needed
+                     * @param mem_cap the memory cap in bytes, zero means no cap
+                     */
+                    void set_mem_cap(const size_t mem_cap) {
+                        m_mem_cap = mem_cap;
+                        evict(m_lru.empty() ? 0 : m_lru.front());
+                    }
+
+                    /**
+                     * Allows to get the memory cap
+                     * @return the memory cap in bytes, zero means no cap
+                     */
+                    inline size_t get_mem_cap() const {
+                        return m_mem_cap;
+                    }
+
+                    /**
+                     * Allows to get the estimated memory size of all loaded controllers
+                     * @return the estimated memory size in bytes
+                     */
+                    inline size_t get_mem_size() const {
+                        return m_mem_size;
+                    }
+
+                    /**
+                     * Allows to get the number of loaded controllers
+                     * @return the number of loaded controllers
+                     */
+                    inline size_t size() const {
+                        return m_sessions.size();
+                    }
+
+                private:
+                    //Stores the memory cap in bytes, zero means no cap
+                    size_t m_mem_cap;
+                    //Stores the estimated memory size of all controllers
+                    size_t m_mem_size;
+                    //Stores the next handle to issue
+                    ctrl_handle m_next_id;
+                    //Stores the mapping from the handles to the sessions
+                    unordered_map<ctrl_handle, unique_ptr<ctrl_session>> m_sessions;
+                    //Stores the handles from the most to the least recently used
+                    list<ctrl_handle> m_lru;
+                    //Stores the CUDD managers per grid key, for sharing
+                    unordered_map<string, weak_ptr<Cudd>> m_cudd_mgrs;
+
+                    /**
+                     * Allows to compute the grid key, the controllers with equal
+                     * grid keys are defined on the same grid
+                     * @param grid the controller's grid
+                     * @return the grid key
+                     */
+                    static inline string get_grid_key(const UniformGrid & grid) {
+                        stringstream key;
+                        key << setprecision(17) << grid.get_dim();
+                        for (auto val : grid.get_lower_left()) key << "|" << val;
+                        for (auto val : grid.get_upper_right()) key << "|" << val;
+                        for (auto val : grid.get_eta()) key << "|" << val;
+                        return key.str();
+                    }
+
+                    /**
+                     * Allows to get the CUDD manager for the given grid, the
+                     * manager is shared if there is one for the same grid
+                     * @param grid_key the grid key
+                     * @return the CUDD manager
+                     */
+                    inline shared_ptr<Cudd> get_cudd_mgr(const string & grid_key) {
+                        shared_ptr<Cudd> p_mgr = m_cudd_mgrs[grid_key].lock();
+                        if (!p_mgr) {
+                            p_mgr = make_shared<Cudd>();
+                            //Disable automatic variable ordering
+                            p_mgr->AutodynDisable();
+                            m_cudd_mgrs[grid_key] = p_mgr;
+                        } else {
+                            LOG_INFO1 << "Sharing the CUDD manager of grid: "
+                                    << grid_key << END_LOG;
+                        }
+                        return p_mgr;
+                    }
+
+                    /**
+                     * Allows to estimate the controller's memory size. Note that
+                     * the BDD nodes shared with other controllers are counted
+                     * for each of them, so the estimate is conservative.
+                     * @param session the controller session
+                     * @return the estimated memory size in bytes
+                     */
+                    static inline size_t estimate_mem_size(const ctrl_session & session) {
+                        //Count the controller's BDD nodes
+                        size_t size = session.m_ctrl_bdd.nodeCount() * CUDD_NODE_SIZE;
+                        //Count the grid point BDDs of the symbolic set
+                        const int dim = session.m_ctrl_set.get_dim();
+                        for (int idx = 0; idx < dim; ++idx) {
+                            size += session.m_ctrl_set.get_no_grid_points(idx) * sizeof (BDD);
+                        }
+                        return size;
+                    }
+
+                    /**
+                     * Allows to remove the session
+                     * @param iter the session iterator
+                     */
+                    inline void remove(unordered_map<ctrl_handle, unique_ptr<ctrl_session>>::iterator iter) {
+                        const string grid_key = iter->second->m_grid_key;
+
+                        m_mem_size -= iter->second->m_mem_size;
+                        m_lru.erase(iter->second->m_lru_it);
+                        m_sessions.erase(iter);
+
+                        //Forget the manager if it is no longer used
+                        auto mgr_iter = m_cudd_mgrs.find(grid_key);
+                        if ((mgr_iter != m_cudd_mgrs.end()) && mgr_iter->second.expired()) {
+                            m_cudd_mgrs.erase(mgr_iter);
+                        }
+                    }
+
+                    /**
+                     * Allows to evict the least recently used controllers until
+                     * the memory size is within the cap. The most recently used
+                     * controller is never evicted, even if exceeds the cap.
+                     * @param keep_id the handle of the controller not to be evicted
+                     */
+                    void evict(const ctrl_handle keep_id) {
+                        while ((m_mem_cap > 0) && (m_mem_size > m_mem_cap)
+                                && (m_lru.back() != keep_id)) {
+                            const ctrl_handle id = m_lru.back();
+                            LOG_INFO << "Evicting controller handle " << id
+                                    << " the memory size " << m_mem_size
+                                    << " exceeds the cap " << m_mem_cap << END_LOG;
+                            remove(m_sessions.find(id));
+                        }
+                        if ((m_mem_cap > 0) && (m_mem_size > m_mem_cap)) {
+                            LOG_WARNING << "The controller handle " << keep_id
+                                    << " alone exceeds the memory cap " << m_mem_cap
+                                    << " bytes" << END_LOG;
+                        }
+                    }
+                };
+            }
+        }
+    }
+}
+
+#endif /* CTRL_SESSIONS_HPP */
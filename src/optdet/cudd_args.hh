@@ -0,0 +1,135 @@
+/* 
+ * File:   cudd_args.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 23, 2018, 11:02 AM
+ */
+
+#ifndef CUDD_ARGS_HPP
+#define CUDD_ARGS_HPP
+
+#include <string>
+#include <vector>
+
+//Command line parameters parser
+#include "tclap/CmdLine.h"
+
+#include "exceptions.hh"
+#include "logger.hh"
+
+#include "cudd_config.hh"
+
+using namespace std;
+using namespace TCLAP;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                //The pointers to the CUDD manager configuration parameters, shared by the tools
+                static vector<string> cudd_profiles;
+                static ValuesConstraint<string> * p_cudd_profile_vals = NULL;
+                static ValueArg<string> * p_cudd_profile = NULL;
+                static ValueArg<uint32_t> * p_cudd_slots = NULL;
+                static ValueArg<uint32_t> * p_cudd_cache = NULL;
+                static ValueArg<uint32_t> * p_cudd_max_cache = NULL;
+                static ValueArg<uint32_t> * p_cudd_max_mem = NULL;
+                static ValueArg<uint32_t> * p_cudd_min_hit = NULL;
+                static ValueArg<uint32_t> * p_cudd_loose_up_to = NULL;
+
+                /**
+                 * Allows to add the CUDD manager configuration parameters, these are long only
+                 * @param cmd_args the command line parameters parser
+                 */
+                static void create_cudd_arguments(CmdLine & cmd_args) {
+                    p_cudd_loose_up_to = new ValueArg<uint32_t>("", "cudd-loose-up-to", string("The number of nodes up to which") +
+                                                                string(" the unique table grows without garbage collection,") +
+                                                                string(" 0 for the profile value"), false, 0, "nodes", cmd_args);
+                    p_cudd_min_hit = new ValueArg<uint32_t>("", "cudd-min-hit", string("The cache hit rate percent above") +
+                                                            string(" which the cache grows, 0 for the profile value"),
+                                                            false, 0, "percent", cmd_args);
+                    p_cudd_max_mem = new ValueArg<uint32_t>("", "cudd-max-mem", string("The hard limit of the CUDD memory") +
+                                                            string(", exceeding it is an error, 0 for no limit"),
+                                                            false, 0, "MB", cmd_args);
+                    p_cudd_max_cache = new ValueArg<uint32_t>("", "cudd-max-cache", string("The maximum number of cache") +
+                                                              string(" slots, 0 for the profile value"), false, 0, "slots", cmd_args);
+                    p_cudd_cache = new ValueArg<uint32_t>("", "cudd-cache", string("The initial number of cache") +
+                                                          string(" slots, 0 for the profile value"), false, 0, "slots", cmd_args);
+                    p_cudd_slots = new ValueArg<uint32_t>("", "cudd-slots", string("The initial number of slots per") +
+                                                          string(" unique sub-table, 0 for the profile value"), false, 0, "slots", cmd_args);
+                    cudd_profiles = cudd_config::get_profiles();
+                    p_cudd_profile_vals = new ValuesConstraint<string>(cudd_profiles);
+                    p_cudd_profile = new ValueArg<string>("", "cudd-profile", string("The CUDD manager profile, auto sizes") +
+                                                          string(" the tables from the controller's node count"),
+                                                          false, CUDD_AUTO_PROFILE_STR, p_cudd_profile_vals, cmd_args);
+                }
+
+                /**
+                 * Allows to extract the CUDD manager configuration parameters and to resolve the profile
+                 * @param source_file the controller file name without the .bdd extension
+                 * @param config the configuration to fill in
+                 */
+                static void extract_cudd_arguments(const string & source_file, cudd_config & config) {
+                    config.m_profile = p_cudd_profile->getValue();
+                    config.m_unique_slots = p_cudd_slots->getValue();
+                    config.m_cache_slots = p_cudd_cache->getValue();
+                    config.m_max_cache = p_cudd_max_cache->getValue();
+                    config.m_max_mem_mb = p_cudd_max_mem->getValue();
+                    config.m_min_hit = p_cudd_min_hit->getValue();
+                    config.m_loose_up_to = p_cudd_loose_up_to->getValue();
+                    ASSERT_CONDITION_THROW((config.m_min_hit > 100),
+                                           string("Improper cache hit rate: ") +
+                                           to_string(config.m_min_hit) + string(" must be <= 100"));
+                    LOG_USAGE << "The CUDD manager profile is: " << config.m_profile << END_LOG;
+                    config.resolve(source_file);
+                }
+
+                /**
+                 * Allows to deallocate the CUDD manager configuration parameters
+                 */
+                static void destroy_cudd_arguments() {
+                    delete p_cudd_profile;
+                    p_cudd_profile = NULL;
+                    delete p_cudd_profile_vals;
+                    p_cudd_profile_vals = NULL;
+                    delete p_cudd_slots;
+                    p_cudd_slots = NULL;
+                    delete p_cudd_cache;
+                    p_cudd_cache = NULL;
+                    delete p_cudd_max_cache;
+                    p_cudd_max_cache = NULL;
+                    delete p_cudd_max_mem;
+                    p_cudd_max_mem = NULL;
+                    delete p_cudd_min_hit;
+                    p_cudd_min_hit = NULL;
+                    delete p_cudd_loose_up_to;
+                    p_cudd_loose_up_to = NULL;
+                }
+            }
+        }
+    }
+}
+
+#endif /* CUDD_ARGS_HPP */
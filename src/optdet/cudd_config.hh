@@ -0,0 +1,297 @@
+/* 
+ * File:   cudd_config.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 23, 2018, 10:17 AM
+ */
+
+#ifndef CUDD_CONFIG_HPP
+#define CUDD_CONFIG_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <cstdint>
+#include <algorithm>
+
+#include <unistd.h>
+
+#include "cuddObj.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+
+using namespace std;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                //The automatic profile name
+#define CUDD_AUTO_PROFILE_STR "auto"
+                //The CUDD defaults profile name
+#define CUDD_DEFAULT_PROFILE_STR "default"
+
+                //The number of bytes in one MB
+#define CUDD_BYTES_ONE_MB (1024ul * 1024ul)
+                //The maximum number of the initial unique sub-table slots of the automatic profile
+#define CUDD_AUTO_MAX_UNIQUE_SLOTS (1u << 22)
+                //The maximum number of the initial cache slots of the automatic profile
+#define CUDD_AUTO_MAX_CACHE_SLOTS (1u << 24)
+                //The number of controller nodes from which the cache is grown more eagerly
+#define CUDD_AUTO_LARGE_NODES 1000000u
+                //The cache hit rate percent above which the cache of a large controller grows
+#define CUDD_AUTO_LARGE_MIN_HIT 15u
+                //The number of bytes of one computed table cache slot, as of the CUDD's DdCache
+#define CUDD_CACHE_SLOT_BYTES (4 * sizeof(void *))
+                //The fraction of the memory CUDD lets the cache grow to, as of DD_MAX_CACHE_FRACTION
+#define CUDD_CACHE_MEM_FRACTION 3u
+                //The fraction of the memory the initial unique sub-tables of the automatic profile may take
+#define CUDD_UNIQUE_MEM_FRACTION 5u
+
+                /**
+                 * The CUDD error handler, turns the CUDD errors into exceptions
+                 * @param message the CUDD error message
+                 */
+                static void cudd_error_handler(string message) {
+                    if (message.find("Maximum memory") != string::npos) {
+                        THROW_EXCEPTION(string("CUDD: ") + message +
+                                        string(" Consider increasing the --cudd-max-mem limit."));
+                    } else {
+                        THROW_EXCEPTION(string("CUDD: ") + message);
+                    }
+                }
+
+                /**
+                 * This structure stores the CUDD manager configuration. The zero values
+                 * are taken from the profile: the "default" profile keeps the CUDD defaults,
+                 * the "auto" profile sizes the unique table and the computed table cache
+                 * from the node count in the controller's .bdd file header and lets the
+                 * cache and the unique table grow up to the fractions of the physical memory
+                 * instead of the 256 MB CUDD assumes when the data size is not limited.
+                 * The initial tables are kept within the hard cache limit and the memory
+                 * limit, as CUDD allocates them in full regardless of these.
+                 */
+                struct cudd_config {
+                    //The profile name
+                    string m_profile;
+                    //The initial number of slots per unique sub-table
+                    uint32_t m_unique_slots;
+                    //The initial number of computed table cache slots
+                    uint32_t m_cache_slots;
+                    //The maximum number of computed table cache slots
+                    uint32_t m_max_cache;
+                    //The hard limit of the CUDD memory in MB
+                    uint32_t m_max_mem_mb;
+                    //The cache hit rate percent above which the cache grows
+                    uint32_t m_min_hit;
+                    //The number of nodes up to which the unique table grows without GC
+                    uint32_t m_loose_up_to;
+                    //The target CUDD memory in bytes, sizes the cache and GC limits, zero for the CUDD default
+                    size_t m_target_mem;
+
+                    /**
+                     * Allows to get the supported profile names
+                     * @return the profile names
+                     */
+                    static vector<string> get_profiles() {
+                        return {CUDD_AUTO_PROFILE_STR, CUDD_DEFAULT_PROFILE_STR};
+                    }
+
+                    /**
+                     * Allows to resolve the profile values
+                     * @param source_file the controller file name without the .bdd extension
+                     */
+                    void resolve(const string & source_file) {
+                        const size_t max_mem = static_cast<size_t> (m_max_mem_mb) * CUDD_BYTES_ONE_MB;
+                        m_target_mem = max_mem;
+                        if (m_profile == CUDD_AUTO_PROFILE_STR) {
+                            size_t num_nodes = 0, num_vars = 0;
+                            read_bdd_header(source_file + string(".bdd"), num_nodes, num_vars);
+                            LOG_INFO << "The controller file has " << num_nodes << " nodes over "
+                                    << num_vars << " variables" << END_LOG;
+
+                            //The sub-tables are to hold the nodes of their variables
+                            if (m_unique_slots == 0) {
+                                m_unique_slots = get_pow2(num_nodes / max(num_vars, (size_t) 1),
+                                                          CUDD_UNIQUE_SLOTS, CUDD_AUTO_MAX_UNIQUE_SLOTS);
+                            }
+                            //The sub-tables of all the variables are to fit into the memory limit
+                            if (max_mem > 0) {
+                                m_unique_slots = min(m_unique_slots, get_pow2_floor(max_mem / CUDD_UNIQUE_MEM_FRACTION /
+                                        (max(num_vars, (size_t) 1) * sizeof(DdNode *))));
+                            }
+                            //The cache is to be as large as the controller
+                            if (m_cache_slots == 0) {
+                                m_cache_slots = get_pow2(num_nodes, CUDD_CACHE_SLOTS, CUDD_AUTO_MAX_CACHE_SLOTS);
+                            }
+                            //The large controllers benefit from the cache growing earlier
+                            if ((m_min_hit == 0) && (num_nodes >= CUDD_AUTO_LARGE_NODES)) {
+                                m_min_hit = CUDD_AUTO_LARGE_MIN_HIT;
+                            }
+                            //Target three quarters of the physical memory, if not limited
+                            if (m_target_mem == 0) {
+                                m_target_mem = get_phys_memory() / 4 * 3;
+                            }
+                        }
+
+                        //The initial cache is not to exceed the hard cache limit
+                        const size_t max_cache = get_max_cache_hard();
+                        if (max_cache > 0) {
+                            m_cache_slots = min((m_cache_slots > 0) ? m_cache_slots : (uint32_t) CUDD_CACHE_SLOTS,
+                                                get_pow2_floor(max_cache));
+                            //CUDD makes the cache at least half as large as the unique sub-table
+                            m_unique_slots = min((m_unique_slots > 0) ? m_unique_slots : (uint32_t) CUDD_UNIQUE_SLOTS,
+                                                 2 * m_cache_slots);
+                        }
+                    }
+
+                    /**
+                     * Allows to create the CUDD manager with this configuration,
+                     * the resolve method is to be called first.
+                     * @return the CUDD manager
+                     */
+                    Cudd create_manager() const {
+                        Cudd cudd_mgr(0, 0, (m_unique_slots > 0) ? m_unique_slots : CUDD_UNIQUE_SLOTS,
+                                (m_cache_slots > 0) ? m_cache_slots : CUDD_CACHE_SLOTS,
+                                m_target_mem, cudd_error_handler);
+                        if (m_max_mem_mb > 0) {
+                            cudd_mgr.SetMaxMemory(static_cast<size_t> (m_max_mem_mb) * CUDD_BYTES_ONE_MB);
+                        }
+                        if (m_max_cache > 0) {
+                            cudd_mgr.SetMaxCacheHard(m_max_cache);
+                        }
+                        if (m_min_hit > 0) {
+                            cudd_mgr.SetMinHit(m_min_hit);
+                        }
+                        if (m_loose_up_to > 0) {
+                            cudd_mgr.SetLooseUpTo(m_loose_up_to);
+                        }
+                        return cudd_mgr;
+                    }
+
+                    /**
+                     * Allows to log the configuration of the CUDD manager
+                     * @param cudd_mgr the CUDD manager
+                     */
+                    void log_config(const Cudd & cudd_mgr) const {
+                        const size_t max_mem = cudd_mgr.ReadMaxMemory();
+                        LOG_USAGE << "CUDD profile '" << m_profile << "': unique sub-table slots "
+                                << ((m_unique_slots > 0) ? m_unique_slots : CUDD_UNIQUE_SLOTS)
+                                << ", cache slots " << cudd_mgr.ReadCacheSlots()
+                                << " (max " << cudd_mgr.ReadMaxCacheHard()
+                                << "), cache growth hit rate " << cudd_mgr.ReadMinHit()
+                                << "%, loose up to " << cudd_mgr.ReadLooseUpTo()
+                                << " nodes, memory limit " << ((m_max_mem_mb > 0) ?
+                                to_string(max_mem / CUDD_BYTES_ONE_MB) + string(" MB") : string("none"))
+                                << END_LOG;
+                    }
+
+                private:
+
+                    /**
+                     * Allows to get the hard limit of the cache slots, the explicit one
+                     * and the one CUDD derives from the target memory, whichever is smaller
+                     * @return the hard limit of the cache slots, zero if not known
+                     */
+                    inline size_t get_max_cache_hard() const {
+                        size_t max_cache = m_max_cache;
+                        if (m_target_mem > 0) {
+                            const size_t mem_cache = m_target_mem / CUDD_CACHE_SLOT_BYTES / CUDD_CACHE_MEM_FRACTION;
+                            max_cache = (max_cache > 0) ? min(max_cache, mem_cache) : mem_cache;
+                        }
+                        return max_cache;
+                    }
+
+                    /**
+                     * Allows to get the largest power of two not exceeding the value
+                     * @param value the value to round down to the power of two
+                     * @return the power of two, at least one, at most 2^31
+                     */
+                    static inline uint32_t get_pow2_floor(const size_t value) {
+                        uint32_t result = 1;
+                        while ((result < (1u << 31)) && ((static_cast<size_t> (result) << 1) <= value)) {
+                            result <<= 1;
+                        }
+                        return result;
+                    }
+
+                    /**
+                     * Allows to get the power of two within the bounds
+                     * @param value the value to round up to the power of two
+                     * @param min_value the minimum value
+                     * @param max_value the maximum value
+                     * @return the power of two
+                     */
+                    static inline uint32_t get_pow2(const size_t value, const uint32_t min_value,
+                            const uint32_t max_value) {
+                        size_t result = 1;
+                        while ((result < value) && (result < max_value)) {
+                            result <<= 1;
+                        }
+                        return static_cast<uint32_t> (min(max(result, (size_t) min_value), (size_t) max_value));
+                    }
+
+                    /**
+                     * Allows to get the size of the physical memory
+                     * @return the size in bytes
+                     */
+                    static inline size_t get_phys_memory() {
+                        const long num_pages = sysconf(_SC_PHYS_PAGES);
+                        const long page_size = sysconf(_SC_PAGESIZE);
+                        return ((num_pages > 0) && (page_size > 0)) ?
+                                static_cast<size_t> (num_pages) * static_cast<size_t> (page_size) : 0;
+                    }
+
+                    /**
+                     * Allows to read the number of nodes and variables from the DDDMP file header
+                     * @param file_name the .bdd file name
+                     * @param num_nodes the number of nodes
+                     * @param num_vars the number of variables
+                     */
+                    static inline void read_bdd_header(const string & file_name,
+                            size_t & num_nodes, size_t & num_vars) {
+                        ifstream file(file_name);
+                        ASSERT_CONDITION_THROW(!file.is_open(), string("Could not open the controller file: ") + file_name);
+                        string line;
+                        while (getline(file, line) && (line != ".nodes")) {
+                            stringstream data(line);
+                            string key;
+                            data >> key;
+                            if (key == ".nnodes") {
+                                data >> num_nodes;
+                            } else if (key == ".nvars") {
+                                data >> num_vars;
+                            }
+                        }
+                    }
+                };
+            }
+        }
+    }
+}
+
+#endif /* CUDD_CONFIG_HPP */
@@ -0,0 +1,98 @@
+/* 
+ * File:   cudd_metrics.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 19, 2018, 09:42 AM
+ */
+
+#ifndef CUDD_METRICS_HPP
+#define CUDD_METRICS_HPP
+
+#include "cuddObj.hh"
+
+#include "monitor.hh"
+
+using namespace tud::utils::monitor;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                /**
+                 * This class registers the CUDD manager statistics with the metrics
+                 * registry for the time of its life. The counters are reported per
+                 * phase as increases and the node and memory levels as end values.
+                 * The number of BDD operations is the number of top-level operations
+                 * counted by the C++ wrapper of the CUDD manager. The recursive calls
+                 * are only counted by the CUDD built with DD_COUNT and are reported
+                 * additionally in that case.
+                 */
+                class cudd_metrics {
+                public:
+
+                    /**
+                     * The basic constructor
+                     * @param cudd_mgr the CUDD manager to read the statistics from, must outlive this object
+                     */
+                    cudd_metrics(const Cudd & cudd_mgr) : m_p_mgr(cudd_mgr.getManager()) {
+                        DdManager * const p_mgr = m_p_mgr;
+                        const Cudd * const p_cudd = &cudd_mgr;
+                        metrics_registry::add_probe(this, [p_mgr, p_cudd](metrics_snapshot & snapshot) {
+                            //The cumulative counters
+                            snapshot["cudd_cache_lookups"] = {Cudd_ReadCacheLookUps(p_mgr), true};
+                            snapshot["cudd_cache_hits"] = {Cudd_ReadCacheHits(p_mgr), true};
+                            snapshot["cudd_gc_count"] = {static_cast<double> (Cudd_ReadGarbageCollections(p_mgr)), true};
+                            snapshot["cudd_gc_time_ms"] = {static_cast<double> (Cudd_ReadGarbageCollectionTime(p_mgr)), true};
+                            snapshot["cudd_reorder_count"] = {static_cast<double> (Cudd_ReadReorderings(p_mgr)), true};
+                            snapshot["cudd_reorder_time_ms"] = {static_cast<double> (Cudd_ReadReorderingTime(p_mgr)), true};
+                            snapshot["cudd_bdd_ops"] = {static_cast<double> (p_cudd->ReadOperations()), true};
+                            const double num_calls = Cudd_ReadRecursiveCalls(p_mgr);
+                            if (num_calls >= 0) {
+                                snapshot["cudd_recursive_calls"] = {num_calls, true};
+                            }
+
+                            //The levels
+                            snapshot["cudd_live_nodes"] = {static_cast<double> (Cudd_ReadNodeCount(p_mgr)), false};
+                            snapshot["cudd_peak_nodes"] = {static_cast<double> (Cudd_ReadPeakNodeCount(p_mgr)), false};
+                            snapshot["cudd_peak_live_nodes"] = {static_cast<double> (Cudd_ReadPeakLiveNodeCount(p_mgr)), false};
+                            snapshot["cudd_dead_nodes"] = {static_cast<double> (Cudd_ReadDead(p_mgr)), false};
+                            snapshot["cudd_memory_bytes"] = {static_cast<double> (Cudd_ReadMemoryInUse(p_mgr)), false};
+                        });
+                    }
+
+                    /**
+                     * The basic destructor, un-registers the probe
+                     */
+                    virtual ~cudd_metrics() {
+                        metrics_registry::remove_probes(this);
+                    }
+
+                private:
+                    //Stores the pointer to the CUDD manager
+                    DdManager * const m_p_mgr;
+                };
+            }
+        }
+    }
+}
+
+#endif /* CUDD_METRICS_HPP */
@@ -0,0 +1,673 @@
+/*
+ * File:   dense_table.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 9, 2018, 11:12 AM
+ */
+
+#ifndef DENSE_TABLE_HPP
+#define DENSE_TABLE_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+
+#include "states_mgr.hh"
+#include "inputs_mgr.hh"
+#include "flat_bdd.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                /*
+                 * The dense table image layout, all the values are in the host byte order:
+                 *
+                 *     dense_table_header
+                 *     flat_bdd_dim x (ss_dim + is_dim)    the grid of each dimension
+                 *     uint64_t     x num_inputs           the input ids used by the controller, sorted
+                 *     uint64_t     x num_words            the cells, num_bits each, packed
+                 *
+                 * A cell stores the index of the state's input id in the input ids
+                 * section, or the all-ones value of num_bits for the states outside
+                 * of the controller's domain. The cells are indexed by the SCOTS
+                 * state id or by the Morton code of the state's dof ids. The Morton
+                 * code interleaves the dof id bits starting from the least significant
+                 * ones, the dimensions that run out of bits are skipped.
+                 */
+
+                //The dense table magic number, "DTB1"
+                static constexpr uint32_t DENSE_TABLE_MAGIC = 0x31425444u;
+                //The maximum number of bits per cell
+                static constexpr uint32_t DENSE_MAX_CELL_BITS = 32;
+                //The maximum number of index bits in the Morton order
+                static constexpr uint32_t DENSE_MAX_MORTON_BITS = 48;
+
+                /**
+                 * The enumeration storing the dense table cell orders
+                 */
+                enum dense_order_enum {
+                    order_sco = 0,
+                    order_morton = order_sco + 1,
+                    dense_order_enum_size = order_morton + 1
+                };
+
+                /**
+                 * The dense table image header
+                 */
+                struct dense_table_header {
+                    //The magic number
+                    uint32_t m_magic;
+                    //The number of state-space dimensions
+                    uint32_t m_ss_dim;
+                    //The number of input-space dimensions
+                    uint32_t m_is_dim;
+                    //The cell order
+                    uint32_t m_order;
+                    //The number of bits per cell
+                    uint32_t m_num_bits;
+                    //The padding to keep the following data aligned
+                    uint32_t m_unused;
+                    //The number of used input ids
+                    uint64_t m_num_inputs;
+                    //The number of cells
+                    uint64_t m_num_cells;
+                };
+
+                /**
+                 * This class represents the dense direct-indexed controller table. It has one
+                 * input per grid state, so a non-deterministic controller is resolved to the
+                 * smallest input id of each state. For the controllers whose domain covers most
+                 * of the grid the table is smaller than the BDD and a lookup is a single load.
+                 */
+                class dense_table {
+                public:
+
+                    /**
+                     * The building constructor
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD
+                     * @param ss_dim the number of state-space dimensions
+                     * @param order the cell order
+                     */
+                    dense_table(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set, const BDD & ctrl_bdd,
+                            const int32_t ss_dim, const dense_order_enum order)
+                    : m_image(), m_p_map(NULL), m_map_size(0), m_p_header(NULL),
+                    m_p_dims(NULL), m_p_inputs(NULL), m_p_cells(NULL), m_none(0) {
+                        build(cudd_mgr, ctrl_set, ctrl_bdd, ss_dim, order);
+                    }
+
+                    /**
+                     * The mapping constructor, the file is mapped read only and shared
+                     * @param file_name the dense table file name
+                     */
+                    dense_table(const string & file_name)
+                    : m_image(), m_p_map(NULL), m_map_size(0), m_p_header(NULL),
+                    m_p_dims(NULL), m_p_inputs(NULL), m_p_cells(NULL), m_none(0) {
+                        const int fd = open(file_name.c_str(), O_RDONLY);
+                        ASSERT_CONDITION_THROW((fd < 0), string("Could not open the dense table file: ") + file_name);
+                        struct stat file_stat = {};
+                        if ((fstat(fd, &file_stat) == 0) && (file_stat.st_size > 0)) {
+                            m_map_size = file_stat.st_size;
+                            m_p_map = mmap(NULL, m_map_size, PROT_READ, MAP_SHARED, fd, 0);
+                        }
+                        close(fd);
+                        if ((m_p_map == NULL) || (m_p_map == MAP_FAILED)) {
+                            m_p_map = NULL;
+                            THROW_EXCEPTION(string("Could not map the dense table file: ") + file_name);
+                        }
+                        try {
+                            set_pointers(static_cast<const char *> (m_p_map), m_map_size);
+                            validate();
+                        } catch (...) {
+                            munmap(m_p_map, m_map_size);
+                            m_p_map = NULL;
+                            throw;
+                        }
+                    }
+
+                    /**
+                     * The basic destructor
+                     */
+                    virtual ~dense_table() {
+                        if (m_p_map != NULL) {
+                            munmap(m_p_map, m_map_size);
+                            m_p_map = NULL;
+                        }
+                    }
+
+                    /**
+                     * Allows to store the dense table image into the file
+                     * @param file_name the dense table file name
+                     */
+                    void store(const string & file_name) const {
+                        ofstream file(file_name, ios::out | ios::binary | ios::trunc);
+                        ASSERT_CONDITION_THROW(!file.is_open(), string("Could not open the dense table file: ") + file_name);
+                        file.write(reinterpret_cast<const char *> (m_p_header), get_size());
+                        ASSERT_CONDITION_THROW(!file.good(), string("Could not write the dense table file: ") + file_name);
+                    }
+
+                    /**
+                     * Allows to check the consistency of the whole image, so that the lookups can
+                     * not run out of the image bounds. Is linear in the number of cells.
+                     * @throws tud_exception if the image is not consistent
+                     */
+                    void validate() const {
+                        const uint32_t ss_dim = m_p_header->m_ss_dim;
+                        const uint32_t is_dim = m_p_header->m_is_dim;
+                        ASSERT_CONDITION_THROW((ss_dim == 0) || (is_dim == 0) || (ss_dim > FLAT_MAX_DIM) ||
+                                (is_dim > FLAT_MAX_DIM) || (m_p_header->m_num_inputs > m_none),
+                                "The dense table image has bad dimensions or too many inputs!");
+                        uint64_t num_inputs = 1;
+                        for (uint32_t dof = 0; dof < ss_dim + is_dim; ++dof) {
+                            const flat_bdd_dim & dim = m_p_dims[dof];
+                            const uint64_t nn = ((dof == 0) || (dof == ss_dim)) ? 1 :
+                                    m_p_dims[dof - 1].m_nn * m_p_dims[dof - 1].m_num_points;
+                            ASSERT_CONDITION_THROW(!(dim.m_eta > 0) || (dim.m_num_points == 0) || (dim.m_nn != nn) ||
+                                    (dim.m_num_points > numeric_limits<abs_type>::max()),
+                                    string("The dense table image has a bad dimension: ") + to_string(dof));
+                            if (dof >= ss_dim) {
+                                num_inputs *= dim.m_num_points;
+                            }
+                        }
+
+                        //The cells must cover the grid exactly as the cell index is computed
+                        vector<abs_type> num_points;
+                        uint64_t num_states = 1;
+                        for (uint32_t dof = 0; dof < ss_dim; ++dof) {
+                            ASSERT_CONDITION_THROW((m_p_dims[dof].m_num_points > m_p_header->m_num_cells / num_states),
+                                    "The dense table image has more states than cells!");
+                            num_states *= m_p_dims[dof].m_num_points;
+                            num_points.push_back(static_cast<abs_type> (m_p_dims[dof].m_num_points));
+                        }
+                        const dense_order_enum order = static_cast<dense_order_enum> (m_p_header->m_order);
+                        ASSERT_CONDITION_THROW((get_num_cells(num_points, order) != m_p_header->m_num_cells) ||
+                                (get_num_bits(m_p_header->m_num_inputs) != m_p_header->m_num_bits),
+                                "The dense table image cells do not match its dimensions!");
+
+                        //The input ids must be on the grid and the cells must refer to them
+                        for (uint64_t idx = 0; idx < m_p_header->m_num_inputs; ++idx) {
+                            ASSERT_CONDITION_THROW((m_p_inputs[idx] >= num_inputs),
+                                    string("The dense table image has a bad input id: ") + to_string(idx));
+                        }
+                        for (uint64_t idx = 0; idx < m_p_header->m_num_cells; ++idx) {
+                            const uint64_t value = get_cell(idx);
+                            ASSERT_CONDITION_THROW((value != m_none) && (value >= m_p_header->m_num_inputs),
+                                    string("The dense table image has a bad cell: ") + to_string(idx));
+                        }
+                    }
+
+                    /**
+                     * Allows to get the input of the state, thread safe
+                     * @param state the state-space point, of the state-space dimensionality
+                     * @param input_id the input id to be set
+                     * @return true if the state is in the controller's domain, otherwise false
+                     */
+                    inline bool lookup(const double * state, abs_type & input_id) const {
+                        const uint32_t ss_dim = m_p_header->m_ss_dim;
+                        abs_type ss_dofs[FLAT_MAX_DIM];
+                        for (uint32_t dof = 0; dof < ss_dim; ++dof) {
+                            const flat_bdd_dim & dim = m_p_dims[dof];
+                            ss_dofs[dof] = static_cast<abs_type> (state[dof] * dim.m_eta_inv - dim.m_x2a_sh);
+                            if (ss_dofs[dof] >= dim.m_num_points) {
+                                return false;
+                            }
+                        }
+                        return lookup_dofs(ss_dofs, input_id);
+                    }
+
+                    /**
+                     * Allows to get the input of the state, thread safe
+                     * @param ss_dofs the state-space dof ids, within the grid
+                     * @param input_id the input id to be set
+                     * @return true if the state is in the controller's domain, otherwise false
+                     */
+                    inline bool lookup_dofs(const abs_type * ss_dofs, abs_type & input_id) const {
+                        const uint64_t value = get_cell(get_cell_idx(ss_dofs));
+                        if (value == m_none) {
+                            return false;
+                        }
+                        input_id = m_p_inputs[value];
+                        return true;
+                    }
+
+                    /**
+                     * Allows to convert the input id into the input-space point, thread safe
+                     * @param id the input id
+                     * @param input the array to store the input-space point, of the input-space dimensionality
+                     */
+                    inline void itox_input(abs_type id, double * input) const {
+                        const flat_bdd_dim * is_dims = m_p_dims + m_p_header->m_ss_dim;
+                        for (int32_t dof = m_p_header->m_is_dim - 1; dof >= 0; --dof) {
+                            const abs_type num = id / is_dims[dof].m_nn;
+                            id = id % is_dims[dof].m_nn;
+                            input[dof] = is_dims[dof].m_first + num * is_dims[dof].m_eta;
+                        }
+                    }
+
+                    /**
+                     * Allows to compare the table with the controller on every grid state
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD
+                     * @return the number of states with an input not allowed by the controller,
+                     *         or with the domain membership different from the controller's one
+                     */
+                    size_t verify(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set, const BDD & ctrl_bdd) const {
+                        const uint32_t ss_dim = m_p_header->m_ss_dim;
+                        vector<pair<abs_type, abs_type>> pairs;
+                        get_pairs(cudd_mgr, ctrl_set, ctrl_bdd, ss_dim, pairs);
+                        sort(pairs.begin(), pairs.end());
+
+                        //Iterate over all the grid states in the SCOTS id order
+                        size_t num_mismatches = 0;
+                        vector<abs_type> ss_dofs(ss_dim, 0);
+                        const abs_type num_states = get_num_states();
+                        for (abs_type ss_id = 0; ss_id < num_states; ++ss_id) {
+                            abs_type input_id = 0;
+                            const bool is_dom = lookup_dofs(ss_dofs.data(), input_id);
+                            auto iter = lower_bound(pairs.begin(), pairs.end(), make_pair(ss_id, (abs_type) 0));
+                            const bool is_ctrl_dom = (iter != pairs.end()) && (iter->first == ss_id);
+                            if ((is_dom != is_ctrl_dom) || (is_dom &&
+                                    !binary_search(pairs.begin(), pairs.end(), make_pair(ss_id, input_id)))) {
+                                ++num_mismatches;
+                            }
+                            //Move to the next state
+                            for (uint32_t dof = 0; dof < ss_dim; ++dof) {
+                                if (++ss_dofs[dof] < m_p_dims[dof].m_num_points) break;
+                                ss_dofs[dof] = 0;
+                            }
+                        }
+                        return num_mismatches;
+                    }
+
+                    /**
+                     * Allows to estimate the dense table size without building it, the number
+                     * of used inputs is bounded by the number of input-space grid points
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ss_dim the number of state-space dimensions
+                     * @param order the cell order
+                     * @return the estimated image size in bytes
+                     */
+                    static inline size_t estimate_size(const SymbolicSet & ctrl_set,
+                            const int32_t ss_dim, const dense_order_enum order) {
+                        const vector<abs_type> num_points = ctrl_set.get_no_gp_per_dim();
+                        uint64_t num_inputs = 1;
+                        for (int32_t dof = ss_dim; dof < ctrl_set.get_dim(); ++dof) {
+                            num_inputs *= num_points[dof];
+                        }
+                        dense_table_header header = {DENSE_TABLE_MAGIC, (uint32_t) ss_dim,
+                            (uint32_t) (ctrl_set.get_dim() - ss_dim), (uint32_t) order, get_num_bits(num_inputs), 0,
+                            num_inputs, get_num_cells(vector<abs_type>(num_points.begin(), num_points.begin() + ss_dim), order)};
+                        return get_size(header);
+                    }
+
+                    /**
+                     * Allows to estimate the flat BDD size of the controller, to compare the table with
+                     * @param ctrl_bdd the controller's BDD
+                     * @return the estimated flat BDD image size in bytes
+                     */
+                    static inline size_t estimate_bdd_size(const BDD & ctrl_bdd) {
+                        return (ctrl_bdd.nodeCount() + 1) * sizeof (flat_bdd_node);
+                    }
+
+                    /**
+                     * Allows to get the number of grid states
+                     * @return the number of grid states
+                     */
+                    inline abs_type get_num_states() const {
+                        abs_type num_states = 1;
+                        for (uint32_t dof = 0; dof < m_p_header->m_ss_dim; ++dof) {
+                            num_states *= m_p_dims[dof].m_num_points;
+                        }
+                        return num_states;
+                    }
+
+                    /**
+                     * Allows to get the number of used input ids
+                     * @return the number of used input ids
+                     */
+                    inline size_t get_num_inputs() const {
+                        return m_p_header->m_num_inputs;
+                    }
+
+                    /**
+                     * Allows to get the number of cells, in the Morton order more than the grid states
+                     * @return the number of cells
+                     */
+                    inline size_t get_num_cells() const {
+                        return m_p_header->m_num_cells;
+                    }
+
+                    /**
+                     * Allows to get the number of bits per cell
+                     * @return the number of bits per cell
+                     */
+                    inline uint32_t get_num_bits() const {
+                        return m_p_header->m_num_bits;
+                    }
+
+                    /**
+                     * Allows to get the number of state-space dimensions
+                     * @return the number of state-space dimensions
+                     */
+                    inline int32_t get_ss_dim() const {
+                        return m_p_header->m_ss_dim;
+                    }
+
+                    /**
+                     * Allows to get the number of input-space dimensions
+                     * @return the number of input-space dimensions
+                     */
+                    inline int32_t get_is_dim() const {
+                        return m_p_header->m_is_dim;
+                    }
+
+                    /**
+                     * Allows to get the image size
+                     * @return the image size in bytes
+                     */
+                    inline size_t get_size() const {
+                        return get_size(*m_p_header);
+                    }
+
+                    /**
+                     * Allows to get the controller's state-input id pairs
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD
+                     * @param ss_dim the number of state-space dimensions
+                     * @param pairs the vector to store the state and input id pairs
+                     */
+                    static inline void get_pairs(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set, const BDD & ctrl_bdd,
+                            const int32_t ss_dim, vector<pair<abs_type, abs_type>> & pairs) {
+                        unique_ptr<SymbolicSet> p_ss_set(states_mgr::get_states_set(ctrl_set, ss_dim));
+                        unique_ptr<SymbolicSet> p_is_set(inputs_mgr::get_inputs_set(ctrl_set, ss_dim));
+                        const int32_t c_dim = ctrl_set.get_dim();
+
+                        abs_type num_pairs = 0;
+                        abs_type * p_dofs = ctrl_set.bdd_to_grid_point_ids(cudd_mgr, ctrl_bdd, num_pairs);
+                        pairs.resize(num_pairs);
+                        for (abs_type idx = 0; idx < num_pairs; ++idx) {
+                            p_ss_set->istoi(&p_dofs[idx * c_dim], pairs[idx].first);
+                            p_is_set->istoi(&p_dofs[idx * c_dim + ss_dim], pairs[idx].second);
+                        }
+                        delete[] p_dofs;
+                    }
+
+                private:
+                    //Stores the built image, if not mapped
+                    vector<uint64_t> m_image;
+                    //Stores the mapped image, if mapped
+                    void * m_p_map;
+                    //Stores the mapped image size
+                    size_t m_map_size;
+                    //Stores the image header
+                    const dense_table_header * m_p_header;
+                    //Stores the image dimensions
+                    const flat_bdd_dim * m_p_dims;
+                    //Stores the image input ids
+                    const uint64_t * m_p_inputs;
+                    //Stores the image cells
+                    const uint64_t * m_p_cells;
+                    //Stores the cell value of the states outside of the domain
+                    uint64_t m_none;
+
+                    /**
+                     * Allows to get the number of bits per cell
+                     * @param num_inputs the number of used input ids
+                     * @return the number of bits per cell, the all-ones value is reserved
+                     */
+                    static inline uint32_t get_num_bits(const uint64_t num_inputs) {
+                        uint32_t num_bits = 1;
+                        while ((((uint64_t) 1) << num_bits) - 1 < num_inputs) {
+                            ++num_bits;
+                        }
+                        return num_bits;
+                    }
+
+                    /**
+                     * Allows to get the number of Morton index bits per state-space dimension
+                     * @param num_points the number of grid points per state-space dimension
+                     * @param dof the dimension
+                     * @return the number of bits to represent the dof ids
+                     */
+                    static inline uint32_t get_dof_bits(const vector<abs_type> & num_points, const size_t dof) {
+                        uint32_t num_bits = 0;
+                        while ((((uint64_t) 1) << num_bits) < num_points[dof]) {
+                            ++num_bits;
+                        }
+                        return num_bits;
+                    }
+
+                    /**
+                     * Allows to get the number of cells
+                     * @param num_points the number of grid points per state-space dimension
+                     * @param order the cell order
+                     * @return the number of cells
+                     */
+                    static inline uint64_t get_num_cells(const vector<abs_type> & num_points, const dense_order_enum order) {
+                        uint64_t num_cells = 1;
+                        if (order == dense_order_enum::order_morton) {
+                            uint32_t num_bits = 0;
+                            for (size_t dof = 0; dof < num_points.size(); ++dof) {
+                                num_bits += get_dof_bits(num_points, dof);
+                            }
+                            ASSERT_CONDITION_THROW((num_bits > DENSE_MAX_MORTON_BITS),
+                                    string("Too many Morton index bits: ") + to_string(num_bits));
+                            num_cells <<= num_bits;
+                        } else {
+                            for (const auto num : num_points) {
+                                num_cells *= num;
+                            }
+                        }
+                        return num_cells;
+                    }
+
+                    /**
+                     * Allows to compute the image size
+                     * @param header the image header
+                     * @return the image size in bytes
+                     */
+                    static inline size_t get_size(const dense_table_header & header) {
+                        return sizeof (dense_table_header)
+                                + (header.m_ss_dim + header.m_is_dim) * sizeof (flat_bdd_dim)
+                                + header.m_num_inputs * sizeof (uint64_t)
+                                + get_num_words(header) * sizeof (uint64_t);
+                    }
+
+                    /**
+                     * Allows to compute the number of cell words
+                     * @param header the image header
+                     * @return the number of cell words
+                     */
+                    static inline size_t get_num_words(const dense_table_header & header) {
+                        return (header.m_num_cells * header.m_num_bits + 63) / 64;
+                    }
+
+                    /**
+                     * Allows to get the cell index of the state
+                     * @param ss_dofs the state-space dof ids, within the grid
+                     * @return the cell index
+                     */
+                    inline uint64_t get_cell_idx(const abs_type * ss_dofs) const {
+                        const uint32_t ss_dim = m_p_header->m_ss_dim;
+                        uint64_t idx = 0;
+                        if (m_p_header->m_order == dense_order_enum::order_morton) {
+                            uint32_t pos = 0;
+                            for (uint32_t bit = 0; bit < DENSE_MAX_MORTON_BITS; ++bit) {
+                                bool is_more = false;
+                                for (uint32_t dof = 0; dof < ss_dim; ++dof) {
+                                    if ((((uint64_t) 1) << bit) < m_p_dims[dof].m_num_points) {
+                                        idx |= ((ss_dofs[dof] >> bit) & 1) << pos;
+                                        ++pos;
+                                        is_more = true;
+                                    }
+                                }
+                                if (!is_more) break;
+                            }
+                        } else {
+                            for (uint32_t dof = 0; dof < ss_dim; ++dof) {
+                                idx += ss_dofs[dof] * m_p_dims[dof].m_nn;
+                            }
+                        }
+                        return idx;
+                    }
+
+                    /**
+                     * Allows to get the cell value
+                     * @param idx the cell index
+                     * @return the cell value
+                     */
+                    inline uint64_t get_cell(const uint64_t idx) const {
+                        const uint32_t num_bits = m_p_header->m_num_bits;
+                        const uint64_t bit = idx * num_bits;
+                        const uint64_t word = bit >> 6;
+                        const uint32_t shift = bit & 63;
+                        uint64_t value = m_p_cells[word] >> shift;
+                        if (shift + num_bits > 64) {
+                            value |= m_p_cells[word + 1] << (64 - shift);
+                        }
+                        return value & m_none;
+                    }
+
+                    /**
+                     * Allows to check the image and to set the section pointers
+                     * @param p_data the image data
+                     * @param size the image size in bytes
+                     */
+                    void set_pointers(const void * p_data, const size_t size) {
+                        ASSERT_CONDITION_THROW((size < sizeof (dense_table_header)), "The dense table image is truncated!");
+                        m_p_header = static_cast<const dense_table_header *> (p_data);
+                        ASSERT_CONDITION_THROW((m_p_header->m_magic != DENSE_TABLE_MAGIC),
+                                "The dense table image has a wrong magic number!");
+                        ASSERT_CONDITION_THROW((m_p_header->m_num_bits == 0) ||
+                                (m_p_header->m_num_bits > DENSE_MAX_CELL_BITS) ||
+                                (m_p_header->m_order >= dense_order_enum::dense_order_enum_size) ||
+                                (size != get_size(*m_p_header)), "The dense table image is corrupted!");
+                        m_p_dims = reinterpret_cast<const flat_bdd_dim *> (m_p_header + 1);
+                        m_p_inputs = reinterpret_cast<const uint64_t *> (m_p_dims + m_p_header->m_ss_dim + m_p_header->m_is_dim);
+                        m_p_cells = m_p_inputs + m_p_header->m_num_inputs;
+                        m_none = (((uint64_t) 1) << m_p_header->m_num_bits) - 1;
+                    }
+
+                    /**
+                     * Allows to build the table image
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD
+                     * @param ss_dim the number of state-space dimensions
+                     * @param order the cell order
+                     */
+                    void build(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set, const BDD & ctrl_bdd,
+                            const int32_t ss_dim, const dense_order_enum order) {
+                        const int32_t is_dim = ctrl_set.get_dim() - ss_dim;
+                        ASSERT_CONDITION_THROW((ss_dim <= 0) || (is_dim <= 0),
+                                string("Improper state-space dimensionality: ") + to_string(ss_dim));
+
+                        //Get the smallest input id per state
+                        vector<pair<abs_type, abs_type>> pairs;
+                        get_pairs(cudd_mgr, ctrl_set, ctrl_bdd, ss_dim, pairs);
+                        sort(pairs.begin(), pairs.end());
+                        pairs.erase(unique(pairs.begin(), pairs.end(), [] (const pair<abs_type, abs_type> & first,
+                                const pair<abs_type, abs_type> & second) {
+                            return first.first == second.first; }), pairs.end());
+
+                        //Collect the used input ids
+                        vector<uint64_t> inputs;
+                        for (const auto & elem : pairs) {
+                            inputs.push_back(elem.second);
+                        }
+                        sort(inputs.begin(), inputs.end());
+                        inputs.erase(unique(inputs.begin(), inputs.end()), inputs.end());
+
+                        //Create the image with all the cells outside of the domain
+                        vector<flat_bdd_dim> dims;
+                        get_flat_dims(ctrl_set, ss_dim, dims);
+                        const vector<abs_type> num_points = ctrl_set.get_no_gp_per_dim();
+                        dense_table_header header = {DENSE_TABLE_MAGIC, (uint32_t) ss_dim, (uint32_t) is_dim,
+                            (uint32_t) order, get_num_bits(inputs.size()), 0, inputs.size(),
+                            get_num_cells(vector<abs_type>(num_points.begin(), num_points.begin() + ss_dim), order)};
+                        ASSERT_CONDITION_THROW((header.m_num_bits > DENSE_MAX_CELL_BITS),
+                                string("Too many controller inputs: ") + to_string(inputs.size()));
+                        m_image.assign(get_size(header) / sizeof (uint64_t), 0);
+                        char * p_data = reinterpret_cast<char *> (m_image.data());
+                        memcpy(p_data, &header, sizeof (header));
+                        memcpy(p_data + sizeof (header), dims.data(), dims.size() * sizeof (flat_bdd_dim));
+                        uint64_t * p_inputs = reinterpret_cast<uint64_t *> (p_data + sizeof (header)
+                                + dims.size() * sizeof (flat_bdd_dim));
+                        copy(inputs.begin(), inputs.end(), p_inputs);
+                        uint64_t * p_cells = p_inputs + inputs.size();
+                        fill(p_cells, p_cells + get_num_words(header), ~((uint64_t) 0));
+                        set_pointers(p_data, m_image.size() * sizeof (uint64_t));
+
+                        //Set the domain cells
+                        vector<abs_type> ss_dofs(ss_dim);
+                        for (const auto & elem : pairs) {
+                            for (int32_t dof = 0; dof < ss_dim; ++dof) {
+                                ss_dofs[dof] = (elem.first / dims[dof].m_nn) % dims[dof].m_num_points;
+                            }
+                            const uint64_t value = lower_bound(inputs.begin(), inputs.end(), elem.second) - inputs.begin();
+                            const uint64_t bit = get_cell_idx(ss_dofs.data()) * header.m_num_bits;
+                            const uint64_t word = bit >> 6;
+                            const uint32_t shift = bit & 63;
+                            p_cells[word] &= ~(m_none << shift);
+                            p_cells[word] |= value << shift;
+                            if (shift + header.m_num_bits > 64) {
+                                p_cells[word + 1] &= ~(m_none >> (64 - shift));
+                                p_cells[word + 1] |= value >> (64 - shift);
+                            }
+                        }
+
+                        LOG_INFO << "Built the dense table of " << header.m_num_cells << " cells with "
+                                << pairs.size() << " domain states, " << inputs.size() << " inputs and "
+                                << header.m_num_bits << " bits per cell, " << get_size() << " bytes" << END_LOG;
+                    }
+                };
+            }
+        }
+    }
+}
+
+#endif /* DENSE_TABLE_HPP */
@@ -29,6 +29,8 @@
 #include <string>
 #include <vector>
 
+#include "cudd_config.hh"
+
 using namespace std;
 
 namespace tud {
@@ -76,6 +78,48 @@ namespace tud {
                     //True if we are requested to perform linear
                     //function compression on BDD indexes
                     bool m_is_bdd_lin;
+                    //True if we are requested to store the dense
+                    //lookup table in the SCOTS state id order
+                    bool m_is_dense_sco;
+                    //True if we are requested to store the dense
+                    //lookup table in the Morton order
+                    bool m_is_dense_morton;
+                    //True if we are requested to store the
+                    //ADD with the input ids as terminals
+                    bool m_is_mtbdd;
+                    //True if we are requested to minimize the controller
+                    //using the states outside of its domain as don't cares
+                    bool m_is_dont_care;
+                    //True if we are requested to store the
+                    //under-approximated controller
+                    bool m_is_approx;
+                    //The maximum fraction of the domain states
+                    //the under-approximated controller may lose
+                    double m_max_loss;
+                    //True if we are requested to store the cover of
+                    //the domain by the same input hyper-rectangles
+                    bool m_is_rect;
+                    //True if we are requested to verify the
+                    //compressed controllers after storing them
+                    bool m_is_verify;
+                    //True if we are requested to store the
+                    //per phase CUDD metrics as JSON
+                    bool m_is_metrics;
+                    //True if we are requested to store the wall-clock
+                    //timeline of the phases as Chrome trace JSON
+                    bool m_is_trace;
+                    //The determinization memory budget in MB for the
+                    //streaming determinization, 0 if not streaming
+                    uint32_t m_stream_mem;
+                    //True if we are requested to re-determinize
+                    //incrementally from the previous controllers
+                    bool m_is_incr;
+                    //Stores the previous source controller file name
+                    string m_prev_source_file;
+                    //Stores the previous determinized controller file name
+                    string m_prev_det_file;
+                    //The CUDD manager configuration
+                    cudd_config m_cudd;
                     //Defines the determinization algorithm to be used
                     det_alg_enum m_det_alg_type;
 
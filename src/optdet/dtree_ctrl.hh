@@ -0,0 +1,662 @@
+/*
+ * File:   dtree_ctrl.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 16, 2018, 14:52 PM
+ */
+
+#ifndef DTREE_CTRL_HPP
+#define DTREE_CTRL_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "thread_pool.hh"
+
+#include "flat_bdd.hh"
+#include "dense_table.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+using namespace tud::utils::threads;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                /*
+                 * The decision tree image layout, all the values are in the host byte order:
+                 *
+                 *     dtree_header
+                 *     flat_bdd_dim x (ss_dim + is_dim)    the grid of each dimension
+                 *     uint64_t     x num_inputs           the input ids used by the tree
+                 *     dtree_node   x num_nodes            the nodes in the pre-order, padded to 8 bytes
+                 *
+                 * An inner node sends the states with the dof id of its dimension below its
+                 * threshold to the left child, which is the next node, and the others to its
+                 * right child. On the real coordinates this is the split at the grid cell
+                 * border, first + (threshold - 0.5) * eta. A leaf stores the index of its
+                 * input id in the input ids section, or DTREE_NONE for the states outside
+                 * of the controller's domain.
+                 */
+
+                //The decision tree magic number, "DTR1"
+                static constexpr uint32_t DTREE_MAGIC = 0x31525444u;
+                //The dimension value of the leaf nodes
+                static constexpr uint32_t DTREE_LEAF = UINT32_MAX;
+                //The leaf value of the states outside of the domain
+                static constexpr uint32_t DTREE_NONE = UINT32_MAX;
+
+                /**
+                 * The decision tree image header
+                 */
+                struct dtree_header {
+                    //The magic number
+                    uint32_t m_magic;
+                    //The number of state-space dimensions
+                    uint32_t m_ss_dim;
+                    //The number of input-space dimensions
+                    uint32_t m_is_dim;
+                    //The tree depth
+                    uint32_t m_depth;
+                    //The number of used input ids
+                    uint64_t m_num_inputs;
+                    //The number of nodes
+                    uint64_t m_num_nodes;
+                };
+
+                /**
+                 * The decision tree node
+                 */
+                struct dtree_node {
+                    //The split dimension, or DTREE_LEAF
+                    uint32_t m_dof;
+                    //The split threshold dof id, or the leaf input index
+                    uint32_t m_value;
+                    //The right child index, unused for the leaves
+                    uint32_t m_right;
+                };
+
+                /**
+                 * This class represents the controller as an axis-aligned decision tree learned
+                 * exactly from the controller's table of states and allowed inputs, the states
+                 * outside of the domain included. A leaf may take any input allowed in all of
+                 * its states, so the tree also determinizes the controller. The tree is grown
+                 * level by level: the splits of all the level's nodes are searched in parallel,
+                 * per node and dimension, by sorting the node's states and sweeping the thresholds.
+                 */
+                class dtree_ctrl {
+                public:
+
+                    /**
+                     * The learning constructor
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD
+                     * @param ss_dim the number of state-space dimensions
+                     * @param workers the thread pool to learn the tree with
+                     */
+                    dtree_ctrl(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set, const BDD & ctrl_bdd,
+                            const int32_t ss_dim, thread_pool & workers)
+                    : m_image(), m_p_map(NULL), m_map_size(0), m_p_header(NULL),
+                    m_p_dims(NULL), m_p_inputs(NULL), m_p_nodes(NULL) {
+                        build(cudd_mgr, ctrl_set, ctrl_bdd, ss_dim, workers);
+                    }
+
+                    /**
+                     * The mapping constructor, the file is mapped read only and shared
+                     * @param file_name the decision tree file name
+                     */
+                    dtree_ctrl(const string & file_name)
+                    : m_image(), m_p_map(NULL), m_map_size(0), m_p_header(NULL),
+                    m_p_dims(NULL), m_p_inputs(NULL), m_p_nodes(NULL) {
+                        const int fd = open(file_name.c_str(), O_RDONLY);
+                        ASSERT_CONDITION_THROW((fd < 0), string("Could not open the decision tree file: ") + file_name);
+                        struct stat file_stat = {};
+                        if ((fstat(fd, &file_stat) == 0) && (file_stat.st_size > 0)) {
+                            m_map_size = file_stat.st_size;
+                            m_p_map = mmap(NULL, m_map_size, PROT_READ, MAP_SHARED, fd, 0);
+                        }
+                        close(fd);
+                        if ((m_p_map == NULL) || (m_p_map == MAP_FAILED)) {
+                            m_p_map = NULL;
+                            THROW_EXCEPTION(string("Could not map the decision tree file: ") + file_name);
+                        }
+                        set_pointers(static_cast<const char *> (m_p_map), m_map_size);
+                    }
+
+                    /**
+                     * The basic destructor
+                     */
+                    virtual ~dtree_ctrl() {
+                        if (m_p_map != NULL) {
+                            munmap(m_p_map, m_map_size);
+                            m_p_map = NULL;
+                        }
+                    }
+
+                    /**
+                     * Allows to store the decision tree image into the file
+                     * @param file_name the decision tree file name
+                     */
+                    void store(const string & file_name) const {
+                        ofstream file(file_name, ios::out | ios::binary | ios::trunc);
+                        ASSERT_CONDITION_THROW(!file.is_open(), string("Could not open the decision tree file: ") + file_name);
+                        file.write(reinterpret_cast<const char *> (m_p_header), get_size());
+                        ASSERT_CONDITION_THROW(!file.good(), string("Could not write the decision tree file: ") + file_name);
+                    }
+
+                    /**
+                     * Allows to get the input of the state, thread safe
+                     * @param state the state-space point, of the state-space dimensionality
+                     * @param input_id the input id to be set
+                     * @return true if the state is in the controller's domain, otherwise false
+                     */
+                    inline bool lookup(const double * state, abs_type & input_id) const {
+                        const uint32_t ss_dim = m_p_header->m_ss_dim;
+                        abs_type ss_dofs[FLAT_MAX_DIM];
+                        for (uint32_t dof = 0; dof < ss_dim; ++dof) {
+                            const flat_bdd_dim & dim = m_p_dims[dof];
+                            ss_dofs[dof] = static_cast<abs_type> (state[dof] * dim.m_eta_inv - dim.m_x2a_sh);
+                            if (ss_dofs[dof] >= dim.m_num_points) {
+                                return false;
+                            }
+                        }
+                        return lookup_dofs(ss_dofs, input_id);
+                    }
+
+                    /**
+                     * Allows to get the input of the state, thread safe
+                     * @param ss_dofs the state-space dof ids, within the grid
+                     * @param input_id the input id to be set
+                     * @return true if the state is in the controller's domain, otherwise false
+                     */
+                    inline bool lookup_dofs(const abs_type * ss_dofs, abs_type & input_id) const {
+                        uint32_t idx = 0;
+                        while (m_p_nodes[idx].m_dof != DTREE_LEAF) {
+                            const dtree_node & node = m_p_nodes[idx];
+                            idx = (ss_dofs[node.m_dof] < node.m_value) ? idx + 1 : node.m_right;
+                        }
+                        if (m_p_nodes[idx].m_value == DTREE_NONE) {
+                            return false;
+                        }
+                        input_id = m_p_inputs[m_p_nodes[idx].m_value];
+                        return true;
+                    }
+
+                    /**
+                     * Allows to compare the tree with the controller on every grid state
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD
+                     * @return the number of states with an input not allowed by the controller,
+                     *         or with the domain membership different from the controller's one
+                     */
+                    size_t verify(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set, const BDD & ctrl_bdd) const {
+                        const uint32_t ss_dim = m_p_header->m_ss_dim;
+                        vector<pair<abs_type, abs_type>> pairs;
+                        dense_table::get_pairs(cudd_mgr, ctrl_set, ctrl_bdd, ss_dim, pairs);
+                        sort(pairs.begin(), pairs.end());
+
+                        //Iterate over all the grid states in the SCOTS id order
+                        size_t num_mismatches = 0;
+                        vector<abs_type> ss_dofs(ss_dim, 0);
+                        const abs_type num_states = get_num_states();
+                        for (abs_type ss_id = 0; ss_id < num_states; ++ss_id) {
+                            abs_type input_id = 0;
+                            const bool is_dom = lookup_dofs(ss_dofs.data(), input_id);
+                            auto iter = lower_bound(pairs.begin(), pairs.end(), make_pair(ss_id, (abs_type) 0));
+                            const bool is_ctrl_dom = (iter != pairs.end()) && (iter->first == ss_id);
+                            if ((is_dom != is_ctrl_dom) || (is_dom &&
+                                    !binary_search(pairs.begin(), pairs.end(), make_pair(ss_id, input_id)))) {
+                                ++num_mismatches;
+                            }
+                            //Move to the next state
+                            for (uint32_t dof = 0; dof < ss_dim; ++dof) {
+                                if (++ss_dofs[dof] < m_p_dims[dof].m_num_points) break;
+                                ss_dofs[dof] = 0;
+                            }
+                        }
+                        return num_mismatches;
+                    }
+
+                    /**
+                     * Allows to get the number of grid states
+                     * @return the number of grid states
+                     */
+                    inline abs_type get_num_states() const {
+                        abs_type num_states = 1;
+                        for (uint32_t dof = 0; dof < m_p_header->m_ss_dim; ++dof) {
+                            num_states *= m_p_dims[dof].m_num_points;
+                        }
+                        return num_states;
+                    }
+
+                    /**
+                     * Allows to get the number of nodes
+                     * @return the number of nodes
+                     */
+                    inline size_t get_num_nodes() const {
+                        return m_p_header->m_num_nodes;
+                    }
+
+                    /**
+                     * Allows to get the tree depth
+                     * @return the tree depth, zero for a single leaf
+                     */
+                    inline uint32_t get_depth() const {
+                        return m_p_header->m_depth;
+                    }
+
+                    /**
+                     * Allows to get the number of used input ids
+                     * @return the number of used input ids
+                     */
+                    inline size_t get_num_inputs() const {
+                        return m_p_header->m_num_inputs;
+                    }
+
+                    /**
+                     * Allows to get the image size
+                     * @return the image size in bytes
+                     */
+                    inline size_t get_size() const {
+                        return get_size(*m_p_header);
+                    }
+
+                private:
+                    //Stores the built image, if not mapped
+                    vector<uint64_t> m_image;
+                    //Stores the mapped image, if mapped
+                    void * m_p_map;
+                    //Stores the mapped image size
+                    size_t m_map_size;
+                    //Stores the image header
+                    const dtree_header * m_p_header;
+                    //Stores the image dimensions
+                    const flat_bdd_dim * m_p_dims;
+                    //Stores the image input ids
+                    const uint64_t * m_p_inputs;
+                    //Stores the image nodes
+                    const dtree_node * m_p_nodes;
+
+                    /**
+                     * The learning data: the states with their allowed input indexes
+                     */
+                    struct dtree_samples {
+                        //The number of state-space dimensions
+                        uint32_t m_ss_dim;
+                        //The number of labels, the input indexes and the none label
+                        uint32_t m_num_labels;
+                        //The dof ids of each state
+                        vector<uint32_t> m_dofs;
+                        //The first label of each state, and the end of the labels
+                        vector<size_t> m_begin;
+                        //The labels of the states
+                        vector<uint32_t> m_labels;
+                    };
+
+                    /**
+                     * The tree node being learned, it owns a range of the state indexes
+                     */
+                    struct dtree_build_node {
+                        //The split dimension, or DTREE_LEAF
+                        uint32_t m_dof;
+                        //The split threshold dof id, or the leaf label
+                        uint32_t m_value;
+                        //The first state index
+                        size_t m_begin;
+                        //The end state index
+                        size_t m_end;
+                        //The left child, if not a leaf
+                        size_t m_left;
+                        //The right child, if not a leaf
+                        size_t m_right;
+                    };
+
+                    /**
+                     * The best split of a node along a dimension
+                     */
+                    struct dtree_split {
+                        //The number of states not having the most frequent label of their side
+                        size_t m_score;
+                        //The distance of the split from the middle of the node
+                        size_t m_balance;
+                        //The split threshold dof id
+                        uint32_t m_threshold;
+                        //True if there is a split
+                        bool m_is_valid;
+                    };
+
+                    /**
+                     * Allows to compute the image size
+                     * @param header the image header
+                     * @return the image size in bytes
+                     */
+                    static inline size_t get_size(const dtree_header & header) {
+                        return sizeof (dtree_header)
+                                + (header.m_ss_dim + header.m_is_dim) * sizeof (flat_bdd_dim)
+                                + header.m_num_inputs * sizeof (uint64_t)
+                                + ((header.m_num_nodes * sizeof (dtree_node) + 7) / 8) * 8;
+                    }
+
+                    /**
+                     * Allows to check the image and to set the section pointers
+                     * @param p_data the image data
+                     * @param size the image size in bytes
+                     */
+                    void set_pointers(const char * p_data, const size_t size) {
+                        ASSERT_CONDITION_THROW((size < sizeof (dtree_header)), "The decision tree image is truncated!");
+                        m_p_header = reinterpret_cast<const dtree_header *> (p_data);
+                        ASSERT_CONDITION_THROW((m_p_header->m_magic != DTREE_MAGIC),
+                                "The decision tree image has a wrong magic number!");
+                        ASSERT_CONDITION_THROW((m_p_header->m_num_nodes == 0) || (m_p_header->m_ss_dim > FLAT_MAX_DIM) ||
+                                (m_p_header->m_is_dim > FLAT_MAX_DIM) || (size != get_size(*m_p_header)),
+                                "The decision tree image is corrupted!");
+                        m_p_dims = reinterpret_cast<const flat_bdd_dim *> (m_p_header + 1);
+                        m_p_inputs = reinterpret_cast<const uint64_t *> (m_p_dims + m_p_header->m_ss_dim + m_p_header->m_is_dim);
+                        m_p_nodes = reinterpret_cast<const dtree_node *> (m_p_inputs + m_p_header->m_num_inputs);
+                    }
+
+                    /**
+                     * Allows to get the label allowed in all the node's states
+                     * @param samples the learning data
+                     * @param order the state indexes
+                     * @param node the node
+                     * @return the smallest such label, or the number of labels if there is none
+                     */
+                    static uint32_t get_common_label(const dtree_samples & samples,
+                            const vector<size_t> & order, const dtree_build_node & node) {
+                        vector<size_t> counts(samples.m_num_labels, 0);
+                        for (size_t idx = node.m_begin; idx < node.m_end; ++idx) {
+                            const size_t state = order[idx];
+                            for (size_t lbl = samples.m_begin[state]; lbl < samples.m_begin[state + 1]; ++lbl) {
+                                ++counts[samples.m_labels[lbl]];
+                            }
+                        }
+                        const size_t num_states = node.m_end - node.m_begin;
+                        for (uint32_t label = 0; label < samples.m_num_labels; ++label) {
+                            if (counts[label] == num_states) {
+                                return label;
+                            }
+                        }
+                        return samples.m_num_labels;
+                    }
+
+                    /**
+                     * Allows to find the best split of the node along the dimension, the node's states are
+                     * sorted by the dimension's dof ids and the thresholds are swept keeping the label counts
+                     * @param samples the learning data
+                     * @param order the state indexes
+                     * @param node the node
+                     * @param dof the dimension
+                     * @param split the best split to be set
+                     */
+                    static void find_split(const dtree_samples & samples, const vector<size_t> & order,
+                            const dtree_build_node & node, const uint32_t dof, dtree_split & split) {
+                        const uint32_t ss_dim = samples.m_ss_dim;
+                        vector<size_t> states(order.begin() + node.m_begin, order.begin() + node.m_end);
+                        sort(states.begin(), states.end(), [&] (const size_t first, const size_t second) {
+                            return samples.m_dofs[first * ss_dim + dof] < samples.m_dofs[second * ss_dim + dof]; });
+
+                        //Count the labels, all the states are on the right
+                        vector<size_t> left(samples.m_num_labels, 0), right(samples.m_num_labels, 0);
+                        for (const auto state : states) {
+                            for (size_t lbl = samples.m_begin[state]; lbl < samples.m_begin[state + 1]; ++lbl) {
+                                ++right[samples.m_labels[lbl]];
+                            }
+                        }
+
+                        //Move the states to the left one by one, evaluate at the dof id changes
+                        const size_t num_states = states.size();
+                        size_t left_max = 0;
+                        split.m_is_valid = false;
+                        for (size_t idx = 0; idx + 1 < num_states; ++idx) {
+                            const size_t state = states[idx];
+                            for (size_t lbl = samples.m_begin[state]; lbl < samples.m_begin[state + 1]; ++lbl) {
+                                const uint32_t label = samples.m_labels[lbl];
+                                left_max = max(left_max, ++left[label]);
+                                --right[label];
+                            }
+                            const uint32_t curr = samples.m_dofs[state * ss_dim + dof];
+                            const uint32_t next = samples.m_dofs[states[idx + 1] * ss_dim + dof];
+                            if (curr != next) {
+                                const size_t right_max = *max_element(right.begin(), right.end());
+                                const size_t score = (idx + 1 - left_max) + (num_states - idx - 1 - right_max);
+                                const size_t balance = (2 * (idx + 1) > num_states) ?
+                                        2 * (idx + 1) - num_states : num_states - 2 * (idx + 1);
+                                if (!split.m_is_valid || (score < split.m_score) ||
+                                        ((score == split.m_score) && (balance < split.m_balance))) {
+                                    split = {score, balance, next, true};
+                                }
+                            }
+                        }
+                    }
+
+                    /**
+                     * Allows to get the learning data from the controller, every grid state is a sample
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD
+                     * @param ss_dim the number of state-space dimensions
+                     * @param dims the grid dimensions
+                     * @param inputs the used input ids, sorted, to be set
+                     * @param samples the learning data to be set
+                     */
+                    static void get_samples(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set, const BDD & ctrl_bdd,
+                            const int32_t ss_dim, const vector<flat_bdd_dim> & dims,
+                            vector<uint64_t> & inputs, dtree_samples & samples) {
+                        vector<pair<abs_type, abs_type>> pairs;
+                        dense_table::get_pairs(cudd_mgr, ctrl_set, ctrl_bdd, ss_dim, pairs);
+                        sort(pairs.begin(), pairs.end());
+                        inputs.clear();
+                        for (const auto & elem : pairs) {
+                            inputs.push_back(elem.second);
+                        }
+                        sort(inputs.begin(), inputs.end());
+                        inputs.erase(unique(inputs.begin(), inputs.end()), inputs.end());
+
+                        abs_type num_states = 1;
+                        for (int32_t dof = 0; dof < ss_dim; ++dof) {
+                            ASSERT_CONDITION_THROW((dims[dof].m_num_points > UINT32_MAX),
+                                    string("Too many grid points: ") + to_string(dims[dof].m_num_points));
+                            num_states *= dims[dof].m_num_points;
+                        }
+                        samples.m_ss_dim = ss_dim;
+                        samples.m_num_labels = inputs.size() + 1;
+                        samples.m_dofs.resize(num_states * ss_dim);
+                        samples.m_begin.resize(num_states + 1);
+                        samples.m_labels.clear();
+                        samples.m_labels.reserve(pairs.size());
+                        auto iter = pairs.begin();
+                        for (abs_type ss_id = 0; ss_id < num_states; ++ss_id) {
+                            for (int32_t dof = 0; dof < ss_dim; ++dof) {
+                                samples.m_dofs[ss_id * ss_dim + dof] = (ss_id / dims[dof].m_nn) % dims[dof].m_num_points;
+                            }
+                            samples.m_begin[ss_id] = samples.m_labels.size();
+                            if ((iter == pairs.end()) || (iter->first != ss_id)) {
+                                samples.m_labels.push_back(inputs.size());
+                            }
+                            for (; (iter != pairs.end()) && (iter->first == ss_id); ++iter) {
+                                samples.m_labels.push_back(lower_bound(inputs.begin(), inputs.end(), iter->second) - inputs.begin());
+                            }
+                        }
+                        samples.m_begin[num_states] = samples.m_labels.size();
+                    }
+
+                    /**
+                     * Allows to learn the tree and to build its image
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD
+                     * @param ss_dim the number of state-space dimensions
+                     * @param workers the thread pool to learn the tree with
+                     */
+                    void build(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set, const BDD & ctrl_bdd,
+                            const int32_t ss_dim, thread_pool & workers) {
+                        const int32_t is_dim = ctrl_set.get_dim() - ss_dim;
+                        ASSERT_CONDITION_THROW((ss_dim <= 0) || (is_dim <= 0),
+                                string("Improper state-space dimensionality: ") + to_string(ss_dim));
+
+                        //Get the learning data
+                        vector<flat_bdd_dim> dims;
+                        get_flat_dims(ctrl_set, ss_dim, dims);
+                        vector<uint64_t> inputs;
+                        dtree_samples samples;
+                        get_samples(cudd_mgr, ctrl_set, ctrl_bdd, ss_dim, dims, inputs, samples);
+                        const size_t num_states = samples.m_begin.size() - 1;
+                        vector<size_t> order(num_states);
+                        for (size_t idx = 0; idx < num_states; ++idx) {
+                            order[idx] = idx;
+                        }
+
+                        //Grow the tree level by level
+                        vector<dtree_build_node> nodes(1, dtree_build_node{DTREE_LEAF, 0, 0, num_states, 0, 0});
+                        vector<size_t> level(1, 0);
+                        uint32_t depth = 0;
+                        while (!level.empty()) {
+                            //Make the leaves of the nodes with a common label
+                            vector<uint32_t> common(level.size());
+                            workers.parallel_for(level.size(), [&] (const size_t begin, const size_t end) {
+                                for (size_t idx = begin; idx < end; ++idx) {
+                                    common[idx] = get_common_label(samples, order, nodes[level[idx]]);
+                                }
+                            }, 1);
+                            vector<size_t> inner;
+                            for (size_t idx = 0; idx < level.size(); ++idx) {
+                                if (common[idx] < samples.m_num_labels) {
+                                    nodes[level[idx]].m_value = (common[idx] == inputs.size()) ? DTREE_NONE : common[idx];
+                                } else {
+                                    inner.push_back(level[idx]);
+                                }
+                            }
+
+                            //Find the best splits, per node and dimension
+                            vector<dtree_split> splits(inner.size() * ss_dim);
+                            workers.parallel_for(splits.size(), [&] (const size_t begin, const size_t end) {
+                                for (size_t idx = begin; idx < end; ++idx) {
+                                    find_split(samples, order, nodes[inner[idx / ss_dim]], idx % ss_dim, splits[idx]);
+                                }
+                            }, 1);
+                            for (size_t idx = 0; idx < inner.size(); ++idx) {
+                                size_t best = idx * ss_dim;
+                                for (size_t dof = 1; dof < (size_t) ss_dim; ++dof) {
+                                    const dtree_split & split = splits[idx * ss_dim + dof];
+                                    if (split.m_is_valid && (!splits[best].m_is_valid || (split.m_score < splits[best].m_score) ||
+                                            ((split.m_score == splits[best].m_score) && (split.m_balance < splits[best].m_balance)))) {
+                                        best = idx * ss_dim + dof;
+                                    }
+                                }
+                                //The node states are distinct grid points, so there is a split
+                                ASSERT_CONDITION_THROW(!splits[best].m_is_valid, "Could not split a decision tree node!");
+                                nodes[inner[idx]].m_dof = best % ss_dim;
+                                nodes[inner[idx]].m_value = splits[best].m_threshold;
+                            }
+
+                            //Partition the node states by the splits
+                            workers.parallel_for(inner.size(), [&] (const size_t begin, const size_t end) {
+                                for (size_t idx = begin; idx < end; ++idx) {
+                                    const dtree_build_node & node = nodes[inner[idx]];
+                                    stable_partition(order.begin() + node.m_begin, order.begin() + node.m_end,
+                                            [&] (const size_t state) {
+                                                return samples.m_dofs[state * ss_dim + node.m_dof] < node.m_value; });
+                                }
+                            }, 1);
+
+                            //Create the children of the next level
+                            vector<size_t> next;
+                            for (const auto node_idx : inner) {
+                                const dtree_build_node node = nodes[node_idx];
+                                const uint32_t dof = node.m_dof, threshold = node.m_value;
+                                const size_t middle = partition_point(order.begin() + node.m_begin, order.begin() + node.m_end,
+                                        [&] (const size_t state) {
+                                            return samples.m_dofs[state * ss_dim + dof] < threshold; }) - order.begin();
+                                nodes[node_idx].m_left = nodes.size();
+                                nodes.push_back(dtree_build_node{DTREE_LEAF, 0, node.m_begin, middle, 0, 0});
+                                nodes[node_idx].m_right = nodes.size();
+                                nodes.push_back(dtree_build_node{DTREE_LEAF, 0, middle, node.m_end, 0, 0});
+                                next.push_back(nodes[node_idx].m_left);
+                                next.push_back(nodes[node_idx].m_right);
+                            }
+                            depth += next.empty() ? 0 : 1;
+                            level.swap(next);
+                        }
+                        ASSERT_CONDITION_THROW((nodes.size() > UINT32_MAX), string("Too many decision tree nodes: ") +
+                                to_string(nodes.size()));
+
+                        //Create the image
+                        const dtree_header header = {DTREE_MAGIC, (uint32_t) ss_dim, (uint32_t) is_dim, depth,
+                            inputs.size(), nodes.size()};
+                        m_image.assign(get_size(header) / sizeof (uint64_t), 0);
+                        char * p_data = reinterpret_cast<char *> (m_image.data());
+                        memcpy(p_data, &header, sizeof (header));
+                        memcpy(p_data + sizeof (header), dims.data(), dims.size() * sizeof (flat_bdd_dim));
+                        set_pointers(p_data, m_image.size() * sizeof (uint64_t));
+                        copy(inputs.begin(), inputs.end(), const_cast<uint64_t *> (m_p_inputs));
+
+                        //Lay out the nodes in the pre-order, the left child follows its parent
+                        dtree_node * p_nodes = const_cast<dtree_node *> (m_p_nodes);
+                        vector<pair<size_t, size_t>> stack(1, make_pair((size_t) 0, (size_t) UINT64_MAX));
+                        uint32_t num_laid = 0;
+                        while (!stack.empty()) {
+                            const size_t node_idx = stack.back().first;
+                            const size_t parent = stack.back().second;
+                            stack.pop_back();
+                            if (parent != UINT64_MAX) {
+                                p_nodes[parent].m_right = num_laid;
+                            }
+                            const dtree_build_node & node = nodes[node_idx];
+                            p_nodes[num_laid] = dtree_node{node.m_dof, node.m_value, 0};
+                            if (node.m_dof != DTREE_LEAF) {
+                                stack.push_back(make_pair(node.m_right, (size_t) num_laid));
+                                stack.push_back(make_pair(node.m_left, (size_t) UINT64_MAX));
+                            }
+                            ++num_laid;
+                        }
+
+                        LOG_INFO << "Learned the decision tree of " << header.m_num_nodes << " nodes and depth "
+                                << depth << " from " << num_states << " grid states with "
+                                << samples.m_labels.size() << " labels, " << get_size() << " bytes" << END_LOG;
+                    }
+                };
+            }
+        }
+    }
+}
+
+#endif /* DTREE_CTRL_HPP */
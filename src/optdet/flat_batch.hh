@@ -0,0 +1,614 @@
+/*
+ * File:   flat_batch.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 9, 2018, 09:35 AM
+ */
+
+#ifndef FLAT_BATCH_HPP
+#define FLAT_BATCH_HPP
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "monitor.hh"
+
+#include "flat_bdd.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+using namespace tud::utils::monitor;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                //The marker of the states without an input
+                static constexpr abs_type FLAT_NO_INPUT = numeric_limits<abs_type>::max();
+
+                //The number of states evaluated in lockstep
+#if defined(__AVX512F__)
+                static constexpr uint32_t FLAT_BATCH_LANES = 16;
+#else
+                static constexpr uint32_t FLAT_BATCH_LANES = 8;
+#endif
+                //The maximum number of state-space dimensions of the batch evaluation
+                static constexpr int32_t FLAT_BATCH_MAX_SS_DIM = 32;
+                //The input ids ADD terminal of the states outside of the controller's domain
+                static constexpr double FLAT_BATCH_ADD_NO_INPUT = -1.0;
+
+                /**
+                 * This class represents the controller compiled for the batch evaluation.
+                 * The controller is first made deterministic by choosing the smallest
+                 * input id in every state. Then the domain and every input bit become
+                 * BDDs over the state variables only, flattened into shared node arrays.
+                 * A batch of states is walked through each of them in lockstep, using
+                 * the AVX-512 or AVX2 gathers if available, without any branching on
+                 * the individual states. Without the gathers, one walk per input bit
+                 * is slower than the per-state lookup, so the controller is instead
+                 * flattened as the ADD of the input ids over the state variables and
+                 * every state is walked through it once, the flat functions are then
+                 * only built if requested, e.g. for the code generation. The evaluation
+                 * is thread safe and allocation free.
+                 */
+                class flat_batch {
+                public:
+
+                    /**
+                     * The basic constructor
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD
+                     * @param ss_dim the number of state-space dimensions
+                     * @param is_funcs if true then the domain and the input bit functions are
+                     *                 flattened even if the evaluation does not use them
+                     */
+                    flat_batch(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set,
+                            const BDD & ctrl_bdd, const int32_t ss_dim, const bool is_funcs = false)
+                    : m_ss_dim(ss_dim), m_is_dim(ctrl_set.get_dim() - ss_dim), m_dims(),
+                    m_in_bits(), m_in_weights(), m_var_dof(), m_var_bit(), m_node_var(), m_node_then(),
+                    m_node_else(), m_roots(), m_id_dof(), m_id_bit(), m_id_then(), m_id_else(), m_id_root(0) {
+                        ASSERT_CONDITION_THROW((m_ss_dim <= 0) || (m_is_dim <= 0) || (m_ss_dim > FLAT_BATCH_MAX_SS_DIM),
+                                string("Improper state-space dimensionality: ") + to_string(ss_dim));
+
+                        //Declare the statistics data
+                        DECLARE_MONITOR_STATS;
+
+                        //Get the beginning statistics data
+                        INITIALIZE_STATS;
+
+                        //Collect the grid dimensions and the variables
+                        get_flat_dims(ctrl_set, ss_dim, m_dims);
+                        for (int32_t dof = 0; dof < ss_dim; ++dof) {
+                            ASSERT_CONDITION_THROW((m_dims[dof].m_num_points > INT32_MAX),
+                                    string("Too many grid points in dimension: ") + to_string(dof));
+                        }
+                        vector<flat_bdd_var> index_vars;
+                        get_flat_vars(ctrl_set, ss_dim, ctrl_bdd.manager(), index_vars, m_in_bits);
+                        const vector<flat_bdd_var> & in_bits = m_in_bits;
+
+                        //Get the input bit variables, weights and the cube of all non-state variables
+                        const uint32_t num_bits = in_bits.size();
+                        vector<BDD> bit_vars(num_bits);
+                        BDD cube = cudd_mgr.bddOne();
+                        for (const unsigned int index : ctrl_bdd.SupportIndices()) {
+                            if (index_vars[index].m_dof >= (uint32_t) ss_dim) {
+                                cube &= cudd_mgr.bddVar(index);
+                            }
+                        }
+                        for (size_t index = 0; index < index_vars.size(); ++index) {
+                            const flat_bdd_var & var = index_vars[index];
+                            if ((var.m_dof != FLAT_UNUSED_DOF) && (var.m_dof >= (uint32_t) ss_dim)) {
+                                bit_vars[var.m_bit] = cudd_mgr.bddVar(index);
+                                cube &= bit_vars[var.m_bit];
+                            }
+                        }
+                        for (const flat_bdd_var & bit : in_bits) {
+                            m_in_weights.push_back((((abs_type) 1) << bit.m_bit) * m_dims[ss_dim + bit.m_dof].m_nn);
+                        }
+
+                        //Keep the smallest input id per state, the larger ids have the
+                        //higher dofs set and within a dof the higher bits set
+                        vector<uint32_t> bit_order(num_bits);
+                        for (uint32_t idx = 0; idx < num_bits; ++idx) {
+                            bit_order[idx] = idx;
+                        }
+                        sort(bit_order.begin(), bit_order.end(), [&](const uint32_t first, const uint32_t second) {
+                            return (in_bits[first].m_dof != in_bits[second].m_dof) ?
+                                    (in_bits[first].m_dof > in_bits[second].m_dof) :
+                                    (in_bits[first].m_bit > in_bits[second].m_bit);
+                        });
+                        BDD det_bdd = ctrl_bdd;
+                        for (const uint32_t idx : bit_order) {
+                            const BDD can_be_zero = (det_bdd & !bit_vars[idx]).ExistAbstract(cube);
+                            det_bdd &= ((!bit_vars[idx]) | (!can_be_zero));
+                        }
+
+                        //The gathers walk the flat functions, otherwise the input ids ADD is walked
+#if defined(__AVX2__) || defined(__AVX512F__)
+                        const bool is_gather = true;
+#else
+                        const bool is_gather = false;
+#endif
+                        if (is_gather || is_funcs) {
+                            flatten_funcs(cudd_mgr, det_bdd, cube, bit_vars, index_vars);
+                        }
+                        if (!is_gather) {
+                            flatten_ids(cudd_mgr, det_bdd, cube, bit_vars, index_vars);
+                        }
+
+                        LOG_INFO << "Compiled the batch controller into " << m_node_var.size() << " flat function nodes and "
+                                << m_id_dof.size() << " input ids ADD nodes, using " << get_simd_name() << END_LOG;
+
+                        //Get the end stats and log them
+                        REPORT_STATS(string("Compiling the batch controller"));
+                    }
+
+                    /**
+                     * Allows to get the name of the used instruction set
+                     * @return the name of the used instruction set
+                     */
+                    static inline const char * get_simd_name() {
+#if defined(__AVX512F__)
+                        return "AVX-512";
+#elif defined(__AVX2__)
+                        return "AVX2";
+#else
+                        return "scalar";
+#endif
+                    }
+
+                    /**
+                     * Allows to get the input of every state, thread safe
+                     * @param states the states, each of the state-space dimensionality
+                     * @param num_states the number of states
+                     * @param input_ids the array to store the smallest input id of every
+                     *                  state, or FLAT_NO_INPUT if the state is outside of
+                     *                  the grid or of the controller's domain
+                     */
+                    void evaluate(const double * states, const size_t num_states, abs_type * input_ids) const {
+#if defined(__AVX2__) || defined(__AVX512F__)
+                        uint32_t dofs[FLAT_BATCH_MAX_SS_DIM * FLAT_BATCH_LANES];
+                        for (size_t begin = 0; begin < num_states; begin += FLAT_BATCH_LANES) {
+                            const uint32_t num_lanes = min((size_t) FLAT_BATCH_LANES, num_states - begin);
+
+                            //Get the state-space dofs and the on-grid lanes
+                            uint32_t active = xtois(states + begin * m_ss_dim, num_lanes, dofs);
+
+                            //Evaluate the domain and then the input bits
+                            active &= walk(m_roots[0], dofs);
+                            abs_type * ids = input_ids + begin;
+                            for (uint32_t lane = 0; lane < num_lanes; ++lane) {
+                                ids[lane] = ((active >> lane) & 1) ? 0 : FLAT_NO_INPUT;
+                            }
+                            if (active == 0) {
+                                continue;
+                            }
+                            for (size_t idx = 0; idx < m_in_weights.size(); ++idx) {
+                                const uint32_t set = walk(m_roots[idx + 1], dofs) & active;
+                                for (uint32_t lane = 0; lane < num_lanes; ++lane) {
+                                    ids[lane] += ((set >> lane) & 1) ? m_in_weights[idx] : 0;
+                                }
+                            }
+                        }
+#else
+                        uint32_t dofs[FLAT_BATCH_MAX_SS_DIM];
+                        for (size_t num = 0; num < num_states; ++num) {
+                            //Get the state-space dofs
+                            const double * state = states + num * m_ss_dim;
+                            bool is_in = true;
+                            for (int32_t dof = 0; dof < m_ss_dim; ++dof) {
+                                const flat_bdd_dim & dim = m_dims[dof];
+                                const double pos = state[dof] * dim.m_eta_inv - dim.m_x2a_sh;
+                                is_in &= (pos > -1.0) && (pos < dim.m_num_points);
+                                dofs[dof] = is_in ? (uint32_t) pos : 0;
+                            }
+
+                            //Walk the input ids ADD down to its terminal
+                            uint32_t idx = m_id_root;
+                            while (m_id_dof[idx] != FLAT_UNUSED_DOF) {
+                                idx = ((dofs[m_id_dof[idx]] >> m_id_bit[idx]) & 1) ? m_id_then[idx] : m_id_else[idx];
+                            }
+                            input_ids[num] = is_in ? m_id_then[idx] : FLAT_NO_INPUT;
+                        }
+#endif
+                    }
+
+                    /**
+                     * Allows to convert the input id into the input-space point, thread safe
+                     * @param id the input id
+                     * @param input the array to store the input-space point, of the input-space dimensionality
+                     */
+                    inline void itox_input(abs_type id, double * input) const {
+                        for (int32_t dof = m_is_dim - 1; dof >= 0; --dof) {
+                            const flat_bdd_dim & dim = m_dims[m_ss_dim + dof];
+                            const abs_type num = id / dim.m_nn;
+                            id = id % dim.m_nn;
+                            input[dof] = dim.m_first + num * dim.m_eta;
+                        }
+                    }
+
+                    /**
+                     * Allows to get the number of state-space dimensions
+                     * @return the number of state-space dimensions
+                     */
+                    inline int32_t get_ss_dim() const {
+                        return m_ss_dim;
+                    }
+
+                    /**
+                     * Allows to get the number of input-space dimensions
+                     * @return the number of input-space dimensions
+                     */
+                    inline int32_t get_is_dim() const {
+                        return m_is_dim;
+                    }
+
+                    /**
+                     * Allows to get the number of flat function nodes, including the two constants,
+                     * zero if the functions were not flattened
+                     * @return the number of nodes
+                     */
+                    inline size_t get_num_nodes() const {
+                        return m_node_var.size();
+                    }
+
+                    /**
+                     * Allows to get the state and then the input grid dimensions
+                     * @return the grid dimensions
+                     */
+                    inline const vector<flat_bdd_dim> & get_dims() const {
+                        return m_dims;
+                    }
+
+                    /**
+                     * Allows to get the input dof and dof bit position of each input bit
+                     * @return the input bits
+                     */
+                    inline const vector<flat_bdd_var> & get_in_bits() const {
+                        return m_in_bits;
+                    }
+
+                    /**
+                     * Allows to get the state dof of each variable, the last one is for the constants
+                     * @return the variable dofs
+                     */
+                    inline const vector<uint32_t> & get_var_dofs() const {
+                        return m_var_dof;
+                    }
+
+                    /**
+                     * Allows to get the state dof bit position of each variable
+                     * @return the variable dof bit positions
+                     */
+                    inline const vector<uint32_t> & get_var_bits() const {
+                        return m_var_bit;
+                    }
+
+                    /**
+                     * Allows to get the variable of each node
+                     * @return the node variables
+                     */
+                    inline const vector<uint32_t> & get_node_vars() const {
+                        return m_node_var;
+                    }
+
+                    /**
+                     * Allows to get the then child of each node
+                     * @return the node then children
+                     */
+                    inline const vector<uint32_t> & get_node_thens() const {
+                        return m_node_then;
+                    }
+
+                    /**
+                     * Allows to get the else child of each node
+                     * @return the node else children
+                     */
+                    inline const vector<uint32_t> & get_node_elses() const {
+                        return m_node_else;
+                    }
+
+                    /**
+                     * Allows to get the domain root and then the input bit roots
+                     * @return the roots
+                     */
+                    inline const vector<uint32_t> & get_roots() const {
+                        return m_roots;
+                    }
+
+                private:
+                    //Stores the number of state-space dimensions
+                    const int32_t m_ss_dim;
+                    //Stores the number of input-space dimensions
+                    const int32_t m_is_dim;
+                    //Stores the state and then the input grid dimensions
+                    vector<flat_bdd_dim> m_dims;
+                    //Stores the input dof and dof bit position of each input bit
+                    vector<flat_bdd_var> m_in_bits;
+                    //Stores the input id weight of each input bit
+                    vector<abs_type> m_in_weights;
+                    //Stores the state dof of each variable
+                    vector<uint32_t> m_var_dof;
+                    //Stores the state dof bit position of each variable
+                    vector<uint32_t> m_var_bit;
+                    //Stores the variable of each node
+                    vector<uint32_t> m_node_var;
+                    //Stores the then child of each node
+                    vector<uint32_t> m_node_then;
+                    //Stores the else child of each node
+                    vector<uint32_t> m_node_else;
+                    //Stores the domain root and then the input bit roots
+                    vector<uint32_t> m_roots;
+                    //Stores the state dof of each input ids node, or FLAT_UNUSED_DOF for the terminals
+                    vector<uint32_t> m_id_dof;
+                    //Stores the state dof bit position of each input ids node
+                    vector<uint32_t> m_id_bit;
+                    //Stores the then child of each input ids node, or the input id for the terminals
+                    vector<abs_type> m_id_then;
+                    //Stores the else child of each input ids node
+                    vector<uint32_t> m_id_else;
+                    //Stores the input ids root
+                    uint32_t m_id_root;
+
+                    /**
+                     * Allows to flatten the domain and the input bits as functions of the state
+                     * into the shared node arrays
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param det_bdd the deterministic controller's BDD
+                     * @param cube the cube of all the non-state variables
+                     * @param bit_vars the input bit variables
+                     * @param index_vars the variables per BDD variable index
+                     */
+                    void flatten_funcs(const Cudd & cudd_mgr, const BDD & det_bdd, const BDD & cube,
+                            const vector<BDD> & bit_vars, const vector<flat_bdd_var> & index_vars) {
+                        //Get the domain and the input bits as functions of the state
+                        vector<BDD> funcs(1, det_bdd.ExistAbstract(cube));
+                        for (const BDD & bit_var : bit_vars) {
+                            funcs.push_back((det_bdd & bit_var).ExistAbstract(cube));
+                        }
+
+                        //Flatten the functions into the shared node arrays
+                        vector<DdNode *> roots;
+                        for (const BDD & func : funcs) {
+                            roots.push_back(func.getNode());
+                        }
+                        vector<flat_bdd_var> vars;
+                        vector<flat_bdd_node> nodes;
+                        flatten_bdds(cudd_mgr.getManager(), roots, index_vars, vars, nodes, m_roots);
+
+                        //Store the variables, with an extra one for the constants to point to
+                        for (const flat_bdd_var & var : vars) {
+                            ASSERT_CONDITION_THROW((var.m_dof >= (uint32_t) m_ss_dim),
+                                    "The flattened function depends on a non-state variable!");
+                            m_var_dof.push_back(var.m_dof);
+                            m_var_bit.push_back(var.m_bit);
+                        }
+                        m_var_dof.push_back(0);
+                        m_var_bit.push_back(0);
+                        nodes[FLAT_BDD_ZERO].m_var = vars.size();
+                        nodes[FLAT_BDD_ONE].m_var = vars.size();
+
+                        //Store the nodes as separate arrays, for the gathers
+                        for (const flat_bdd_node & node : nodes) {
+                            m_node_var.push_back(node.m_var);
+                            m_node_then.push_back(node.m_then);
+                            m_node_else.push_back(node.m_else);
+                        }
+                    }
+
+                    /**
+                     * Allows to flatten the ADD of the input ids over the state variables into the
+                     * node arrays, the terminals store the input id or FLAT_NO_INPUT. The ADD is the
+                     * sum over the inputs of the deterministic controller weighted by the input ids.
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param det_bdd the deterministic controller's BDD
+                     * @param cube the cube of all the non-state variables
+                     * @param bit_vars the input bit variables
+                     * @param index_vars the variables per BDD variable index
+                     */
+                    void flatten_ids(const Cudd & cudd_mgr, const BDD & det_bdd, const BDD & cube,
+                            const vector<BDD> & bit_vars, const vector<flat_bdd_var> & index_vars) {
+                        BDD bits_cube = cudd_mgr.bddOne();
+                        ADD id_add = cudd_mgr.addZero();
+                        for (size_t idx = 0; idx < bit_vars.size(); ++idx) {
+                            bits_cube &= bit_vars[idx];
+                            id_add += bit_vars[idx].Add() * cudd_mgr.constant((double) m_in_weights[idx]);
+                        }
+
+                        //Only the input bits are summed over, a domain state has a single input
+                        const BDD in_bdd = det_bdd.ExistAbstract(cube.ExistAbstract(bits_cube));
+                        const ADD sum_add = (in_bdd.Add() * id_add).ExistAbstract(bits_cube.Add());
+                        const ADD ids_add = det_bdd.ExistAbstract(cube).Add().Ite(
+                                sum_add, cudd_mgr.constant(FLAT_BATCH_ADD_NO_INPUT));
+
+                        //Number the reachable nodes, the children before the parents
+                        unordered_map<DdNode *, uint32_t> node_ids;
+                        vector<pair<DdNode *, bool>> stack(1, make_pair(ids_add.getNode(), false));
+                        while (!stack.empty()) {
+                            DdNode * node = stack.back().first;
+                            const bool is_expanded = stack.back().second;
+                            stack.pop_back();
+                            if (node_ids.count(node) != 0) {
+                                continue;
+                            }
+                            if (Cudd_IsConstant(node)) {
+                                const double value = Cudd_V(node);
+                                node_ids[node] = m_id_dof.size();
+                                m_id_dof.push_back(FLAT_UNUSED_DOF);
+                                m_id_bit.push_back(0);
+                                m_id_then.push_back((value == FLAT_BATCH_ADD_NO_INPUT) ? FLAT_NO_INPUT : (abs_type) value);
+                                m_id_else.push_back(0);
+                            } else if (is_expanded) {
+                                const flat_bdd_var & var = index_vars[Cudd_NodeReadIndex(node)];
+                                ASSERT_CONDITION_THROW((var.m_dof >= (uint32_t) m_ss_dim),
+                                        "The input ids ADD depends on a non-state variable!");
+                                node_ids[node] = m_id_dof.size();
+                                m_id_dof.push_back(var.m_dof);
+                                m_id_bit.push_back(var.m_bit);
+                                m_id_then.push_back(node_ids[Cudd_T(node)]);
+                                m_id_else.push_back(node_ids[Cudd_E(node)]);
+                            } else {
+                                stack.push_back(make_pair(node, true));
+                                stack.push_back(make_pair(Cudd_T(node), false));
+                                stack.push_back(make_pair(Cudd_E(node), false));
+                            }
+                        }
+                        m_id_root = node_ids[ids_add.getNode()];
+                    }
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+
+                    /**
+                     * Allows to compute the state-space dofs of the lanes, the padding
+                     * lanes repeat the last state, the dofs are stored per dof
+                     * @param states the lane states
+                     * @param num_lanes the number of used lanes
+                     * @param dofs the array to store the dofs, dof-major
+                     * @return the mask of the used lanes with the on-grid states
+                     */
+                    inline uint32_t xtois(const double * states, const uint32_t num_lanes, uint32_t * dofs) const {
+                        uint32_t on_grid = (1u << num_lanes) - 1;
+#if defined(__AVX512F__)
+                        const __m256i lanes = _mm256_min_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                _mm256_set1_epi32(num_lanes - 1));
+                        const __m256i lanes_hi = _mm256_min_epi32(_mm256_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15),
+                                _mm256_set1_epi32(num_lanes - 1));
+                        const __m256i stride = _mm256_set1_epi32(m_ss_dim);
+                        //The masked intrinsics with the zero sources leave nothing undefined
+                        const __m512d zero_pd = _mm512_setzero_pd();
+                        const __m256i zero_lo = _mm256_setzero_si256();
+                        const __m512i zero = _mm512_setzero_si512();
+                        for (int32_t dof = 0; dof < m_ss_dim; ++dof) {
+                            const flat_bdd_dim & dim = m_dims[dof];
+                            const __m512d eta_inv = _mm512_set1_pd(dim.m_eta_inv);
+                            const __m512d x2a_sh = _mm512_set1_pd(dim.m_x2a_sh);
+                            const __m256i lo = _mm512_mask_cvttpd_epi32(zero_lo, 0xFF, _mm512_sub_pd(_mm512_mul_pd(
+                                    _mm512_mask_i32gather_pd(zero_pd, 0xFF, _mm256_mullo_epi32(lanes, stride),
+                                    states + dof, 8), eta_inv), x2a_sh));
+                            const __m256i hi = _mm512_mask_cvttpd_epi32(zero_lo, 0xFF, _mm512_sub_pd(_mm512_mul_pd(
+                                    _mm512_mask_i32gather_pd(zero_pd, 0xFF, _mm256_mullo_epi32(lanes_hi, stride),
+                                    states + dof, 8), eta_inv), x2a_sh));
+                            const __m512i ids = _mm512_mask_inserti64x4(zero, 0xFF,
+                                    _mm512_mask_inserti64x4(zero, 0xFF, zero, lo, 0), hi, 1);
+                            _mm512_storeu_si512(dofs + dof * FLAT_BATCH_LANES, ids);
+                            on_grid &= _mm512_cmplt_epu32_mask(ids, _mm512_set1_epi32(dim.m_num_points));
+                        }
+#elif defined(__AVX2__)
+                        const __m128i stride = _mm_set1_epi32(m_ss_dim);
+                        //The masked gather with the zero source leaves nothing undefined
+                        const __m256d zero_pd = _mm256_setzero_pd();
+                        const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+                        for (uint32_t lane = 0; lane < FLAT_BATCH_LANES; lane += 4) {
+                            const __m128i lanes = _mm_min_epi32(_mm_add_epi32(_mm_setr_epi32(0, 1, 2, 3),
+                                    _mm_set1_epi32(lane)), _mm_set1_epi32(num_lanes - 1));
+                            const __m128i offsets = _mm_mullo_epi32(lanes, stride);
+                            for (int32_t dof = 0; dof < m_ss_dim; ++dof) {
+                                const flat_bdd_dim & dim = m_dims[dof];
+                                const __m128i ids = _mm256_cvttpd_epi32(_mm256_sub_pd(_mm256_mul_pd(
+                                        _mm256_mask_i32gather_pd(zero_pd, states + dof, offsets, all, 8),
+                                        _mm256_set1_pd(dim.m_eta_inv)), _mm256_set1_pd(dim.m_x2a_sh)));
+                                _mm_storeu_si128(reinterpret_cast<__m128i *> (dofs + dof * FLAT_BATCH_LANES + lane), ids);
+                                const __m128i max_id = _mm_set1_epi32(dim.m_num_points - 1);
+                                const uint32_t in = _mm_movemask_ps(_mm_castsi128_ps(
+                                        _mm_cmpeq_epi32(_mm_min_epu32(ids, max_id), ids)));
+                                on_grid &= ~((~in & 0xFu) << lane);
+                            }
+                        }
+#endif
+                        return on_grid;
+                    }
+
+                    /**
+                     * Allows to walk the lanes through the flat BDD in lockstep
+                     * @param root the root node index
+                     * @param dofs the lane dofs, dof-major
+                     * @return the mask of the lanes reaching the constant true
+                     */
+                    inline uint32_t walk(const uint32_t root, const uint32_t * dofs) const {
+                        const int * node_var = reinterpret_cast<const int *> (m_node_var.data());
+                        const int * node_then = reinterpret_cast<const int *> (m_node_then.data());
+                        const int * node_else = reinterpret_cast<const int *> (m_node_else.data());
+                        const int * var_dof = reinterpret_cast<const int *> (m_var_dof.data());
+                        const int * var_bit = reinterpret_cast<const int *> (m_var_bit.data());
+                        const int * lane_dofs = reinterpret_cast<const int *> (dofs);
+#if defined(__AVX512F__)
+                        const __m512i one = _mm512_set1_epi32(FLAT_BDD_ONE);
+                        const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+                        //The masked intrinsics with the zero source leave nothing undefined
+                        const __m512i zero = _mm512_setzero_si512();
+                        const __mmask16 all = 0xFFFF;
+                        __m512i idx = _mm512_set1_epi32(root);
+                        while (_mm512_cmpgt_epu32_mask(idx, one)) {
+                            const __m512i var = _mm512_mask_i32gather_epi32(zero, all, idx, node_var, 4);
+                            const __m512i then_idx = _mm512_mask_i32gather_epi32(zero, all, idx, node_then, 4);
+                            const __m512i else_idx = _mm512_mask_i32gather_epi32(zero, all, idx, node_else, 4);
+                            const __m512i dof = _mm512_mask_i32gather_epi32(zero, all, var, var_dof, 4);
+                            const __m512i bit = _mm512_mask_i32gather_epi32(zero, all, var, var_bit, 4);
+                            const __m512i val = _mm512_mask_i32gather_epi32(zero, all, _mm512_add_epi32(
+                                    _mm512_mask_slli_epi32(zero, all, dof, 4), lanes), lane_dofs, 4);
+                            const __mmask16 is_then = _mm512_test_epi32_mask(
+                                    _mm512_mask_srlv_epi32(zero, all, val, bit), one);
+                            idx = _mm512_mask_blend_epi32(is_then, else_idx, then_idx);
+                        }
+                        return _mm512_cmpeq_epi32_mask(idx, one);
+#elif defined(__AVX2__)
+                        const __m256i one = _mm256_set1_epi32(FLAT_BDD_ONE);
+                        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+                        __m256i idx = _mm256_set1_epi32(root);
+                        while (_mm256_movemask_epi8(_mm256_cmpgt_epi32(idx, one))) {
+                            const __m256i var = _mm256_i32gather_epi32(node_var, idx, 4);
+                            const __m256i then_idx = _mm256_i32gather_epi32(node_then, idx, 4);
+                            const __m256i else_idx = _mm256_i32gather_epi32(node_else, idx, 4);
+                            const __m256i dof = _mm256_i32gather_epi32(var_dof, var, 4);
+                            const __m256i bit = _mm256_i32gather_epi32(var_bit, var, 4);
+                            const __m256i val = _mm256_i32gather_epi32(lane_dofs, _mm256_add_epi32(
+                                    _mm256_slli_epi32(dof, 3), lanes), 4);
+                            const __m256i is_then = _mm256_cmpeq_epi32(_mm256_and_si256(
+                                    _mm256_srlv_epi32(val, bit), one), one);
+                            idx = _mm256_blendv_epi8(else_idx, then_idx, is_then);
+                        }
+                        return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(idx, one)));
+#endif
+                    }
+#endif
+                };
+            }
+        }
+    }
+}
+
+#endif /* FLAT_BATCH_HPP */
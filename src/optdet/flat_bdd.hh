@@ -0,0 +1,674 @@
+/*
+ * File:   flat_bdd.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 3, 2018, 10:20 AM
+ */
+
+#ifndef FLAT_BDD_HPP
+#define FLAT_BDD_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                /*
+                 * The flat BDD image layout, all the values are in the host byte order:
+                 *
+                 *     flat_bdd_header
+                 *     flat_bdd_dim  x (ss_dim + is_dim)    the grid of each dimension
+                 *     flat_bdd_var  x num_vars             the variables in the BDD level order
+                 *     flat_bdd_var  x num_in_bits          the input bits: dof and dof bit position
+                 *     flat_bdd_node x num_nodes            the nodes, parents before children
+                 *
+                 * The node with index zero is the constant false and the one with index one
+                 * is the constant true. The complement edges are resolved, so the nodes can
+                 * be walked without any knowledge of CUDD.
+                 */
+
+                //The flat BDD magic number, "FBD1"
+                static constexpr uint32_t FLAT_BDD_MAGIC = 0x31444246u;
+                //The flat BDD false node index
+                static constexpr uint32_t FLAT_BDD_ZERO = 0;
+                //The flat BDD true node index
+                static constexpr uint32_t FLAT_BDD_ONE = 1;
+                //The marker of the flat BDD variables not used by the controller
+                static constexpr uint32_t FLAT_UNUSED_DOF = UINT32_MAX;
+                //The maximum number of input-space BDD variables
+                static constexpr uint32_t FLAT_MAX_IN_BITS = 64;
+                //The maximum state- and input-space dimensionality, bounds the dofs arrays of the lookups
+                static constexpr uint32_t FLAT_MAX_DIM = 32;
+
+                /**
+                 * The flat BDD image header
+                 */
+                struct flat_bdd_header {
+                    //The magic number
+                    uint32_t m_magic;
+                    //The number of state-space dimensions
+                    uint32_t m_ss_dim;
+                    //The number of input-space dimensions
+                    uint32_t m_is_dim;
+                    //The number of BDD variables
+                    uint32_t m_num_vars;
+                    //The number of input-space BDD variables
+                    uint32_t m_num_in_bits;
+                    //The number of nodes, including the two constants
+                    uint32_t m_num_nodes;
+                    //The root node index
+                    uint32_t m_root;
+                    //The padding to keep the following data aligned
+                    uint32_t m_unused;
+                };
+
+                /**
+                 * The flat BDD grid dimension
+                 */
+                struct flat_bdd_dim {
+                    //The first grid point
+                    double m_first;
+                    //The grid step
+                    double m_eta;
+                    //The inverse of the grid step
+                    double m_eta_inv;
+                    //The real to grid point shift, as in SCOTS
+                    double m_x2a_sh;
+                    //The number of grid points
+                    uint64_t m_num_points;
+                    //The grid point id multiplier, within the state or input space
+                    uint64_t m_nn;
+                };
+
+                /**
+                 * The flat BDD variable
+                 */
+                struct flat_bdd_var {
+                    //The dof index, or FLAT_UNUSED_DOF
+                    uint32_t m_dof;
+                    //The dof bit position for the state variables and
+                    //the global input bit index for the input variables
+                    uint32_t m_bit;
+                };
+
+                /**
+                 * The flat BDD node
+                 */
+                struct flat_bdd_node {
+                    //The variable index, in the level order
+                    uint32_t m_var;
+                    //The then child index
+                    uint32_t m_then;
+                    //The else child index
+                    uint32_t m_else;
+                };
+
+                /**
+                 * Allows to get the flat grid dimensions of the controller
+                 * @param ctrl_set the controller's symbolic set
+                 * @param ss_dim the number of state-space dimensions
+                 * @param dims the vector to store the state and then the input dimensions
+                 */
+                static inline void get_flat_dims(const SymbolicSet & ctrl_set, const int32_t ss_dim,
+                        vector<flat_bdd_dim> & dims) {
+                    ASSERT_CONDITION_THROW((ss_dim > (int32_t) FLAT_MAX_DIM) || (ctrl_set.get_dim() - ss_dim > (int32_t) FLAT_MAX_DIM),
+                            string("The state- and input-space dimensionality may not exceed ") + to_string(FLAT_MAX_DIM));
+                    dims.resize(ctrl_set.get_dim());
+                    const vector<double> first = ctrl_set.get_lower_left();
+                    const vector<double> eta = ctrl_set.get_eta();
+                    const vector<abs_type> num_points = ctrl_set.get_no_gp_per_dim();
+                    for (int32_t dof = 0; dof < ctrl_set.get_dim(); ++dof) {
+                        dims[dof].m_first = first[dof];
+                        dims[dof].m_eta = eta[dof];
+                        dims[dof].m_eta_inv = 1.0 / eta[dof];
+                        dims[dof].m_x2a_sh = dims[dof].m_first * dims[dof].m_eta_inv - 0.5;
+                        dims[dof].m_num_points = num_points[dof];
+                        dims[dof].m_nn = ((dof == 0) || (dof == ss_dim)) ? 1 : dims[dof - 1].m_nn * num_points[dof - 1];
+                    }
+                }
+
+                /**
+                 * Allows to map the BDD variables onto the dof bits, the first
+                 * variable of the interval represents the most significant bit
+                 * @param ctrl_set the controller's symbolic set
+                 * @param ss_dim the number of state-space dimensions
+                 * @param dd_mgr the CUDD manager
+                 * @param index_vars the vector to store the variables per BDD variable index
+                 * @param in_bits the vector to store the input bits: dof and dof bit position
+                 */
+                static inline void get_flat_vars(const SymbolicSet & ctrl_set, const int32_t ss_dim,
+                        DdManager * dd_mgr, vector<flat_bdd_var> & index_vars, vector<flat_bdd_var> & in_bits) {
+                    index_vars.assign(Cudd_ReadSize(dd_mgr), flat_bdd_var{FLAT_UNUSED_DOF, 0});
+                    in_bits.clear();
+                    vector<IntegerInterval<abs_type>> ints = ctrl_set.get_bdd_intervals();
+                    for (int32_t dof = 0; dof < ctrl_set.get_dim(); ++dof) {
+                        const vector<unsigned int> var_ids = ints[dof].get_bdd_var_ids();
+                        const uint32_t num_bits = var_ids.size();
+                        for (uint32_t idx = 0; idx < num_bits; ++idx) {
+                            const uint32_t bit_pos = num_bits - idx - 1;
+                            flat_bdd_var & var = index_vars[var_ids[idx]];
+                            var.m_dof = dof;
+                            if (dof < ss_dim) {
+                                var.m_bit = bit_pos;
+                            } else {
+                                var.m_bit = in_bits.size();
+                                in_bits.push_back(flat_bdd_var{(uint32_t) (dof - ss_dim), bit_pos});
+                            }
+                        }
+                    }
+                    ASSERT_CONDITION_THROW((in_bits.size() > FLAT_MAX_IN_BITS),
+                            string("Too many input-space BDD variables: ") + to_string(in_bits.size()));
+                }
+
+                /**
+                 * Allows to flatten the BDDs into a single node array, the nodes are
+                 * shared between the BDDs, ordered by level and the complemented
+                 * nodes are resolved into distinct ones
+                 * @param dd_mgr the CUDD manager
+                 * @param roots the BDD roots
+                 * @param index_vars the variables per BDD variable index
+                 * @param vars the vector to store the used variables in the level order
+                 * @param nodes the vector to store the nodes, the first two are the constants
+                 * @param root_ids the vector to store the root node indexes
+                 */
+                static inline void flatten_bdds(DdManager * dd_mgr, const vector<DdNode *> & roots,
+                        const vector<flat_bdd_var> & index_vars, vector<flat_bdd_var> & vars,
+                        vector<flat_bdd_node> & nodes, vector<uint32_t> & root_ids) {
+                    //Collect the reachable nodes, the complemented ones are distinct
+                    DdNode * const one = Cudd_ReadOne(dd_mgr);
+                    DdNode * const zero = Cudd_Not(one);
+                    unordered_map<DdNode *, uint32_t> node_ids;
+                    vector<DdNode *> dd_nodes;
+                    vector<DdNode *> stack(roots);
+                    node_ids[zero] = FLAT_BDD_ZERO;
+                    node_ids[one] = FLAT_BDD_ONE;
+                    while (!stack.empty()) {
+                        DdNode * node = stack.back();
+                        stack.pop_back();
+                        if (node_ids.emplace(node, 0).second) {
+                            dd_nodes.push_back(node);
+                            DdNode * reg = Cudd_Regular(node);
+                            stack.push_back(Cudd_NotCond(Cudd_T(reg), Cudd_IsComplement(node)));
+                            stack.push_back(Cudd_NotCond(Cudd_E(reg), Cudd_IsComplement(node)));
+                        }
+                    }
+
+                    //Order the nodes by level, so the parents come before the children
+                    stable_sort(dd_nodes.begin(), dd_nodes.end(), [&](DdNode * first, DdNode * second) {
+                        return Cudd_ReadPerm(dd_mgr, Cudd_NodeReadIndex(Cudd_Regular(first))) <
+                                Cudd_ReadPerm(dd_mgr, Cudd_NodeReadIndex(Cudd_Regular(second)));
+                    });
+                    for (size_t idx = 0; idx < dd_nodes.size(); ++idx) {
+                        node_ids[dd_nodes[idx]] = idx + 2;
+                    }
+
+                    //Number the used variables in the level order
+                    vector<int32_t> index_to_var(index_vars.size(), -1);
+                    vars.clear();
+                    for (DdNode * node : dd_nodes) {
+                        const unsigned int index = Cudd_NodeReadIndex(Cudd_Regular(node));
+                        if (index_to_var[index] < 0) {
+                            index_to_var[index] = vars.size();
+                            vars.push_back(index_vars[index]);
+                        }
+                    }
+
+                    //Create the nodes
+                    nodes.resize(dd_nodes.size() + 2);
+                    nodes[FLAT_BDD_ZERO] = flat_bdd_node{UINT32_MAX, FLAT_BDD_ZERO, FLAT_BDD_ZERO};
+                    nodes[FLAT_BDD_ONE] = flat_bdd_node{UINT32_MAX, FLAT_BDD_ONE, FLAT_BDD_ONE};
+                    for (size_t idx = 0; idx < dd_nodes.size(); ++idx) {
+                        DdNode * reg = Cudd_Regular(dd_nodes[idx]);
+                        const bool is_compl = Cudd_IsComplement(dd_nodes[idx]);
+                        nodes[idx + 2].m_var = index_to_var[Cudd_NodeReadIndex(reg)];
+                        nodes[idx + 2].m_then = node_ids[Cudd_NotCond(Cudd_T(reg), is_compl)];
+                        nodes[idx + 2].m_else = node_ids[Cudd_NotCond(Cudd_E(reg), is_compl)];
+                    }
+
+                    //Get the root node indexes
+                    root_ids.clear();
+                    for (DdNode * root : roots) {
+                        root_ids.push_back(node_ids[root]);
+                    }
+                }
+
+                /**
+                 * This class represents the controller's BDD compiled into a contiguous
+                 * node array. The array can be stored into a file and later on mapped
+                 * into memory, possibly by several processes at once. The lookups need
+                 * neither CUDD nor SCOTS, are thread safe and allocation free.
+                 */
+                class flat_bdd {
+                public:
+
+                    /**
+                     * The compiling constructor
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD
+                     * @param ss_dim the number of state-space dimensions
+                     */
+                    flat_bdd(const SymbolicSet & ctrl_set, const BDD & ctrl_bdd, const int32_t ss_dim)
+                    : m_image(), m_p_map(NULL), m_map_size(0), m_p_header(NULL),
+                    m_p_dims(NULL), m_p_vars(NULL), m_p_in_bits(NULL), m_p_nodes(NULL) {
+                        compile(ctrl_set, ctrl_bdd, ss_dim);
+                        set_pointers(m_image.data(), m_image.size());
+                    }
+
+                    /**
+                     * The mapping constructor, the file is mapped read only and shared
+                     * @param file_name the flat BDD file name
+                     */
+                    flat_bdd(const string & file_name)
+                    : m_image(), m_p_map(NULL), m_map_size(0), m_p_header(NULL),
+                    m_p_dims(NULL), m_p_vars(NULL), m_p_in_bits(NULL), m_p_nodes(NULL) {
+                        const int fd = open(file_name.c_str(), O_RDONLY);
+                        ASSERT_CONDITION_THROW((fd < 0), string("Could not open the flat BDD file: ") + file_name);
+                        struct stat file_stat = {};
+                        if ((fstat(fd, &file_stat) == 0) && (file_stat.st_size > 0)) {
+                            m_map_size = file_stat.st_size;
+                            m_p_map = mmap(NULL, m_map_size, PROT_READ, MAP_SHARED, fd, 0);
+                        }
+                        close(fd);
+                        if ((m_p_map == NULL) || (m_p_map == MAP_FAILED)) {
+                            m_p_map = NULL;
+                            THROW_EXCEPTION(string("Could not map the flat BDD file: ") + file_name);
+                        }
+                        set_pointers(static_cast<const char *> (m_p_map), m_map_size);
+                    }
+
+                    /**
+                     * The viewing constructor, the image is neither copied nor owned
+                     * @param p_data the image data, shall outlive the flat BDD
+                     * @param size the image size in bytes
+                     */
+                    flat_bdd(const char * p_data, const size_t size)
+                    : m_image(), m_p_map(NULL), m_map_size(0), m_p_header(NULL),
+                    m_p_dims(NULL), m_p_vars(NULL), m_p_in_bits(NULL), m_p_nodes(NULL) {
+                        set_pointers(p_data, size);
+                    }
+
+                    /**
+                     * The basic destructor
+                     */
+                    virtual ~flat_bdd() {
+                        if (m_p_map != NULL) {
+                            munmap(m_p_map, m_map_size);
+                            m_p_map = NULL;
+                        }
+                    }
+
+                    /**
+                     * Allows to store the flat BDD image into the file
+                     * @param file_name the flat BDD file name
+                     */
+                    void store(const string & file_name) const {
+                        ofstream file(file_name, ios::out | ios::binary | ios::trunc);
+                        ASSERT_CONDITION_THROW(!file.is_open(), string("Could not open the flat BDD file: ") + file_name);
+                        file.write(reinterpret_cast<const char *> (m_p_header), get_size());
+                        ASSERT_CONDITION_THROW(!file.good(), string("Could not write the flat BDD file: ") + file_name);
+                    }
+
+                    /**
+                     * Allows to get the inputs available in the state, thread safe, the
+                     * input ids are sorted and unique unless there are more of them than fit
+                     * @param state the state-space point, of the state-space dimensionality
+                     * @param input_ids the array to store the input ids
+                     * @param max_ids the maximum number of input ids to store
+                     * @return the number of available inputs, zero if the state is outside
+                     *         of the grid, can be larger than max_ids
+                     */
+                    inline size_t lookup(const double * state, abs_type * input_ids, const size_t max_ids) const {
+                        const uint32_t ss_dim = m_p_header->m_ss_dim;
+                        abs_type ss_dofs[FLAT_MAX_DIM];
+                        for (uint32_t dof = 0; dof < ss_dim; ++dof) {
+                            const flat_bdd_dim & dim = m_p_dims[dof];
+                            ss_dofs[dof] = static_cast<abs_type> (state[dof] * dim.m_eta_inv - dim.m_x2a_sh);
+                            if (ss_dofs[dof] >= dim.m_num_points) {
+                                return 0;
+                            }
+                        }
+                        size_t num_ids = 0;
+                        walk(m_p_header->m_root, ss_dofs, 0, 0, input_ids, max_ids, num_ids);
+                        if (num_ids <= max_ids) {
+                            sort(input_ids, input_ids + num_ids);
+                            num_ids = unique(input_ids, input_ids + num_ids) - input_ids;
+                        }
+                        return num_ids;
+                    }
+
+                    /**
+                     * Allows to convert the input id into the input-space point, thread safe
+                     * @param id the input id
+                     * @param input the array to store the input-space point, of the input-space dimensionality
+                     */
+                    inline void itox_input(abs_type id, double * input) const {
+                        const flat_bdd_dim * is_dims = m_p_dims + m_p_header->m_ss_dim;
+                        for (int32_t dof = m_p_header->m_is_dim - 1; dof >= 0; --dof) {
+                            const abs_type num = id / is_dims[dof].m_nn;
+                            id = id % is_dims[dof].m_nn;
+                            input[dof] = is_dims[dof].m_first + num * is_dims[dof].m_eta;
+                        }
+                    }
+
+                    /**
+                     * Allows to get the number of state-space dimensions
+                     * @return the number of state-space dimensions
+                     */
+                    inline int32_t get_ss_dim() const {
+                        return m_p_header->m_ss_dim;
+                    }
+
+                    /**
+                     * Allows to get the number of input-space dimensions
+                     * @return the number of input-space dimensions
+                     */
+                    inline int32_t get_is_dim() const {
+                        return m_p_header->m_is_dim;
+                    }
+
+                    /**
+                     * Allows to get the grid dimensions, the state ones and then the input ones
+                     * @return the pointer to the grid dimensions
+                     */
+                    inline const flat_bdd_dim * get_dims() const {
+                        return m_p_dims;
+                    }
+
+                    /**
+                     * Allows to check the consistency of the whole image, so that the lookups can
+                     * not run out of the image bounds or loop. Is linear in the number of nodes.
+                     * @throws tud_exception if the image is not consistent
+                     */
+                    void validate() const {
+                        const uint32_t ss_dim = m_p_header->m_ss_dim;
+                        const uint32_t is_dim = m_p_header->m_is_dim;
+                        const uint32_t num_in_bits = m_p_header->m_num_in_bits;
+                        ASSERT_CONDITION_THROW((ss_dim == 0) || (is_dim == 0) || (m_p_header->m_num_nodes < 2),
+                                "The flat BDD image has no dimensions or constants!");
+                        for (uint32_t dof = 0; dof < ss_dim + is_dim; ++dof) {
+                            ASSERT_CONDITION_THROW(!(m_p_dims[dof].m_eta > 0) || (m_p_dims[dof].m_num_points == 0) ||
+                                    (m_p_dims[dof].m_nn == 0), string("The flat BDD image has a bad dimension: ") +
+                                    to_string(dof));
+                        }
+                        for (uint32_t idx = 0; idx < num_in_bits; ++idx) {
+                            ASSERT_CONDITION_THROW((m_p_in_bits[idx].m_dof >= is_dim) ||
+                                    (m_p_in_bits[idx].m_bit >= FLAT_MAX_IN_BITS),
+                                    string("The flat BDD image has a bad input bit: ") + to_string(idx));
+                        }
+                        for (uint32_t idx = 0; idx < m_p_header->m_num_vars; ++idx) {
+                            const flat_bdd_var & var = m_p_vars[idx];
+                            ASSERT_CONDITION_THROW((var.m_dof != FLAT_UNUSED_DOF) && ((var.m_dof >= ss_dim + is_dim) ||
+                                    ((var.m_dof < ss_dim) && (var.m_bit >= FLAT_MAX_IN_BITS)) ||
+                                    ((var.m_dof >= ss_dim) && (var.m_bit >= num_in_bits))),
+                                    string("The flat BDD image has a bad variable: ") + to_string(idx));
+                        }
+                        //The parents come before the children, so the walks always terminate
+                        for (uint32_t idx = FLAT_BDD_ONE + 1; idx < m_p_header->m_num_nodes; ++idx) {
+                            const flat_bdd_node & node = m_p_nodes[idx];
+                            ASSERT_CONDITION_THROW((node.m_var >= m_p_header->m_num_vars) ||
+                                    ((node.m_then > FLAT_BDD_ONE) && (node.m_then <= idx)) ||
+                                    ((node.m_else > FLAT_BDD_ONE) && (node.m_else <= idx)) ||
+                                    (node.m_then >= m_p_header->m_num_nodes) ||
+                                    (node.m_else >= m_p_header->m_num_nodes),
+                                    string("The flat BDD image has a bad node: ") + to_string(idx));
+                        }
+                    }
+
+                    /**
+                     * Allows to get the number of nodes, including the two constants
+                     * @return the number of nodes
+                     */
+                    inline size_t get_num_nodes() const {
+                        return m_p_header->m_num_nodes;
+                    }
+
+                    /**
+                     * Allows to get the image size
+                     * @return the image size in bytes
+                     */
+                    inline size_t get_size() const {
+                        return get_size(*m_p_header);
+                    }
+
+                    /**
+                     * Allows to get the image data
+                     * @return the pointer to the image data, of get_size() bytes
+                     */
+                    inline const char * get_data() const {
+                        return reinterpret_cast<const char *> (m_p_header);
+                    }
+
+                private:
+                    //Stores the compiled image, if not mapped
+                    vector<char> m_image;
+                    //Stores the mapped image, if mapped
+                    void * m_p_map;
+                    //Stores the mapped image size
+                    size_t m_map_size;
+                    //Stores the image header
+                    const flat_bdd_header * m_p_header;
+                    //Stores the image dimensions
+                    const flat_bdd_dim * m_p_dims;
+                    //Stores the image variables
+                    const flat_bdd_var * m_p_vars;
+                    //Stores the image input bits
+                    const flat_bdd_var * m_p_in_bits;
+                    //Stores the image nodes
+                    const flat_bdd_node * m_p_nodes;
+
+                    /**
+                     * Allows to compute the image size
+                     * @param header the image header
+                     * @return the image size in bytes
+                     */
+                    static inline size_t get_size(const flat_bdd_header & header) {
+                        return sizeof (flat_bdd_header)
+                                + (header.m_ss_dim + header.m_is_dim) * sizeof (flat_bdd_dim)
+                                + (header.m_num_vars + header.m_num_in_bits) * sizeof (flat_bdd_var)
+                                + header.m_num_nodes * sizeof (flat_bdd_node);
+                    }
+
+                    /**
+                     * Allows to check the image and to set the section pointers
+                     * @param p_data the image data
+                     * @param size the image size in bytes
+                     */
+                    void set_pointers(const char * p_data, const size_t size) {
+                        ASSERT_CONDITION_THROW((size < sizeof (flat_bdd_header)), "The flat BDD image is truncated!");
+                        m_p_header = reinterpret_cast<const flat_bdd_header *> (p_data);
+                        ASSERT_CONDITION_THROW((m_p_header->m_magic != FLAT_BDD_MAGIC),
+                                "The flat BDD image has a wrong magic number!");
+                        ASSERT_CONDITION_THROW((size != get_size(*m_p_header)) ||
+                                (m_p_header->m_num_in_bits > FLAT_MAX_IN_BITS) ||
+                                (m_p_header->m_ss_dim > FLAT_MAX_DIM) || (m_p_header->m_is_dim > FLAT_MAX_DIM) ||
+                                (m_p_header->m_root >= m_p_header->m_num_nodes),
+                                "The flat BDD image is corrupted!");
+                        m_p_dims = reinterpret_cast<const flat_bdd_dim *> (m_p_header + 1);
+                        m_p_vars = reinterpret_cast<const flat_bdd_var *> (m_p_dims + m_p_header->m_ss_dim + m_p_header->m_is_dim);
+                        m_p_in_bits = m_p_vars + m_p_header->m_num_vars;
+                        m_p_nodes = reinterpret_cast<const flat_bdd_node *> (m_p_in_bits + m_p_header->m_num_in_bits);
+                    }
+
+                    /**
+                     * Allows to compile the BDD into the image
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD
+                     * @param ss_dim the number of state-space dimensions
+                     */
+                    void compile(const SymbolicSet & ctrl_set, const BDD & ctrl_bdd, const int32_t ss_dim) {
+                        const int32_t is_dim = ctrl_set.get_dim() - ss_dim;
+                        ASSERT_CONDITION_THROW((ss_dim <= 0) || (is_dim <= 0),
+                                string("Improper state-space dimensionality: ") + to_string(ss_dim));
+
+                        //Collect the grid dimensions and the variables
+                        vector<flat_bdd_dim> dims;
+                        get_flat_dims(ctrl_set, ss_dim, dims);
+                        vector<flat_bdd_var> index_vars, in_bits;
+                        get_flat_vars(ctrl_set, ss_dim, ctrl_bdd.manager(), index_vars, in_bits);
+
+                        //Flatten the nodes
+                        vector<flat_bdd_var> vars;
+                        vector<flat_bdd_node> nodes;
+                        vector<uint32_t> root_ids;
+                        flatten_bdds(ctrl_bdd.manager(), vector<DdNode *>(1, ctrl_bdd.getNode()),
+                                index_vars, vars, nodes, root_ids);
+
+                        //Create the image
+                        flat_bdd_header header = {FLAT_BDD_MAGIC, (uint32_t) ss_dim, (uint32_t) is_dim,
+                            (uint32_t) vars.size(), (uint32_t) in_bits.size(), (uint32_t) nodes.size(), root_ids[0], 0};
+                        m_image.resize(get_size(header));
+                        char * p_data = m_image.data();
+                        p_data = copy_data(p_data, &header, 1);
+                        p_data = copy_data(p_data, dims.data(), dims.size());
+                        p_data = copy_data(p_data, vars.data(), vars.size());
+                        p_data = copy_data(p_data, in_bits.data(), in_bits.size());
+                        p_data = copy_data(p_data, nodes.data(), nodes.size());
+
+                        LOG_INFO << "Compiled the BDD of " << ctrl_bdd.nodeCount() << " CUDD nodes into "
+                                << header.m_num_nodes << " flat nodes, " << m_image.size() << " bytes" << END_LOG;
+                    }
+
+                    /**
+                     * Allows to copy the data into the image
+                     * @param p_dst the image position
+                     * @param p_src the data
+                     * @param num the number of data elements
+                     * @return the next image position
+                     */
+                    template<typename data_type>
+                    static inline char * copy_data(char * p_dst, const data_type * p_src, const size_t num) {
+                        memcpy(p_dst, p_src, num * sizeof (data_type));
+                        return p_dst + num * sizeof (data_type);
+                    }
+
+                    /**
+                     * Allows to walk the flat BDD collecting the input cubes
+                     * @param node_id the current node index
+                     * @param ss_dofs the state-space dof ids
+                     * @param value the assigned input bit values
+                     * @param care the mask of the assigned input bits
+                     * @param input_ids the array to store the input ids
+                     * @param max_ids the maximum number of input ids to store
+                     * @param num_ids the number of found input ids
+                     */
+                    void walk(uint32_t node_id, const abs_type * ss_dofs, uint64_t value, uint64_t care,
+                            abs_type * input_ids, const size_t max_ids, size_t & num_ids) const {
+                        const uint32_t ss_dim = m_p_header->m_ss_dim;
+                        while (node_id > FLAT_BDD_ONE) {
+                            const flat_bdd_node & node = m_p_nodes[node_id];
+                            const flat_bdd_var & var = m_p_vars[node.m_var];
+                            if (var.m_dof < ss_dim) {
+                                //The state variable is fixed by the state
+                                node_id = ((ss_dofs[var.m_dof] >> var.m_bit) & 1) ? node.m_then : node.m_else;
+                            } else if (var.m_dof == FLAT_UNUSED_DOF) {
+                                //The foreign variable is existentially abstracted
+                                walk(node.m_then, ss_dofs, value, care, input_ids, max_ids, num_ids);
+                                node_id = node.m_else;
+                            } else {
+                                //The input variable gets both of its values
+                                const uint64_t mask = ((uint64_t) 1) << var.m_bit;
+                                walk(node.m_then, ss_dofs, value | mask, care | mask, input_ids, max_ids, num_ids);
+                                node_id = node.m_else;
+                                care |= mask;
+                            }
+                        }
+                        if (node_id == FLAT_BDD_ONE) {
+                            expand_cube(value, care, input_ids, max_ids, num_ids);
+                        }
+                    }
+
+                    /**
+                     * Allows to expand the input cube into the input ids
+                     * @param value the assigned input bit values
+                     * @param care the mask of the assigned input bits
+                     * @param input_ids the array to store the input ids
+                     * @param max_ids the maximum number of input ids to store
+                     * @param num_ids the number of found input ids
+                     */
+                    void expand_cube(const uint64_t value, const uint64_t care,
+                            abs_type * input_ids, const size_t max_ids, size_t & num_ids) const {
+                        const uint32_t num_bits = m_p_header->m_num_in_bits;
+                        const uint32_t is_dim = m_p_header->m_is_dim;
+                        const flat_bdd_dim * is_dims = m_p_dims + m_p_header->m_ss_dim;
+                        const uint64_t all = (num_bits == FLAT_MAX_IN_BITS) ? ~((uint64_t) 0)
+                                : ((((uint64_t) 1) << num_bits) - 1);
+                        const uint64_t dont_care = all & ~care;
+
+                        //Iterate over all the subsets of the don't care bits
+                        abs_type is_dofs[FLAT_MAX_DIM];
+                        uint64_t sub = dont_care;
+                        while (true) {
+                            const uint64_t bits = value | sub;
+                            fill(is_dofs, is_dofs + is_dim, 0);
+                            for (uint32_t idx = 0; idx < num_bits; ++idx) {
+                                if ((bits >> idx) & 1) {
+                                    is_dofs[m_p_in_bits[idx].m_dof] |= ((abs_type) 1) << m_p_in_bits[idx].m_bit;
+                                }
+                            }
+                            abs_type id = 0;
+                            bool is_on_grid = true;
+                            for (uint32_t dof = 0; dof < is_dim; ++dof) {
+                                is_on_grid = is_on_grid && (is_dofs[dof] < is_dims[dof].m_num_points);
+                                id += is_dofs[dof] * is_dims[dof].m_nn;
+                            }
+                            if (is_on_grid) {
+                                if (num_ids < max_ids) {
+                                    input_ids[num_ids] = id;
+                                }
+                                ++num_ids;
+                            }
+                            if (sub == 0) {
+                                break;
+                            }
+                            sub = (sub - 1) & dont_care;
+                        }
+                    }
+                };
+            }
+        }
+    }
+}
+
+#endif /* FLAT_BDD_HPP */
@@ -82,7 +82,7 @@ namespace tud {
                      * method. The process is to be finalized by calling on points_finished.
                      */
                     greedy_estimator()
-                    : m_p_inp_sets(NULL), m_inp_to_st() {
+                    : m_p_inp_sets(NULL), m_inp_to_st(), m_prior_cnt() {
                         LOG_DEBUG3 << "Creating greedy estimator: " << this << END_LOG;
                     }
 
@@ -168,6 +168,18 @@ namespace tud {
                         REPORT_STATS(string("Creating abstraction"));
                     }
 
+                    /**
+                     * Allows to warm start the set cover with the previous determinization. The number
+                     * of states the previous determinization kept for an input is added to the input's
+                     * set size, so the inputs chosen before are preferred in the same order.
+                     * @param prior_cnt the mapping from the input ids to the numbers of kept states
+                     */
+                    void set_prior_counts(const map_id_to_cnt & prior_cnt) {
+                        m_prior_cnt = prior_cnt;
+                        LOG_INFO << "Warm starting the set cover with " << m_prior_cnt.size()
+                                 << " previously chosen input ids" << END_LOG;
+                    }
+
                     /**
                      * The basic destructor.
                      */
@@ -255,6 +267,10 @@ namespace tud {
                     //and the input sets that overlap with some other ones.
                     map_id_to_ids m_inp_to_st;
                     
+                    //Stores the number of states the previous determinization
+                    //kept per input id, empty unless warm started
+                    map_id_to_cnt m_prior_cnt;
+                    
                     /**
                      * Allows to get access to static function container variable
                      * @return the reference to a static function variable
@@ -290,8 +306,10 @@ namespace tud {
                             LOG_DEBUG2 << "Considering input id: " << elem.first << " of "
                                        << states.size() << " internal states" << END_LOG;
                             
-                            //Compute the actual set size
-                            const size_t set_size = count_act_states(states);
+                            //Compute the actual set size, with the warm start states
+                            const auto prior_iter = m_prior_cnt.find(elem.first);
+                            const size_t set_size = count_act_states(states) +
+                                    ((prior_iter != m_prior_cnt.end()) ? prior_iter->second : 0);
                             
                             LOG_DEBUG2 << "Input id: " << elem.first << " has "
                                        << set_size << " actual states" << END_LOG;
@@ -104,6 +104,7 @@ namespace tud {
                         //Iterate orver the states, get the corresponding
                         //inputs and add them to the estimator set by ids
                         auto state_begin = all_states.begin();
+                        trace_span batch_span("Extracting states batch", TRACE_BATCH_SIZE);
                         for(int i = 0; i < num_states; ++i) {
                             //Get a new state vector
                             state.assign(state_begin, state_begin + ss_dim);
@@ -121,7 +122,9 @@ namespace tud {
                             
                             //Move forward in the list of states
                             state_begin += ss_dim;
+                            batch_span.next();
                         }
+                        batch_span.finish();
                         
                         //Finalize the initial estimator creation
                         m_det_est.points_finished();
@@ -136,6 +139,15 @@ namespace tud {
                     virtual ~greedy_optimizer() {
                     }
                     
+                    /**
+                     * Allows to warm start the determinization with the previous one
+                     * @param prior_cnt the mapping from the input ids to the
+                     *                  numbers of states kept with them
+                     */
+                    void warm_start(const map_id_to_cnt & prior_cnt) {
+                        m_det_est.set_prior_counts(prior_cnt);
+                    }
+                    
                     /**
                      * Allows to optimize the controller by performing determinization in
                      * such a way that it minimizes the resulting BDD size.
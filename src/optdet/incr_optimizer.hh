@@ -0,0 +1,227 @@
+/*
+ * File:   incr_optimizer.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 30, 2018, 2:40 PM
+ */
+
+#ifndef INCR_OPTIMIZER_HPP
+#define INCR_OPTIMIZER_HPP
+
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "monitor.hh"
+
+#include "ctrl_data.hh"
+#include "inputs_mgr.hh"
+#include "states_mgr.hh"
+#include "greedy_estimator.hh"
+#include "greedy_optimizer.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+using namespace tud::utils::monitor;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                /**
+                 * This class re-determinizes the re-synthesized controller using the previous
+                 * determinization. The previous choices still allowed by the controller are
+                 * kept, only the remaining states, which are new or lost their previous
+                 * choice, are determinized with the given optimizer. The greedy optimizer is
+                 * warm started with the inputs of the kept choices.
+                 */
+                template<class optimizer_type>
+                class incr_optimizer {
+                public:
+
+                    /**
+                     * The basic constructor
+                     * @param cudd_mgr the cudd manager to be used
+                     * @param input_ctrl the controller's data
+                     * @param prev_src_ctrl the previous source controller's data
+                     * @param prev_det_ctrl the previous determinized controller's data
+                     */
+                    incr_optimizer(const Cudd & cudd_mgr, const ctrl_data & input_ctrl,
+                                   const ctrl_data & prev_src_ctrl, const ctrl_data & prev_det_ctrl)
+                    : m_cudd_mgr(cudd_mgr), m_input_ctrl(input_ctrl), m_is_mgr(input_ctrl.m_ctrl_set, input_ctrl.m_ss_dim),
+                    m_num_ss_vars(0), m_is_cube(), m_kept_bdd(), m_region_ctrl() {
+                        //Declare the statistics data
+                        DECLARE_MONITOR_STATS;
+
+                        //Get the beginning statistics data
+                        INITIALIZE_STATS;
+
+                        //The previous controllers must be over the same grid and BDD variables
+                        check_same_grid(prev_src_ctrl, "source");
+                        check_same_grid(prev_det_ctrl, "determinized");
+
+                        //Get the cube of the input-space variables and the number of state-space variables
+                        m_is_cube = m_is_mgr.get_inputs_set().get_cube(cudd_mgr);
+                        unique_ptr<SymbolicSet> p_ss_set(states_mgr::get_states_set(input_ctrl.m_ctrl_set,
+                                                                                    input_ctrl.m_ss_dim));
+                        m_num_ss_vars = p_ss_set->get_no_bdd_vars();
+
+                        //Compute the symbolic difference of the sources, for the statistics
+                        const BDD diff_bdd = (input_ctrl.m_ctrl_bdd ^ prev_src_ctrl.m_ctrl_bdd).ExistAbstract(m_is_cube);
+
+                        //Keep the previous choices which are still allowed
+                        m_kept_bdd = prev_det_ctrl.m_ctrl_bdd & input_ctrl.m_ctrl_bdd;
+                        const BDD kept_states = m_kept_bdd.ExistAbstract(m_is_cube);
+                        ASSERT_CONDITION_THROW((m_kept_bdd.CountMinterm(input_ctrl.m_ctrl_set.get_no_bdd_vars()) !=
+                                                kept_states.CountMinterm(m_num_ss_vars)),
+                                               string("The previous determinized controller is not deterministic!"));
+
+                        //The remaining states of the domain are to be re-determinized
+                        m_region_ctrl.m_ss_dim = input_ctrl.m_ss_dim;
+                        m_region_ctrl.m_ctrl_set = input_ctrl.m_ctrl_set;
+                        m_region_ctrl.m_ctrl_bdd = input_ctrl.m_ctrl_bdd & !kept_states;
+
+                        LOG_USAGE << "The sources differ in " << count_states(diff_bdd) << " states, kept "
+                        << count_states(kept_states) << " previous choices, re-determinizing "
+                        << count_states(m_region_ctrl.m_ctrl_bdd) << " states" << END_LOG;
+
+                        //Get the end stats and log them
+                        REPORT_STATS(string("Computing controllers difference"));
+                    }
+
+                    /**
+                     * The basic destructor
+                     */
+                    virtual ~incr_optimizer() {
+                    }
+
+                    /**
+                     * Allows to optimize the controller by re-determinizing its changed states
+                     * @param output_ctrl the resulting controller to be filled in
+                     */
+                    void optimize(ctrl_data & output_ctrl) {
+                        //Copy the symbolic set data
+                        output_ctrl.m_ctrl_set = m_input_ctrl.m_ctrl_set;
+                        output_ctrl.m_ctrl_bdd = m_kept_bdd;
+
+                        //There is nothing to re-determinize if all choices are kept
+                        if(m_region_ctrl.m_ctrl_bdd != m_cudd_mgr.bddZero()) {
+                            //Determinize the remaining states
+                            ctrl_data det_ctrl;
+                            optimizer_type opt(m_cudd_mgr, m_region_ctrl);
+                            warm_start(opt);
+                            opt.optimize(det_ctrl);
+
+                            //The determinized BDD may cover the states outside of the
+                            //region, keep it within the region for the merge
+                            output_ctrl.m_ctrl_bdd |= det_ctrl.m_ctrl_bdd &
+                                    m_region_ctrl.m_ctrl_bdd.ExistAbstract(m_is_cube);
+                        }
+                    }
+
+                protected:
+
+                    /**
+                     * Allows to check that the previous controller has the same grid as the current one
+                     * @param prev_ctrl the previous controller
+                     * @param name the previous controller name for the error message
+                     */
+                    inline void check_same_grid(const ctrl_data & prev_ctrl, const string & name) const {
+                        const SymbolicSet & cur_set = m_input_ctrl.m_ctrl_set;
+                        const SymbolicSet & prev_set = prev_ctrl.m_ctrl_set;
+                        ASSERT_CONDITION_THROW((cur_set.get_bdd_var_ids() != prev_set.get_bdd_var_ids()) ||
+                                               (cur_set.get_lower_left() != prev_set.get_lower_left()) ||
+                                               (cur_set.get_eta() != prev_set.get_eta()) ||
+                                               (cur_set.get_no_gp_per_dim() != prev_set.get_no_gp_per_dim()),
+                                               string("The previous ") + name +
+                                               string(" controller's grid differs from the controller's one!"));
+                    }
+
+                    /**
+                     * Allows to count the states of the BDD over the controller's variables
+                     * @param bdd the BDD to count the states of
+                     * @return the number of states
+                     */
+                    inline uint64_t count_states(const BDD & bdd) const {
+                        return static_cast<uint64_t> (bdd.ExistAbstract(m_is_cube).CountMinterm(m_num_ss_vars));
+                    }
+
+                    /**
+                     * The optimizers other than greedy are not warm started
+                     * @param opt the optimizer
+                     */
+                    template<class other_optimizer_type>
+                    inline void warm_start(other_optimizer_type & /*opt*/) {
+                    }
+
+                    /**
+                     * Allows to warm start the greedy optimizer with the number of kept states per input
+                     * @param opt the optimizer
+                     */
+                    inline void warm_start(greedy_optimizer & opt) {
+                        //Get the input ids of the kept choices
+                        unique_ptr<SymbolicSet> p_ss_set(states_mgr::get_states_set(m_input_ctrl.m_ctrl_set,
+                                                                                    m_input_ctrl.m_ss_dim));
+                        const BDD is_bdd = m_kept_bdd.ExistAbstract(p_ss_set->get_cube(m_cudd_mgr));
+                        const vector<double> kept_inputs = m_is_mgr.get_inputs_set().bdd_to_grid_points(m_cudd_mgr, is_bdd);
+                        set<abs_type> input_ids;
+                        m_is_mgr.get_input_ids(kept_inputs, input_ids);
+
+                        //Count the kept states per input
+                        map_id_to_cnt prior_cnt;
+                        for(const abs_type input_id : input_ids) {
+                            prior_cnt[input_id] = count_states(m_kept_bdd & m_is_mgr.id_to_bdd(input_id));
+                        }
+                        opt.warm_start(prior_cnt);
+                    }
+
+                private:
+                    //Stores the reference to the CUDD manage
+                    const Cudd & m_cudd_mgr;
+                    //Stores the reference to the original controller
+                    const ctrl_data & m_input_ctrl;
+                    //Stores the controller's inputs manager
+                    inputs_mgr m_is_mgr;
+                    //Stores the number of state-space BDD variables
+                    int m_num_ss_vars;
+                    //Stores the cube of the input-space variables
+                    BDD m_is_cube;
+                    //Stores the kept previous choices
+                    BDD m_kept_bdd;
+                    //Stores the part of the controller to be re-determinized
+                    ctrl_data m_region_ctrl;
+                };
+
+            }
+        }
+    }
+}
+
+#endif /* INCR_OPTIMIZER_HPP */
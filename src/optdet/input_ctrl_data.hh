@@ -69,6 +69,17 @@ namespace tud {
                         m_cudd_mgr.AutodynDisable();
                     }
                     
+                    /**
+                     * The constructor with the configured CUDD manager
+                     * @param cudd_mgr the CUDD manager to use
+                     */
+                    input_ctrl_data(const Cudd & cudd_mgr)
+                    : m_ss_dim(0), m_cudd_mgr(cudd_mgr),
+                    m_ctrl_set(), m_ctrl_bdd() {
+                        //Disable automatic variable ordering
+                        m_cudd_mgr.AutodynDisable();
+                    }
+                    
                     /**
                      * Allows to load the SCOTS v2.0 BDD controller
                      * @param source_file the controller's file name to load
@@ -219,6 +230,14 @@ namespace tud {
                                    << m_ctrl_bdd.nodeCount() << END_LOG;
                     }
                     
+                    /**
+                     * Allows to get the CUDD manager of the controller
+                     * @return the CUDD manager
+                     */
+                    const Cudd & get_cudd_mgr() const {
+                        return m_cudd_mgr;
+                    }
+                    
                     /**
                      * The basic constructor
                      */
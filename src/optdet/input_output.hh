@@ -43,6 +43,9 @@
 #include "inputs_mgr.hh"
 #include "states_mgr.hh"
 #include "bdd_decoder.hh"
+#include "dense_table.hh"
+#include "ctrl_add.hh"
+#include "rect_cover.hh"
 
 using namespace std;
 using namespace scots;
@@ -64,7 +67,13 @@ namespace tud {
                     bdd_const = sco_const + 1,
                     sco_lin = bdd_const + 1,
                     bdd_lin = sco_lin + 1,
-                    store_type_enum_size = bdd_lin + 1
+                    dense_sco = bdd_lin + 1,
+                    dense_morton = dense_sco + 1,
+                    mtbdd = dense_morton + 1,
+                    dont_care = mtbdd + 1,
+                    approx = dont_care + 1,
+                    rect = approx + 1,
+                    store_type_enum_size = rect + 1
                 };
                 
                 static void load_controller_bdd(const Cudd & cudd_mgr,
@@ -117,6 +126,11 @@ namespace tud {
                         << input_ctrl.m_ctrl_bdd.nodeCount()
                         << " nodes." << END_LOG;
                     } else {
+                        //The DDDMP loader does not report the CUDD errors, check for the memory limit
+                        ASSERT_CONDITION_THROW((cudd_mgr.ReadErrorCode() == CUDD_MAX_MEM_EXCEEDED),
+                                               string("Controller files '") + source_file +
+                                               string(".scs/.bdd' do not fit into the CUDD memory limit, ") +
+                                               string("consider increasing the --cudd-max-mem value!"));
                         //throw an exception, the file could not be loaded
                         THROW_EXCEPTION(string("Controller files '") + source_file +
                                         string(".scs/.bdd' could not be loaded!"));
@@ -161,6 +175,42 @@ namespace tud {
                     REPORT_STATS(string("Storing controller"));
                 }
                 
+                /**
+                 * Allows to get the file name of the compressed controller
+                 * @param file_name the controller file name
+                 * @param type the compression type, one of sco_const, sco_lin, bdd_const, bdd_lin,
+                 *             dense_sco, dense_morton, mtbdd, dont_care, approx, rect; the dense tables get
+                 *             the .dtb extension and the rectangle cover gets the .rct extension
+                 * @return the compressed controller file name
+                 */
+                static inline string get_comp_file_name(const string & file_name,
+                                                        const store_type_enum type) {
+                    switch(type) {
+                        case store_type_enum::sco_const:
+                            return file_name + "_con";
+                        case store_type_enum::sco_lin:
+                            return file_name + "_lin";
+                        case store_type_enum::bdd_const:
+                            return file_name + "_bcon";
+                        case store_type_enum::bdd_lin:
+                            return file_name + "_blin";
+                        case store_type_enum::dense_sco:
+                            return file_name + "_dsco.dtb";
+                        case store_type_enum::dense_morton:
+                            return file_name + "_dmor.dtb";
+                        case store_type_enum::mtbdd:
+                            return file_name + "_add";
+                        case store_type_enum::dont_care:
+                            return file_name + "_dc";
+                        case store_type_enum::approx:
+                            return file_name + "_apx";
+                        case store_type_enum::rect:
+                            return file_name + "_rect.rct";
+                        default:
+                            THROW_EXCEPTION(string("Unsupported compression algorithm type: ") + to_string(type));
+                    }
+                }
+                
                 namespace _utils {
                     
                     //The convenience type definition
@@ -870,7 +920,7 @@ namespace tud {
                         
                         //Store the compressed BDD
                         store_controller(ext_cudd_mgr, ext_ctrl_set, ext_ctrl_bdd,
-                                         file_name + (is_linear ? "_lin" : "_con"));
+                                         get_comp_file_name(file_name, (is_linear ? sco_lin : sco_const)));
                     }
                     
                     static inline void store_bdd_comp_bdd(const Cudd & ini_cudd_mgr,
@@ -890,7 +940,216 @@ namespace tud {
                         
                         //Store the compressed BDD
                         store_controller(ext_cudd_mgr, ext_ctrl_set, ext_ctrl_bdd,
-                                         file_name + (is_linear ? "_blin" : "_bcon"));
+                                         get_comp_file_name(file_name, (is_linear ? bdd_lin : bdd_const)));
+                    }
+                    
+                    static inline void store_dense_table(const Cudd & ini_cudd_mgr,
+                                                         const SymbolicSet & ini_ctrl_set,
+                                                         const BDD & ini_ctrl_bdd,
+                                                         const string file_name,
+                                                         const size_t ss_dim,
+                                                         const store_type_enum type) {
+                        const dense_order_enum order = (type == store_type_enum::dense_morton) ?
+                                dense_order_enum::order_morton : dense_order_enum::order_sco;
+                        
+                        //Estimate whether the table pays off before enumerating the controller
+                        const size_t est_size = dense_table::estimate_size(ini_ctrl_set, ss_dim, order);
+                        const size_t bdd_size = dense_table::estimate_bdd_size(ini_ctrl_bdd);
+                        LOG_USAGE << "The estimated dense table size v.s. the flat BDD size: "
+                        << est_size << "/" << bdd_size << " bytes" << END_LOG;
+                        if(est_size > bdd_size) {
+                            LOG_WARNING << "The dense table is likely to be larger than the BDD!" << END_LOG;
+                        }
+                        
+                        //Build and store the table
+                        dense_table table(ini_cudd_mgr, ini_ctrl_set, ini_ctrl_bdd, ss_dim, order);
+                        const string table_fn = get_comp_file_name(file_name, type);
+                        table.store(table_fn);
+                        LOG_USAGE << "The resulting " << table_fn << " size: " << table.get_size()
+                        << " bytes, " << table.get_num_bits() << " bits per cell" << END_LOG;
+                    }
+                    
+                    static inline void store_add_ctrl(const Cudd & ini_cudd_mgr,
+                                                      const SymbolicSet & ini_ctrl_set,
+                                                      const BDD & ini_ctrl_bdd,
+                                                      const string file_name,
+                                                      const size_t ss_dim) {
+                        //Encode the controller, the ADD shares the manager and the variables
+                        const ADD ctrl = ctrl_add::from_relation(ini_cudd_mgr, ini_ctrl_set, ini_ctrl_bdd, ss_dim);
+                        
+                        //Store the ADD
+                        const string add_fn = get_comp_file_name(file_name, store_type_enum::mtbdd);
+                        ctrl_add::store(ini_ctrl_set, ctrl, add_fn);
+                        ifstream add_file((add_fn + string(".add")).c_str(), ifstream::ate | ifstream::binary);
+                        LOG_USAGE << "The resulting " << add_fn << ".add size: " << add_file.tellg() << " bytes" << END_LOG;
+                    }
+                    
+                    /**
+                     * Allows to minimize the controller using the states outside of its domain as don't cares.
+                     * The restrict, constrain, LI compaction and squeeze operators are tried and the smallest
+                     * result is taken. The minimized BDD only agrees with the controller on its domain, so
+                     * the domain has to be checked separately, e.g. with the domain BDD stored alongside.
+                     * @param ini_cudd_mgr the CUDD manager
+                     * @param ini_ctrl_set the controller's symbolic set
+                     * @param ini_ctrl_bdd the controller's BDD
+                     * @param ss_dim the number of state-space dimensions
+                     * @param dom_bdd the controller's domain BDD to be set
+                     * @return the minimized controller's BDD
+                     */
+                    static inline BDD dont_care_minimize(const Cudd & ini_cudd_mgr,
+                                                         const SymbolicSet & ini_ctrl_set,
+                                                         const BDD & ini_ctrl_bdd,
+                                                         const size_t ss_dim,
+                                                         BDD & dom_bdd) {
+                        //Get the domain, the complement thereof is the don't care set
+                        unique_ptr<SymbolicSet> p_is_set(inputs_mgr::get_inputs_set(ini_ctrl_set, ss_dim));
+                        dom_bdd = ini_ctrl_bdd.ExistAbstract(p_is_set->get_cube(ini_cudd_mgr));
+                        
+                        //Try the minimization operators, keep the smallest result
+                        const BDD results[] = {
+                            ini_ctrl_bdd.Restrict(dom_bdd),
+                            ini_ctrl_bdd.Constrain(dom_bdd),
+                            ini_ctrl_bdd.LICompaction(dom_bdd),
+                            ini_ctrl_bdd.Squeeze(ini_ctrl_bdd | !dom_bdd)
+                        };
+                        const char * const names[] = {"restrict", "constrain", "LI compaction", "squeeze"};
+                        size_t min_idx = 0;
+                        for (size_t idx = 0; idx < sizeof (names) / sizeof (names[0]); ++idx) {
+                            LOG_INFO << "The " << names[idx] << " result #nodes: " << results[idx].nodeCount() << END_LOG;
+                            if (results[idx].nodeCount() < results[min_idx].nodeCount()) {
+                                min_idx = idx;
+                            }
+                        }
+                        
+                        LOG_RESULT << "Don't care minimized controller size, #nodes: " << ini_ctrl_bdd.nodeCount()
+                        << " -> " << results[min_idx].nodeCount() << " (" << names[min_idx] << "), domain #nodes: "
+                        << dom_bdd.nodeCount() << END_LOG;
+                        
+                        return results[min_idx];
+                    }
+                    
+                    static inline void store_dc_min_bdd(const Cudd & ini_cudd_mgr,
+                                                        const SymbolicSet & ini_ctrl_set,
+                                                        const BDD & ini_ctrl_bdd,
+                                                        const string file_name,
+                                                        const size_t ss_dim) {
+                        //Minimize the controller
+                        BDD dom_bdd;
+                        const BDD min_bdd = dont_care_minimize(ini_cudd_mgr, ini_ctrl_set, ini_ctrl_bdd, ss_dim, dom_bdd);
+                        
+                        //Store the minimized BDD and its domain next to it
+                        const string dc_fn = get_comp_file_name(file_name, store_type_enum::dont_care);
+                        store_controller(ini_cudd_mgr, ini_ctrl_set, min_bdd, dc_fn);
+                        store_controller(ini_cudd_mgr, ini_ctrl_set, dom_bdd, dc_fn + string(".dom"));
+                    }
+                    
+                    /**
+                     * Allows to get the fraction of the controller's domain states lost by its sub-controller
+                     * @param is_cube the cube of the input-space BDD variables
+                     * @param num_ss_vars the number of the state-space BDD variables
+                     * @param dom_cnt the number of the controller's domain states
+                     * @param sub_bdd the sub-controller's BDD
+                     * @return the fraction of lost domain states, within [0,1]
+                     */
+                    static inline double get_lost_fraction(const BDD & is_cube, const int num_ss_vars,
+                                                           const double dom_cnt, const BDD & sub_bdd) {
+                        const double sub_cnt = sub_bdd.ExistAbstract(is_cube).CountMinterm(num_ss_vars);
+                        return (dom_cnt > 0.0) ? (dom_cnt - sub_cnt) / dom_cnt : 0.0;
+                    }
+                    
+                    /**
+                     * Allows to under-approximate the determinized controller losing at most the given
+                     * fraction of its domain states. The heavy branch and short paths subsetting and the
+                     * remapping under-approximation are tried, for each of them the node count threshold
+                     * is found by a binary search, the smallest result within the loss bound is taken.
+                     * The lost states are counted exactly as the minterms of the domain BDDs.
+                     * @param ini_cudd_mgr the CUDD manager
+                     * @param ini_ctrl_set the controller's symbolic set
+                     * @param ini_ctrl_bdd the determinized controller's BDD
+                     * @param ss_dim the number of state-space dimensions
+                     * @param max_loss the maximum fraction of the domain states to be lost
+                     * @return the under-approximated controller's BDD
+                     */
+                    static inline BDD approximate(const Cudd & ini_cudd_mgr,
+                                                  const SymbolicSet & ini_ctrl_set,
+                                                  const BDD & ini_ctrl_bdd,
+                                                  const size_t ss_dim,
+                                                  const double max_loss) {
+                        //Count the BDD variables
+                        const vector<IntegerInterval<abs_type>> ints = ini_ctrl_set.get_bdd_intervals();
+                        int num_ss_vars = 0, num_vars = 0;
+                        for (size_t dof = 0; dof < ints.size(); ++dof) {
+                            const int num_bits = static_cast<int> (ints[dof].get_bdd_var_ids().size());
+                            num_ss_vars += (dof < ss_dim) ? num_bits : 0;
+                            num_vars += num_bits;
+                        }
+                        
+                        //Count the domain states
+                        unique_ptr<SymbolicSet> p_is_set(inputs_mgr::get_inputs_set(ini_ctrl_set, ss_dim));
+                        const BDD is_cube = p_is_set->get_cube(ini_cudd_mgr);
+                        const double dom_cnt = ini_ctrl_bdd.ExistAbstract(is_cube).CountMinterm(num_ss_vars);
+                        
+                        //Search for the smallest threshold within the loss bound, per operator
+                        const char * const names[] = {"heavy branch", "short paths", "remap"};
+                        BDD best_bdd = ini_ctrl_bdd;
+                        double best_loss = 0.0;
+                        const char * best_name = "none";
+                        for (size_t op = 0; op < sizeof (names) / sizeof (names[0]); ++op) {
+                            int low = 0, high = ini_ctrl_bdd.nodeCount();
+                            while (low <= high) {
+                                const int thresh = low + (high - low) / 2;
+                                const BDD sub_bdd = (op == 0) ? ini_ctrl_bdd.SubsetHeavyBranch(num_vars, thresh) :
+                                        ((op == 1) ? ini_ctrl_bdd.SubsetShortPaths(num_vars, thresh, true) :
+                                         ini_ctrl_bdd.RemapUnderApprox(num_vars, thresh));
+                                const double loss = get_lost_fraction(is_cube, num_ss_vars, dom_cnt, sub_bdd);
+                                LOG_INFO1 << "The " << names[op] << " threshold: " << thresh << ", #nodes: "
+                                << sub_bdd.nodeCount() << ", lost: " << loss << END_LOG;
+                                if (loss <= max_loss) {
+                                    if (sub_bdd.nodeCount() < best_bdd.nodeCount()) {
+                                        best_bdd = sub_bdd;
+                                        best_loss = loss;
+                                        best_name = names[op];
+                                    }
+                                    high = thresh - 1;
+                                } else {
+                                    low = thresh + 1;
+                                }
+                            }
+                        }
+                        
+                        LOG_RESULT << "Approximated controller size, #nodes: " << ini_ctrl_bdd.nodeCount()
+                        << " -> " << best_bdd.nodeCount() << " (" << best_name << "), lost domain states: "
+                        << best_loss * dom_cnt << " of " << dom_cnt << " (" << best_loss * 100.0 << "%)" << END_LOG;
+                        
+                        return best_bdd;
+                    }
+                    
+                    static inline void store_rect_cover(const Cudd & ini_cudd_mgr,
+                                                        const SymbolicSet & ini_ctrl_set,
+                                                        const BDD & ini_ctrl_bdd,
+                                                        const string file_name,
+                                                        const size_t ss_dim) {
+                        //Build and store the cover
+                        rect_cover cover(ini_cudd_mgr, ini_ctrl_set, ini_ctrl_bdd, ss_dim);
+                        const string cover_fn = get_comp_file_name(file_name, store_type_enum::rect);
+                        cover.store(cover_fn);
+                        LOG_USAGE << "The resulting " << cover_fn << " size v.s. the flat BDD size: " << cover.get_size()
+                        << "/" << dense_table::estimate_bdd_size(ini_ctrl_bdd) << " bytes, "
+                        << cover.get_num_rects() << " rectangles" << END_LOG;
+                    }
+                    
+                    static inline void store_approx_bdd(const Cudd & ini_cudd_mgr,
+                                                        const SymbolicSet & ini_ctrl_set,
+                                                        const BDD & ini_ctrl_bdd,
+                                                        const string file_name,
+                                                        const size_t ss_dim,
+                                                        const double max_loss) {
+                        //Approximate the controller
+                        const BDD apx_bdd = approximate(ini_cudd_mgr, ini_ctrl_set, ini_ctrl_bdd, ss_dim, max_loss);
+                        
+                        //Store the approximated BDD
+                        store_controller(ini_cudd_mgr, ini_ctrl_set, apx_bdd,
+                                         get_comp_file_name(file_name, store_type_enum::approx));
                     }
                 }
                 
@@ -899,7 +1158,8 @@ namespace tud {
                                                  const BDD & ini_ctrl_bdd,
                                                  const string file_name,
                                                  const store_type_enum type,
-                                                 const size_t ss_dim = 0)
+                                                 const size_t ss_dim = 0,
+                                                 const double max_loss = 0.0)
                 __attribute__ ((unused));
                 
                 /**
@@ -912,14 +1172,22 @@ namespace tud {
                  * @param ss_dim the state-space dimensionality if "type == store_type_enum::sco_const"
                  *                                              or "type == store_type_enum::bdd_const"
                  *                                              or "type == store_type_enum::sco_lin"
-                 *                                              or "type == store_type_enum::bdd_lin".
+                 *                                              or "type == store_type_enum::bdd_lin"
+                 *                                              or "type == store_type_enum::dense_sco"
+                 *                                              or "type == store_type_enum::dense_morton"
+                 *                                              or "type == store_type_enum::mtbdd"
+                 *                                              or "type == store_type_enum::dont_care"
+                 *                                              or "type == store_type_enum::approx"
+                 *                                              or "type == store_type_enum::rect".
+                 * @param max_loss the maximum fraction of lost domain states if "type == store_type_enum::approx"
                  */
                 static void store_min_controller(const Cudd & ini_cudd_mgr,
                                                  const SymbolicSet & ini_ctrl_set,
                                                  const BDD & ini_ctrl_bdd,
                                                  const string file_name,
                                                  const store_type_enum type,
-                                                 const size_t ss_dim) {
+                                                 const size_t ss_dim,
+                                                 const double max_loss) {
                     //Declare the statistics data
                     DECLARE_MONITOR_STATS;
                     
@@ -968,6 +1236,38 @@ namespace tud {
                             REPORT_STATS(string("Linear compression on BDD ids and storing the controller"));
                             break;
                         }
+                        case store_type_enum::dense_sco:
+                        case store_type_enum::dense_morton: {
+                            LOG_USAGE << "Starting building and storing the dense table ..." << END_LOG;
+                            _utils::store_dense_table(ini_cudd_mgr, ini_ctrl_set, ini_ctrl_bdd,
+                                                      file_name, ss_dim, type);
+                            REPORT_STATS(string("Building and storing the dense table"));
+                            break;
+                        }
+                        case store_type_enum::mtbdd: {
+                            LOG_USAGE << "Starting ADD encoding and storing the controller ..." << END_LOG;
+                            _utils::store_add_ctrl(ini_cudd_mgr, ini_ctrl_set, ini_ctrl_bdd, file_name, ss_dim);
+                            REPORT_STATS(string("ADD encoding and storing the controller"));
+                            break;
+                        }
+                        case store_type_enum::dont_care: {
+                            LOG_USAGE << "Starting don't care minimization and storing the controller ..." << END_LOG;
+                            _utils::store_dc_min_bdd(ini_cudd_mgr, ini_ctrl_set, ini_ctrl_bdd, file_name, ss_dim);
+                            REPORT_STATS(string("Don't care minimization and storing the controller"));
+                            break;
+                        }
+                        case store_type_enum::approx: {
+                            LOG_USAGE << "Starting approximation and storing the controller ..." << END_LOG;
+                            _utils::store_approx_bdd(ini_cudd_mgr, ini_ctrl_set, ini_ctrl_bdd, file_name, ss_dim, max_loss);
+                            REPORT_STATS(string("Approximation and storing the controller"));
+                            break;
+                        }
+                        case store_type_enum::rect: {
+                            LOG_USAGE << "Starting building and storing the rectangle cover ..." << END_LOG;
+                            _utils::store_rect_cover(ini_cudd_mgr, ini_ctrl_set, ini_ctrl_bdd, file_name, ss_dim);
+                            REPORT_STATS(string("Building and storing the rectangle cover"));
+                            break;
+                        }
                         default: {
                             THROW_EXCEPTION(string("Unsupported compression algorithm type: ") + to_string(type));
                         }
@@ -0,0 +1,178 @@
+/*
+ * File:   latency_histogram.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on March 26, 2018, 15:20 PM
+ */
+
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <atomic>
+#include <string>
+#include <sstream>
+#include <cstdint>
+
+using namespace std;
+
+namespace tud {
+    namespace utils {
+        namespace monitor {
+
+            /**
+             * This class represents a thread safe latency histogram with
+             * logarithmic buckets: the bucket with index k counts the
+             * latencies within [2^k, 2^(k+1)) time units, the bucket
+             * with index zero also counts the latencies below one. The
+             * time unit is micro seconds unless given otherwise.
+             */
+            class latency_histogram {
+            public:
+                //The number of histogram buckets
+                static constexpr size_t NUM_BUCKETS = 40;
+
+                /**
+                 * The basic constructor
+                 * @param unit the time unit name, used for reporting
+                 */
+                latency_histogram(const string & unit = "us") : m_unit(unit), m_count(0), m_sum(0), m_max(0) {
+                    for (auto & bucket : m_buckets) {
+                        bucket = 0;
+                    }
+                }
+
+                /**
+                 * Allows to add the latency sample, thread safe
+                 * @param latency the latency in the time units
+                 */
+                inline void add(const uint64_t latency) {
+                    m_buckets[get_bucket(latency)].fetch_add(1, memory_order_relaxed);
+                    m_count.fetch_add(1, memory_order_relaxed);
+                    m_sum.fetch_add(latency, memory_order_relaxed);
+                    update_max(latency);
+                }
+
+                /**
+                 * Allows to add all the samples of another histogram of the same time unit, thread safe
+                 * @param other the histogram to add the samples of
+                 */
+                void add(const latency_histogram & other) {
+                    for (size_t idx = 0; idx < NUM_BUCKETS; ++idx) {
+                        m_buckets[idx].fetch_add(other.m_buckets[idx].load(memory_order_relaxed), memory_order_relaxed);
+                    }
+                    m_count.fetch_add(other.m_count.load(memory_order_relaxed), memory_order_relaxed);
+                    m_sum.fetch_add(other.m_sum.load(memory_order_relaxed), memory_order_relaxed);
+                    update_max(other.m_max.load(memory_order_relaxed));
+                }
+
+                /**
+                 * Allows to get the number of samples
+                 * @return the number of samples
+                 */
+                inline uint64_t get_count() const {
+                    return m_count.load(memory_order_relaxed);
+                }
+
+                /**
+                 * Allows to estimate the latency percentile as the upper
+                 * bound of the bucket the percentile falls into
+                 * @param percent the percentile, from (0, 100]
+                 * @return the latency percentile upper bound in the time units
+                 */
+                inline uint64_t get_percentile(const double percent) const {
+                    const uint64_t count = get_count();
+                    const uint64_t rank = (uint64_t) (count * percent / 100.0 + 0.5);
+                    uint64_t sum = 0;
+                    for (size_t idx = 0; idx < NUM_BUCKETS; ++idx) {
+                        sum += m_buckets[idx].load(memory_order_relaxed);
+                        if ((sum > 0) && (sum >= rank)) {
+                            return ((uint64_t) 1) << (idx + 1);
+                        }
+                    }
+                    return 0;
+                }
+
+                /**
+                 * Allows to get the textual histogram report, one line per non-empty bucket
+                 * @param name the histogram name
+                 * @return the report
+                 */
+                string report(const string & name) const {
+                    stringstream out;
+                    const uint64_t count = get_count();
+                    out << name << ": requests=" << count
+                            << ", mean=" << ((count > 0) ? (m_sum.load() / count) : 0)
+                            << " " << m_unit << ", max=" << m_max.load() << " " << m_unit
+                            << ", p50<=" << get_percentile(50) << " " << m_unit
+                            << ", p90<=" << get_percentile(90) << " " << m_unit
+                            << ", p99<=" << get_percentile(99) << " " << m_unit
+                            << ", p99.9<=" << get_percentile(99.9) << " " << m_unit << "\n";
+                    for (size_t idx = 0; idx < NUM_BUCKETS; ++idx) {
+                        const uint64_t num = m_buckets[idx].load(memory_order_relaxed);
+                        if (num > 0) {
+                            out << "  [" << ((idx == 0) ? 0 : (((uint64_t) 1) << idx)) << ", "
+                                    << (((uint64_t) 1) << (idx + 1)) << ") " << m_unit << ": " << num << "\n";
+                        }
+                    }
+                    return out.str();
+                }
+
+            private:
+                //Stores the time unit name
+                const string m_unit;
+                //Stores the buckets
+                atomic<uint64_t> m_buckets[NUM_BUCKETS];
+                //Stores the number of samples
+                atomic<uint64_t> m_count;
+                //Stores the sum of all the latencies
+                atomic<uint64_t> m_sum;
+                //Stores the maximum latency
+                atomic<uint64_t> m_max;
+
+                /**
+                 * Allows to update the maximum latency, thread safe
+                 * @param latency the latency in the time units
+                 */
+                inline void update_max(const uint64_t latency) {
+                    uint64_t max = m_max.load(memory_order_relaxed);
+                    while ((latency > max) &&
+                            !m_max.compare_exchange_weak(max, latency, memory_order_relaxed)) {
+                    }
+                }
+
+                /**
+                 * Allows to get the bucket index for the latency
+                 * @param latency the latency in the time units
+                 * @return the bucket index
+                 */
+                static inline size_t get_bucket(uint64_t latency) {
+                    size_t idx = 0;
+                    while ((latency >>= 1) && (idx < NUM_BUCKETS - 1)) {
+                        ++idx;
+                    }
+                    return idx;
+                }
+            };
+        }
+    }
+}
+
+#endif /* LATENCY_HISTOGRAM_HPP */
@@ -28,6 +28,8 @@
 
 #include <string>
 
+#include "cudd_config.hh"
+
 using namespace std;
 
 namespace tud {
@@ -52,6 +54,8 @@ namespace tud {
                     //True if we are requested to perform BDD variable
                     //reordering to optimize the end controller size
                     bool m_is_reorder;
+                    //The CUDD manager configuration
+                    cudd_config m_cudd;
                     //Stores the over and undershoot points percent
                     float m_overs_pct;
                 };
@@ -38,6 +38,8 @@
 #include <time.h>    // std::clock std::clock_t
 #include <string.h>
 
+#include "async_logger.hh"
+
 using namespace std;
 
 namespace tud {
@@ -72,6 +74,34 @@ namespace tud {
                     static recursive_mutex mv;
                     return mv;
                 }
+
+                /**
+                 * This is the logging lock guard, it only locks the mutex if
+                 * the asynchronous logging is off, otherwise the messages are
+                 * formatted into the thread local streams without locking
+                 */
+                struct log_scoped_lock {
+                    //True if the mutex is locked
+                    const bool m_is_locked;
+
+                    /**
+                     * The basic constructor, locks the mutex if needed
+                     */
+                    log_scoped_lock() : m_is_locked(!async_logger::is_on()) {
+                        if (m_is_locked) {
+                            m_mv().lock();
+                        }
+                    }
+
+                    /**
+                     * The basic destructor, unlocks the mutex if locked
+                     */
+                    ~log_scoped_lock() {
+                        if (m_is_locked) {
+                            m_mv().unlock();
+                        }
+                    }
+                };
             };
 
             //This Macro is used to convert numerival values to proper strings!
@@ -89,7 +119,7 @@ namespace tud {
   if (level > MAXIMUM_LOGGING_LEVEL) ;                             \
   else if (level > logger::get_reporting_level()) ;                 \
        else {                                                       \
-            logging_synch::rec_scoped_lock lock(logging_synch::m_mv()); \
+            logging_synch::log_scoped_lock lock;                        \
             logger::get(level)
 
 #define __FILENAME__ (strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : __FILE__)
@@ -98,7 +128,7 @@ namespace tud {
   if (level > MAXIMUM_LOGGING_LEVEL) ;                                 \
   else if (level > logger::get_reporting_level()) ;                     \
        else {                                                           \
-            logging_synch::rec_scoped_lock lock(logging_synch::m_mv());     \
+            logging_synch::log_scoped_lock lock;                            \
             logger::get(level, __FILENAME__, __FUNCTION__, LINE_STRING)
 
             //The Macro commands to be used for logging data with different log levels,
@@ -251,7 +281,7 @@ namespace tud {
                  * @return the output stream object
                  */
                 static inline std::ostream& get(debug_levels_enum level) {
-                    return cout << m_debug_level_str()[level] << ":" << WHITE_SPACE_SEPARATOR;
+                    return get_stream() << m_debug_level_str()[level] << ":" << WHITE_SPACE_SEPARATOR;
                 }
 
                 /**
@@ -263,10 +293,29 @@ namespace tud {
                  * @return the output stream object
                  */
                 static inline std::ostream& get(debug_levels_enum level, const char * file, const char * func, const char * line) {
-                    return cout << m_debug_level_str()[level] << WHITE_SPACE_SEPARATOR << "<"
+                    return get_stream() << m_debug_level_str()[level] << WHITE_SPACE_SEPARATOR << "<"
                             << file << "::" << func << "(...):" << line << ">:" << WHITE_SPACE_SEPARATOR;
                 }
 
+                /**
+                 * Allows to start the asynchronous logging, the messages are then written
+                 * into the standard output by a background thread, see async_logger
+                 */
+                static inline void start_async() {
+                    async_logger::start();
+                }
+
+                /**
+                 * Allows to stop the asynchronous logging, writes out the pending messages
+                 */
+                static inline void stop_async() {
+                    async_logger::stop();
+                    if (async_logger::get_num_dropped() > 0) {
+                        LOG_WARNING << "The asynchronous logging has dropped "
+                                << async_logger::get_num_dropped() << " messages" << END_LOG;
+                    }
+                }
+
                 /**
                  * Checks if the current reporting level is higher or equal to the given
                  * @return the reporting level to check
@@ -309,6 +358,9 @@ namespace tud {
                             << WHITE_SPACE_SEPARATOR << msg << ":" << WHITE_SPACE_SEPARATOR;
                             m_prefix() = pref.str();
                             
+                            //Write out the pending asynchronous messages first
+                            async_logger::flush();
+                            
                             //Output the time string
                             cout << compute_time_string(m_begin_time(), m_time_str_len());
                             cout.flush();
@@ -334,6 +386,9 @@ namespace tud {
                         //Do not update each time to save on computations
                         if (m_update_counter() > (CLOCKS_PER_SEC / 4)) {
                             
+                            //Write out the pending asynchronous messages first
+                            async_logger::flush();
+                            
                             //Output the current time
                             cout << compute_time_clear_string(m_time_str_len())
                             << compute_time_string(clock() - m_begin_time(), m_time_str_len());
@@ -353,6 +408,9 @@ namespace tud {
                  */
                 static void stop_progress_bar() {
                     if (IS_ENOUGH_LOGGING_LEVEL(m_curr_level()) && m_is_pb_on()) {
+                        //Write out the pending asynchronous messages first
+                        async_logger::flush();
+                        
                         //Clear the progress
                         cout << compute_time_clear_string(m_time_str_len()) << "\n";
                         cout.flush();
@@ -375,6 +433,15 @@ namespace tud {
                 };
 
             private:
+
+                /**
+                 * Allows to get the stream to log into
+                 * @return the thread local asynchronous stream if the asynchronous logging is on, otherwise the standard output
+                 */
+                static inline std::ostream& get_stream() {
+                    return async_logger::is_on() ? async_logger::get_stream() : cout;
+                }
+
                 //Stores the the string representation of the the DebugLevel enumeration elements
                 static inline const string * m_debug_level_str() {
                     static const string debug_level_str[debug_levels_enum::size] = {
@@ -47,6 +47,19 @@
 #include <cstdlib>
 #include <cstdio>
 #include <sstream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#ifdef ALLOC_STATS
+#include "alloc_stats.hh"
+#endif
 
 using namespace tud::utils::logging;
 using namespace tud::utils::exceptions;
@@ -55,36 +68,77 @@ namespace tud {
     namespace utils {
         namespace monitor {
             
+#ifdef ALLOC_STATS
+            
+#define DECLARE_ALLOC_STATS \
+            alloc_usage alloc_start = {}, alloc_phase = {};
+
+#define INITIALIZE_ALLOC_STATS \
+            alloc_stats::start_phase(alloc_start);
+
+#define REPORT_ALLOC_STATS(ACTION_PARAM) \
+            alloc_stats::end_phase(alloc_start, alloc_phase); \
+            alloc_stats::report((ACTION_PARAM), alloc_phase);
+
+#else
+            
+#define DECLARE_ALLOC_STATS
+#define INITIALIZE_ALLOC_STATS
+#define REPORT_ALLOC_STATS(ACTION_PARAM)
+
+#endif
+            
 #ifdef __APPLE__
             
 #define DECLARE_MONITOR_STATS \
             double start_time, end_time; \
+            TMemotyUsage mem_stat_start = {}, mem_stat_end = {}; \
+            metrics_snapshot metrics_start; \
+            int64_t trace_start = 0; \
+            DECLARE_ALLOC_STATS
 
 #define INITIALIZE_STATS \
-            start_time = stat_monitor::get_cpu_time();
+            trace_start = trace_recorder::get_time_us(); \
+            metrics_registry::snapshot(metrics_start); \
+            start_time = stat_monitor::get_cpu_time(); \
+            INITIALIZE_ALLOC_STATS
             
 #define REPORT_STATS(ACTION_PARAM)\
+            REPORT_ALLOC_STATS(ACTION_PARAM) \
             end_time = stat_monitor::get_cpu_time(); \
             LOG_USAGE << (ACTION_PARAM) << " took " \
-            << (end_time - start_time) << " CPU seconds." << END_LOG;
+            << (end_time - start_time) << " CPU seconds." << END_LOG; \
+            metrics_registry::record((ACTION_PARAM), (end_time - start_time), \
+                                     mem_stat_start, mem_stat_end, metrics_start); \
+            trace_recorder::add_span((ACTION_PARAM), trace_start, "phase");
 
 #else
             
 #define DECLARE_MONITOR_STATS \
             double start_time, end_time; \
-            TMemotyUsage mem_stat_start = {}, mem_stat_end = {};
+            TMemotyUsage mem_stat_start = {}, mem_stat_end = {}; \
+            metrics_snapshot metrics_start; \
+            int64_t trace_start = 0; \
+            DECLARE_ALLOC_STATS
 
 #define INITIALIZE_STATS \
+            trace_start = trace_recorder::get_time_us(); \
             stat_monitor::get_mem_stat(mem_stat_start); \
-            start_time = stat_monitor::get_cpu_time();
+            metrics_registry::snapshot(metrics_start); \
+            start_time = stat_monitor::get_cpu_time(); \
+            INITIALIZE_ALLOC_STATS
             
 #define REPORT_STATS(ACTION_PARAM)\
+            REPORT_ALLOC_STATS(ACTION_PARAM) \
             end_time = stat_monitor::get_cpu_time(); \
             stat_monitor::get_mem_stat(mem_stat_end); \
             LOG_USAGE << (ACTION_PARAM) << " took " \
             << (end_time - start_time) << " CPU seconds." << END_LOG; \
             report_memory_usage((ACTION_PARAM).c_str(), \
-                                mem_stat_start, mem_stat_end, true);
+                                mem_stat_start, mem_stat_end, true); \
+            metrics_registry::record((ACTION_PARAM), (end_time - start_time), \
+                                     mem_stat_start, mem_stat_end, metrics_start); \
+            trace_recorder::add_span((ACTION_PARAM), trace_start, "phase");
             
 #endif
             /**
@@ -297,6 +351,429 @@ namespace tud {
 
             };
             
+            /**
+             * Allows to escape the string for JSON
+             * @param str the string
+             * @return the escaped string
+             */
+            static inline string json_escape(const string & str) {
+                string result;
+                for (const char chr : str) {
+                    if ((chr == '"') || (chr == '\\')) {
+                        result += '\\';
+                    }
+                    result += chr;
+                }
+                return result;
+            }
+
+            /**
+             * This structure stores a metric value of a snapshot
+             */
+            struct metric_value {
+                //The metric value
+                double m_value;
+                //True if the value is a cumulative counter, the phase gets
+                //its increase, otherwise the phase gets the end value
+                bool m_is_counter;
+            };
+
+            //The metric values per metric name
+            typedef map<string, metric_value> metrics_snapshot;
+
+            //The function filling in the snapshot with the current metric values
+            typedef function<void(metrics_snapshot &)> metrics_probe;
+
+            /**
+             * This class is the metrics registry, the REPORT_STATS phases are recorded here
+             * along with the values of the registered metrics probes, e.g. the CUDD manager
+             * statistics, if the registry is enabled. The recorded phases can be exported as
+             * JSON. The probes are read on the thread reporting the phase, so a probe shall
+             * be safe to read there, the recording itself is thread safe.
+             */
+            class metrics_registry {
+            public:
+
+                /**
+                 * Allows to enable or disable the phase recording
+                 * @param is_enabled true to enable, false to disable
+                 */
+                static inline void set_enabled(const bool is_enabled) {
+                    lock_guard<mutex> guard(get_mutex());
+                    get_state().m_is_enabled = is_enabled;
+                }
+
+                /**
+                 * Allows to register the metrics probe
+                 * @param p_owner the probe owner, the key to remove the probe
+                 * @param probe the probe
+                 */
+                static inline void add_probe(const void * p_owner, const metrics_probe & probe) {
+                    lock_guard<mutex> guard(get_mutex());
+                    get_state().m_probes.push_back(make_pair(p_owner, probe));
+                }
+
+                /**
+                 * Allows to remove the metrics probes of the owner
+                 * @param p_owner the probe owner
+                 */
+                static inline void remove_probes(const void * p_owner) {
+                    lock_guard<mutex> guard(get_mutex());
+                    vector<pair<const void *, metrics_probe>> & probes = get_state().m_probes;
+                    for (auto iter = probes.begin(); iter != probes.end();) {
+                        iter = (iter->first == p_owner) ? probes.erase(iter) : iter + 1;
+                    }
+                }
+
+                /**
+                 * Allows to take the snapshot of the registered probes, if enabled
+                 * @param snapshot the snapshot to be filled in
+                 */
+                static inline void snapshot(metrics_snapshot & snapshot) {
+                    lock_guard<mutex> guard(get_mutex());
+                    snapshot.clear();
+                    if (get_state().m_is_enabled) {
+                        for (const pair<const void *, metrics_probe> & probe : get_state().m_probes) {
+                            probe.second(snapshot);
+                        }
+                    }
+                }
+
+                /**
+                 * Allows to record the phase, if enabled
+                 * @param name the phase name
+                 * @param cpu_time the phase CPU time in seconds
+                 * @param ms_start the start memory usage statistics
+                 * @param ms_end the end memory usage statistics
+                 * @param start the start metrics snapshot
+                 */
+                static inline void record(const string & name, const double cpu_time,
+                        const TMemotyUsage & ms_start, const TMemotyUsage & ms_end,
+                        const metrics_snapshot & start) {
+                    if (!get_state().m_is_enabled) {
+                        return;
+                    }
+                    metrics_snapshot end;
+                    snapshot(end);
+
+                    //Compute the counter increases, the other values are taken as is
+                    phase_record phase = {name, cpu_time, ms_start, ms_end, end};
+                    for (auto & entry : phase.m_metrics) {
+                        const auto iter = start.find(entry.first);
+                        if (entry.second.m_is_counter && (iter != start.end())) {
+                            entry.second.m_value -= iter->second.m_value;
+                        }
+                    }
+                    if (!phase.m_metrics.empty()) {
+                        LOG_INFO << "Phase '" << name << "' metrics: " << to_string(phase.m_metrics) << END_LOG;
+                    }
+
+                    lock_guard<mutex> guard(get_mutex());
+                    get_state().m_phases.push_back(phase);
+                }
+
+                /**
+                 * Allows to store the recorded phases as JSON
+                 * @param file_name the file name
+                 */
+                static inline void store_json(const string & file_name) {
+                    lock_guard<mutex> guard(get_mutex());
+                    ofstream file(file_name);
+                    ASSERT_CONDITION_THROW(!file.is_open(), string("Could not open the metrics file: ") + file_name);
+                    file.precision(9);
+                    file << "{\n  \"phases\": [";
+                    const vector<phase_record> & phases = get_state().m_phases;
+                    for (size_t idx = 0; idx < phases.size(); ++idx) {
+                        const phase_record & phase = phases[idx];
+                        file << ((idx == 0) ? "" : ",") << "\n    {\"name\": \"" << json_escape(phase.m_name)
+                                << "\", \"cpu_sec\": " << phase.m_cpu_time
+                                << ", \"vmsize_kb\": " << (phase.m_ms_end.vmsize - phase.m_ms_start.vmsize)
+                                << ", \"vmrss_kb\": " << (phase.m_ms_end.vmrss - phase.m_ms_start.vmrss)
+                                << ", \"vmhwm_kb\": " << phase.m_ms_end.vmhwm << ", \"metrics\": {";
+                        bool is_first = true;
+                        for (const auto & entry : phase.m_metrics) {
+                            file << (is_first ? "" : ", ") << "\"" << json_escape(entry.first) << "\": " << entry.second.m_value;
+                            is_first = false;
+                        }
+                        file << "}}";
+                    }
+                    file << "\n  ]\n}\n";
+                    ASSERT_CONDITION_THROW(!file.good(), string("Could not write the metrics file: ") + file_name);
+                    LOG_USAGE << "Stored " << phases.size() << " phase metrics into '" << file_name << "'" << END_LOG;
+                }
+
+            private:
+
+                /**
+                 * This structure stores the recorded phase
+                 */
+                struct phase_record {
+                    //The phase name
+                    string m_name;
+                    //The phase CPU time in seconds
+                    double m_cpu_time;
+                    //The start memory usage statistics
+                    TMemotyUsage m_ms_start;
+                    //The end memory usage statistics
+                    TMemotyUsage m_ms_end;
+                    //The metric counter increases and end values
+                    metrics_snapshot m_metrics;
+                };
+
+                /**
+                 * This structure stores the registry state
+                 */
+                struct registry_state {
+                    //True if the phases are recorded
+                    bool m_is_enabled;
+                    //The registered probes with their owners
+                    vector<pair<const void *, metrics_probe>> m_probes;
+                    //The recorded phases
+                    vector<phase_record> m_phases;
+                };
+
+                /**
+                 * Allows to get the registry state
+                 * @return the registry state
+                 */
+                static inline registry_state & get_state() {
+                    static registry_state state = {false, {}, {}};
+                    return state;
+                }
+
+                /**
+                 * Allows to get the registry mutex
+                 * @return the registry mutex
+                 */
+                static inline mutex & get_mutex() {
+                    static mutex registry_mutex;
+                    return registry_mutex;
+                }
+
+                /**
+                 * Allows to convert the metrics into a string for logging
+                 * @param metrics the metrics
+                 * @return the string representation
+                 */
+                static inline string to_string(const metrics_snapshot & metrics) {
+                    stringstream stream;
+                    for (const auto & entry : metrics) {
+                        stream << entry.first << "=" << entry.second.m_value << " ";
+                    }
+                    return stream.str();
+                }
+            };
+            
+            /**
+             * This class records the wall-clock time spans, the REPORT_STATS phases and the
+             * trace_span scopes, with the ids of the threads they ran on. The spans are stored
+             * in the Chrome trace-event JSON format to be inspected in a timeline viewer, e.g.
+             * chrome://tracing or Perfetto, the spans of one thread are nested by their times.
+             * When disabled the time is not even read, so the spans are almost free.
+             */
+            class trace_recorder {
+            public:
+
+                /**
+                 * Allows to enable or disable the span recording
+                 * @param is_enabled true to enable, false to disable
+                 */
+                static inline void set_enabled(const bool is_enabled) {
+                    //Fix the time origin before the first span
+                    get_origin();
+                    get_enabled().store(is_enabled, memory_order_relaxed);
+                }
+
+                /**
+                 * Allows to check if the span recording is enabled
+                 * @return true if enabled
+                 */
+                static inline bool is_enabled() {
+                    return get_enabled().load(memory_order_relaxed);
+                }
+
+                /**
+                 * Allows to get the current wall-clock time since the trace origin
+                 * @return the time in micro seconds or zero if disabled
+                 */
+                static inline int64_t get_time_us() {
+                    if (is_enabled()) {
+                        return chrono::duration_cast<chrono::microseconds>(
+                                chrono::steady_clock::now() - get_origin()).count();
+                    } else {
+                        return 0;
+                    }
+                }
+
+                /**
+                 * Allows to get the small id of the calling thread, in the order of first use
+                 * @return the thread id
+                 */
+                static inline uint32_t get_thread_id() {
+                    static atomic<uint32_t> next_id(0);
+                    static thread_local const uint32_t thread_id = next_id.fetch_add(1);
+                    return thread_id;
+                }
+
+                /**
+                 * Allows to record the span ending now on the calling thread, if enabled
+                 * @param name the span name
+                 * @param start_us the span start time, as given by get_time_us
+                 * @param category the span category
+                 */
+                static inline void add_span(const string & name, const int64_t start_us,
+                        const char * category) {
+                    if (is_enabled()) {
+                        const trace_event event = {name, category, start_us,
+                            get_time_us() - start_us, get_thread_id()};
+                        lock_guard<mutex> guard(get_mutex());
+                        get_events().push_back(event);
+                    }
+                }
+
+                /**
+                 * Allows to store the recorded spans as the Chrome trace-event JSON
+                 * @param file_name the file name
+                 */
+                static inline void store_json(const string & file_name) {
+                    lock_guard<mutex> guard(get_mutex());
+                    ofstream file(file_name);
+                    ASSERT_CONDITION_THROW(!file.is_open(), string("Could not open the trace file: ") + file_name);
+                    const vector<trace_event> & events = get_events();
+                    const int pid = getpid();
+                    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+                    for (size_t idx = 0; idx < events.size(); ++idx) {
+                        const trace_event & event = events[idx];
+                        file << ((idx == 0) ? "" : ",") << "\n  {\"name\": \"" << json_escape(event.m_name)
+                                << "\", \"cat\": \"" << event.m_category << "\", \"ph\": \"X\", \"ts\": "
+                                << event.m_start << ", \"dur\": " << event.m_duration
+                                << ", \"pid\": " << pid << ", \"tid\": " << event.m_thread_id << "}";
+                    }
+                    file << "\n]}\n";
+                    ASSERT_CONDITION_THROW(!file.good(), string("Could not write the trace file: ") + file_name);
+                    LOG_USAGE << "Stored " << events.size() << " trace spans into '" << file_name << "'" << END_LOG;
+                }
+
+            private:
+
+                /**
+                 * This structure stores the recorded span
+                 */
+                struct trace_event {
+                    //The span name
+                    string m_name;
+                    //The span category
+                    const char * m_category;
+                    //The start time in micro seconds
+                    int64_t m_start;
+                    //The duration in micro seconds
+                    int64_t m_duration;
+                    //The id of the thread the span ran on
+                    uint32_t m_thread_id;
+                };
+
+                /**
+                 * Allows to get the enabled flag
+                 * @return the enabled flag
+                 */
+                static inline atomic<bool> & get_enabled() {
+                    static atomic<bool> is_enabled(false);
+                    return is_enabled;
+                }
+
+                /**
+                 * Allows to get the trace time origin
+                 * @return the time origin
+                 */
+                static inline const chrono::steady_clock::time_point & get_origin() {
+                    static const chrono::steady_clock::time_point origin = chrono::steady_clock::now();
+                    return origin;
+                }
+
+                /**
+                 * Allows to get the recorded spans
+                 * @return the recorded spans
+                 */
+                static inline vector<trace_event> & get_events() {
+                    static vector<trace_event> events;
+                    return events;
+                }
+
+                /**
+                 * Allows to get the recorder mutex
+                 * @return the recorder mutex
+                 */
+                static inline mutex & get_mutex() {
+                    static mutex recorder_mutex;
+                    return recorder_mutex;
+                }
+            };
+
+            //The default number of loop items per traced batch
+#define TRACE_BATCH_SIZE 4096
+
+            /**
+             * This class is the scoped trace span, it records the wall-clock time
+             * from its construction until its destruction, finish or the next batch
+             */
+            class trace_span {
+            public:
+
+                /**
+                 * The basic constructor
+                 * @param name the span name, is not copied unless the recording is enabled
+                 * @param batch_size the number of next() calls after which a new span is
+                 *                   started, zero to never split the span
+                 */
+                trace_span(const char * name, const size_t batch_size = 0)
+                : m_name(name), m_batch_size(batch_size), m_count(0),
+                m_start(trace_recorder::get_time_us()) {
+                }
+
+                /**
+                 * The basic destructor, records the span
+                 */
+                virtual ~trace_span() {
+                    finish();
+                }
+
+                /**
+                 * Allows to record the current span before the destruction,
+                 * nothing is recorded after that
+                 */
+                inline void finish() {
+                    if (trace_recorder::is_enabled() && ((m_count > 0) || (m_batch_size == 0))) {
+                        trace_recorder::add_span(m_name, m_start, "span");
+                    }
+                    m_count = 0;
+                    m_batch_size = SIZE_MAX;
+                }
+
+                /**
+                 * Allows to count the processed item, every batch of the
+                 * given size of items is recorded as a separate span
+                 */
+                inline void next() {
+                    if (++m_count == m_batch_size) {
+                        if (trace_recorder::is_enabled()) {
+                            trace_recorder::add_span(m_name, m_start, "span");
+                        }
+                        m_count = 0;
+                        m_start = trace_recorder::get_time_us();
+                    }
+                }
+
+            private:
+                //The span name
+                const char * const m_name;
+                //The batch size
+                size_t m_batch_size;
+                //The number of items in the current batch
+                size_t m_count;
+                //The start time of the current span
+                int64_t m_start;
+            };
+            
             //The number of bytes in one Mb
             const uint32_t BYTES_ONE_MB = 1024u;
 
@@ -0,0 +1,593 @@
+/*
+ * File:   rect_cover.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 13, 2018, 10:27 AM
+ */
+
+#ifndef RECT_COVER_HPP
+#define RECT_COVER_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+
+#include "states_mgr.hh"
+#include "inputs_mgr.hh"
+#include "flat_bdd.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                /*
+                 * The rectangle cover image layout, all the values are in the host byte order:
+                 *
+                 *     rect_cover_header
+                 *     flat_bdd_dim x (ss_dim + is_dim)           the grid of each dimension
+                 *     uint64_t     x num_rects                   the input id of each rectangle
+                 *     uint32_t     x num_rects * 2 * ss_dim      the rectangles: lower and upper dof ids per dimension
+                 *     uint32_t     x num_nodes * (2 * ss_dim + 2) the R-tree nodes: the bounding rectangle,
+                 *                                                the first child and the number of children
+                 *
+                 * The last two sections are padded to 8 bytes. The R-tree is packed: the
+                 * rectangles are sorted by the Morton code of their centers and grouped
+                 * bottom up by RECT_FANOUT. The root is the first node, the last num_leaves
+                 * nodes are the leaves whose children are rectangles, the children of the
+                 * other nodes are nodes. The rectangles of one input may overlap, those of
+                 * different inputs do not as long as the controller is deterministic.
+                 */
+
+                //The rectangle cover magic number, "RCT1"
+                static constexpr uint32_t RECT_COVER_MAGIC = 0x31544352u;
+                //The number of children per R-tree node
+                static constexpr uint32_t RECT_FANOUT = 16;
+                //The maximum R-tree lookup stack depth
+                static constexpr uint32_t RECT_MAX_STACK = 1024;
+
+                /**
+                 * The rectangle cover image header
+                 */
+                struct rect_cover_header {
+                    //The magic number
+                    uint32_t m_magic;
+                    //The number of state-space dimensions
+                    uint32_t m_ss_dim;
+                    //The number of input-space dimensions
+                    uint32_t m_is_dim;
+                    //The number of children per R-tree node
+                    uint32_t m_fanout;
+                    //The number of rectangles
+                    uint64_t m_num_rects;
+                    //The number of R-tree nodes
+                    uint64_t m_num_nodes;
+                    //The number of R-tree leaf nodes
+                    uint64_t m_num_leaves;
+                };
+
+                /**
+                 * This class represents the controller as a cover of its domain by the axis-aligned
+                 * hyper-rectangles of states with the same input. The rectangles are grown greedily
+                 * and symbolically from the determinized controller's BDD, and indexed by a packed
+                 * R-tree, so a lookup visits a logarithmic number of nodes on smooth controllers.
+                 */
+                class rect_cover {
+                public:
+
+                    /**
+                     * The building constructor
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD
+                     * @param ss_dim the number of state-space dimensions
+                     */
+                    rect_cover(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set,
+                            const BDD & ctrl_bdd, const int32_t ss_dim)
+                    : m_image(), m_p_map(NULL), m_map_size(0), m_p_header(NULL), m_p_dims(NULL),
+                    m_p_inputs(NULL), m_p_rects(NULL), m_p_nodes(NULL), m_node_size(0), m_first_leaf(0) {
+                        build(cudd_mgr, ctrl_set, ctrl_bdd, ss_dim);
+                    }
+
+                    /**
+                     * The mapping constructor, the file is mapped read only and shared
+                     * @param file_name the rectangle cover file name
+                     */
+                    rect_cover(const string & file_name)
+                    : m_image(), m_p_map(NULL), m_map_size(0), m_p_header(NULL), m_p_dims(NULL),
+                    m_p_inputs(NULL), m_p_rects(NULL), m_p_nodes(NULL), m_node_size(0), m_first_leaf(0) {
+                        const int fd = open(file_name.c_str(), O_RDONLY);
+                        ASSERT_CONDITION_THROW((fd < 0), string("Could not open the rectangle cover file: ") + file_name);
+                        struct stat file_stat = {};
+                        if ((fstat(fd, &file_stat) == 0) && (file_stat.st_size > 0)) {
+                            m_map_size = file_stat.st_size;
+                            m_p_map = mmap(NULL, m_map_size, PROT_READ, MAP_SHARED, fd, 0);
+                        }
+                        close(fd);
+                        if ((m_p_map == NULL) || (m_p_map == MAP_FAILED)) {
+                            m_p_map = NULL;
+                            THROW_EXCEPTION(string("Could not map the rectangle cover file: ") + file_name);
+                        }
+                        set_pointers(static_cast<const char *> (m_p_map), m_map_size);
+                    }
+
+                    /**
+                     * The basic destructor
+                     */
+                    virtual ~rect_cover() {
+                        if (m_p_map != NULL) {
+                            munmap(m_p_map, m_map_size);
+                            m_p_map = NULL;
+                        }
+                    }
+
+                    /**
+                     * Allows to store the rectangle cover image into the file
+                     * @param file_name the rectangle cover file name
+                     */
+                    void store(const string & file_name) const {
+                        ofstream file(file_name, ios::out | ios::binary | ios::trunc);
+                        ASSERT_CONDITION_THROW(!file.is_open(), string("Could not open the rectangle cover file: ") + file_name);
+                        file.write(reinterpret_cast<const char *> (m_p_header), get_size());
+                        ASSERT_CONDITION_THROW(!file.good(), string("Could not write the rectangle cover file: ") + file_name);
+                    }
+
+                    /**
+                     * Allows to get the input of the state, thread safe
+                     * @param state the state-space point, of the state-space dimensionality
+                     * @param input_id the input id to be set
+                     * @return true if the state is in the controller's domain, otherwise false
+                     */
+                    inline bool lookup(const double * state, abs_type & input_id) const {
+                        const uint32_t ss_dim = m_p_header->m_ss_dim;
+                        abs_type ss_dofs[FLAT_MAX_DIM];
+                        for (uint32_t dof = 0; dof < ss_dim; ++dof) {
+                            const flat_bdd_dim & dim = m_p_dims[dof];
+                            ss_dofs[dof] = static_cast<abs_type> (state[dof] * dim.m_eta_inv - dim.m_x2a_sh);
+                            if (ss_dofs[dof] >= dim.m_num_points) {
+                                return false;
+                            }
+                        }
+                        return lookup_dofs(ss_dofs, input_id);
+                    }
+
+                    /**
+                     * Allows to get the input of the state, thread safe
+                     * @param ss_dofs the state-space dof ids, within the grid
+                     * @param input_id the input id to be set
+                     * @return true if the state is in the controller's domain, otherwise false
+                     */
+                    inline bool lookup_dofs(const abs_type * ss_dofs, abs_type & input_id) const {
+                        const uint32_t ss_dim = m_p_header->m_ss_dim;
+                        if (m_p_header->m_num_nodes == 0) {
+                            return false;
+                        }
+                        //Descend into all the nodes containing the state, until a rectangle does
+                        uint64_t stack[RECT_MAX_STACK];
+                        uint32_t size = 0;
+                        stack[size++] = 0;
+                        while (size > 0) {
+                            const uint64_t node_idx = stack[--size];
+                            const uint32_t * p_node = m_p_nodes + node_idx * m_node_size;
+                            const uint32_t first = p_node[2 * ss_dim];
+                            const uint32_t num_children = p_node[2 * ss_dim + 1];
+                            if (node_idx >= m_first_leaf) {
+                                for (uint32_t idx = first; idx < first + num_children; ++idx) {
+                                    if (is_inside(m_p_rects + idx * 2 * ss_dim, ss_dofs)) {
+                                        input_id = m_p_inputs[idx];
+                                        return true;
+                                    }
+                                }
+                            } else {
+                                for (uint32_t idx = first + num_children; idx > first; --idx) {
+                                    if (is_inside(m_p_nodes + (idx - 1) * m_node_size, ss_dofs)) {
+                                        stack[size++] = idx - 1;
+                                    }
+                                }
+                            }
+                        }
+                        return false;
+                    }
+
+                    /**
+                     * Allows to compare the cover with the controller on every grid state
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD
+                     * @return the number of states with an input not allowed by the controller,
+                     *         or with the domain membership different from the controller's one
+                     */
+                    size_t verify(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set, const BDD & ctrl_bdd) const {
+                        const uint32_t ss_dim = m_p_header->m_ss_dim;
+                        unique_ptr<SymbolicSet> p_ss_set(states_mgr::get_states_set(ctrl_set, ss_dim));
+                        unique_ptr<SymbolicSet> p_is_set(inputs_mgr::get_inputs_set(ctrl_set, ss_dim));
+                        const int32_t c_dim = ctrl_set.get_dim();
+
+                        //Get the controller's state-input id pairs
+                        abs_type num_pairs = 0;
+                        abs_type * p_dofs = ctrl_set.bdd_to_grid_point_ids(cudd_mgr, ctrl_bdd, num_pairs);
+                        vector<pair<abs_type, abs_type>> pairs(num_pairs);
+                        for (abs_type idx = 0; idx < num_pairs; ++idx) {
+                            p_ss_set->istoi(&p_dofs[idx * c_dim], pairs[idx].first);
+                            p_is_set->istoi(&p_dofs[idx * c_dim + ss_dim], pairs[idx].second);
+                        }
+                        delete[] p_dofs;
+                        sort(pairs.begin(), pairs.end());
+
+                        //Iterate over all the grid states in the SCOTS id order
+                        size_t num_mismatches = 0;
+                        vector<abs_type> ss_dofs(ss_dim, 0);
+                        const abs_type num_states = p_ss_set->size();
+                        for (abs_type ss_id = 0; ss_id < num_states; ++ss_id) {
+                            abs_type input_id = 0;
+                            const bool is_dom = lookup_dofs(ss_dofs.data(), input_id);
+                            auto iter = lower_bound(pairs.begin(), pairs.end(), make_pair(ss_id, (abs_type) 0));
+                            const bool is_ctrl_dom = (iter != pairs.end()) && (iter->first == ss_id);
+                            if ((is_dom != is_ctrl_dom) || (is_dom &&
+                                    !binary_search(pairs.begin(), pairs.end(), make_pair(ss_id, input_id)))) {
+                                ++num_mismatches;
+                            }
+                            //Move to the next state
+                            for (uint32_t dof = 0; dof < ss_dim; ++dof) {
+                                if (++ss_dofs[dof] < m_p_dims[dof].m_num_points) break;
+                                ss_dofs[dof] = 0;
+                            }
+                        }
+                        return num_mismatches;
+                    }
+
+                    /**
+                     * Allows to get the number of rectangles
+                     * @return the number of rectangles
+                     */
+                    inline size_t get_num_rects() const {
+                        return m_p_header->m_num_rects;
+                    }
+
+                    /**
+                     * Allows to get the number of R-tree nodes
+                     * @return the number of R-tree nodes
+                     */
+                    inline size_t get_num_nodes() const {
+                        return m_p_header->m_num_nodes;
+                    }
+
+                    /**
+                     * Allows to get the image size
+                     * @return the image size in bytes
+                     */
+                    inline size_t get_size() const {
+                        return get_size(*m_p_header);
+                    }
+
+                private:
+                    //Stores the built image, if not mapped
+                    vector<uint64_t> m_image;
+                    //Stores the mapped image, if mapped
+                    void * m_p_map;
+                    //Stores the mapped image size
+                    size_t m_map_size;
+                    //Stores the image header
+                    const rect_cover_header * m_p_header;
+                    //Stores the image dimensions
+                    const flat_bdd_dim * m_p_dims;
+                    //Stores the image input ids
+                    const uint64_t * m_p_inputs;
+                    //Stores the image rectangles
+                    const uint32_t * m_p_rects;
+                    //Stores the image R-tree nodes
+                    const uint32_t * m_p_nodes;
+                    //Stores the number of values per R-tree node
+                    uint32_t m_node_size;
+                    //Stores the index of the first leaf node
+                    uint64_t m_first_leaf;
+
+                    /**
+                     * Allows to check if the state is inside of the rectangle
+                     * @param p_rect the rectangle: the lower and upper dof ids per dimension
+                     * @param ss_dofs the state-space dof ids
+                     * @return true if the state is inside of the rectangle
+                     */
+                    inline bool is_inside(const uint32_t * p_rect, const abs_type * ss_dofs) const {
+                        for (uint32_t dof = 0; dof < m_p_header->m_ss_dim; ++dof) {
+                            if ((ss_dofs[dof] < p_rect[2 * dof]) || (ss_dofs[dof] > p_rect[2 * dof + 1])) {
+                                return false;
+                            }
+                        }
+                        return true;
+                    }
+
+                    /**
+                     * Allows to get the section size padded to 8 bytes
+                     * @param num_values the number of 32 bit values
+                     * @return the padded size in bytes
+                     */
+                    static inline size_t get_padded_size(const size_t num_values) {
+                        return ((num_values * sizeof (uint32_t) + 7) / 8) * 8;
+                    }
+
+                    /**
+                     * Allows to compute the image size
+                     * @param header the image header
+                     * @return the image size in bytes
+                     */
+                    static inline size_t get_size(const rect_cover_header & header) {
+                        return sizeof (rect_cover_header)
+                                + (header.m_ss_dim + header.m_is_dim) * sizeof (flat_bdd_dim)
+                                + header.m_num_rects * sizeof (uint64_t)
+                                + get_padded_size(header.m_num_rects * 2 * header.m_ss_dim)
+                                + get_padded_size(header.m_num_nodes * (2 * header.m_ss_dim + 2));
+                    }
+
+                    /**
+                     * Allows to check the image and to set the section pointers
+                     * @param p_data the image data
+                     * @param size the image size in bytes
+                     */
+                    void set_pointers(const char * p_data, const size_t size) {
+                        ASSERT_CONDITION_THROW((size < sizeof (rect_cover_header)), "The rectangle cover image is truncated!");
+                        m_p_header = reinterpret_cast<const rect_cover_header *> (p_data);
+                        ASSERT_CONDITION_THROW((m_p_header->m_magic != RECT_COVER_MAGIC),
+                                "The rectangle cover image has a wrong magic number!");
+                        ASSERT_CONDITION_THROW((m_p_header->m_ss_dim == 0) || (m_p_header->m_ss_dim > FLAT_MAX_DIM) ||
+                                (m_p_header->m_is_dim > FLAT_MAX_DIM) || (size != get_size(*m_p_header)) ||
+                                (m_p_header->m_num_leaves > m_p_header->m_num_nodes),
+                                "The rectangle cover image is corrupted!");
+                        m_p_dims = reinterpret_cast<const flat_bdd_dim *> (m_p_header + 1);
+                        m_p_inputs = reinterpret_cast<const uint64_t *> (m_p_dims + m_p_header->m_ss_dim + m_p_header->m_is_dim);
+                        m_p_rects = reinterpret_cast<const uint32_t *> (m_p_inputs + m_p_header->m_num_rects);
+                        m_p_nodes = reinterpret_cast<const uint32_t *> (reinterpret_cast<const char *> (m_p_rects)
+                                + get_padded_size(m_p_header->m_num_rects * 2 * m_p_header->m_ss_dim));
+                        m_node_size = 2 * m_p_header->m_ss_dim + 2;
+                        m_first_leaf = m_p_header->m_num_nodes - m_p_header->m_num_leaves;
+                    }
+
+                    /**
+                     * Allows to grow the rectangle along one dimension and direction as far as it stays
+                     * within the states set, the extension is found by galloping and then binary search
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ss_set the state-space symbolic set
+                     * @param states the states set
+                     * @param dof the dimension to grow along
+                     * @param is_up true to grow the upper bound, false to grow the lower bound
+                     * @param lb the lower bound dof ids
+                     * @param ub the upper bound dof ids
+                     */
+                    static void grow(const Cudd & cudd_mgr, const SymbolicSet & ss_set, const BDD & states,
+                            const int32_t dof, const bool is_up, vector<abs_type> & lb, vector<abs_type> & ub) {
+                        const abs_type max_ext = is_up ? (ss_set.get_no_gp_per_dim()[dof] - 1 - ub[dof]) : lb[dof];
+                        const abs_type base = is_up ? ub[dof] : lb[dof];
+                        //The rectangle with the extension fits if the added slab is within the states set
+                        auto is_fit = [&] (const abs_type ext) -> bool {
+                            vector<abs_type> slab_lb(lb), slab_ub(ub);
+                            slab_lb[dof] = is_up ? base + 1 : base - ext;
+                            slab_ub[dof] = is_up ? base + ext : base - 1;
+                            return ss_set.interval_to_bdd(cudd_mgr, slab_lb, slab_ub) <= states;
+                        };
+                        abs_type good = 0, step = 1;
+                        while ((good + step <= max_ext) && is_fit(good + step)) {
+                            good += step;
+                            step *= 2;
+                        }
+                        while (step > 1) {
+                            step /= 2;
+                            if ((good + step <= max_ext) && is_fit(good + step)) {
+                                good += step;
+                            }
+                        }
+                        if (is_up) {
+                            ub[dof] += good;
+                        } else {
+                            lb[dof] -= good;
+                        }
+                    }
+
+                    /**
+                     * Allows to get the Morton code of the rectangle's center
+                     * @param rect the rectangle: the lower and upper dof ids per dimension
+                     * @param ss_dim the number of state-space dimensions
+                     * @return the Morton code
+                     */
+                    static inline uint64_t get_morton(const uint32_t * rect, const uint32_t ss_dim) {
+                        const uint32_t num_bits = min((uint32_t) 32, (uint32_t) (64 / ss_dim));
+                        uint64_t code = 0;
+                        uint32_t pos = 0;
+                        for (uint32_t bit = 0; bit < num_bits; ++bit) {
+                            for (uint32_t dof = 0; dof < ss_dim; ++dof) {
+                                const uint64_t center = ((uint64_t) rect[2 * dof] + rect[2 * dof + 1]) / 2;
+                                code |= ((center >> bit) & 1) << pos++;
+                            }
+                        }
+                        return code;
+                    }
+
+                    /**
+                     * Allows to build the cover image
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD
+                     * @param ss_dim the number of state-space dimensions
+                     */
+                    void build(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set,
+                            const BDD & ctrl_bdd, const int32_t ss_dim) {
+                        const int32_t is_dim = ctrl_set.get_dim() - ss_dim;
+                        ASSERT_CONDITION_THROW((ss_dim <= 0) || (is_dim <= 0),
+                                string("Improper state-space dimensionality: ") + to_string(ss_dim));
+                        unique_ptr<SymbolicSet> p_ss_set(states_mgr::get_states_set(ctrl_set, ss_dim));
+                        unique_ptr<SymbolicSet> p_is_set(inputs_mgr::get_inputs_set(ctrl_set, ss_dim));
+                        for (const auto num : p_ss_set->get_no_gp_per_dim()) {
+                            ASSERT_CONDITION_THROW((num > UINT32_MAX), string("Too many grid points: ") + to_string(num));
+                        }
+                        const BDD ss_cube = p_ss_set->get_cube(cudd_mgr);
+                        const BDD is_cube = p_is_set->get_cube(cudd_mgr);
+
+                        //Get the state-space variables, to pick the seed states
+                        vector<BDD> ss_vars;
+                        for (const auto id : p_ss_set->get_bdd_var_ids()) {
+                            ss_vars.push_back(cudd_mgr.bddVar(id));
+                        }
+
+                        //Get the used input ids
+                        abs_type num_inputs = 0;
+                        abs_type * p_is_dofs = p_is_set->bdd_to_grid_point_ids(cudd_mgr, ctrl_bdd.ExistAbstract(ss_cube), num_inputs);
+                        vector<abs_type> inputs(num_inputs);
+                        for (abs_type idx = 0; idx < num_inputs; ++idx) {
+                            p_is_set->istoi(&p_is_dofs[idx * is_dim], inputs[idx]);
+                        }
+                        delete[] p_is_dofs;
+
+                        //Cover the states of each input with rectangles, grown from the uncovered states
+                        vector<uint32_t> rects;
+                        vector<uint64_t> rect_inputs;
+                        for (const auto input_id : inputs) {
+                            const BDD states = (ctrl_bdd & p_is_set->id_to_bdd(input_id)).ExistAbstract(is_cube);
+                            BDD uncovered = states;
+                            while (uncovered != cudd_mgr.bddZero()) {
+                                abs_type num_seeds = 0;
+                                abs_type * p_seed = p_ss_set->bdd_to_grid_point_ids(
+                                        cudd_mgr, uncovered.PickOneMinterm(ss_vars), num_seeds);
+                                vector<abs_type> lb(p_seed, p_seed + ss_dim), ub(lb);
+                                delete[] p_seed;
+                                for (int32_t dof = 0; dof < ss_dim; ++dof) {
+                                    grow(cudd_mgr, *p_ss_set, states, dof, true, lb, ub);
+                                    grow(cudd_mgr, *p_ss_set, states, dof, false, lb, ub);
+                                }
+                                uncovered &= !p_ss_set->interval_to_bdd(cudd_mgr, lb, ub);
+                                for (int32_t dof = 0; dof < ss_dim; ++dof) {
+                                    rects.push_back(static_cast<uint32_t> (lb[dof]));
+                                    rects.push_back(static_cast<uint32_t> (ub[dof]));
+                                }
+                                rect_inputs.push_back(input_id);
+                            }
+                        }
+                        const size_t num_rects = rect_inputs.size();
+                        ASSERT_CONDITION_THROW((num_rects > UINT32_MAX), string("Too many rectangles: ") + to_string(num_rects));
+
+                        //Sort the rectangles in the Morton order of their centers
+                        const uint32_t rect_size = 2 * ss_dim;
+                        vector<uint64_t> codes(num_rects);
+                        vector<size_t> order(num_rects);
+                        for (size_t idx = 0; idx < num_rects; ++idx) {
+                            codes[idx] = get_morton(&rects[idx * rect_size], ss_dim);
+                        }
+                        iota(order.begin(), order.end(), 0);
+                        stable_sort(order.begin(), order.end(), [&] (const size_t first, const size_t second) {
+                            return codes[first] < codes[second]; });
+
+                        //Pack the R-tree bottom up, the level nodes cover RECT_FANOUT consecutive children
+                        const uint32_t node_size = rect_size + 2;
+                        vector<vector<uint32_t>> levels;
+                        const uint32_t * p_children = NULL;
+                        vector<uint32_t> sorted_rects(num_rects * rect_size);
+                        for (size_t idx = 0; idx < num_rects; ++idx) {
+                            copy_n(&rects[order[idx] * rect_size], rect_size, &sorted_rects[idx * rect_size]);
+                        }
+                        p_children = sorted_rects.data();
+                        size_t num_children = num_rects, child_size = rect_size;
+                        while ((levels.empty() && (num_children > 0)) || (num_children > 1)) {
+                            vector<uint32_t> level;
+                            for (size_t first = 0; first < num_children; first += RECT_FANOUT) {
+                                const size_t last = min(num_children, first + RECT_FANOUT);
+                                vector<uint32_t> node(p_children + first * child_size, p_children + first * child_size + rect_size);
+                                for (size_t child = first + 1; child < last; ++child) {
+                                    for (uint32_t dof = 0; dof < (uint32_t) ss_dim; ++dof) {
+                                        node[2 * dof] = min(node[2 * dof], p_children[child * child_size + 2 * dof]);
+                                        node[2 * dof + 1] = max(node[2 * dof + 1], p_children[child * child_size + 2 * dof + 1]);
+                                    }
+                                }
+                                node.push_back(static_cast<uint32_t> (first));
+                                node.push_back(static_cast<uint32_t> (last - first));
+                                level.insert(level.end(), node.begin(), node.end());
+                            }
+                            levels.push_back(level);
+                            p_children = levels.back().data();
+                            num_children = levels.back().size() / node_size;
+                            child_size = node_size;
+                        }
+                        ASSERT_CONDITION_THROW((levels.size() * RECT_FANOUT > RECT_MAX_STACK),
+                                string("The R-tree is too deep: ") + to_string(levels.size()));
+
+                        //Lay out the levels from the root down, re-basing the child node indices
+                        size_t num_nodes = 0;
+                        vector<size_t> offsets(levels.size());
+                        for (size_t level = levels.size(); level > 0; --level) {
+                            offsets[level - 1] = num_nodes;
+                            num_nodes += levels[level - 1].size() / node_size;
+                        }
+                        ASSERT_CONDITION_THROW((num_nodes > UINT32_MAX), string("Too many R-tree nodes: ") + to_string(num_nodes));
+
+                        //Create the image
+                        vector<flat_bdd_dim> dims;
+                        get_flat_dims(ctrl_set, ss_dim, dims);
+                        const rect_cover_header header = {RECT_COVER_MAGIC, (uint32_t) ss_dim, (uint32_t) is_dim,
+                            RECT_FANOUT, num_rects, num_nodes, levels.empty() ? 0 : levels[0].size() / node_size};
+                        m_image.assign(get_size(header) / sizeof (uint64_t), 0);
+                        char * p_data = reinterpret_cast<char *> (m_image.data());
+                        memcpy(p_data, &header, sizeof (header));
+                        memcpy(p_data + sizeof (header), dims.data(), dims.size() * sizeof (flat_bdd_dim));
+                        set_pointers(p_data, m_image.size() * sizeof (uint64_t));
+                        uint64_t * p_inputs = const_cast<uint64_t *> (m_p_inputs);
+                        for (size_t idx = 0; idx < num_rects; ++idx) {
+                            p_inputs[idx] = rect_inputs[order[idx]];
+                        }
+                        copy(sorted_rects.begin(), sorted_rects.end(), const_cast<uint32_t *> (m_p_rects));
+                        for (size_t level = 0; level < levels.size(); ++level) {
+                            uint32_t * p_nodes = const_cast<uint32_t *> (m_p_nodes) + offsets[level] * node_size;
+                            copy(levels[level].begin(), levels[level].end(), p_nodes);
+                            if (level > 0) {
+                                for (size_t idx = 0; idx < levels[level].size() / node_size; ++idx) {
+                                    p_nodes[idx * node_size + rect_size] += static_cast<uint32_t> (offsets[level - 1]);
+                                }
+                            }
+                        }
+
+                        LOG_INFO << "Built the rectangle cover of " << num_rects << " rectangles for "
+                                << inputs.size() << " inputs with " << num_nodes << " R-tree nodes, "
+                                << get_size() << " bytes" << END_LOG;
+                    }
+                };
+            }
+        }
+    }
+}
+
+#endif /* RECT_COVER_HPP */
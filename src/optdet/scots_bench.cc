@@ -0,0 +1,323 @@
+/*
+ * File:   scots_bench.cc
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 17, 2018, 11:05 AM
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <fstream>
+
+// SCOTS header
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "monitor.hh"
+
+#include "scots_bench.hh"
+
+#include "ctrl_data.hh"
+#include "det_tool_params.hh"
+#include "input_output.hh"
+#include "greedy_optimizer.hh"
+#include "space_optimizer.hh"
+#include "bench_report.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::logging;
+using namespace tud::utils::exceptions;
+using namespace tud::utils::monitor;
+using namespace tud::ctrl::scots::optimal;
+
+//The convenience type definition for the named phase measurements of a run
+typedef vector<pair<string, phase_sample>> run_samples;
+
+//The phase names of the storing types, in the order of store_type_enum
+static const char * const STORE_TYPE_NAMES[store_type_enum::store_type_enum_size] = {
+    "reorder", "extend", "sco_const", "bdd_const", "sco_lin", "bdd_lin",
+    "dense_sco", "dense_morton", "mtbdd", "dont_care", "approx", "rect"
+};
+
+/**
+ * Allows to get the file size
+ * @param file_name the file name
+ * @return the file size in bytes, zero if the file could not be opened
+ */
+static size_t get_file_size(const string & file_name) {
+    ifstream file(file_name.c_str(), ifstream::ate | ifstream::binary);
+    return file.is_open() ? static_cast<size_t> (file.tellg()) : 0;
+}
+
+/**
+ * Allows to get the size of the stored controller data, the
+ * symbolic set files are the same for all types and are skipped
+ * @param target_file the determinized controller file name
+ * @param type the storing type
+ * @return the stored controller data size in bytes
+ */
+static size_t get_stored_size(const string & target_file, const store_type_enum type) {
+    switch (type) {
+        case store_type_enum::reorder:
+            return get_file_size(target_file + string("_reo.bdd"));
+        case store_type_enum::extend:
+            return get_file_size(target_file + string("_ext.bdd"));
+        case store_type_enum::dense_sco:
+        case store_type_enum::dense_morton:
+        case store_type_enum::rect:
+            return get_file_size(get_comp_file_name(target_file, type));
+        case store_type_enum::mtbdd:
+            return get_file_size(get_comp_file_name(target_file, type) + string(".add"));
+        case store_type_enum::dont_care:
+            return get_file_size(get_comp_file_name(target_file, type) + string(".bdd")) +
+                    get_file_size(get_comp_file_name(target_file, type) + string(".dom.bdd"));
+        default:
+            return get_file_size(get_comp_file_name(target_file, type) + string(".bdd"));
+    }
+}
+
+/**
+ * Allows to get the number of nodes of the stored BDD or ADD, from the file header
+ * @param file_name the dddmp .bdd file or the ctrl_add .add file name
+ * @return the number of nodes, zero if the file could not be read
+ */
+static size_t get_file_nodes(const string & file_name) {
+    ifstream file(file_name.c_str(), ifstream::binary);
+    string token;
+    size_t num_nodes = 0;
+    if (file >> token) {
+        if (token == ADD_FILE_TAG) {
+            //The ADD file starts with the number of nodes
+            file >> num_nodes;
+        } else {
+            //The dddmp header ends with the .nodes line, the node data is binary
+            while ((token != ".nnodes") && (token != ".nodes") && (file >> token)) {
+            }
+            if (token == ".nnodes") {
+                file >> num_nodes;
+            }
+        }
+    }
+    return file ? num_nodes : 0;
+}
+
+/**
+ * Allows to get the number of nodes of the stored controller, the dense
+ * tables and the rectangle covers are not BDDs and have no nodes
+ * @param target_file the determinized controller file name
+ * @param type the storing type
+ * @return the number of the stored BDD or ADD nodes
+ */
+static size_t get_stored_nodes(const string & target_file, const store_type_enum type) {
+    switch (type) {
+        case store_type_enum::reorder:
+            return get_file_nodes(target_file + string("_reo.bdd"));
+        case store_type_enum::extend:
+            return get_file_nodes(target_file + string("_ext.bdd"));
+        case store_type_enum::dense_sco:
+        case store_type_enum::dense_morton:
+        case store_type_enum::rect:
+            return 0;
+        case store_type_enum::mtbdd:
+            return get_file_nodes(get_comp_file_name(target_file, type) + string(".add"));
+        case store_type_enum::dont_care:
+            return get_file_nodes(get_comp_file_name(target_file, type) + string(".bdd")) +
+                    get_file_nodes(get_comp_file_name(target_file, type) + string(".dom.bdd"));
+        default:
+            return get_file_nodes(get_comp_file_name(target_file, type) + string(".bdd"));
+    }
+}
+
+/**
+ * Allows to measure the extraction, the optimizer construction, and the determinization
+ * @param cudd_mgr the CUDD manager
+ * @param input_ctrl the input controller
+ * @param output_ctrl the determinized controller to be filled in
+ * @param opt_phase the determinization phase name
+ * @param samples the run measurements to be extended
+ */
+template<class optimizer_type>
+static void run_optimizer(const Cudd & cudd_mgr, const ctrl_data & input_ctrl,
+                          ctrl_data & output_ctrl, const string & opt_phase,
+                          run_samples & samples) {
+    phase_timer timer;
+    
+    timer.start();
+    unique_ptr<optimizer_type> p_opt(new optimizer_type(cudd_mgr, input_ctrl));
+    samples.emplace_back("extract", timer.stop());
+    
+    timer.start();
+    p_opt->optimize(output_ctrl);
+    samples.emplace_back(opt_phase, timer.stop(output_ctrl.m_ctrl_bdd.nodeCount()));
+}
+
+/**
+ * Allows to run all the phases once on a fresh CUDD manager
+ * @param params the tool parameters
+ * @param ctrl_idx the controller index
+ * @param det_alg the determinization algorithm name
+ * @param samples the run measurements to be filled in
+ */
+static void run_phases(const bench_tool_params & params, const size_t ctrl_idx,
+                       const string & det_alg, run_samples & samples) {
+    const string & ctrl_file = params.m_ctrl_files[ctrl_idx];
+    const int32_t ss_dim = params.m_ss_dims[ctrl_idx];
+    const string target_file = params.m_target_file + string("_") + to_string(ctrl_idx) + string("_") + det_alg;
+    phase_timer timer;
+    
+    //Disable automatic variable ordering, as the determinizer does
+    Cudd cudd_mgr;
+    cudd_mgr.AutodynDisable();
+    ctrl_data input_ctrl = {}, output_ctrl = {};
+    
+    timer.start();
+    load_controller_bdd(cudd_mgr, ctrl_file, ss_dim, input_ctrl);
+    samples.emplace_back("load", timer.stop(input_ctrl.m_ctrl_bdd.nodeCount(),
+                                            get_file_size(ctrl_file + string(".bdd"))));
+    
+    det_tool_params det_params = {};
+    det_params.set_det_alg_type(det_alg);
+    switch (det_params.m_det_alg_type) {
+        case det_alg_enum::local:
+            run_optimizer<space_optimizer<space_tree_sco<false>>>(cudd_mgr, input_ctrl, output_ctrl, "tree_to_bdd", samples);
+            break;
+        case det_alg_enum::bdd_local:
+            run_optimizer<space_optimizer<space_tree_bdd<false>>>(cudd_mgr, input_ctrl, output_ctrl, "tree_to_bdd", samples);
+            break;
+        case det_alg_enum::global:
+            run_optimizer<greedy_optimizer>(cudd_mgr, input_ctrl, output_ctrl, "determinize", samples);
+            break;
+        case det_alg_enum::mixed:
+            run_optimizer<space_optimizer<space_tree_sco<true>>>(cudd_mgr, input_ctrl, output_ctrl, "tree_to_bdd", samples);
+            break;
+        case det_alg_enum::bdd_mixed:
+            run_optimizer<space_optimizer<space_tree_bdd<true>>>(cudd_mgr, input_ctrl, output_ctrl, "tree_to_bdd", samples);
+            break;
+        default:
+            THROW_EXCEPTION(string("Unsupported determinization algorithm type: ") + det_alg);
+    }
+    
+    timer.start();
+    store_controller(cudd_mgr, output_ctrl.m_ctrl_set, output_ctrl.m_ctrl_bdd, target_file);
+    samples.emplace_back("store", timer.stop(output_ctrl.m_ctrl_bdd.nodeCount(),
+                                             get_file_size(target_file + string(".bdd"))));
+    
+    //Delete the input BDD, as the determinizer does
+    input_ctrl.m_ctrl_bdd &= cudd_mgr.bddZero();
+    
+    //Reordering changes the variable order of the manager, so it goes last
+    for (int32_t idx = 1; idx <= store_type_enum::store_type_enum_size; ++idx) {
+        const store_type_enum type = static_cast<store_type_enum> (idx % store_type_enum::store_type_enum_size);
+        timer.start();
+        store_min_controller(cudd_mgr, output_ctrl.m_ctrl_set, output_ctrl.m_ctrl_bdd,
+                             target_file, type, ss_dim, params.m_max_loss);
+        phase_sample sample = timer.stop(0, get_stored_size(target_file, type));
+        sample.m_nodes = get_stored_nodes(target_file, type);
+        samples.emplace_back(string("store_") + STORE_TYPE_NAMES[type], sample);
+    }
+}
+
+/**
+ * The main program entry point
+ */
+int main(int argc, char** argv) {
+    //Declare the return code
+    int return_code = 0;
+    
+    //Set the uncaught exception handler
+    std::set_terminate(handler);
+    
+    //First print the program info
+    print_info();
+    
+    //Set up possible program arguments
+    create_arguments_parser();
+
+    try {
+        //Declare the parameters structure
+        bench_tool_params params = {};
+        
+        //Attempt to extract the program arguments
+        extract_arguments(argc, argv, params);
+
+        //Run the phases, the warm-up runs are not measured
+        bench_report report;
+        for (size_t ctrl_idx = 0; ctrl_idx < params.m_ctrl_files.size(); ++ctrl_idx) {
+            for (const string & det_alg : params.m_det_algs) {
+                for (int32_t run = 0; run < params.m_num_warmup + params.m_num_runs; ++run) {
+                    run_samples samples;
+                    run_phases(params, ctrl_idx, det_alg, samples);
+                    
+                    const bool is_warmup = (run < params.m_num_warmup);
+                    double wall = 0.0;
+                    for (const pair<string, phase_sample> & sample : samples) {
+                        wall += sample.second.m_wall;
+                        if (!is_warmup) {
+                            report.add_sample(params.m_ctrl_files[ctrl_idx], det_alg, sample.first, sample.second);
+                        }
+                    }
+                    LOG_RESULT << (is_warmup ? "Warm-up" : "Measured") << " run #" << run << " of '"
+                            << params.m_ctrl_files[ctrl_idx] << "' with " << det_alg << " took "
+                            << wall << " wall seconds" << END_LOG;
+                }
+            }
+        }
+        
+        //Report the phase summaries
+        vector<phase_summary> summaries;
+        report.get_summaries(summaries);
+        for (const phase_summary & sum : summaries) {
+            LOG_RESULT << sum.get_key() << ": median wall " << sum.m_wall_med << " sec., median CPU "
+                    << sum.m_cpu_med << " sec., peak RSS " << sum.m_peak_rss << " Kb, " << sum.m_nodes
+                    << " nodes, " << sum.m_bytes << " bytes" << END_LOG;
+        }
+        report.store(params.m_report_file, params.m_is_json);
+        LOG_RESULT << "Stored the benchmark report into '" << params.m_report_file << "'" << END_LOG;
+        
+        //Compare with the baseline
+        if (!params.m_baseline_file.empty()) {
+            const size_t num_regressed = report.compare(params.m_baseline_file, params.m_threshold);
+            if (num_regressed > 0) {
+                LOG_ERROR << "Found " << num_regressed << " regressed phases w.r.t. the baseline '"
+                        << params.m_baseline_file << "'" << END_LOG;
+                return_code = 2;
+            }
+        }
+        
+        LOG_USAGE << "Finished" << END_LOG;
+    } catch (std::exception & ex) {
+        //The argument's extraction has failed, print the error message and quit
+        LOG_ERROR << ex.what() << END_LOG;
+        return_code = 1;
+    }
+    
+    //Destroy the command line parameters parser
+    destroy_arguments_parser();
+    
+    return return_code;
+}
@@ -0,0 +1,357 @@
+/*
+ * File:   scots_bench.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 17, 2018, 09:40 AM
+ */
+
+#ifndef SCOTS_BENCH_HPP
+#define SCOTS_BENCH_HPP
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <execinfo.h>
+
+//Command line parameters parser
+#include "tclap/CmdLine.h"
+
+#include "exceptions.hh"
+#include "logger.hh"
+
+#include "det_tool_params.hh"
+
+using namespace std;
+using namespace TCLAP;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                //Declare the program version string
+#define PROGRAM_VERSION_STR "1.0"
+
+                // Check windows
+#if _WIN32 || _WIN64
+#if _WIN64
+#define ENVIRONMENT64
+#else
+#define ENVIRONMENT32
+#endif
+#endif
+
+                // Check GCC
+#if __GNUC__
+#if __x86_64__ || __ppc64__
+#define ENVIRONMENT64
+#else
+#define ENVIRONMENT32
+#endif
+#endif
+
+#define SAFE_DESTROY(ptr) \
+    if (ptr != NULL) { \
+        delete ptr; \
+        ptr = NULL; \
+    }
+
+                /**
+                 * This functions does nothing more but printing the program header information
+                 */
+                static void print_info(const char * prog_name_str) {
+                    LOG_USAGE << " ------------------------------------------------------------------ " << END_LOG;
+                    LOG_USAGE << "|                    " << prog_name_str << "          :)\\___/(: |" << END_LOG;
+                    LOG_USAGE << "|                       Software version " << PROGRAM_VERSION_STR << "             {(@)v(@)} |" << END_LOG;
+                    LOG_USAGE << "|                        DCSC, TU Delft, NL              {|~- -~|} |" << END_LOG;
+                    LOG_USAGE << "|            Copyright (C) Dr. Ivan S Zapreev, 2017-2018 {/^'^'^\\} |" << END_LOG;
+                    LOG_USAGE << "|  ═════════════════════════════════════════════════════════m-m══  |" << END_LOG;
+                    LOG_USAGE << "|        This software is distributed under GPL 2.0 license        |" << END_LOG;
+                    LOG_USAGE << "|          (GPL stands for GNU General Public License)             |" << END_LOG;
+                    LOG_USAGE << "|          The product comes with ABSOLUTELY NO WARRANTY.          |" << END_LOG;
+                    LOG_USAGE << "|   This is a free software, you are welcome to redistribute it.   |" << END_LOG;
+#ifdef ENVIRONMENT64
+                    LOG_USAGE << "|                     Running in 64 bit mode!                      |" << END_LOG;
+#else
+                    LOG_USAGE << "|                     Running in 32 bit mode!                      |" << END_LOG;
+#endif
+                    LOG_USAGE << "|                 Build on: " << __DATE__ << " " << __TIME__ << "                   |" << END_LOG;
+                    LOG_USAGE << " ------------------------------------------------------------------ " << END_LOG;
+                }
+
+                //Declare the maximum stack trace depth
+#define MAX_STACK_TRACE_LEN 100
+
+                /**
+                 * The uncaught exceptions handler
+                 */
+                static void handler() {
+                    void *trace_elems[20];
+                    int trace_elem_count(backtrace(trace_elems, MAX_STACK_TRACE_LEN));
+                    char **stack_syms(backtrace_symbols(trace_elems, trace_elem_count));
+                    LOG_ERROR << "Ooops, Sorry! Something terrible has happened, we crashed!" << END_LOG;
+                    for (int i = 0; i < trace_elem_count; ++i) {
+                        LOG_ERROR << stack_syms[i] << END_LOG;
+                    }
+                    free(stack_syms);
+                    exit(1);
+                }
+                
+                
+                
+                /**
+                 * This structure stores the tool's input parameters
+                 */
+                struct bench_tool_params {
+                    //Stores the controller file names
+                    vector<string> m_ctrl_files;
+                    //Stores the state-space dimensionality per controller
+                    vector<int32_t> m_ss_dims;
+                    //Stores the determinization algorithm names
+                    vector<string> m_det_algs;
+                    //Stores the prefix of the benchmark output controller files
+                    string m_target_file;
+                    //Stores the report file name
+                    string m_report_file;
+                    //True if the report is to be written as JSON, otherwise CSV
+                    bool m_is_json;
+                    //Stores the baseline report file name, empty if none
+                    string m_baseline_file;
+                    //The allowed fraction of the median wall time increase
+                    double m_threshold;
+                    //The number of the measured runs
+                    int32_t m_num_runs;
+                    //The number of the warm-up runs
+                    int32_t m_num_warmup;
+                    //The maximum fraction of the domain states
+                    //the under-approximated controller may lose
+                    double m_max_loss;
+                };
+                
+                //The pointer to the command line parameters parser
+                static CmdLine * p_cmd_args = NULL;
+                static MultiArg<string> * p_ctrl_files_arg = NULL;
+                static MultiArg<int32_t> * p_ss_dims_arg = NULL;
+                static ValuesConstraint<string> * p_det_alg_constr = NULL;
+                static MultiArg<string> * p_det_algs_arg = NULL;
+                static ValueArg<string> * p_target_file_arg = NULL;
+                static ValueArg<string> * p_report_file_arg = NULL;
+                static vector<string> formats = {"csv", "json"};
+                static ValuesConstraint<string> * p_format_constr = NULL;
+                static ValueArg<string> * p_format_arg = NULL;
+                static ValueArg<string> * p_baseline_file_arg = NULL;
+                static ValueArg<double> * p_threshold_arg = NULL;
+                static ValueArg<int32_t> * p_num_runs_arg = NULL;
+                static ValueArg<int32_t> * p_num_warmup_arg = NULL;
+                static ValueArg<double> * p_max_loss_arg = NULL;
+                static vector<string> debug_levels;
+                static ValuesConstraint<string> * p_debug_levels_constr = NULL;
+                static ValueArg<string> * p_debug_level_arg = NULL;
+                
+                /**
+                 * This functions does nothing more but printing the program header information
+                 */
+                static void print_info() {
+                    print_info("Determinizer Benchmark for SCOTSv2.0");
+                }
+                
+                /**
+                 * Creates and sets up the command line parameters parser
+                 */
+                void create_arguments_parser() {
+                    //Declare the command line arguments parser
+                    p_cmd_args = new CmdLine("", ' ', PROGRAM_VERSION_STR);
+                    
+                    //Add the controller file parameters - compulsory, can be repeated
+                    p_ctrl_files_arg = new MultiArg<string>("c", "controller", string("The SCOTSv2.0 BDD controller ") +
+                                                            string("file name without (.scs/.bdd)"), true,
+                                                            "controller file name", *p_cmd_args);
+                    
+                    //Add the number of state-space dimensions - compulsory, one for all or one per controller
+                    p_ss_dims_arg = new MultiArg<int32_t>("d", "state-dimension", string("The number of state space ") +
+                                                          string("dimensions, one for all or one per controller"), true,
+                                                          "state-space dimensionality", *p_cmd_args);
+                    
+                    //Add the determinization algorithms - optional, can be repeated, default is all of them
+                    p_det_alg_constr = new ValuesConstraint<string>(det_tool_params::get_det_alg());
+                    p_det_algs_arg = new MultiArg<string>("a", "algorithm", string("The determinization algorithm ") +
+                                                          string("to benchmark, can be repeated, default is all"),
+                                                          false, p_det_alg_constr, *p_cmd_args);
+                    
+                    //Add the output controllers file prefix - compulsory
+                    p_target_file_arg = new ValueArg<string>("t", "target-controller", string("The output controllers ") +
+                                                             string("file name prefix, the files are overwritten per run"),
+                                                             true, "", "target controller file name", *p_cmd_args);
+                    
+                    //Add the report file - compulsory
+                    p_report_file_arg = new ValueArg<string>("o", "report", string("The benchmark report file name"),
+                                                             true, "", "report file name", *p_cmd_args);
+                    
+                    //Add the report format - optional, default is CSV
+                    p_format_constr = new ValuesConstraint<string>(formats);
+                    p_format_arg = new ValueArg<string>("f", "format", "The benchmark report format",
+                                                        false, formats.front(), p_format_constr, *p_cmd_args);
+                    
+                    //Add the baseline report file - optional
+                    p_baseline_file_arg = new ValueArg<string>("b", "baseline", string("The baseline report file ") +
+                                                               string("name, JSON or CSV, to compare with"), false, "",
+                                                               "baseline file name", *p_cmd_args);
+                    
+                    //Add the regression threshold - optional
+                    p_threshold_arg = new ValueArg<double>("x", "threshold", string("The allowed fraction of the ") +
+                                                           string("median wall time increase w.r.t. the baseline"),
+                                                           false, 0.1, "regression threshold", *p_cmd_args);
+                    
+                    //Add the number of measured runs - optional
+                    p_num_runs_arg = new ValueArg<int32_t>("r", "runs", string("The number of measured runs"),
+                                                           false, 3, "number of runs", *p_cmd_args);
+                    
+                    //Add the number of warm-up runs - optional
+                    p_num_warmup_arg = new ValueArg<int32_t>("u", "warm-up", string("The number of warm-up runs"),
+                                                             false, 1, "number of warm-up runs", *p_cmd_args);
+                    
+                    //Add the approximation loss - optional
+                    p_max_loss_arg = new ValueArg<double>("p", "approx", string("The maximum fraction of the domain ") +
+                                                          string("states the approximated controller may lose"),
+                                                          false, 0.01, "max lost fraction", *p_cmd_args);
+                    
+                    //Add the -d the debug level parameter - optional, default is e.g. RESULT
+                    logger::get_reporting_levels(&debug_levels);
+                    p_debug_levels_constr = new ValuesConstraint<string>(debug_levels);
+                    p_debug_level_arg = new ValueArg<string>("l", "logging", "The log level to be used",
+                                                             false, RESULT_PARAM_VALUE, p_debug_levels_constr, *p_cmd_args);
+                }
+                
+                /**
+                 * This function tries to extract the
+                 * @param argc the number of program arguments
+                 * @param argv the array of program arguments
+                 * @param params the structure to store the tool parameter values
+                 */
+                static void extract_arguments(const uint argc,
+                                              char const * const * const argv,
+                                              bench_tool_params & params) {
+                    //Parse the arguments
+                    try {
+                        p_cmd_args->parse(argc, argv);
+                    } catch (ArgException &e) {
+                        THROW_EXCEPTION(string("Error: ") + e.error() + string(", for argument: ") + e.argId());
+                    }
+                    
+                    //Set the logging level right away
+                    logger::set_reporting_level(p_debug_level_arg->getValue());
+                    
+                    //Store the parsed parameter values
+                    params.m_ctrl_files = p_ctrl_files_arg->getValue();
+                    for (size_t idx = 0; idx < params.m_ctrl_files.size(); ++idx) {
+                        LOG_USAGE << "Given BDD controller #" << idx << " file: '"
+                                << params.m_ctrl_files[idx] << "'" << END_LOG;
+                    }
+                    
+                    params.m_ss_dims = p_ss_dims_arg->getValue();
+                    ASSERT_CONDITION_THROW((params.m_ss_dims.size() != 1) &&
+                                           (params.m_ss_dims.size() != params.m_ctrl_files.size()),
+                                           string("The number of state-space dimensionalities: ") +
+                                           to_string(params.m_ss_dims.size()) + string(" must be 1 or ") +
+                                           to_string(params.m_ctrl_files.size()));
+                    params.m_ss_dims.resize(params.m_ctrl_files.size(), params.m_ss_dims.front());
+                    for (size_t idx = 0; idx < params.m_ss_dims.size(); ++idx) {
+                        LOG_USAGE << "The controller #" << idx << " state-space dimensionality is: "
+                                << params.m_ss_dims[idx] << END_LOG;
+                        ASSERT_CONDITION_THROW((params.m_ss_dims[idx] <= 0),
+                                               string("Improper number of state-space dimensions: ") +
+                                               to_string(params.m_ss_dims[idx]) + string(" must be > 0 "));
+                    }
+                    
+                    params.m_det_algs = p_det_algs_arg->getValue();
+                    if (params.m_det_algs.empty()) {
+                        params.m_det_algs = det_tool_params::get_det_alg();
+                    }
+                    for (const string & det_alg : params.m_det_algs) {
+                        LOG_USAGE << "Benchmarking the determinization algorithm: " << det_alg << END_LOG;
+                    }
+                    
+                    params.m_target_file = p_target_file_arg->getValue();
+                    LOG_USAGE << "Given output controllers file prefix: '" << params.m_target_file << "'" << END_LOG;
+                    
+                    params.m_report_file = p_report_file_arg->getValue();
+                    params.m_is_json = (p_format_arg->getValue() == "json");
+                    LOG_USAGE << "Given " << p_format_arg->getValue() << " report file: '"
+                            << params.m_report_file << "'" << END_LOG;
+                    
+                    params.m_baseline_file = p_baseline_file_arg->getValue();
+                    params.m_threshold = p_threshold_arg->getValue();
+                    if (!params.m_baseline_file.empty()) {
+                        LOG_USAGE << "Given baseline report file: '" << params.m_baseline_file
+                                << "', the regression threshold is: " << params.m_threshold << END_LOG;
+                    }
+                    ASSERT_CONDITION_THROW((params.m_threshold < 0.0),
+                                           string("Improper regression threshold: ") +
+                                           to_string(params.m_threshold) + string(" must be >= 0 "));
+                    
+                    params.m_num_runs = p_num_runs_arg->getValue();
+                    params.m_num_warmup = p_num_warmup_arg->getValue();
+                    LOG_USAGE << "The number of measured/warm-up runs is: " << params.m_num_runs
+                            << "/" << params.m_num_warmup << END_LOG;
+                    ASSERT_CONDITION_THROW((params.m_num_runs <= 0),
+                                           string("Improper number of measured runs: ") +
+                                           to_string(params.m_num_runs) + string(" must be > 0 "));
+                    ASSERT_CONDITION_THROW((params.m_num_warmup < 0),
+                                           string("Improper number of warm-up runs: ") +
+                                           to_string(params.m_num_warmup) + string(" must be >= 0 "));
+                    
+                    params.m_max_loss = p_max_loss_arg->getValue();
+                    LOG_USAGE << "The maximum lost fraction of the approximation is: " << params.m_max_loss << END_LOG;
+                    ASSERT_CONDITION_THROW((params.m_max_loss < 0.0) || (params.m_max_loss > 1.0),
+                                           string("Improper maximum lost fraction: ") +
+                                           to_string(params.m_max_loss) + string(" must be within [0,1]"));
+                }
+                
+                /**
+                 * Allows to deallocate the parameters parser if it is needed
+                 */
+                void destroy_arguments_parser() {
+                    SAFE_DESTROY(p_ctrl_files_arg);
+                    SAFE_DESTROY(p_ss_dims_arg);
+                    SAFE_DESTROY(p_det_alg_constr);
+                    SAFE_DESTROY(p_det_algs_arg);
+                    SAFE_DESTROY(p_target_file_arg);
+                    SAFE_DESTROY(p_report_file_arg);
+                    SAFE_DESTROY(p_format_constr);
+                    SAFE_DESTROY(p_format_arg);
+                    SAFE_DESTROY(p_baseline_file_arg);
+                    SAFE_DESTROY(p_threshold_arg);
+                    SAFE_DESTROY(p_num_runs_arg);
+                    SAFE_DESTROY(p_num_warmup_arg);
+                    SAFE_DESTROY(p_max_loss_arg);
+                    SAFE_DESTROY(p_debug_levels_constr);
+                    SAFE_DESTROY(p_debug_level_arg);
+                    SAFE_DESTROY(p_cmd_args);
+                }
+            }
+        }
+    }
+}
+
+#endif /* SCOTS_BENCH_HPP */
@@ -0,0 +1,252 @@
+/*
+ * File:   scots_codegen.cc
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 12, 2018, 16:20 PM
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+
+// SCOTS header
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "monitor.hh"
+
+#include "scots_codegen.hh"
+
+#include "ctrl_data.hh"
+#include "input_output.hh"
+#include "inputs_mgr.hh"
+#include "states_mgr.hh"
+#include "flat_batch.hh"
+#include "ctrl_codegen.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::logging;
+using namespace tud::utils::exceptions;
+using namespace tud::utils::monitor;
+using namespace tud::ctrl::scots::optimal;
+
+/**
+ * Allows to quote the file name for the shell command
+ * @param file_name the file name
+ * @return the quoted file name
+ */
+static string quote(const string & file_name) {
+    ASSERT_CONDITION_THROW((file_name.find('\'') != string::npos),
+            string("The file name '") + file_name + string("' may not contain quotes!"));
+    return string("'") + file_name + string("'");
+}
+
+/**
+ * Allows to compile the generated controller with a driver looking up the states from a file
+ * @param params the tool parameters
+ * @param driver_file the driver source file name base
+ * @param exec_file the driver executable file name
+ */
+static void compile_driver(const codegen_tool_params & params,
+        const string & driver_file, const string & exec_file) {
+    const size_t pos = params.m_target_file.find_last_of('/');
+    const string dir_name = (pos == string::npos) ? string(".") : params.m_target_file.substr(0, pos);
+    const string base_name = (pos == string::npos) ? params.m_target_file : params.m_target_file.substr(pos + 1);
+    const string upper = ctrl_codegen::get_upper(params.m_name);
+    const bool is_c99 = (params.m_lang == cg_c99);
+    const string source_file = driver_file + (is_c99 ? string(".c") : string(".cpp"));
+
+    //Write the driver, it reads the states and writes the found flag followed by the input
+    ofstream driver(source_file, ios::out | ios::trunc);
+    ASSERT_CONDITION_THROW(!driver.is_open(), string("Could not open the file: ") + source_file);
+    driver << "#include <stdio.h>\n\n#include \"" << base_name << (is_c99 ? ".h" : ".hpp") << "\"\n\n"
+            << "int main(int argc, char ** argv) {\n"
+            << "    double x[" << upper << "_SS_DIM], u[" << upper << "_IS_DIM + 1];\n"
+            << "    FILE * in = (argc == 3) ? fopen(argv[1], \"rb\") : NULL;\n"
+            << "    FILE * out = (argc == 3) ? fopen(argv[2], \"wb\") : NULL;\n"
+            << "    if ((in == NULL) || (out == NULL)) return 1;\n"
+            << "    while (fread(x, sizeof(double), " << upper << "_SS_DIM, in) == " << upper << "_SS_DIM) {\n"
+            << "        u[0] = " << (is_c99 ? string("") : params.m_name + string("::"))
+            << params.m_name << "_lookup(x, &u[1]);\n"
+            << "        if (fwrite(u, sizeof(double), " << upper << "_IS_DIM + 1, out) != "
+            << upper << "_IS_DIM + 1) return 1;\n"
+            << "    }\n    fclose(in);\n    return (fclose(out) == 0) ? 0 : 1;\n}\n";
+    driver.close();
+    ASSERT_CONDITION_THROW(!driver.good(), string("Could not write the file: ") + source_file);
+
+    //Compile it with the generated code, using the compiler from the environment if set
+    const char * p_compiler = getenv(is_c99 ? "CC" : "CXX");
+    const string command = ((p_compiler != NULL) ? string(p_compiler) : string(is_c99 ? "cc" : "c++")) +
+            (is_c99 ? string(" -std=c99") : string(" -std=c++11")) + string(" -O1 -I") + quote(dir_name) +
+            string(" -o ") + quote(exec_file) + string(" ") + quote(source_file) +
+            (is_c99 ? string(" ") + quote(params.m_target_file + string(".c")) : string(""));
+    LOG_USAGE << "Compiling the generated controller: " << command << END_LOG;
+    const int status = system(command.c_str());
+    remove(source_file.c_str());
+    ASSERT_CONDITION_THROW((status != 0), string("Could not compile the generated controller, the command: ") + command);
+}
+
+/**
+ * Allows to check the generated controller against the restriction on every domain state,
+ * the generated code is compiled and run on all the domain states
+ * @param params the tool parameters
+ * @param cudd_mgr the CUDD manager
+ * @param ctrl the controller
+ */
+static void check_controller(const codegen_tool_params & params, const Cudd & cudd_mgr, const ctrl_data & ctrl) {
+    //Declare the statistics data
+    DECLARE_MONITOR_STATS;
+
+    //Get the beginning statistics data
+    INITIALIZE_STATS;
+
+    //Get the domain states
+    const int32_t ss_dim = params.m_ss_dim;
+    unique_ptr<SymbolicSet> p_ss_set(states_mgr::get_states_set(ctrl.m_ctrl_set, ss_dim));
+    unique_ptr<SymbolicSet> p_is_set(inputs_mgr::get_inputs_set(ctrl.m_ctrl_set, ss_dim));
+    const int32_t is_dim = p_is_set->get_dim();
+    BDD dom_bdd = ctrl.m_ctrl_bdd.ExistAbstract(p_is_set->get_cube(cudd_mgr));
+    abs_type num_states = 0;
+    unique_ptr<abs_type[]> ss_dofs(p_ss_set->bdd_to_grid_point_ids(cudd_mgr, dom_bdd, num_states));
+    vector<double> states(num_states * ss_dim);
+    for (abs_type idx = 0; idx < num_states; ++idx) {
+        double * p_state = &states[idx * ss_dim];
+        p_ss_set->Itox(&ss_dofs[idx * ss_dim], p_state);
+    }
+
+    //Write the states for the driver
+    const string states_file = params.m_target_file + string("_check.states");
+    const string inputs_file = params.m_target_file + string("_check.inputs");
+    //The executable without a directory would be searched in the PATH
+    const string exec_file = ((params.m_target_file.find('/') == string::npos) ? string("./") : string("")) +
+            params.m_target_file + string("_check");
+    {
+        ofstream file(states_file, ios::out | ios::trunc | ios::binary);
+        file.write(reinterpret_cast<const char *> (states.data()), states.size() * sizeof(double));
+        ASSERT_CONDITION_THROW(!file.good(), string("Could not write the file: ") + states_file);
+    }
+
+    //Compile and run the generated controller on the states
+    compile_driver(params, params.m_target_file + string("_check_main"), exec_file);
+    const int status = system((quote(exec_file) + string(" ") + quote(states_file) +
+            string(" ") + quote(inputs_file)).c_str());
+    vector<double> outputs(num_states * (is_dim + 1));
+    {
+        ifstream file(inputs_file, ios::in | ios::binary);
+        file.read(reinterpret_cast<char *> (outputs.data()), outputs.size() * sizeof(double));
+        ASSERT_CONDITION_THROW((status != 0) || !file.good(), string("Could not run the generated controller: ") + exec_file);
+    }
+    remove(states_file.c_str());
+    remove(inputs_file.c_str());
+    remove(exec_file.c_str());
+
+    //Compare with the smallest input of the restriction
+    size_t num_diff = 0;
+    vector<double> inputs;
+    for (abs_type idx = 0; idx < num_states; ++idx) {
+        const vector<double> state(&states[idx * ss_dim], &states[(idx + 1) * ss_dim]);
+        ctrl.m_ctrl_set.restriction(cudd_mgr, ctrl.m_ctrl_bdd, state, inputs);
+        abs_type min_id = FLAT_NO_INPUT;
+        for (size_t in_idx = 0; in_idx < inputs.size(); in_idx += is_dim) {
+            min_id = min(min_id, p_is_set->xtoi(&inputs[in_idx]));
+        }
+        const double * p_output = &outputs[idx * (is_dim + 1)];
+        const abs_type input_id = (p_output[0] != 0.0) ? p_is_set->xtoi(&p_output[1]) : FLAT_NO_INPUT;
+        if (min_id != input_id) {
+            LOG_DEBUG << "The state #" << idx << " input id " << input_id
+                    << " differs from the restriction " << min_id << END_LOG;
+            ++num_diff;
+        }
+    }
+
+    //Get the end stats and log them
+    REPORT_STATS(string("Checking the generated controller"));
+
+    ASSERT_CONDITION_THROW((num_diff > 0), string("The generated controller differs from ") +
+            string("the restriction in ") + to_string(num_diff) + string(" of ") +
+            to_string(num_states) + string(" domain states!"));
+    LOG_RESULT << "The compiled generated controller matches the restriction on all "
+            << num_states << " domain states" << END_LOG;
+}
+
+/**
+ * The main program entry point
+ */
+int main(int argc, char** argv) {
+    //Declare the return code
+    int return_code = 0;
+    
+    //Set the uncaught exception handler
+    std::set_terminate(handler);
+    
+    //First print the program info
+    print_info();
+    
+    //Set up possible program arguments
+    create_arguments_parser();
+
+    try {
+        //Declare the parameters structure
+        codegen_tool_params params = {};
+        
+        //Attempt to extract the program arguments
+        extract_arguments(argc, argv, params);
+
+        //Load the controller
+        Cudd cudd_mgr;
+        ctrl_data ctrl;
+        load_controller_bdd(cudd_mgr, params.m_source_file, params.m_ss_dim, ctrl);
+
+        //Compile the controller into the state functions
+        flat_batch batch(cudd_mgr, ctrl.m_ctrl_set, ctrl.m_ctrl_bdd, params.m_ss_dim, true);
+
+        //Generate the code
+        ctrl_codegen codegen(batch, params.m_name, params.m_mode);
+        codegen.generate(params.m_target_file, params.m_lang);
+        LOG_RESULT << "Generated the controller code of " << batch.get_num_nodes()
+                << " nodes, the estimated ROM size is " << codegen.get_rom_size() << " bytes" << END_LOG;
+
+        //Check the controller if requested
+        if (params.m_is_check) {
+            check_controller(params, cudd_mgr, ctrl);
+        }
+        
+        LOG_USAGE << "Finished" << END_LOG;
+    } catch (std::exception & ex) {
+        //The argument's extraction has failed, print the error message and quit
+        LOG_ERROR << ex.what() << END_LOG;
+        return_code = 1;
+    }
+    
+    //Destroy the command line parameters parser
+    destroy_arguments_parser();
+    
+    return return_code;
+}
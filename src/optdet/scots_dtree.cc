@@ -0,0 +1,140 @@
+/*
+ * File:   scots_dtree.cc
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 16, 2018, 16:34 PM
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+
+// SCOTS header
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "monitor.hh"
+#include "thread_pool.hh"
+
+#include "scots_dtree.hh"
+
+#include "ctrl_data.hh"
+#include "input_output.hh"
+#include "dense_table.hh"
+#include "dtree_ctrl.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::logging;
+using namespace tud::utils::exceptions;
+using namespace tud::utils::monitor;
+using namespace tud::utils::threads;
+using namespace tud::ctrl::scots::optimal;
+
+/**
+ * The main program entry point
+ */
+int main(int argc, char** argv) {
+    //Declare the return code
+    int return_code = 0;
+    
+    //Set the uncaught exception handler
+    std::set_terminate(handler);
+    
+    //First print the program info
+    print_info();
+    
+    //Set up possible program arguments
+    create_arguments_parser();
+
+    try {
+        //Declare the parameters structure
+        dtree_tool_params params = {};
+        
+        //Attempt to extract the program arguments
+        extract_arguments(argc, argv, params);
+        
+        //Log asynchronously, the per state logging is then not slowing down the computations
+        logger::start_async();
+        
+        //Enable the timeline tracing if requested
+        trace_recorder::set_enabled(params.m_is_trace);
+
+        //Load the controller
+        Cudd cudd_mgr;
+        ctrl_data ctrl;
+        load_controller_bdd(cudd_mgr, params.m_source_file, params.m_ss_dim, ctrl);
+
+        //Learn and store the decision tree
+        const string target_file = params.m_target_file + string(".dtr");
+        {
+            //Declare the statistics data
+            DECLARE_MONITOR_STATS;
+
+            //Get the beginning statistics data
+            INITIALIZE_STATS;
+
+            thread_pool workers(1);
+            workers.set_num_threads(params.m_num_workers);
+            dtree_ctrl tree(cudd_mgr, ctrl.m_ctrl_set, ctrl.m_ctrl_bdd, params.m_ss_dim, workers);
+            tree.store(target_file);
+            LOG_RESULT << "Stored the decision tree with " << tree.get_num_nodes() << " nodes and depth "
+                    << tree.get_depth() << " into '" << target_file << "', " << tree.get_size()
+                    << " bytes v.s. " << dense_table::estimate_bdd_size(ctrl.m_ctrl_bdd)
+                    << " bytes of the flat BDD" << END_LOG;
+
+            //Get the end stats and log them
+            REPORT_STATS(string("Learning the decision tree"));
+        }
+
+        //Map the stored tree and verify it against the original controller
+        {
+            dtree_ctrl tree(target_file);
+            const size_t num_mismatches = tree.verify(cudd_mgr, ctrl.m_ctrl_set, ctrl.m_ctrl_bdd);
+            ASSERT_CONDITION_THROW((num_mismatches > 0), string("The decision tree '") + target_file +
+                                   string("' does not match the controller in ") +
+                                   to_string(num_mismatches) + string(" states"));
+            LOG_RESULT << "The decision tree '" << target_file << "' matches the controller on all "
+                    << tree.get_num_states() << " grid states" << END_LOG;
+        }
+        
+        //Store the recorded timeline if requested
+        if(params.m_is_trace) {
+            trace_recorder::store_json(params.m_target_file + string("_trace.json"));
+        }
+        
+        LOG_USAGE << "Finished" << END_LOG;
+    } catch (std::exception & ex) {
+        //The argument's extraction has failed, print the error message and quit
+        LOG_ERROR << ex.what() << END_LOG;
+        return_code = 1;
+    }
+    
+    //Write out the pending log messages
+    logger::stop_async();
+    
+    //Destroy the command line parameters parser
+    destroy_arguments_parser();
+    
+    return return_code;
+}
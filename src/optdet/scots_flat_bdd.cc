@@ -0,0 +1,281 @@
+/*
+ * File:   scots_flat_bdd.cc
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 3, 2018, 14:40 PM
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+
+// SCOTS header
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "monitor.hh"
+
+#include "scots_flat_bdd.hh"
+
+#include "ctrl_data.hh"
+#include "input_output.hh"
+#include "inputs_mgr.hh"
+#include "flat_bdd.hh"
+#include "flat_batch.hh"
+#include "tiled_ctrl.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::logging;
+using namespace tud::utils::exceptions;
+using namespace tud::utils::monitor;
+using namespace tud::ctrl::scots::optimal;
+
+//The maximum number of inputs per state for the benchmark lookups
+static constexpr size_t MAX_BENCH_INPUTS = 1 << 16;
+
+/**
+ * Allows to compare the flat BDD lookups with the restriction on random states
+ * @param params the tool parameters
+ * @param cudd_mgr the CUDD manager
+ * @param ctrl the controller
+ * @param flat the flat BDD
+ */
+static void run_benchmark(const flat_tool_params & params, const Cudd & cudd_mgr,
+        const ctrl_data & ctrl, const flat_bdd & flat) {
+    const int32_t ss_dim = params.m_ss_dim;
+    const size_t num_states = params.m_num_bench;
+
+    //Generate the random states within the state-space grid bounds
+    const vector<double> lleft = ctrl.m_ctrl_set.get_lower_left();
+    const vector<double> uright = ctrl.m_ctrl_set.get_upper_right();
+    mt19937 gen(0);
+    vector<vector<double>> states(num_states, vector<double>(ss_dim));
+    for (auto & state : states) {
+        for (int32_t dof = 0; dof < ss_dim; ++dof) {
+            state[dof] = uniform_real_distribution<double>(lleft[dof], uright[dof])(gen);
+        }
+    }
+
+    //Compute the restriction with CUDD
+    unique_ptr<SymbolicSet> p_is_set(inputs_mgr::get_inputs_set(ctrl.m_ctrl_set, ss_dim));
+    const int32_t is_dim = p_is_set->get_dim();
+    vector<vector<abs_type>> ref_ids(num_states);
+    auto start = chrono::steady_clock::now();
+    vector<double> inputs;
+    for (size_t idx = 0; idx < num_states; ++idx) {
+        ctrl.m_ctrl_set.restriction(cudd_mgr, ctrl.m_ctrl_bdd, states[idx], inputs);
+        for (size_t in_idx = 0; in_idx < inputs.size(); in_idx += is_dim) {
+            ref_ids[idx].push_back(p_is_set->xtoi(&inputs[in_idx]));
+        }
+    }
+    const double ref_us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+
+    //Compute the flat BDD lookups
+    vector<abs_type> flat_ids(MAX_BENCH_INPUTS);
+    vector<size_t> flat_num(num_states);
+    size_t num_pairs = 0;
+    start = chrono::steady_clock::now();
+    for (size_t idx = 0; idx < num_states; ++idx) {
+        flat_num[idx] = flat.lookup(states[idx].data(), flat_ids.data(), MAX_BENCH_INPUTS);
+        num_pairs += flat_num[idx];
+    }
+    const double flat_us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+
+    //Check that the results match
+    size_t num_diff = 0;
+    for (size_t idx = 0; idx < num_states; ++idx) {
+        sort(ref_ids[idx].begin(), ref_ids[idx].end());
+        const size_t num = flat.lookup(states[idx].data(), flat_ids.data(), MAX_BENCH_INPUTS);
+        if ((num != ref_ids[idx].size()) || !equal(ref_ids[idx].begin(), ref_ids[idx].end(), flat_ids.begin())) {
+            ++num_diff;
+        }
+    }
+
+    //Compute the batch evaluation, the states are to be stored consecutively
+    flat_batch batch(cudd_mgr, ctrl.m_ctrl_set, ctrl.m_ctrl_bdd, ss_dim);
+    vector<double> batch_states;
+    for (const auto & state : states) {
+        batch_states.insert(batch_states.end(), state.begin(), state.end());
+    }
+    vector<abs_type> batch_ids(num_states);
+    start = chrono::steady_clock::now();
+    batch.evaluate(batch_states.data(), num_states, batch_ids.data());
+    const double batch_us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+
+    //Compute the per-state loop taking the smallest input ids as well
+    vector<abs_type> loop_ids(num_states);
+    start = chrono::steady_clock::now();
+    for (size_t idx = 0; idx < num_states; ++idx) {
+        loop_ids[idx] = (flat.lookup(states[idx].data(), flat_ids.data(), MAX_BENCH_INPUTS) > 0) ?
+                flat_ids[0] : FLAT_NO_INPUT;
+    }
+    const double loop_us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+    for (size_t idx = 0; idx < num_states; ++idx) {
+        if (batch_ids[idx] != loop_ids[idx]) {
+            ++num_diff;
+        }
+    }
+
+    LOG_RESULT << "Benchmarked " << num_states << " states with " << num_pairs
+            << " state-input pairs" << END_LOG;
+    LOG_RESULT << "The restriction took " << (ref_us / num_states) << " us per state" << END_LOG;
+    LOG_RESULT << "The flat BDD lookup took " << (flat_us / num_states) << " us per state, "
+            << (ref_us / max(flat_us, 1.0)) << " times faster" << END_LOG;
+    LOG_RESULT << "The per-state flat BDD loop does " << (num_states / max(loop_us, 1.0) * 1E6)
+            << " states per second" << END_LOG;
+    LOG_RESULT << "The " << flat_batch::get_simd_name() << " batch evaluation does "
+            << (num_states / max(batch_us, 1.0) * 1E6) << " states per second, "
+            << (loop_us / max(batch_us, 1.0)) << " times faster" << END_LOG;
+    ASSERT_CONDITION_THROW((num_diff > 0), string("The flat BDD lookups differ from ") +
+            string("the restriction for ") + to_string(num_diff) + string(" states!"));
+}
+
+/**
+ * Allows to compare the tiled controller lookups with the flat BDD ones on random states,
+ * the states are visited along a random walk to resemble the closed-loop trajectories
+ * @param params the tool parameters
+ * @param ctrl the controller
+ * @param flat the flat BDD
+ * @param file_name the tiled controller file name
+ */
+static void run_tiled_benchmark(const flat_tool_params & params, const ctrl_data & ctrl,
+        const flat_bdd & flat, const string & file_name) {
+    const int32_t ss_dim = params.m_ss_dim;
+    const size_t num_states = params.m_num_bench;
+    tiled_ctrl tiled(file_name, params.m_max_resident);
+
+    //Generate the random walk within the state-space grid bounds, one grid step per move
+    const vector<double> lleft = ctrl.m_ctrl_set.get_lower_left();
+    const vector<double> uright = ctrl.m_ctrl_set.get_upper_right();
+    const vector<double> eta = ctrl.m_ctrl_set.get_eta();
+    mt19937 gen(0);
+    vector<vector<double>> states(num_states, vector<double>(ss_dim));
+    for (int32_t dof = 0; dof < ss_dim; ++dof) {
+        states[0][dof] = uniform_real_distribution<double>(lleft[dof], uright[dof])(gen);
+    }
+    for (size_t idx = 1; idx < num_states; ++idx) {
+        for (int32_t dof = 0; dof < ss_dim; ++dof) {
+            const double next = states[idx - 1][dof] + eta[dof] * uniform_int_distribution<int32_t>(-1, 1)(gen);
+            states[idx][dof] = min(max(next, lleft[dof]), uright[dof]);
+        }
+    }
+
+    //Compare the lookups
+    vector<abs_type> flat_ids(MAX_BENCH_INPUTS), tiled_ids(MAX_BENCH_INPUTS);
+    size_t num_diff = 0;
+    const auto start = chrono::steady_clock::now();
+    for (size_t idx = 0; idx < num_states; ++idx) {
+        const size_t num = tiled.lookup(states[idx].data(), tiled_ids.data(), MAX_BENCH_INPUTS);
+        if ((num != flat.lookup(states[idx].data(), flat_ids.data(), MAX_BENCH_INPUTS)) ||
+                !equal(tiled_ids.begin(), tiled_ids.begin() + min(num, MAX_BENCH_INPUTS), flat_ids.begin())) {
+            ++num_diff;
+        }
+    }
+    const double both_us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+
+    LOG_RESULT << "Walked " << num_states << " states through " << tiled.get_num_tiles()
+            << " tiles, both lookups took " << (both_us / num_states) << " us per state, " << tiled.report() << END_LOG;
+    ASSERT_CONDITION_THROW((num_diff > 0), string("The tiled controller lookups differ from ") +
+            string("the flat BDD ones for ") + to_string(num_diff) + string(" states!"));
+}
+
+/**
+ * The main program entry point
+ */
+int main(int argc, char** argv) {
+    //Declare the return code
+    int return_code = 0;
+    
+    //Set the uncaught exception handler
+    std::set_terminate(handler);
+    
+    //First print the program info
+    print_info();
+    
+    //Set up possible program arguments
+    create_arguments_parser();
+
+    try {
+        //Declare the parameters structure
+        flat_tool_params params = {};
+        
+        //Attempt to extract the program arguments
+        extract_arguments(argc, argv, params);
+
+        //Load the controller
+        Cudd cudd_mgr;
+        ctrl_data ctrl;
+        load_controller_bdd(cudd_mgr, params.m_source_file, params.m_ss_dim, ctrl);
+
+        //Compile and store the flat BDD
+        const string target_file = params.m_target_file + string(".fbd");
+        {
+            //Declare the statistics data
+            DECLARE_MONITOR_STATS;
+
+            //Get the beginning statistics data
+            INITIALIZE_STATS;
+
+            flat_bdd flat(ctrl.m_ctrl_set, ctrl.m_ctrl_bdd, params.m_ss_dim);
+            flat.store(target_file);
+            LOG_RESULT << "Stored the flat BDD with " << flat.get_num_nodes() << " nodes into '"
+                    << target_file << "', " << flat.get_size() << " bytes" << END_LOG;
+
+            //Get the end stats and log them
+            REPORT_STATS(string("Compiling the flat BDD"));
+        }
+
+        //Store the tiled controller if requested
+        const string tiled_file = params.m_target_file + string(".tfb");
+        if (params.m_tile_points > 0) {
+            tiled_ctrl::store(cudd_mgr, ctrl.m_ctrl_set, ctrl.m_ctrl_bdd,
+                    params.m_ss_dim, params.m_tile_points, tiled_file);
+        }
+
+        //Benchmark the mapped flat BDD if requested
+        if (params.m_num_bench > 0) {
+            flat_bdd flat(target_file);
+            run_benchmark(params, cudd_mgr, ctrl, flat);
+            if (params.m_tile_points > 0) {
+                run_tiled_benchmark(params, ctrl, flat, tiled_file);
+            }
+        }
+        
+        LOG_USAGE << "Finished" << END_LOG;
+    } catch (std::exception & ex) {
+        //The argument's extraction has failed, print the error message and quit
+        LOG_ERROR << ex.what() << END_LOG;
+        return_code = 1;
+    }
+    
+    //Destroy the command line parameters parser
+    destroy_arguments_parser();
+    
+    return return_code;
+}
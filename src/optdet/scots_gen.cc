@@ -0,0 +1,96 @@
+/*
+ * File:   scots_gen.cc
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 18, 2018, 11:40 AM
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+
+// SCOTS header
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "monitor.hh"
+
+#include "scots_gen.hh"
+
+#include "ctrl_data.hh"
+#include "input_output.hh"
+#include "ctrl_generator.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::logging;
+using namespace tud::utils::exceptions;
+using namespace tud::utils::monitor;
+using namespace tud::ctrl::scots::optimal;
+
+/**
+ * The main program entry point
+ */
+int main(int argc, char** argv) {
+    //Declare the return code
+    int return_code = 0;
+    
+    //Set the uncaught exception handler
+    std::set_terminate(handler);
+    
+    //First print the program info
+    print_info();
+    
+    //Set up possible program arguments
+    create_arguments_parser();
+
+    try {
+        //Declare the parameters structure
+        gen_tool_params params = {};
+        
+        //Attempt to extract the program arguments
+        extract_arguments(argc, argv, params);
+
+        //Generate the controller, keep the variable order as created
+        Cudd cudd_mgr;
+        cudd_mgr.AutodynDisable();
+        ctrl_data ctrl;
+        ctrl_generator generator(cudd_mgr, params.m_config);
+        generator.generate(ctrl);
+        
+        //Store the controller
+        store_controller(cudd_mgr, ctrl.m_ctrl_set, ctrl.m_ctrl_bdd, params.m_target_file);
+        LOG_RESULT << "Stored the controller into '" << params.m_target_file << ".scs/.bdd'" << END_LOG;
+        
+        LOG_USAGE << "Finished" << END_LOG;
+    } catch (std::exception & ex) {
+        //The argument's extraction has failed, print the error message and quit
+        LOG_ERROR << ex.what() << END_LOG;
+        return_code = 1;
+    }
+    
+    //Destroy the command line parameters parser
+    destroy_arguments_parser();
+    
+    return return_code;
+}
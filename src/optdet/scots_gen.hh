@@ -0,0 +1,344 @@
+/*
+ * File:   scots_gen.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 18, 2018, 09:52 AM
+ */
+
+#ifndef SCOTS_GEN_HPP
+#define SCOTS_GEN_HPP
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <execinfo.h>
+
+//Command line parameters parser
+#include "tclap/CmdLine.h"
+
+#include "exceptions.hh"
+#include "logger.hh"
+
+#include "ctrl_generator.hh"
+
+using namespace std;
+using namespace TCLAP;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                //Declare the program version string
+#define PROGRAM_VERSION_STR "1.0"
+
+                // Check windows
+#if _WIN32 || _WIN64
+#if _WIN64
+#define ENVIRONMENT64
+#else
+#define ENVIRONMENT32
+#endif
+#endif
+
+                // Check GCC
+#if __GNUC__
+#if __x86_64__ || __ppc64__
+#define ENVIRONMENT64
+#else
+#define ENVIRONMENT32
+#endif
+#endif
+
+#define SAFE_DESTROY(ptr) \
+    if (ptr != NULL) { \
+        delete ptr; \
+        ptr = NULL; \
+    }
+
+                /**
+                 * This functions does nothing more but printing the program header information
+                 */
+                static void print_info(const char * prog_name_str) {
+                    LOG_USAGE << " ------------------------------------------------------------------ " << END_LOG;
+                    LOG_USAGE << "|                    " << prog_name_str << "          :)\\___/(: |" << END_LOG;
+                    LOG_USAGE << "|                       Software version " << PROGRAM_VERSION_STR << "             {(@)v(@)} |" << END_LOG;
+                    LOG_USAGE << "|                        DCSC, TU Delft, NL              {|~- -~|} |" << END_LOG;
+                    LOG_USAGE << "|            Copyright (C) Dr. Ivan S Zapreev, 2017-2018 {/^'^'^\\} |" << END_LOG;
+                    LOG_USAGE << "|  ═════════════════════════════════════════════════════════m-m══  |" << END_LOG;
+                    LOG_USAGE << "|        This software is distributed under GPL 2.0 license        |" << END_LOG;
+                    LOG_USAGE << "|          (GPL stands for GNU General Public License)             |" << END_LOG;
+                    LOG_USAGE << "|          The product comes with ABSOLUTELY NO WARRANTY.          |" << END_LOG;
+                    LOG_USAGE << "|   This is a free software, you are welcome to redistribute it.   |" << END_LOG;
+#ifdef ENVIRONMENT64
+                    LOG_USAGE << "|                     Running in 64 bit mode!                      |" << END_LOG;
+#else
+                    LOG_USAGE << "|                     Running in 32 bit mode!                      |" << END_LOG;
+#endif
+                    LOG_USAGE << "|                 Build on: " << __DATE__ << " " << __TIME__ << "                   |" << END_LOG;
+                    LOG_USAGE << " ------------------------------------------------------------------ " << END_LOG;
+                }
+
+                //Declare the maximum stack trace depth
+#define MAX_STACK_TRACE_LEN 100
+
+                /**
+                 * The uncaught exceptions handler
+                 */
+                static void handler() {
+                    void *trace_elems[20];
+                    int trace_elem_count(backtrace(trace_elems, MAX_STACK_TRACE_LEN));
+                    char **stack_syms(backtrace_symbols(trace_elems, trace_elem_count));
+                    LOG_ERROR << "Ooops, Sorry! Something terrible has happened, we crashed!" << END_LOG;
+                    for (int i = 0; i < trace_elem_count; ++i) {
+                        LOG_ERROR << stack_syms[i] << END_LOG;
+                    }
+                    free(stack_syms);
+                    exit(1);
+                }
+                
+                
+                
+                /**
+                 * This structure stores the tool's input parameters
+                 */
+                struct gen_tool_params {
+                    //Stores the output file name
+                    string m_target_file;
+                    //Stores the generated controller configuration
+                    gen_config m_config;
+                };
+                
+                //The pointer to the command line parameters parser
+                static CmdLine * p_cmd_args = NULL;
+                static ValueArg<string> * p_target_file_arg = NULL;
+                static ValueArg<int32_t> * p_ss_dim_arg = NULL;
+                static MultiArg<int32_t> * p_ss_points_arg = NULL;
+                static ValueArg<int32_t> * p_is_dim_arg = NULL;
+                static MultiArg<int32_t> * p_is_points_arg = NULL;
+                static ValueArg<double> * p_density_arg = NULL;
+                static ValueArg<double> * p_mean_inputs_arg = NULL;
+                static vector<string> dists = {"const", "uniform", "geometric"};
+                static ValuesConstraint<string> * p_dist_constr = NULL;
+                static ValueArg<string> * p_dist_arg = NULL;
+                static vector<string> structs = {"smooth", "noise", "checker"};
+                static ValuesConstraint<string> * p_struct_constr = NULL;
+                static ValueArg<string> * p_struct_arg = NULL;
+                static ValueArg<int32_t> * p_scale_arg = NULL;
+                static ValueArg<uint64_t> * p_seed_arg = NULL;
+                static vector<string> debug_levels;
+                static ValuesConstraint<string> * p_debug_levels_constr = NULL;
+                static ValueArg<string> * p_debug_level_arg = NULL;
+                
+                /**
+                 * This functions does nothing more but printing the program header information
+                 */
+                static void print_info() {
+                    print_info("Controller Generator for SCOTSv2.0");
+                }
+                
+                /**
+                 * Creates and sets up the command line parameters parser
+                 */
+                void create_arguments_parser() {
+                    //Declare the command line arguments parser
+                    p_cmd_args = new CmdLine("", ' ', PROGRAM_VERSION_STR);
+                    
+                    //Add the output controller file parameter - compulsory
+                    p_target_file_arg = new ValueArg<string>("t", "target-controller", string("The SCOTSv2.0 BDD controller ") +
+                                                             string("file name without (.scs/.bdd)"), true, "",
+                                                             "target controller file name", *p_cmd_args);
+                    
+                    //Add the number of state-space dimensions - compulsory
+                    p_ss_dim_arg = new ValueArg<int32_t>("d", "state-dimension", string("The number of state space dimensions"),
+                                                         true, 0, "state-space dimensionality", *p_cmd_args);
+                    
+                    //Add the state-space grid resolution - compulsory, one for all or one per dimension
+                    p_ss_points_arg = new MultiArg<int32_t>("g", "state-points", string("The number of grid points ") +
+                                                            string("per state space dimension, one for all or one per dimension"),
+                                                            true, "state grid points", *p_cmd_args);
+                    
+                    //Add the number of input-space dimensions - optional
+                    p_is_dim_arg = new ValueArg<int32_t>("i", "input-dimension", string("The number of input space dimensions"),
+                                                         false, 1, "input-space dimensionality", *p_cmd_args);
+                    
+                    //Add the input-space grid resolution - optional, one for all or one per dimension, default is 8
+                    p_is_points_arg = new MultiArg<int32_t>("k", "input-points", string("The number of grid points per ") +
+                                                            string("input space dimension, one for all or one per dimension, default is 8"),
+                                                            false, "input grid points", *p_cmd_args);
+                    
+                    //Add the domain density - optional
+                    p_density_arg = new ValueArg<double>("e", "density", string("The fraction of the grid states ") +
+                                                         string("in the controller's domain"), false, 1.0,
+                                                         "domain density", *p_cmd_args);
+                    
+                    //Add the mean number of inputs per state - optional
+                    p_mean_inputs_arg = new ValueArg<double>("p", "inputs", string("The mean number of inputs per ") +
+                                                             string("domain state"), false, 1.0,
+                                                             "mean inputs per state", *p_cmd_args);
+                    
+                    //Add the inputs per state distribution - optional
+                    p_dist_constr = new ValuesConstraint<string>(dists);
+                    p_dist_arg = new ValueArg<string>("y", "distribution", string("The inputs per state distribution: ") +
+                                                      string("const - the rounded mean, uniform - within [1, 2*mean-1], ") +
+                                                      string("geometric - one plus the geometric of the given mean"),
+                                                      false, dists.front(), p_dist_constr, *p_cmd_args);
+                    
+                    //Add the spatial structure - optional
+                    p_struct_constr = new ValuesConstraint<string>(structs);
+                    p_struct_arg = new ValueArg<string>("s", "structure", string("The spatial structure: smooth - the ") +
+                                                        string("inputs are constant on the Voronoi regions of random seeds, ") +
+                                                        string("noise - the inputs are random per state, checker - the inputs ") +
+                                                        string("alternate on the hyper-cubic cells"), false, structs.front(),
+                                                        p_struct_constr, *p_cmd_args);
+                    
+                    //Add the structure scale - optional
+                    p_scale_arg = new ValueArg<int32_t>("r", "scale", string("The number of regions if smooth, ") +
+                                                        string("the cell width in grid points if checker"), false, 16,
+                                                        "structure scale", *p_cmd_args);
+                    
+                    //Add the random seed - optional
+                    p_seed_arg = new ValueArg<uint64_t>("z", "seed", string("The random seed"), false, 1,
+                                                        "random seed", *p_cmd_args);
+                    
+                    //Add the -d the debug level parameter - optional, default is e.g. RESULT
+                    logger::get_reporting_levels(&debug_levels);
+                    p_debug_levels_constr = new ValuesConstraint<string>(debug_levels);
+                    p_debug_level_arg = new ValueArg<string>("l", "logging", "The log level to be used",
+                                                             false, RESULT_PARAM_VALUE, p_debug_levels_constr, *p_cmd_args);
+                }
+                
+                /**
+                 * Allows to get the grid points per dimension, one given value is used for all dimensions
+                 * @param name the space name for logging
+                 * @param dim the number of dimensions
+                 * @param points the given grid points, to be resized to the number of dimensions
+                 */
+                static void extract_points(const string & name, const int32_t dim, vector<int32_t> & points) {
+                    ASSERT_CONDITION_THROW((points.size() != 1) && (points.size() != (size_t) dim),
+                                           string("The number of ") + name + string(" grid point values: ") +
+                                           to_string(points.size()) + string(" must be 1 or ") + to_string(dim));
+                    points.resize(dim, points.front());
+                    for (int32_t dof = 0; dof < dim; ++dof) {
+                        LOG_USAGE << "The " << name << " dimension #" << dof << " grid points: " << points[dof] << END_LOG;
+                        ASSERT_CONDITION_THROW((points[dof] <= 0), string("Improper number of grid points: ") +
+                                               to_string(points[dof]) + string(" must be > 0 "));
+                    }
+                }
+                
+                /**
+                 * This function tries to extract the
+                 * @param argc the number of program arguments
+                 * @param argv the array of program arguments
+                 * @param params the structure to store the tool parameter values
+                 */
+                static void extract_arguments(const uint argc,
+                                              char const * const * const argv,
+                                              gen_tool_params & params) {
+                    //Parse the arguments
+                    try {
+                        p_cmd_args->parse(argc, argv);
+                    } catch (ArgException &e) {
+                        THROW_EXCEPTION(string("Error: ") + e.error() + string(", for argument: ") + e.argId());
+                    }
+                    
+                    //Set the logging level right away
+                    logger::set_reporting_level(p_debug_level_arg->getValue());
+                    
+                    //Store the parsed parameter values
+                    params.m_target_file = p_target_file_arg->getValue();
+                    LOG_USAGE << "Given BDD controller output file: '" << params.m_target_file << "'" << END_LOG;
+                    
+                    const int32_t ss_dim = p_ss_dim_arg->getValue();
+                    LOG_USAGE << "The state-space dimensionality is: " << ss_dim << END_LOG;
+                    ASSERT_CONDITION_THROW((ss_dim <= 0), string("Improper number of state-space dimensions: ") +
+                                           to_string(ss_dim) + string(" must be > 0 "));
+                    params.m_config.m_ss_points = p_ss_points_arg->getValue();
+                    extract_points("state", ss_dim, params.m_config.m_ss_points);
+                    
+                    const int32_t is_dim = p_is_dim_arg->getValue();
+                    LOG_USAGE << "The input-space dimensionality is: " << is_dim << END_LOG;
+                    ASSERT_CONDITION_THROW((is_dim <= 0), string("Improper number of input-space dimensions: ") +
+                                           to_string(is_dim) + string(" must be > 0 "));
+                    params.m_config.m_is_points = p_is_points_arg->getValue();
+                    if (params.m_config.m_is_points.empty()) {
+                        params.m_config.m_is_points.push_back(8);
+                    }
+                    extract_points("input", is_dim, params.m_config.m_is_points);
+                    
+                    params.m_config.m_density = p_density_arg->getValue();
+                    LOG_USAGE << "The domain density is: " << params.m_config.m_density << END_LOG;
+                    ASSERT_CONDITION_THROW((params.m_config.m_density <= 0.0) || (params.m_config.m_density > 1.0),
+                                           string("Improper domain density: ") + to_string(params.m_config.m_density) +
+                                           string(" must be within (0,1]"));
+                    
+                    params.m_config.m_mean_inputs = p_mean_inputs_arg->getValue();
+                    params.m_config.m_dist = static_cast<gen_dist_enum> (find(dists.begin(), dists.end(),
+                                                                              p_dist_arg->getValue()) - dists.begin());
+                    LOG_USAGE << "The mean number of inputs per state is: " << params.m_config.m_mean_inputs
+                            << ", distribution: " << p_dist_arg->getValue() << END_LOG;
+                    ASSERT_CONDITION_THROW((params.m_config.m_mean_inputs < 1.0),
+                                           string("Improper mean number of inputs per state: ") +
+                                           to_string(params.m_config.m_mean_inputs) + string(" must be >= 1"));
+                    
+                    params.m_config.m_struct = static_cast<gen_struct_enum> (find(structs.begin(), structs.end(),
+                                                                                  p_struct_arg->getValue()) - structs.begin());
+                    params.m_config.m_scale = p_scale_arg->getValue();
+                    LOG_USAGE << "The spatial structure is: " << p_struct_arg->getValue()
+                            << ", scale: " << params.m_config.m_scale << END_LOG;
+                    ASSERT_CONDITION_THROW((params.m_config.m_scale <= 0), string("Improper structure scale: ") +
+                                           to_string(params.m_config.m_scale) + string(" must be > 0 "));
+                    
+                    params.m_config.m_seed = p_seed_arg->getValue();
+                    LOG_USAGE << "The random seed is: " << params.m_config.m_seed << END_LOG;
+                }
+                
+                /**
+                 * Allows to deallocate the parameters parser if it is needed
+                 */
+                void destroy_arguments_parser() {
+                    SAFE_DESTROY(p_target_file_arg);
+                    SAFE_DESTROY(p_ss_dim_arg);
+                    SAFE_DESTROY(p_ss_points_arg);
+                    SAFE_DESTROY(p_is_dim_arg);
+                    SAFE_DESTROY(p_is_points_arg);
+                    SAFE_DESTROY(p_density_arg);
+                    SAFE_DESTROY(p_mean_inputs_arg);
+                    SAFE_DESTROY(p_dist_constr);
+                    SAFE_DESTROY(p_dist_arg);
+                    SAFE_DESTROY(p_struct_constr);
+                    SAFE_DESTROY(p_struct_arg);
+                    SAFE_DESTROY(p_scale_arg);
+                    SAFE_DESTROY(p_seed_arg);
+                    SAFE_DESTROY(p_debug_levels_constr);
+                    SAFE_DESTROY(p_debug_level_arg);
+                    SAFE_DESTROY(p_cmd_args);
+                }
+            }
+        }
+    }
+}
+
+#endif /* SCOTS_GEN_HPP */
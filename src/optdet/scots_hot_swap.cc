@@ -0,0 +1,177 @@
+/*
+ * File:   scots_hot_swap.cc
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 5, 2018, 14:02 PM
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <memory>
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "monitor.hh"
+
+#include "scots_hot_swap.hh"
+
+#include "flat_bdd.hh"
+#include "ctrl_runtime.hh"
+#include "latency_histogram.hh"
+
+using namespace std;
+
+using namespace tud::utils::logging;
+using namespace tud::utils::exceptions;
+using namespace tud::utils::monitor;
+using namespace tud::ctrl::scots::optimal;
+
+//The maximum number of inputs per state for the benchmark lookups
+static constexpr size_t MAX_SWAP_INPUTS = 1 << 10;
+//The number of pre-generated random states per reader
+static constexpr size_t NUM_READER_STATES = 1 << 12;
+
+/**
+ * Allows to run the reader until the stop flag is set
+ * @param runtime the controller runtime
+ * @param ss_dims the state-space grid dimensions
+ * @param seed the random states seed
+ * @param is_stop the stop flag
+ * @param latency the lookup latency histogram to add the reader's samples to
+ * @param num_lookups the number of lookups to add the reader's lookups to
+ */
+static void run_reader(ctrl_runtime & runtime, const vector<flat_bdd_dim> & ss_dims,
+        const size_t seed, const atomic<bool> & is_stop, latency_histogram & latency,
+        atomic<uint64_t> & num_lookups) {
+    const size_t ss_dim = ss_dims.size();
+    const size_t is_dim = runtime.get_is_dim();
+
+    //Generate the random states within the state-space grid bounds
+    mt19937 gen(seed);
+    vector<double> states(NUM_READER_STATES * ss_dim);
+    for (size_t idx = 0; idx < NUM_READER_STATES; ++idx) {
+        for (size_t dof = 0; dof < ss_dim; ++dof) {
+            const double last = ss_dims[dof].m_first + (ss_dims[dof].m_num_points - 1) * ss_dims[dof].m_eta;
+            states[idx * ss_dim + dof] = uniform_real_distribution<double>(ss_dims[dof].m_first, last)(gen);
+        }
+    }
+
+    //Query the runtime, the samples are kept locally not to share the cache lines
+    ctrl_runtime::reader reader(runtime, MAX_SWAP_INPUTS);
+    latency_histogram local("ns");
+    vector<double> inputs(MAX_SWAP_INPUTS * is_dim);
+    uint64_t num = 0;
+    while (!is_stop.load(memory_order_relaxed)) {
+        const double * state = &states[(num % NUM_READER_STATES) * ss_dim];
+        const auto start = chrono::steady_clock::now();
+        reader.lookup(state, inputs.data(), MAX_SWAP_INPUTS);
+        local.add(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+        ++num;
+    }
+    latency.add(local);
+    num_lookups.fetch_add(num);
+}
+
+/**
+ * The main program entry point
+ */
+int main(int argc, char** argv) {
+    //Declare the return code
+    int return_code = 0;
+    
+    //Set the uncaught exception handler
+    std::set_terminate(handler);
+    
+    //First print the program info
+    print_info();
+    
+    //Set up possible program arguments
+    create_arguments_parser();
+
+    try {
+        //Declare the parameters structure
+        swap_tool_params params = {};
+        
+        //Attempt to extract the program arguments
+        extract_arguments(argc, argv, params);
+
+        vector<string> file_names;
+        for (const auto & file_name : params.m_ctrl_files) {
+            file_names.push_back(file_name + string(".fbd"));
+        }
+
+        //Get the state-space grid of the first controller to generate the states within
+        vector<flat_bdd_dim> ss_dims;
+        {
+            flat_bdd first(file_names[0]);
+            ss_dims.assign(first.get_dims(), first.get_dims() + first.get_ss_dim());
+        }
+
+        //Start the runtime and the readers
+        ctrl_runtime runtime(file_names[0]);
+        latency_histogram latency("ns");
+        atomic<uint64_t> num_lookups(0);
+        atomic<bool> is_stop(false);
+        vector<thread> readers;
+        for (int32_t idx = 0; idx < params.m_num_readers; ++idx) {
+            readers.push_back(thread(run_reader, ref(runtime), cref(ss_dims), idx,
+                    cref(is_stop), ref(latency), ref(num_lookups)));
+        }
+
+        //Request the swaps cyclically until the time is up
+        const auto end = chrono::steady_clock::now() + chrono::seconds(params.m_duration);
+        size_t next = 1;
+        while (chrono::steady_clock::now() < end) {
+            this_thread::sleep_for(chrono::milliseconds(params.m_period));
+            runtime.request_swap(file_names[next % file_names.size()]);
+            ++next;
+        }
+        is_stop.store(true);
+        for (auto & reader : readers) {
+            reader.join();
+        }
+
+        LOG_RESULT << "Did " << num_lookups.load() << " lookups in " << params.m_duration << " sec. with "
+                << params.m_num_readers << " readers, " << (num_lookups.load() / params.m_duration)
+                << " lookups per second" << END_LOG;
+        LOG_RESULT << "Requested " << (next - 1) << " swaps, published " << (runtime.get_num_versions() - 1)
+                << " versions, rejected " << runtime.get_num_failed() << " versions" << END_LOG;
+        LOG_RESULT << latency.report("Lookup latency") << END_LOG;
+        LOG_RESULT << runtime.get_swap_latency().report("Swap latency") << END_LOG;
+        
+        LOG_USAGE << "Finished" << END_LOG;
+    } catch (std::exception & ex) {
+        //The argument's extraction has failed, print the error message and quit
+        LOG_ERROR << ex.what() << END_LOG;
+        return_code = 1;
+    }
+    
+    //Destroy the command line parameters parser
+    destroy_arguments_parser();
+    
+    return return_code;
+}
@@ -0,0 +1,248 @@
+/*
+ * File:   scots_hot_swap.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 5, 2018, 14:02 PM
+ */
+
+#ifndef SCOTS_HOT_SWAP_HPP
+#define SCOTS_HOT_SWAP_HPP
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <execinfo.h>
+
+//Command line parameters parser
+#include "tclap/CmdLine.h"
+
+#include "exceptions.hh"
+#include "logger.hh"
+
+#include "ctrl_runtime.hh"
+
+using namespace std;
+using namespace TCLAP;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                //Declare the program version string
+#define PROGRAM_VERSION_STR "1.0"
+
+                // Check windows
+#if _WIN32 || _WIN64
+#if _WIN64
+#define ENVIRONMENT64
+#else
+#define ENVIRONMENT32
+#endif
+#endif
+
+                // Check GCC
+#if __GNUC__
+#if __x86_64__ || __ppc64__
+#define ENVIRONMENT64
+#else
+#define ENVIRONMENT32
+#endif
+#endif
+
+#define SAFE_DESTROY(ptr) \
+    if (ptr != NULL) { \
+        delete ptr; \
+        ptr = NULL; \
+    }
+
+                /**
+                 * This functions does nothing more but printing the program header information
+                 */
+                static void print_info(const char * prog_name_str) {
+                    LOG_USAGE << " ------------------------------------------------------------------ " << END_LOG;
+                    LOG_USAGE << "|                    " << prog_name_str << "          :)\\___/(: |" << END_LOG;
+                    LOG_USAGE << "|                       Software version " << PROGRAM_VERSION_STR << "             {(@)v(@)} |" << END_LOG;
+                    LOG_USAGE << "|                        DCSC, TU Delft, NL              {|~- -~|} |" << END_LOG;
+                    LOG_USAGE << "|            Copyright (C) Dr. Ivan S Zapreev, 2017-2018 {/^'^'^\\} |" << END_LOG;
+                    LOG_USAGE << "|  ═════════════════════════════════════════════════════════m-m══  |" << END_LOG;
+                    LOG_USAGE << "|        This software is distributed under GPL 2.0 license        |" << END_LOG;
+                    LOG_USAGE << "|          (GPL stands for GNU General Public License)             |" << END_LOG;
+                    LOG_USAGE << "|          The product comes with ABSOLUTELY NO WARRANTY.          |" << END_LOG;
+                    LOG_USAGE << "|   This is a free software, you are welcome to redistribute it.   |" << END_LOG;
+#ifdef ENVIRONMENT64
+                    LOG_USAGE << "|                     Running in 64 bit mode!                      |" << END_LOG;
+#else
+                    LOG_USAGE << "|                     Running in 32 bit mode!                      |" << END_LOG;
+#endif
+                    LOG_USAGE << "|                 Build on: " << __DATE__ << " " << __TIME__ << "                   |" << END_LOG;
+                    LOG_USAGE << " ------------------------------------------------------------------ " << END_LOG;
+                }
+
+                //Declare the maximum stack trace depth
+#define MAX_STACK_TRACE_LEN 100
+
+                /**
+                 * The uncaught exceptions handler
+                 */
+                static void handler() {
+                    void *trace_elems[20];
+                    int trace_elem_count(backtrace(trace_elems, MAX_STACK_TRACE_LEN));
+                    char **stack_syms(backtrace_symbols(trace_elems, trace_elem_count));
+                    LOG_ERROR << "Ooops, Sorry! Something terrible has happened, we crashed!" << END_LOG;
+                    for (int i = 0; i < trace_elem_count; ++i) {
+                        LOG_ERROR << stack_syms[i] << END_LOG;
+                    }
+                    free(stack_syms);
+                    exit(1);
+                }
+                
+                
+                /**
+                 * This structure stores the tool's input parameters
+                 */
+                struct swap_tool_params {
+                    //Stores the flat BDD controller file names
+                    vector<string> m_ctrl_files;
+                    //The number of reader threads
+                    int32_t m_num_readers;
+                    //The benchmark duration in seconds
+                    int32_t m_duration;
+                    //The controller swap period in milliseconds
+                    int32_t m_period;
+                };
+                
+                //The pointer to the command line parameters parser
+                static CmdLine * p_cmd_args = NULL;
+                static MultiArg<string> * p_ctrl_files_arg = NULL;
+                static ValueArg<int32_t> * p_num_readers_arg = NULL;
+                static ValueArg<int32_t> * p_duration_arg = NULL;
+                static ValueArg<int32_t> * p_period_arg = NULL;
+                static vector<string> debug_levels;
+                static ValuesConstraint<string> * p_debug_levels_constr = NULL;
+                static ValueArg<string> * p_debug_level_arg = NULL;
+                
+                /**
+                 * This functions does nothing more but printing the program header information
+                 */
+                static void print_info() {
+                    print_info("Controller Hot Swap Bench for SCOTSv2.0");
+                }
+                
+                /**
+                 * Creates and sets up the command line parameters parser
+                 */
+                void create_arguments_parser() {
+                    //Declare the command line arguments parser
+                    p_cmd_args = new CmdLine("", ' ', PROGRAM_VERSION_STR);
+                    
+                    //Add the flat BDD controller file parameters - compulsory, swapped in the given order
+                    p_ctrl_files_arg = new MultiArg<string>("c", "controller", string("The flat BDD controller ") +
+                                                            string("file name without (.fbd), the controllers are ") +
+                                                            string("swapped cyclically in the given order"), true,
+                                                            "controller file name", *p_cmd_args);
+                    
+                    //Add the number of reader threads - optional, default is 4
+                    p_num_readers_arg = new ValueArg<int32_t>("r", "readers", string("The number of reader threads"),
+                                                              false, 4, "number of readers", *p_cmd_args);
+                    
+                    //Add the benchmark duration - optional, default is 10 seconds
+                    p_duration_arg = new ValueArg<int32_t>("t", "time", string("The benchmark duration in seconds"),
+                                                           false, 10, "duration", *p_cmd_args);
+                    
+                    //Add the swap period - optional, default is 100 milliseconds
+                    p_period_arg = new ValueArg<int32_t>("p", "period", string("The controller swap period ") +
+                                                         string("in milliseconds"), false, 100, "swap period", *p_cmd_args);
+                    
+                    //Add the -d the debug level parameter - optional, default is e.g. RESULT
+                    logger::get_reporting_levels(&debug_levels);
+                    p_debug_levels_constr = new ValuesConstraint<string>(debug_levels);
+                    p_debug_level_arg = new ValueArg<string>("l", "logging", "The log level to be used",
+                                                             false, RESULT_PARAM_VALUE, p_debug_levels_constr, *p_cmd_args);
+                }
+                
+                /**
+                 * This function tries to extract the
+                 * @param argc the number of program arguments
+                 * @param argv the array of program arguments
+                 * @param params the structure to store the tool parameter values
+                 */
+                static void extract_arguments(const uint argc,
+                                              char const * const * const argv,
+                                              swap_tool_params & params) {
+                    //Parse the arguments
+                    try {
+                        p_cmd_args->parse(argc, argv);
+                    } catch (ArgException &e) {
+                        THROW_EXCEPTION(string("Error: ") + e.error() + string(", for argument: ") + e.argId());
+                    }
+                    
+                    //Set the logging level right away
+                    logger::set_reporting_level(p_debug_level_arg->getValue());
+                    
+                    //Store the parsed parameter values
+                    params.m_ctrl_files = p_ctrl_files_arg->getValue();
+                    for (const auto & file_name : params.m_ctrl_files) {
+                        LOG_USAGE << "Given flat BDD controller file: '" << file_name << "'" << END_LOG;
+                    }
+                    
+                    params.m_num_readers = p_num_readers_arg->getValue();
+                    LOG_USAGE << "The number of reader threads is: " << params.m_num_readers << END_LOG;
+                    ASSERT_CONDITION_THROW((params.m_num_readers <= 0) ||
+                                           (params.m_num_readers > (int32_t) RUNTIME_MAX_READERS),
+                                           string("Improper number of reader threads: ") +
+                                           to_string(params.m_num_readers) + string(" must be within [1, ") +
+                                           to_string(RUNTIME_MAX_READERS) + string("]"));
+                    
+                    params.m_duration = p_duration_arg->getValue();
+                    LOG_USAGE << "The benchmark duration is: " << params.m_duration << " sec." << END_LOG;
+                    ASSERT_CONDITION_THROW((params.m_duration <= 0),
+                                           string("Improper benchmark duration: ") +
+                                           to_string(params.m_duration) + string(" must be > 0 ") );
+                    
+                    params.m_period = p_period_arg->getValue();
+                    LOG_USAGE << "The controller swap period is: " << params.m_period << " ms." << END_LOG;
+                    ASSERT_CONDITION_THROW((params.m_period <= 0),
+                                           string("Improper controller swap period: ") +
+                                           to_string(params.m_period) + string(" must be > 0 ") );
+                }
+                
+                /**
+                 * Allows to deallocate the parameters parser if it is needed
+                 */
+                void destroy_arguments_parser() {
+                    SAFE_DESTROY(p_ctrl_files_arg);
+                    SAFE_DESTROY(p_num_readers_arg);
+                    SAFE_DESTROY(p_duration_arg);
+                    SAFE_DESTROY(p_period_arg);
+                    SAFE_DESTROY(p_debug_levels_constr);
+                    SAFE_DESTROY(p_debug_level_arg);
+                    SAFE_DESTROY(p_cmd_args);
+                }
+            }
+        }
+    }
+}
+
+#endif /* SCOTS_HOT_SWAP_HPP */
@@ -41,6 +41,13 @@
 #include "input_output.hh"
 #include "greedy_optimizer.hh"
 #include "space_optimizer.hh"
+#include "stream_optimizer.hh"
+#include "incr_optimizer.hh"
+#include "comp_decoder.hh"
+#include "dense_table.hh"
+#include "ctrl_add.hh"
+#include "rect_cover.hh"
+#include "cudd_metrics.hh"
 
 using namespace std;
 using namespace scots;
@@ -51,6 +58,220 @@ using namespace tud::utils::exceptions;
 using namespace tud::utils::monitor;
 using namespace tud::ctrl::scots::optimal;
 
+/**
+ * Allows to verify the stored compressed controller by decoding it and
+ * comparing it with the determinized controller on every state
+ * @param cudd_mgr the CUDD manager of the determinized controller
+ * @param output_ctrl the determinized controller
+ * @param params the tool parameters
+ * @param type the compression type
+ */
+static void verify_comp_controller(const Cudd & cudd_mgr,
+                                   const ctrl_data & output_ctrl,
+                                   const det_tool_params & params,
+                                   const store_type_enum type) {
+    const string file_name = get_comp_file_name(params.m_target_file, type);
+    
+    //Decode the compressed controller and compare
+    comp_decoder decoder(file_name, params.m_ss_dim, type);
+    const size_t num_mismatches = decoder.verify(cudd_mgr, output_ctrl.m_ctrl_set, output_ctrl.m_ctrl_bdd);
+    
+    ASSERT_CONDITION_THROW((num_mismatches > 0), string("The compressed controller '") + file_name +
+                           string("' does not match the determinized one in ") +
+                           to_string(num_mismatches) + string(" states"));
+    
+    LOG_RESULT << "The compressed controller '" << file_name << "' with "
+    << decoder.get_num_switches() << " switch points matches the determinized one on all "
+    << decoder.get_num_states() << " states" << END_LOG;
+}
+
+/**
+ * Allows to verify the stored dense table by mapping it and comparing
+ * it with the determinized controller on every grid state
+ * @param cudd_mgr the CUDD manager of the determinized controller
+ * @param output_ctrl the determinized controller
+ * @param params the tool parameters
+ * @param type the dense table type
+ */
+static void verify_dense_table(const Cudd & cudd_mgr,
+                               const ctrl_data & output_ctrl,
+                               const det_tool_params & params,
+                               const store_type_enum type) {
+    const string file_name = get_comp_file_name(params.m_target_file, type);
+    
+    //Map the dense table and compare
+    dense_table table(file_name);
+    const size_t num_mismatches = table.verify(cudd_mgr, output_ctrl.m_ctrl_set, output_ctrl.m_ctrl_bdd);
+    
+    ASSERT_CONDITION_THROW((num_mismatches > 0), string("The dense table '") + file_name +
+                           string("' does not match the determinized controller in ") +
+                           to_string(num_mismatches) + string(" states"));
+    
+    LOG_RESULT << "The dense table '" << file_name << "' matches the determinized controller on all "
+    << table.get_num_states() << " grid states" << END_LOG;
+}
+
+/**
+ * Allows to verify the stored rectangle cover by looking up every grid state
+ * @param cudd_mgr the CUDD manager of the determinized controller
+ * @param output_ctrl the determinized controller
+ * @param params the tool parameters
+ */
+static void verify_rect_cover(const Cudd & cudd_mgr,
+                              const ctrl_data & output_ctrl,
+                              const det_tool_params & params) {
+    const string file_name = get_comp_file_name(params.m_target_file, store_type_enum::rect);
+    
+    //Map the rectangle cover and compare
+    rect_cover cover(file_name);
+    const size_t num_mismatches = cover.verify(cudd_mgr, output_ctrl.m_ctrl_set, output_ctrl.m_ctrl_bdd);
+    
+    ASSERT_CONDITION_THROW((num_mismatches > 0), string("The rectangle cover '") + file_name +
+                           string("' does not match the determinized controller in ") +
+                           to_string(num_mismatches) + string(" states"));
+    
+    LOG_RESULT << "The rectangle cover '" << file_name << "' of " << cover.get_num_rects()
+    << " rectangles matches the determinized controller on all grid states" << END_LOG;
+}
+
+/**
+ * Allows to verify the stored ADD controller by loading it, converting it back
+ * into the relational BDD and looking up every domain state with the ADD walk
+ * @param cudd_mgr the CUDD manager of the determinized controller
+ * @param output_ctrl the determinized controller
+ * @param params the tool parameters
+ */
+static void verify_add_ctrl(const Cudd & cudd_mgr,
+                            const ctrl_data & output_ctrl,
+                            const det_tool_params & params) {
+    const string file_name = get_comp_file_name(params.m_target_file, store_type_enum::mtbdd);
+    
+    //Load the ADD into the same manager, the variables are matched by ids
+    SymbolicSet add_set;
+    ADD add;
+    ctrl_add::load(cudd_mgr, add_set, add, file_name);
+    const BDD ctrl_bdd = ctrl_add::to_relation(cudd_mgr, add_set, add, params.m_ss_dim);
+    ASSERT_CONDITION_THROW((ctrl_bdd != output_ctrl.m_ctrl_bdd), string("The ADD controller '") +
+                           file_name + string("' does not match the determinized one"));
+    
+    //Look up every state-input pair of the determinized controller
+    const ctrl_add lookup(add_set, add, params.m_ss_dim);
+    const int32_t c_dim = add_set.get_dim();
+    unique_ptr<SymbolicSet> p_is_set(inputs_mgr::get_inputs_set(add_set, params.m_ss_dim));
+    abs_type num_pairs = 0;
+    abs_type * p_dofs = add_set.bdd_to_grid_point_ids(cudd_mgr, output_ctrl.m_ctrl_bdd, num_pairs);
+    size_t num_mismatches = 0;
+    for (abs_type idx = 0; idx < num_pairs; ++idx) {
+        abs_type is_id = 0, add_id = 0;
+        p_is_set->istoi(&p_dofs[idx * c_dim + params.m_ss_dim], is_id);
+        if (!lookup.lookup_dofs(&p_dofs[idx * c_dim], add_id) || (add_id != is_id)) {
+            ++num_mismatches;
+        }
+    }
+    delete[] p_dofs;
+    ASSERT_CONDITION_THROW((num_mismatches > 0), string("The ADD controller '") + file_name +
+                           string("' lookups do not match the determinized one in ") +
+                           to_string(num_mismatches) + string(" states"));
+    
+    LOG_RESULT << "The ADD controller '" << file_name << "' with " << add.nodeCount()
+    << " nodes matches the determinized one on all " << num_pairs << " states" << END_LOG;
+}
+
+/**
+ * Allows to verify the stored don't care minimized controller, it shall
+ * agree with the determinized controller on the stored domain
+ * @param cudd_mgr the CUDD manager of the determinized controller
+ * @param output_ctrl the determinized controller
+ * @param params the tool parameters
+ */
+static void verify_dc_min_ctrl(const Cudd & cudd_mgr,
+                               const ctrl_data & output_ctrl,
+                               const det_tool_params & params) {
+    const string file_name = get_comp_file_name(params.m_target_file, store_type_enum::dont_care);
+    
+    //Load the minimized controller and its domain
+    ctrl_data min_ctrl, dom_ctrl;
+    load_controller_bdd(cudd_mgr, file_name, params.m_ss_dim, min_ctrl);
+    load_controller_bdd(cudd_mgr, file_name + string(".dom"), params.m_ss_dim, dom_ctrl);
+    
+    ASSERT_CONDITION_THROW(((min_ctrl.m_ctrl_bdd & dom_ctrl.m_ctrl_bdd) != output_ctrl.m_ctrl_bdd),
+                           string("The don't care minimized controller '") + file_name +
+                           string("' does not match the determinized one on the domain"));
+    
+    LOG_RESULT << "The don't care minimized controller '" << file_name
+    << "' matches the determinized one on its domain" << END_LOG;
+}
+
+/**
+ * Allows to verify the stored approximated controller, it shall be a sub-controller
+ * of the determinized one losing at most the allowed fraction of the domain states
+ * @param cudd_mgr the CUDD manager of the determinized controller
+ * @param output_ctrl the determinized controller
+ * @param params the tool parameters
+ */
+static void verify_approx_ctrl(const Cudd & cudd_mgr,
+                               const ctrl_data & output_ctrl,
+                               const det_tool_params & params) {
+    const string file_name = get_comp_file_name(params.m_target_file, store_type_enum::approx);
+    
+    //Load the approximated controller
+    ctrl_data apx_ctrl;
+    load_controller_bdd(cudd_mgr, file_name, params.m_ss_dim, apx_ctrl);
+    ASSERT_CONDITION_THROW(!apx_ctrl.m_ctrl_bdd.Leq(output_ctrl.m_ctrl_bdd),
+                           string("The approximated controller '") + file_name +
+                           string("' is not a sub-controller of the determinized one"));
+    
+    //Count the lost domain states
+    unique_ptr<SymbolicSet> p_is_set(inputs_mgr::get_inputs_set(output_ctrl.m_ctrl_set, params.m_ss_dim));
+    const BDD is_cube = p_is_set->get_cube(cudd_mgr);
+    const BDD lost_bdd = output_ctrl.m_ctrl_bdd.ExistAbstract(is_cube) & !apx_ctrl.m_ctrl_bdd.ExistAbstract(is_cube);
+    unique_ptr<SymbolicSet> p_ss_set(states_mgr::get_states_set(output_ctrl.m_ctrl_set, params.m_ss_dim));
+    const abs_type num_lost = p_ss_set->get_size(cudd_mgr, lost_bdd);
+    const abs_type num_dom = p_ss_set->get_size(cudd_mgr, output_ctrl.m_ctrl_bdd.ExistAbstract(is_cube));
+    ASSERT_CONDITION_THROW((num_lost > params.m_max_loss * num_dom),
+                           string("The approximated controller '") + file_name + string("' loses ") +
+                           to_string(num_lost) + string(" of ") + to_string(num_dom) + string(" domain states"));
+    
+    LOG_RESULT << "The approximated controller '" << file_name << "' is a sub-controller of the determinized one losing "
+    << num_lost << " of " << num_dom << " domain states" << END_LOG;
+}
+
+/**
+ * Allows to determinize the controller with the given optimizer, one partition
+ * at a time if the streaming is requested or only the changed states if the
+ * incremental re-determinization is requested
+ * @param cudd_mgr the CUDD manager of the controller
+ * @param input_ctrl the controller to determinize
+ * @param prev_src_ctrl the previous source controller, if incremental
+ * @param prev_det_ctrl the previous determinized controller, if incremental
+ * @param params the tool parameters
+ * @param output_ctrl the determinized controller to be filled in
+ */
+template<class optimizer_type>
+static void determinize(const Cudd & cudd_mgr,
+                        const ctrl_data & input_ctrl,
+                        const ctrl_data & prev_src_ctrl,
+                        const ctrl_data & prev_det_ctrl,
+                        const det_tool_params & params,
+                        ctrl_data & output_ctrl) {
+    if(params.m_is_incr) {
+        //Initialize the incremental optimizer class instance
+        incr_optimizer<optimizer_type> opt(cudd_mgr, input_ctrl, prev_src_ctrl, prev_det_ctrl);
+        //Optimize by determinization
+        opt.optimize(output_ctrl);
+    } else if(params.m_stream_mem > 0) {
+        //Initialize the streaming optimizer class instance
+        stream_optimizer<optimizer_type> opt(cudd_mgr, input_ctrl, params.m_stream_mem, params.m_target_file);
+        //Optimize by determinization
+        opt.optimize(output_ctrl);
+    } else {
+        //Initialize the optimizer class instance
+        optimizer_type opt(cudd_mgr, input_ctrl);
+        //Optimize by determinization
+        opt.optimize(output_ctrl);
+    }
+}
+
 /**
  * The main program entry point
  */
@@ -68,24 +289,44 @@ int main(int argc, char** argv) {
     create_arguments_parser();
     
     try {
-        //Declare the CUDD manager
-        Cudd cudd_mgr;
         //Declare the parameters structure
         det_tool_params params = {};
+        
+        //Attempt to extract the program arguments
+        extract_arguments(argc, argv, params);
+        
+        //Declare the CUDD manager, configured from the arguments
+        Cudd cudd_mgr = params.m_cudd.create_manager();
+        //Register the CUDD statistics with the metrics registry
+        cudd_metrics metrics(cudd_mgr);
         //Declare the input and output controller structures
         ctrl_data input_ctrl = {}, output_ctrl = {};
+        //Declare the previous controller structures, for the incremental re-determinization
+        ctrl_data prev_src_ctrl = {}, prev_det_ctrl = {};
         //Declare the statistics data
         DECLARE_MONITOR_STATS;
         
-        //Attempt to extract the program arguments
-        extract_arguments(argc, argv, params);
+        //Log asynchronously, the per state logging is then not slowing down the computations
+        logger::start_async();
+        
+        //Enable the phase metrics recording if requested
+        metrics_registry::set_enabled(params.m_is_metrics);
+        //Enable the phase timeline tracing if requested
+        trace_recorder::set_enabled(params.m_is_trace);
         
         //Disable automatic variable ordering
         cudd_mgr.AutodynDisable();
+        params.m_cudd.log_config(cudd_mgr);
         
         //Load the controller's BDD into the structure
         load_controller_bdd(cudd_mgr, params.m_source_file, params.m_ss_dim, input_ctrl);
         
+        //Load the previous controllers' BDDs into the structures
+        if(params.m_is_incr) {
+            load_controller_bdd(cudd_mgr, params.m_prev_source_file, params.m_ss_dim, prev_src_ctrl);
+            load_controller_bdd(cudd_mgr, params.m_prev_det_file, params.m_ss_dim, prev_det_ctrl);
+        }
+        
         {
             LOG_USAGE << "Starting the BDD determinization ..." << END_LOG;
             
@@ -95,38 +336,28 @@ int main(int argc, char** argv) {
             //Choose the determinization algorithm
             switch(params.m_det_alg_type) {
                 case det_alg_enum::local: {
-                    //Initialize the optimizer class instance
-                    space_optimizer<space_tree_sco<false>> opt(cudd_mgr, input_ctrl);
-                    //Optimize by determinization
-                    opt.optimize(output_ctrl);
+                    determinize<space_optimizer<space_tree_sco<false>>>(cudd_mgr, input_ctrl, prev_src_ctrl,
+                                                                        prev_det_ctrl, params, output_ctrl);
                     break;
                 }
                 case det_alg_enum::bdd_local: {
-                    //Initialize the optimizer class instance
-                    space_optimizer<space_tree_bdd<false>> opt(cudd_mgr, input_ctrl);
-                    //Optimize by determinization
-                    opt.optimize(output_ctrl);
+                    determinize<space_optimizer<space_tree_bdd<false>>>(cudd_mgr, input_ctrl, prev_src_ctrl,
+                                                                        prev_det_ctrl, params, output_ctrl);
                     break;
                 }
                 case det_alg_enum::global: {
-                    //Initialize the optimizer class instance
-                    greedy_optimizer opt(cudd_mgr, input_ctrl);
-                    //Optimize by determinization
-                    opt.optimize(output_ctrl);
+                    determinize<greedy_optimizer>(cudd_mgr, input_ctrl, prev_src_ctrl,
+                                                  prev_det_ctrl, params, output_ctrl);
                     break;
                 }
                 case det_alg_enum::mixed: {
-                    //Initialize the optimizer class instance
-                    space_optimizer<space_tree_sco<true>> opt(cudd_mgr, input_ctrl);
-                    //Optimize by determinization
-                    opt.optimize(output_ctrl);
+                    determinize<space_optimizer<space_tree_sco<true>>>(cudd_mgr, input_ctrl, prev_src_ctrl,
+                                                                       prev_det_ctrl, params, output_ctrl);
                     break;
                 }
                 case det_alg_enum::bdd_mixed: {
-                    //Initialize the optimizer class instance
-                    space_optimizer<space_tree_bdd<true>> opt(cudd_mgr, input_ctrl);
-                    //Optimize by determinization
-                    opt.optimize(output_ctrl);
+                    determinize<space_optimizer<space_tree_bdd<true>>>(cudd_mgr, input_ctrl, prev_src_ctrl,
+                                                                       prev_det_ctrl, params, output_ctrl);
                     break;
                 }
                 default: {
@@ -152,6 +383,8 @@ int main(int argc, char** argv) {
         LOG_INFO2 << "Deleting the original controller BDD" << END_LOG;
         //First delete the input BDD
         input_ctrl.m_ctrl_bdd &= cudd_mgr.bddZero();
+        prev_src_ctrl.m_ctrl_bdd = cudd_mgr.bddZero();
+        prev_det_ctrl.m_ctrl_bdd = cudd_mgr.bddZero();
         
         //Store different options
         if(params.m_is_reorder) {
@@ -174,6 +407,9 @@ int main(int argc, char** argv) {
                                  params.m_target_file,
                                  store_type_enum::sco_const,
                                  params.m_ss_dim);
+            if(params.m_is_verify) {
+                verify_comp_controller(cudd_mgr, output_ctrl, params, store_type_enum::sco_const);
+            }
         }
         if(params.m_is_sco_lin) {
             store_min_controller(cudd_mgr, output_ctrl.m_ctrl_set,
@@ -181,6 +417,9 @@ int main(int argc, char** argv) {
                                  params.m_target_file,
                                  store_type_enum::sco_lin,
                                  params.m_ss_dim);
+            if(params.m_is_verify) {
+                verify_comp_controller(cudd_mgr, output_ctrl, params, store_type_enum::sco_lin);
+            }
         }
         if(params.m_is_bdd_const) {
             store_min_controller(cudd_mgr, output_ctrl.m_ctrl_set,
@@ -188,6 +427,9 @@ int main(int argc, char** argv) {
                                  params.m_target_file,
                                  store_type_enum::bdd_const,
                                  params.m_ss_dim);
+            if(params.m_is_verify) {
+                verify_comp_controller(cudd_mgr, output_ctrl, params, store_type_enum::bdd_const);
+            }
         }
         if(params.m_is_bdd_lin) {
             store_min_controller(cudd_mgr, output_ctrl.m_ctrl_set,
@@ -195,6 +437,79 @@ int main(int argc, char** argv) {
                                  params.m_target_file,
                                  store_type_enum::bdd_lin,
                                  params.m_ss_dim);
+            if(params.m_is_verify) {
+                verify_comp_controller(cudd_mgr, output_ctrl, params, store_type_enum::bdd_lin);
+            }
+        }
+        if(params.m_is_dense_sco) {
+            store_min_controller(cudd_mgr, output_ctrl.m_ctrl_set,
+                                 output_ctrl.m_ctrl_bdd,
+                                 params.m_target_file,
+                                 store_type_enum::dense_sco,
+                                 params.m_ss_dim);
+            if(params.m_is_verify) {
+                verify_dense_table(cudd_mgr, output_ctrl, params, store_type_enum::dense_sco);
+            }
+        }
+        if(params.m_is_dense_morton) {
+            store_min_controller(cudd_mgr, output_ctrl.m_ctrl_set,
+                                 output_ctrl.m_ctrl_bdd,
+                                 params.m_target_file,
+                                 store_type_enum::dense_morton,
+                                 params.m_ss_dim);
+            if(params.m_is_verify) {
+                verify_dense_table(cudd_mgr, output_ctrl, params, store_type_enum::dense_morton);
+            }
+        }
+        if(params.m_is_mtbdd) {
+            store_min_controller(cudd_mgr, output_ctrl.m_ctrl_set,
+                                 output_ctrl.m_ctrl_bdd,
+                                 params.m_target_file,
+                                 store_type_enum::mtbdd,
+                                 params.m_ss_dim);
+            if(params.m_is_verify) {
+                verify_add_ctrl(cudd_mgr, output_ctrl, params);
+            }
+        }
+        if(params.m_is_dont_care) {
+            store_min_controller(cudd_mgr, output_ctrl.m_ctrl_set,
+                                 output_ctrl.m_ctrl_bdd,
+                                 params.m_target_file,
+                                 store_type_enum::dont_care,
+                                 params.m_ss_dim);
+            if(params.m_is_verify) {
+                verify_dc_min_ctrl(cudd_mgr, output_ctrl, params);
+            }
+        }
+        if(params.m_is_approx) {
+            store_min_controller(cudd_mgr, output_ctrl.m_ctrl_set,
+                                 output_ctrl.m_ctrl_bdd,
+                                 params.m_target_file,
+                                 store_type_enum::approx,
+                                 params.m_ss_dim,
+                                 params.m_max_loss);
+            if(params.m_is_verify) {
+                verify_approx_ctrl(cudd_mgr, output_ctrl, params);
+            }
+        }
+        if(params.m_is_rect) {
+            store_min_controller(cudd_mgr, output_ctrl.m_ctrl_set,
+                                 output_ctrl.m_ctrl_bdd,
+                                 params.m_target_file,
+                                 store_type_enum::rect,
+                                 params.m_ss_dim);
+            if(params.m_is_verify) {
+                verify_rect_cover(cudd_mgr, output_ctrl, params);
+            }
+        }
+        
+        //Store the recorded phase metrics if requested
+        if(params.m_is_metrics) {
+            metrics_registry::store_json(params.m_target_file + "_metrics.json");
+        }
+        //Store the recorded phase timeline if requested
+        if(params.m_is_trace) {
+            trace_recorder::store_json(params.m_target_file + "_trace.json");
         }
 
         LOG_USAGE << "Finished" << END_LOG;
@@ -204,6 +519,9 @@ int main(int argc, char** argv) {
         return_code = 1;
     }
     
+    //Write out the pending log messages
+    logger::stop_async();
+    
     //Destroy the command line parameters parser
     destroy_arguments_parser();
     
@@ -35,6 +35,7 @@
 
 #include "exceptions.hh"
 #include "logger.hh"
+#include "cudd_args.hh"
 
 #include "det_tool_params.hh"
 
@@ -131,6 +132,18 @@ namespace tud {
                 static SwitchArg * p_is_sco_lin = NULL;
                 static SwitchArg * p_is_bdd_const = NULL;
                 static SwitchArg * p_is_bdd_lin = NULL;
+                static SwitchArg * p_is_dense_sco = NULL;
+                static SwitchArg * p_is_dense_morton = NULL;
+                static SwitchArg * p_is_mtbdd = NULL;
+                static SwitchArg * p_is_dont_care = NULL;
+                static ValueArg<double> * p_max_loss = NULL;
+                static SwitchArg * p_is_rect = NULL;
+                static SwitchArg * p_is_verify = NULL;
+                static SwitchArg * p_is_metrics = NULL;
+                static SwitchArg * p_is_trace = NULL;
+                static ValueArg<uint32_t> * p_stream_mem = NULL;
+                static ValueArg<string> * p_prev_source_file_arg = NULL;
+                static ValueArg<string> * p_prev_det_file_arg = NULL;
                 static ValueArg<string> * p_det_alg = NULL;
                 static ValuesConstraint<string> * p_det_alg_vals = NULL;
 
@@ -185,12 +198,56 @@ namespace tud {
                     p_is_bdd_lin = new SwitchArg("n", "bdd-angled", string("Compress using linear functions") +
                                                  string(" on the internal bdd state ids"),
                                                  *p_cmd_args, false);
+                    //Dense table flag: Store the direct-indexed table of inputs, in the SCOTS state id order
+                    p_is_dense_sco = new SwitchArg("b", "dense", string("Store the dense lookup table") +
+                                                   string(" in the SCOTS state id order"), *p_cmd_args, false);
+                    //Dense table flag: Store the direct-indexed table of inputs, in the Morton order of the state dofs
+                    p_is_dense_morton = new SwitchArg("z", "dense-morton", string("Store the dense lookup table") +
+                                                      string(" in the Morton (Z-order) of the state dofs"), *p_cmd_args, false);
+                    //Encoding flag: Store the ADD with the input ids as terminals, over the state variables only
+                    p_is_mtbdd = new SwitchArg("m", "mtbdd", string("Store the ADD (MTBDD) with the input ids") +
+                                               string(" as terminals"), *p_cmd_args, false);
+                    //Compression flag: Minimize the bdd using the states outside of the domain as don't cares
+                    p_is_dont_care = new SwitchArg("u", "dont-care", string("Minimize using the states outside") +
+                                                   string(" of the domain as don't cares, store the domain too"), *p_cmd_args, false);
+                    //Approximation value: Store the under-approximated bdd losing at most the given fraction of the domain
+                    p_max_loss = new ValueArg<double>("p", "approx", string("Store the under-approximated controller") +
+                                                      string(" losing at most the given fraction of the domain states"),
+                                                      false, 0.0, "max lost fraction", *p_cmd_args);
+                    //Rectangle cover flag: Store the same-input hyper-rectangles covering the domain, with an R-tree index
+                    p_is_rect = new SwitchArg("k", "rect-cover", string("Store the cover of the domain by the same input") +
+                                              string(" hyper-rectangles with the R-tree index"), *p_cmd_args, false);
+                    //Verification flag: Decode the compressed controllers and compare them with the determinized one
+                    p_is_verify = new SwitchArg("v", "verify", string("Verify the compressed controllers against") +
+                                                string(" the determinized one"), *p_cmd_args, false);
+                    //Metrics flag: Store the per phase CUDD statistics into the <target>_metrics.json file
+                    p_is_metrics = new SwitchArg("j", "metrics", string("Store the per phase CUDD statistics") +
+                                                 string(" into a JSON file along with the controller"), *p_cmd_args, false);
+                    //Trace flag: Store the wall-clock phase timeline into the <target>_trace.json file
+                    p_is_trace = new SwitchArg("w", "trace", string("Store the wall-clock timeline of the phases") +
+                                               string(" into a Chrome trace-event JSON file"), *p_cmd_args, false);
+                    //Streaming value: Determinize one state-space partition at a time within the memory budget
+                    p_stream_mem = new ValueArg<uint32_t>("o", "stream-mem", string("Determinize one state-space partition") +
+                                                          string(" at a time within the memory budget, spilling them to disk"),
+                                                          false, 0, "MB", *p_cmd_args);
+                    //Incremental values: Keep the choices of the previous determinization, re-determinize the rest
+                    p_prev_source_file_arg = new ValueArg<string>("i", "prev-source", string("The previous SCOTSv2.0 BDD") +
+                                                                  string(" source controller file name without (.scs/.bdd),") +
+                                                                  string(" for the incremental re-determinization"), false, "",
+                                                                  "previous source controller file name", *p_cmd_args);
+                    p_prev_det_file_arg = new ValueArg<string>("f", "prev-determinized", string("The previous determinized") +
+                                                               string(" controller file name without (.scs/.bdd),") +
+                                                               string(" for the incremental re-determinization"), false, "",
+                                                               "previous determinized controller file name", *p_cmd_args);
 
                     //This argument will define the determinization scope and thus the actual algorithm
                     p_det_alg_vals = new ValuesConstraint<string>(det_tool_params::get_det_alg());
                     p_det_alg = new ValueArg<string>("a", "algorithm", string("Define the determinization algorithm"),
                                                        true, "mixed", p_det_alg_vals, *p_cmd_args);
 
+                    //Add the CUDD manager configuration parameters - optional
+                    create_cudd_arguments(*p_cmd_args);
+                    
                     //Add the -d the debug level parameter - optional, default is e.g. RESULT
                     logger::get_reporting_levels(&debug_levels);
                     p_debug_levels_constr = new ValuesConstraint<string>(debug_levels);
@@ -253,12 +310,74 @@ namespace tud {
                     params.m_is_bdd_lin = p_is_bdd_lin->getValue();
                     LOG_USAGE << "The final linear bdd compression is: " <<
                     (params.m_is_bdd_lin ? "" : "NOT ") << "NEEDED" << END_LOG;
+                    
+                    params.m_is_dense_sco = p_is_dense_sco->getValue();
+                    LOG_USAGE << "The final dense table in the SCOTS order is: " <<
+                    (params.m_is_dense_sco ? "" : "NOT ") << "NEEDED" << END_LOG;
+                    
+                    params.m_is_dense_morton = p_is_dense_morton->getValue();
+                    LOG_USAGE << "The final dense table in the Morton order is: " <<
+                    (params.m_is_dense_morton ? "" : "NOT ") << "NEEDED" << END_LOG;
+                    
+                    params.m_is_mtbdd = p_is_mtbdd->getValue();
+                    LOG_USAGE << "The final ADD encoding is: " <<
+                    (params.m_is_mtbdd ? "" : "NOT ") << "NEEDED" << END_LOG;
+                    
+                    params.m_is_dont_care = p_is_dont_care->getValue();
+                    LOG_USAGE << "The final don't care minimization is: " <<
+                    (params.m_is_dont_care ? "" : "NOT ") << "NEEDED" << END_LOG;
+                    
+                    params.m_is_approx = p_max_loss->isSet();
+                    params.m_max_loss = p_max_loss->getValue();
+                    LOG_USAGE << "The final approximation is: " << (params.m_is_approx ? "" : "NOT ") << "NEEDED"
+                    << (params.m_is_approx ? string(", max lost fraction: ") + to_string(params.m_max_loss) : string(""))
+                    << END_LOG;
+                    ASSERT_CONDITION_THROW((params.m_max_loss < 0.0) || (params.m_max_loss > 1.0),
+                                           string("Improper maximum lost fraction: ") +
+                                           to_string(params.m_max_loss) + string(" must be within [0,1]"));
+                    
+                    params.m_is_rect = p_is_rect->getValue();
+                    LOG_USAGE << "The final rectangle cover is: " <<
+                    (params.m_is_rect ? "" : "NOT ") << "NEEDED" << END_LOG;
+                    
+                    params.m_is_verify = p_is_verify->getValue();
+                    LOG_USAGE << "The compressed controllers verification is: " <<
+                    (params.m_is_verify ? "" : "NOT ") << "NEEDED" << END_LOG;
+                    
+                    params.m_is_metrics = p_is_metrics->getValue();
+                    LOG_USAGE << "The phase metrics export is: " <<
+                    (params.m_is_metrics ? "" : "NOT ") << "NEEDED" << END_LOG;
+                    
+                    params.m_is_trace = p_is_trace->getValue();
+                    LOG_USAGE << "The phase timeline trace is: " <<
+                    (params.m_is_trace ? "" : "NOT ") << "NEEDED" << END_LOG;
+                    
+                    params.m_stream_mem = p_stream_mem->getValue();
+                    LOG_USAGE << "The streaming determinization is: " << (p_stream_mem->isSet() ? "" : "NOT ") << "NEEDED"
+                    << (p_stream_mem->isSet() ? string(", memory budget: ") + to_string(params.m_stream_mem) + string(" MB") : string(""))
+                    << END_LOG;
+                    ASSERT_CONDITION_THROW(p_stream_mem->isSet() && (params.m_stream_mem == 0),
+                                           string("Improper streaming memory budget: 0 MB, must be > 0"));
+                    
+                    params.m_is_incr = p_prev_source_file_arg->isSet() || p_prev_det_file_arg->isSet();
+                    params.m_prev_source_file = p_prev_source_file_arg->getValue();
+                    params.m_prev_det_file = p_prev_det_file_arg->getValue();
+                    LOG_USAGE << "The incremental re-determinization is: " << (params.m_is_incr ? "" : "NOT ") << "NEEDED"
+                    << (params.m_is_incr ? string(", previous controllers: '") + params.m_prev_source_file +
+                        string("', '") + params.m_prev_det_file + string("'") : string("")) << END_LOG;
+                    ASSERT_CONDITION_THROW(params.m_is_incr && !(p_prev_source_file_arg->isSet() && p_prev_det_file_arg->isSet()),
+                                           string("The incremental re-determinization needs both the previous source ") +
+                                           string("and the previous determinized controllers"));
+                    ASSERT_CONDITION_THROW(params.m_is_incr && (params.m_stream_mem > 0),
+                                           string("The incremental re-determinization can not be streamed"));
 
                     params.set_det_alg_type(p_det_alg->getValue());
                     LOG_USAGE << "The determinization algorithm: " <<
                     (params.m_det_alg_type == det_alg_enum::local ?
                      "Local" : ( params.m_det_alg_type == det_alg_enum::global ?
                                 "Global" : "Mixed" ) ) << END_LOG;
+                    
+                    extract_cudd_arguments(params.m_source_file, params.m_cudd);
                 }
                 
                 /**
@@ -274,10 +393,23 @@ namespace tud {
                     SAFE_DESTROY(p_is_sco_lin);
                     SAFE_DESTROY(p_is_bdd_const);
                     SAFE_DESTROY(p_is_bdd_lin);
+                    SAFE_DESTROY(p_is_dense_sco);
+                    SAFE_DESTROY(p_is_dense_morton);
+                    SAFE_DESTROY(p_is_mtbdd);
+                    SAFE_DESTROY(p_is_dont_care);
+                    SAFE_DESTROY(p_max_loss);
+                    SAFE_DESTROY(p_is_rect);
+                    SAFE_DESTROY(p_is_verify);
+                    SAFE_DESTROY(p_is_metrics);
+                    SAFE_DESTROY(p_is_trace);
+                    SAFE_DESTROY(p_stream_mem);
+                    SAFE_DESTROY(p_prev_source_file_arg);
+                    SAFE_DESTROY(p_prev_det_file_arg);
                     SAFE_DESTROY(p_det_alg);
                     SAFE_DESTROY(p_det_alg_vals);
                     SAFE_DESTROY(p_debug_levels_constr);
                     SAFE_DESTROY(p_debug_level_arg);
+                    destroy_cudd_arguments();
                     SAFE_DESTROY(p_cmd_args);
                 }
             }
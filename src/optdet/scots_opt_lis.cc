@@ -91,20 +91,22 @@ int main(int argc, char** argv) {
     create_arguments_parser();
     
     try {
-        //Declare the CUDD manager
-        Cudd cudd_mgr;
         //Declare the parameters structure
         lis_tool_params params = {};
+        
+        //Attempt to extract the program arguments
+        extract_arguments(argc, argv, params);
+        
+        //Declare the CUDD manager, configured from the arguments
+        Cudd cudd_mgr = params.m_cudd.create_manager();
         //Declare the input and output controller structures
         ctrl_data input_ctrl = {};
         //Declare the statistics data
         DECLARE_MONITOR_STATS;
         
-        //Attempt to extract the program arguments
-        extract_arguments(argc, argv, params);
-        
         //Disable automatic variable ordering
         cudd_mgr.AutodynDisable();
+        params.m_cudd.log_config(cudd_mgr);
         
         //Load the controller's BDD into the structure
         load_controller_bdd(cudd_mgr, params.m_source_file, params.m_ss_dim, input_ctrl);
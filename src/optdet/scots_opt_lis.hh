@@ -35,6 +35,7 @@
 
 #include "exceptions.hh"
 #include "logger.hh"
+#include "cudd_args.hh"
 
 #include "lis_tool_params.hh"
 
@@ -170,6 +171,9 @@ namespace tud {
                     p_is_reorder = new SwitchArg("r", "reorder", string("Reorder variables to optimize") +
                                                  string(" resulting BDD size"), *p_cmd_args, false);
                     
+                    //Add the CUDD manager configuration parameters - optional
+                    create_cudd_arguments(*p_cmd_args);
+                    
                     //Add the -d the debug level parameter - optional, default is e.g. RESULT
                     logger::get_reporting_levels(&debug_levels);
                     p_debug_levels_constr = new ValuesConstraint<string>(debug_levels);
@@ -221,6 +225,8 @@ namespace tud {
                     params.m_is_reorder = !params.m_is_no_supp && p_is_reorder->getValue();
                     LOG_USAGE << "The resulting support set BDD variable reordering is: " <<
                     (params.m_is_reorder ? "" : "NOT ") << "NEEDED" << END_LOG;
+                    
+                    extract_cudd_arguments(params.m_source_file, params.m_cudd);
                 }
                 
                 /**
@@ -235,6 +241,7 @@ namespace tud {
                     SAFE_DESTROY(p_is_reorder);
                     SAFE_DESTROY(p_debug_levels_constr);
                     SAFE_DESTROY(p_debug_level_arg);
+                    destroy_cudd_arguments();
                     SAFE_DESTROY(p_cmd_args);
                 }
             }
@@ -0,0 +1,380 @@
+/*
+ * File:   scots_serve.cc
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on March 27, 2018, 13:15 PM
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <sstream>
+#include <condition_variable>
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// SCOTS header
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "monitor.hh"
+
+#include "scots_serve.hh"
+
+#include "ctrl_data.hh"
+#include "input_output.hh"
+#include "thread_pool.hh"
+#include "ctrl_lookup.hh"
+#include "serve_protocol.hh"
+#include "latency_histogram.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::logging;
+using namespace tud::utils::exceptions;
+using namespace tud::utils::monitor;
+using namespace tud::utils::threads;
+using namespace tud::ctrl::scots::optimal;
+
+//The maximum number of states per query request
+static constexpr uint32_t MAX_REQ_STATES = 1u << 24;
+//The maximum number of state-space dimensions in a query request
+static constexpr uint32_t MAX_REQ_SS_DIM = 64;
+//The number of states a single worker processes at once, smaller requests stay on the connection thread
+static constexpr size_t SERVE_CHUNK_SIZE = 256;
+
+/**
+ * This structure stores the served controller
+ */
+struct served_ctrl {
+    //Stores the controller file name
+    string m_file_name;
+    //Stores the controller lookup table
+    unique_ptr<ctrl_lookup> m_lookup;
+    //Stores the request latencies
+    latency_histogram m_latency;
+};
+
+//Stores the served controllers, immutable once the server runs
+static vector<unique_ptr<served_ctrl>> controllers;
+//Stores the query workers
+static thread_pool workers(1);
+
+//Stores the listening socket descriptor
+static int listen_fd = -1;
+//Stores the stop flag, set by the signal handler
+static volatile sig_atomic_t is_stop = 0;
+//Guards the open connections data
+static mutex conn_mutex;
+//Notifies about the closed connections
+static condition_variable conn_cv;
+//Stores the open connection descriptors
+static set<int> conn_fds;
+
+/**
+ * The termination signal handler, stops accepting connections
+ * @param signum the signal number
+ */
+static void stop_handler(int signum) {
+    (void) signum;
+    is_stop = 1;
+    if (listen_fd >= 0) {
+        shutdown(listen_fd, SHUT_RDWR);
+    }
+}
+
+/**
+ * Allows to get the latency report of all the controllers
+ * @return the latency report
+ */
+static string get_latency_report() {
+    stringstream report;
+    for (size_t idx = 0; idx < controllers.size(); ++idx) {
+        report << controllers[idx]->m_latency.report(string("Controller #") + to_string(idx) +
+                string(" '") + controllers[idx]->m_file_name + string("'"));
+    }
+    return report.str();
+}
+
+/**
+ * Allows to load the controllers and to convert them into the lookup tables
+ * @param params the tool parameters
+ */
+static void load_controllers(const serve_tool_params & params) {
+    for (size_t idx = 0; idx < params.m_ctrl_files.size(); ++idx) {
+        unique_ptr<served_ctrl> served(new served_ctrl());
+        served->m_file_name = params.m_ctrl_files[idx];
+        {
+            //The CUDD manager is only needed while building the lookup table
+            Cudd cudd_mgr;
+            ctrl_data ctrl;
+            load_controller_bdd(cudd_mgr, served->m_file_name, params.m_ss_dims[idx], ctrl);
+            served->m_lookup.reset(new ctrl_lookup(cudd_mgr, ctrl.m_ctrl_set,
+                    ctrl.m_ctrl_bdd, ctrl.m_ss_dim, workers));
+        }
+        LOG_RESULT << "Serving controller #" << idx << " '" << served->m_file_name << "' with "
+                << served->m_lookup->get_num_states() << " states" << END_LOG;
+        controllers.push_back(move(served));
+    }
+}
+
+/**
+ * Allows to answer the query request, the states payload is not read yet
+ * @param fd the connection descriptor
+ * @param req the request header
+ * @param states the states buffer, re-used between requests
+ * @param counts the input counts buffer, re-used between requests
+ * @param input_ids the per state input ids buffer, re-used between requests
+ * @param offsets the input offsets buffer, re-used between requests
+ * @param inputs the inputs buffer, re-used between requests
+ * @return true if the connection can be used further, otherwise false
+ */
+static bool answer_query(const int fd, const serve_req_header & req, vector<double> & states,
+        vector<uint32_t> & counts, vector<const abs_type *> & input_ids,
+        vector<size_t> & offsets, vector<double> & inputs) {
+    serve_resp_header resp = {SERVE_MAGIC, status_ok, 0, 0, 0};
+
+    //Do not even read the payload if it is too large
+    if ((req.m_num_states > MAX_REQ_STATES) || (req.m_ss_dim > MAX_REQ_SS_DIM)) {
+        resp.m_status = status_bad_req;
+        write_fully(fd, &resp, sizeof (resp));
+        return false;
+    }
+
+    //Read the states
+    const size_t num_states = req.m_num_states;
+    states.resize(num_states * req.m_ss_dim);
+    if (!read_fully(fd, states.data(), states.size() * sizeof (double))) {
+        return false;
+    }
+    const auto start = chrono::steady_clock::now();
+
+    //Check that the controller is known and of the right dimensionality
+    if (req.m_ctrl_idx >= controllers.size()) {
+        resp.m_status = status_unknown_ctrl;
+        return write_fully(fd, &resp, sizeof (resp));
+    }
+    served_ctrl & served = *controllers[req.m_ctrl_idx];
+    const ctrl_lookup & lookup = *served.m_lookup;
+    if (req.m_ss_dim != (uint32_t) lookup.get_ss_dim()) {
+        resp.m_status = status_bad_dim;
+        return write_fully(fd, &resp, sizeof (resp));
+    }
+    const size_t ss_dim = lookup.get_ss_dim();
+    const size_t is_dim = lookup.get_is_dim();
+
+    //Look up the input ids and count them per state
+    counts.resize(num_states);
+    input_ids.resize(num_states);
+    workers.parallel_for(num_states, [&](const size_t begin, const size_t end) {
+        for (size_t idx = begin; idx < end; ++idx) {
+            counts[idx] = lookup.lookup(&states[idx * ss_dim], input_ids[idx]);
+        }
+    }, SERVE_CHUNK_SIZE);
+
+    //Compute the output positions
+    offsets.resize(num_states + 1);
+    offsets[0] = 0;
+    for (size_t idx = 0; idx < num_states; ++idx) {
+        offsets[idx + 1] = offsets[idx] + counts[idx];
+    }
+
+    //Convert the inputs
+    inputs.resize(offsets[num_states] * is_dim);
+    workers.parallel_for(num_states, [&](const size_t begin, const size_t end) {
+        for (size_t idx = begin; idx < end; ++idx) {
+            for (size_t in_idx = 0; in_idx < counts[idx]; ++in_idx) {
+                lookup.itox_input(input_ids[idx][in_idx], &inputs[(offsets[idx] + in_idx) * is_dim]);
+            }
+        }
+    }, SERVE_CHUNK_SIZE);
+
+    //Send the response
+    resp.m_num_states = req.m_num_states;
+    resp.m_is_dim = is_dim;
+    resp.m_num_inputs = offsets[num_states];
+    const bool is_ok = write_fully(fd, &resp, sizeof (resp)) &&
+            write_fully(fd, counts.data(), counts.size() * sizeof (uint32_t)) &&
+            write_fully(fd, inputs.data(), inputs.size() * sizeof (double));
+
+    served.m_latency.add(chrono::duration_cast<chrono::microseconds>(
+            chrono::steady_clock::now() - start).count());
+
+    return is_ok;
+}
+
+/**
+ * Allows to serve the connection until it is closed
+ * @param fd the connection descriptor
+ */
+static void serve_connection(const int fd) {
+    //The buffers are re-used between the connection's requests
+    vector<double> states, inputs;
+    vector<uint32_t> counts;
+    vector<const abs_type *> input_ids;
+    vector<size_t> offsets;
+
+    serve_req_header req = {};
+    bool is_ok = true;
+    while (is_ok && read_fully(fd, &req, sizeof (req))) {
+        if (req.m_magic != SERVE_MAGIC) {
+            LOG_WARNING << "Got a request with a wrong magic number, closing the connection!" << END_LOG;
+            is_ok = false;
+        } else if (req.m_type == req_query) {
+            is_ok = answer_query(fd, req, states, counts, input_ids, offsets, inputs);
+        } else if (req.m_type == req_stats) {
+            const string report = get_latency_report();
+            const serve_resp_header resp = {SERVE_MAGIC, status_ok, 0, 0, report.size()};
+            is_ok = write_fully(fd, &resp, sizeof (resp)) &&
+                    write_fully(fd, report.data(), report.size());
+        } else {
+            const serve_resp_header resp = {SERVE_MAGIC, status_bad_req, 0, 0, 0};
+            write_fully(fd, &resp, sizeof (resp));
+            is_ok = false;
+        }
+    }
+
+    //Close the connection and notify the server
+    close(fd);
+    {
+        lock_guard<mutex> lock(conn_mutex);
+        conn_fds.erase(fd);
+    }
+    conn_cv.notify_all();
+}
+
+/**
+ * Allows to run the server until it gets the termination signal
+ * @param params the tool parameters
+ */
+static void run_server(const serve_tool_params & params) {
+    //Create the listening socket
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    ASSERT_CONDITION_THROW((params.m_socket_file.size() >= sizeof (addr.sun_path)),
+            string("The socket file name '") + params.m_socket_file + string("' is too long!"));
+    params.m_socket_file.copy(addr.sun_path, sizeof (addr.sun_path) - 1);
+    unlink(params.m_socket_file.c_str());
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_CONDITION_THROW((listen_fd < 0), "Could not create the socket!");
+    ASSERT_CONDITION_THROW((bind(listen_fd, (sockaddr *) & addr, sizeof (addr)) != 0) ||
+            (listen(listen_fd, SOMAXCONN) != 0),
+            string("Could not listen on the socket '") + params.m_socket_file + string("'!"));
+
+    //Set the termination handlers, the writes to closed connections shall just fail
+    signal(SIGINT, stop_handler);
+    signal(SIGTERM, stop_handler);
+    signal(SIGPIPE, SIG_IGN);
+
+    LOG_RESULT << "Listening on '" << params.m_socket_file << "' with "
+            << workers.get_num_threads() << " worker threads" << END_LOG;
+
+    //Accept the connections, one thread per connection
+    while (!is_stop) {
+        const int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (!is_stop && (errno != EINTR)) {
+                LOG_WARNING << "Failed to accept a connection: " << strerror(errno) << END_LOG;
+            }
+            continue;
+        }
+        {
+            lock_guard<mutex> lock(conn_mutex);
+            conn_fds.insert(fd);
+        }
+        thread(serve_connection, fd).detach();
+    }
+
+    //Close the open connections and wait until they are done
+    {
+        unique_lock<mutex> lock(conn_mutex);
+        for (const int fd : conn_fds) {
+            shutdown(fd, SHUT_RDWR);
+        }
+        conn_cv.wait(lock, [] {
+            return conn_fds.empty(); });
+    }
+    close(listen_fd);
+    listen_fd = -1;
+    unlink(params.m_socket_file.c_str());
+}
+
+/**
+ * The main program entry point
+ */
+int main(int argc, char** argv) {
+    //Declare the return code
+    int return_code = 0;
+    
+    //Set the uncaught exception handler
+    std::set_terminate(handler);
+    
+    //First print the program info
+    print_info();
+    
+    //Set up possible program arguments
+    create_arguments_parser();
+
+    try {
+        //Declare the parameters structure
+        serve_tool_params params = {};
+        
+        //Attempt to extract the program arguments
+        extract_arguments(argc, argv, params);
+
+        //Start the workers, the lookup tables are built in parallel as well
+        workers.set_num_threads(params.m_num_workers);
+
+        //Load the controllers
+        load_controllers(params);
+
+        //Serve the queries
+        run_server(params);
+
+        //Report the latencies
+        LOG_RESULT << "Request latencies:\n" << get_latency_report() << END_LOG;
+        
+        LOG_USAGE << "Finished" << END_LOG;
+    } catch (std::exception & ex) {
+        //The argument's extraction has failed, print the error message and quit
+        LOG_ERROR << ex.what() << END_LOG;
+        return_code = 1;
+    }
+    
+    //Destroy the command line parameters parser
+    destroy_arguments_parser();
+    
+    return return_code;
+}
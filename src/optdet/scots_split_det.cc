@@ -66,7 +66,7 @@ static void split_per_input(const split_tool_params & params, const input_ctrl_d
     //Create, strip and store a new controller for each of the given ids
     for(abs_type input_id : input_ids) {
         //1. Load the controller
-        input_ctrl_data input_ctrl;
+        input_ctrl_data input_ctrl(params.m_cudd.create_manager());
         input_ctrl.load_controller_bdd(params.m_source_file, params.m_ss_dim);
         //2. Remove other ids
         input_ctrl.fix_input(input_id);
@@ -126,7 +126,8 @@ int main(int argc, char** argv) {
         extract_arguments(argc, argv, params);
 
         //Define the main controller's variable
-        input_ctrl_data main_ctrl;
+        input_ctrl_data main_ctrl(params.m_cudd.create_manager());
+        params.m_cudd.log_config(main_ctrl.get_cudd_mgr());
         
         //Load the controller
         main_ctrl.load_controller_bdd(params.m_source_file, params.m_ss_dim);
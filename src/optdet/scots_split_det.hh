@@ -35,6 +35,7 @@
 
 #include "exceptions.hh"
 #include "logger.hh"
+#include "cudd_args.hh"
 
 using namespace std;
 using namespace TCLAP;
@@ -130,6 +131,8 @@ namespace tud {
                     bool m_is_input;
                     //If true then we need the domain BDD
                     bool m_is_supp;
+                    //The CUDD manager configuration
+                    cudd_config m_cudd;
                 };
                 
                 //The pointer to the command line parameters parser
@@ -180,6 +183,9 @@ namespace tud {
                     p_is_supp = new SwitchArg("p", "support", string("Request the reordered  ") +
                                               string("controller support BDD"), *p_cmd_args, false);
                     
+                    //Add the CUDD manager configuration parameters - optional
+                    create_cudd_arguments(*p_cmd_args);
+                    
                     //Add the -d the debug level parameter - optional, default is e.g. RESULT
                     logger::get_reporting_levels(&debug_levels);
                     p_debug_levels_constr = new ValuesConstraint<string>(debug_levels);
@@ -229,6 +235,8 @@ namespace tud {
                     
                     ASSERT_CONDITION_THROW(!params.m_is_supp && !params.m_is_input,
                                            "Nothing to be done request domain or input splitting!");
+                    
+                    extract_cudd_arguments(params.m_source_file, params.m_cudd);
                 }
                 
                 /**
@@ -242,6 +250,7 @@ namespace tud {
                     SAFE_DESTROY(p_is_supp);
                     SAFE_DESTROY(p_debug_levels_constr);
                     SAFE_DESTROY(p_debug_level_arg);
+                    destroy_cudd_arguments();
                     SAFE_DESTROY(p_cmd_args);
                 }
             }
@@ -35,6 +35,7 @@
 
 #include "exceptions.hh"
 #include "logger.hh"
+#include "cudd_args.hh"
 
 using namespace std;
 using namespace TCLAP;
@@ -128,6 +129,8 @@ namespace tud {
                     int32_t m_ss_dim;
                     //This flag allows to switch between scots ids and internal bdd ids
                     bool m_is_bdd_ids;
+                    //The CUDD manager configuration
+                    cudd_config m_cudd;
                 };
                 
                 //The pointer to the command line parameters parser
@@ -173,6 +176,9 @@ namespace tud {
                     p_is_bdd_ids = new SwitchArg("b", "bdd", string("Request the bdd ids plotting ") +
                                                string("instead of scots abstract ids"), *p_cmd_args, false);
                     
+                    //Add the CUDD manager configuration parameters - optional
+                    create_cudd_arguments(*p_cmd_args);
+                    
                     //Add the -d the debug level parameter - optional, default is e.g. RESULT
                     logger::get_reporting_levels(&debug_levels);
                     p_debug_levels_constr = new ValuesConstraint<string>(debug_levels);
@@ -215,6 +221,8 @@ namespace tud {
                     params.m_is_bdd_ids = p_is_bdd_ids->getValue();
                     LOG_USAGE << "The BDD ids plotting is: "
                     << (params.m_is_bdd_ids ? "" : "NOT ") << "NEEDED" << END_LOG;
+                    
+                    extract_cudd_arguments(params.m_source_file, params.m_cudd);
                 }
                 
                 /**
@@ -227,6 +235,7 @@ namespace tud {
                     SAFE_DESTROY(p_is_bdd_ids);
                     SAFE_DESTROY(p_debug_levels_constr);
                     SAFE_DESTROY(p_debug_level_arg);
+                    destroy_cudd_arguments();
                     SAFE_DESTROY(p_cmd_args);
                 }
             }
@@ -0,0 +1,144 @@
+/*
+ * File:   serve_protocol.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on March 27, 2018, 10:02 AM
+ */
+
+#ifndef SERVE_PROTOCOL_HPP
+#define SERVE_PROTOCOL_HPP
+
+#include <cstdint>
+#include <cerrno>
+#include <unistd.h>
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                /*
+                 * The binary protocol of the controller query daemon. All the values
+                 * are in the host byte order as the daemon is only reachable through
+                 * a local Unix-domain socket. Each request is answered by exactly one
+                 * response, a connection can carry any number of requests.
+                 *
+                 * Query request:  serve_req_header, num_states x ss_dim doubles (the states)
+                 * Query response: serve_resp_header, num_states uint32_t (the number of
+                 *                 inputs per state), num_inputs x is_dim doubles (the inputs)
+                 * Stats request:  serve_req_header
+                 * Stats response: serve_resp_header, num_inputs chars (the textual report)
+                 */
+
+                //The protocol magic number, "SCS1"
+                static constexpr uint32_t SERVE_MAGIC = 0x31534353u;
+
+                //The request types
+                enum serve_req_type_enum {
+                    req_query = 0,
+                    req_stats = req_query + 1,
+                    serve_req_type_enum_size = req_stats + 1
+                };
+
+                //The response statuses
+                enum serve_status_enum {
+                    status_ok = 0,
+                    status_bad_req = status_ok + 1,
+                    status_unknown_ctrl = status_bad_req + 1,
+                    status_bad_dim = status_unknown_ctrl + 1,
+                    serve_status_enum_size = status_bad_dim + 1
+                };
+
+                /**
+                 * The request header
+                 */
+                struct serve_req_header {
+                    //The protocol magic number
+                    uint32_t m_magic;
+                    //The request type
+                    uint32_t m_type;
+                    //The controller index, in the order the controllers are given to the daemon
+                    uint32_t m_ctrl_idx;
+                    //The number of states
+                    uint32_t m_num_states;
+                    //The number of state-space dimensions
+                    uint32_t m_ss_dim;
+                };
+
+                /**
+                 * The response header
+                 */
+                struct serve_resp_header {
+                    //The protocol magic number
+                    uint32_t m_magic;
+                    //The response status
+                    uint32_t m_status;
+                    //The number of states
+                    uint32_t m_num_states;
+                    //The number of input-space dimensions
+                    uint32_t m_is_dim;
+                    //The number of inputs, or the report length for the stats request
+                    uint64_t m_num_inputs;
+                };
+
+                /**
+                 * Allows to read the given number of bytes from the socket
+                 * @param fd the socket descriptor
+                 * @param data the buffer to read into
+                 * @param size the number of bytes to read
+                 * @return true if all the bytes were read, otherwise false
+                 */
+                static inline bool read_fully(const int fd, void * data, size_t size) {
+                    char * p_data = static_cast<char *> (data);
+                    while (size > 0) {
+                        const ssize_t num = ::read(fd, p_data, size);
+                        if (num < 0 && errno == EINTR) continue;
+                        if (num <= 0) return false;
+                        p_data += num;
+                        size -= num;
+                    }
+                    return true;
+                }
+
+                /**
+                 * Allows to write the given number of bytes into the socket
+                 * @param fd the socket descriptor
+                 * @param data the buffer to write from
+                 * @param size the number of bytes to write
+                 * @return true if all the bytes were written, otherwise false
+                 */
+                static inline bool write_fully(const int fd, const void * data, size_t size) {
+                    const char * p_data = static_cast<const char *> (data);
+                    while (size > 0) {
+                        const ssize_t num = ::write(fd, p_data, size);
+                        if (num < 0 && errno == EINTR) continue;
+                        if (num <= 0) return false;
+                        p_data += num;
+                        size -= num;
+                    }
+                    return true;
+                }
+            }
+        }
+    }
+}
+
+#endif /* SERVE_PROTOCOL_HPP */
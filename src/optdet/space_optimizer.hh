@@ -104,6 +104,7 @@ namespace tud {
                         //Iterate over the states, get the corresponding
                         //inputs and add them to the estimator set by ids
                         auto state_begin = all_states.begin();
+                        trace_span batch_span("Extracting states batch", TRACE_BATCH_SIZE);
                         for(int i = 0; i < num_states; ++i) {
                             //Get a new state vector
                             state.assign(state_begin, state_begin + ss_dim);
@@ -119,7 +120,9 @@ namespace tud {
                             
                             //Move forward in the list of states
                             state_begin += ss_dim;
+                            batch_span.next();
                         }
+                        batch_span.finish();
                         
                         //Finalize the initial estimator creation
                         m_tree.points_finished();
@@ -88,8 +88,10 @@ namespace tud {
                         //Get the symbilic set of the state space
                         const SymbolicSet & ss_set = m_ss_mgr.get_states_set();
 
-                        //Compute the maximum tree depth
+                        //Compute the maximum tree depth, it is shared by
+                        //the nodes and is left from the previous tree, if any
                         const size_t ss_dim = m_ss_mgr.get_dim();
+                        space_node::m_max_depth() = 0;
                         for(size_t idx = 0; idx < ss_dim; ++idx) {
                             //Update the maximum tree depth by adding the number of bits
                             space_node::m_max_depth() += ceil(log2(ss_set.get_no_grid_points(idx)));
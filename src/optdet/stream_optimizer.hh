@@ -0,0 +1,235 @@
+/*
+ * File:   stream_optimizer.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 27, 2018, 11:05 AM
+ */
+
+#ifndef STREAM_OPTIMIZER_HPP
+#define STREAM_OPTIMIZER_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <algorithm>
+
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "monitor.hh"
+
+#include "ctrl_data.hh"
+#include "inputs_mgr.hh"
+#include "states_mgr.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+using namespace tud::utils::monitor;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                //The estimated number of bytes the determinization needs per state, measured
+                //for the space trees, the state-space coordinates add ss_dim * sizeof(double)
+#define STREAM_STATE_BYTES 208
+
+                /**
+                 * This class determinizes the controller one state-space partition at a time,
+                 * to bound the memory used by the determinization. The partitions are the
+                 * cubes over the top-most state-space BDD variables, a partition is split
+                 * further until its domain states are estimated to fit into the memory budget.
+                 * Every determinized partition is spilled into the binary DDDMP file and they
+                 * are all merged at the end. The controller BDD itself stays in the memory.
+                 */
+                template<class optimizer_type>
+                class stream_optimizer {
+                public:
+
+                    /**
+                     * The basic constructor
+                     * @param cudd_mgr the cudd manager to be used
+                     * @param input_ctrl the controller's data
+                     * @param mem_budget_mb the determinization memory budget in MB, per partition
+                     * @param spill_file the file name base for the spilled partitions
+                     */
+                    stream_optimizer(const Cudd & cudd_mgr, const ctrl_data & input_ctrl,
+                                     const uint32_t mem_budget_mb, const string & spill_file)
+                    : m_cudd_mgr(cudd_mgr), m_input_ctrl(input_ctrl), m_spill_file(spill_file),
+                    m_max_states((static_cast<double> (mem_budget_mb) * 1024 * 1024) /
+                                 (STREAM_STATE_BYTES + input_ctrl.m_ss_dim * sizeof(double))),
+                    m_num_ss_vars(0), m_is_cube(), m_ss_vars(), m_num_parts(0) {
+                        //Get the cube of the input-space variables
+                        unique_ptr<SymbolicSet> p_is_set(inputs_mgr::get_inputs_set(input_ctrl.m_ctrl_set,
+                                                                                    input_ctrl.m_ss_dim));
+                        m_is_cube = p_is_set->get_cube(cudd_mgr);
+
+                        //Get the state-space variables ordered by their levels, top first
+                        unique_ptr<SymbolicSet> p_ss_set(states_mgr::get_states_set(input_ctrl.m_ctrl_set,
+                                                                                    input_ctrl.m_ss_dim));
+                        m_num_ss_vars = p_ss_set->get_no_bdd_vars();
+                        vector<unsigned int> var_ids = p_ss_set->get_bdd_var_ids();
+                        sort(var_ids.begin(), var_ids.end(), [&cudd_mgr](const unsigned int a, const unsigned int b) {
+                            return cudd_mgr.ReadPerm(a) < cudd_mgr.ReadPerm(b);
+                        });
+                        for(const unsigned int var_id : var_ids) {
+                            m_ss_vars.push_back(cudd_mgr.bddVar(var_id));
+                        }
+
+                        LOG_USAGE << "Streaming determinization with at most " << static_cast<uint64_t> (m_max_states)
+                        << " states per partition for the " << mem_budget_mb << " MB budget" << END_LOG;
+                    }
+
+                    /**
+                     * The basic destructor
+                     */
+                    virtual ~stream_optimizer() {
+                    }
+
+                    /**
+                     * Allows to optimize the controller by determinizing it one partition at a time
+                     * @param output_ctrl the resulting controller to be filled in
+                     */
+                    void optimize(ctrl_data & output_ctrl) {
+                        //Declare the statistics data
+                        DECLARE_MONITOR_STATS;
+
+                        //Get the beginning statistics data
+                        INITIALIZE_STATS;
+                        //Determinize and spill the partitions, starting from the entire state space
+                        spill_partitions(m_cudd_mgr.bddOne(), 0);
+                        //Get the end stats and log them
+                        REPORT_STATS(string("Determinizing ") + to_string(m_num_parts) + string(" partitions"));
+
+                        //Get the beginning statistics data
+                        INITIALIZE_STATS;
+                        //Copy the symbolic set data
+                        output_ctrl.m_ctrl_set = m_input_ctrl.m_ctrl_set;
+                        output_ctrl.m_ctrl_bdd = m_cudd_mgr.bddZero();
+                        for(size_t part_idx = 0; part_idx < m_num_parts; ++part_idx) {
+                            const string file_name = get_part_file_name(part_idx);
+                            SymbolicSet part_set;
+                            BDD part_bdd;
+                            if(!read_from_file(m_cudd_mgr, part_set, part_bdd, file_name.c_str())) {
+                                THROW_EXCEPTION(string("The partition files '") + file_name +
+                                                string(".scs/.bdd' could not be loaded!"));
+                            }
+                            output_ctrl.m_ctrl_bdd |= part_bdd;
+
+                            //The partition is not needed any more
+                            remove((file_name + string(".scs")).c_str());
+                            remove((file_name + string(".bdd")).c_str());
+                        }
+                        //Get the end stats and log them
+                        REPORT_STATS(string("Merging ") + to_string(m_num_parts) + string(" partitions"));
+                    }
+
+                protected:
+
+                    /**
+                     * Allows to get the spill file name of the partition
+                     * @param part_idx the partition index
+                     * @return the partition file name without (.scs/.bdd)
+                     */
+                    inline string get_part_file_name(const size_t part_idx) const {
+                        return m_spill_file + string("_part_") + to_string(part_idx);
+                    }
+
+                    /**
+                     * Allows to determinize and spill the partitions within the given cube,
+                     * the cube is split on the next state-space variable if it is too large
+                     * @param cube the cube of the partition
+                     * @param depth the number of state-space variables fixed by the cube
+                     */
+                    void spill_partitions(const BDD & cube, const size_t depth) {
+                        //Get the partition of the controller
+                        ctrl_data part_ctrl;
+                        part_ctrl.m_ss_dim = m_input_ctrl.m_ss_dim;
+                        part_ctrl.m_ctrl_set = m_input_ctrl.m_ctrl_set;
+                        part_ctrl.m_ctrl_bdd = m_input_ctrl.m_ctrl_bdd & cube;
+
+                        //Count the domain states of the partition
+                        const double num_states = part_ctrl.m_ctrl_bdd.ExistAbstract(m_is_cube).CountMinterm(m_num_ss_vars);
+                        if(num_states == 0) {
+                            return;
+                        }
+
+                        if((num_states > m_max_states) && (depth < m_ss_vars.size())) {
+                            //Release the partition before splitting it
+                            part_ctrl.m_ctrl_bdd = m_cudd_mgr.bddZero();
+                            spill_partitions(cube & m_ss_vars[depth], depth + 1);
+                            spill_partitions(cube & !m_ss_vars[depth], depth + 1);
+                        } else {
+                            LOG_USAGE << "Determinizing partition " << m_num_parts << " with "
+                            << static_cast<uint64_t> (num_states) << " states, "
+                            << depth << " state variables fixed" << END_LOG;
+
+                            //Determinize the partition, the optimizer is destroyed right away
+                            ctrl_data det_ctrl;
+                            {
+                                optimizer_type opt(m_cudd_mgr, part_ctrl);
+                                opt.optimize(det_ctrl);
+                            }
+                            //The determinized BDD may cover the states outside of the
+                            //domain, keep it within the partition for the merge
+                            det_ctrl.m_ctrl_bdd &= cube;
+
+                            //Spill the partition into the file
+                            const string file_name = get_part_file_name(m_num_parts);
+                            if(!write_to_file(m_cudd_mgr, det_ctrl.m_ctrl_set, det_ctrl.m_ctrl_bdd, file_name)) {
+                                THROW_EXCEPTION(string("The partition files '") + file_name +
+                                                string(".scs/.bdd' could not be written!"));
+                            }
+                            ++m_num_parts;
+                        }
+                    }
+
+                private:
+                    //Stores the reference to the CUDD manage
+                    const Cudd & m_cudd_mgr;
+                    //Stores the reference to the original controller
+                    const ctrl_data & m_input_ctrl;
+                    //Stores the file name base for the spilled partitions
+                    const string m_spill_file;
+                    //Stores the maximum number of states per partition
+                    const double m_max_states;
+                    //Stores the number of state-space BDD variables
+                    int m_num_ss_vars;
+                    //Stores the cube of the input-space variables
+                    BDD m_is_cube;
+                    //Stores the state-space variables ordered by their levels
+                    vector<BDD> m_ss_vars;
+                    //Stores the number of spilled partitions
+                    size_t m_num_parts;
+                };
+
+            }
+        }
+    }
+}
+
+#endif /* STREAM_OPTIMIZER_HPP */
@@ -0,0 +1,269 @@
+/*
+ * File:   thread_pool.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on March 19, 2018, 11:05 AM
+ */
+
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+#include "monitor.hh"
+
+using namespace std;
+using namespace tud::utils::monitor;
+
+namespace tud {
+    namespace utils {
+        namespace threads {
+
+            /**
+             * This class represents a simple pool of worker threads. The pool
+             * executes one parallel loop at a time, the loop's index range is
+             * split into chunks that are picked up by the workers as well as
+             * by the calling thread. The call blocks until the loop is done.
+             */
+            class thread_pool {
+            public:
+                //The loop body function type, gets the [begin, end) index range
+                typedef function<void(const size_t, const size_t)> range_func;
+
+                /**
+                 * The basic constructor
+                 * @param num_threads the number of threads, including the calling one
+                 */
+                thread_pool(const size_t num_threads = thread::hardware_concurrency())
+                : m_workers(), m_run_mutex(), m_mutex(), m_job_cv(), m_done_cv(),
+                m_job_gen(0), m_num_busy(0), m_is_stop(false), m_p_func(NULL),
+                m_num_items(0), m_chunk_size(1), m_next_item(0), m_error() {
+                    start(num_threads);
+                }
+
+                /**
+                 * The basic destructor
+                 */
+                virtual ~thread_pool() {
+                    stop();
+                }
+
+                /**
+                 * Allows to change the number of threads
+                 * @param num_threads the number of threads, including the calling one,
+                 *                    zero means the number of hardware threads
+                 */
+                void set_num_threads(const size_t num_threads) {
+                    lock_guard<mutex> run_lock(m_run_mutex);
+                    stop();
+                    start(num_threads);
+                }
+
+                /**
+                 * Allows to get the number of threads
+                 * @return the number of threads, including the calling one
+                 */
+                inline size_t get_num_threads() const {
+                    return m_workers.size() + 1;
+                }
+
+                /**
+                 * Allows to execute the parallel loop over [0, num_items)
+                 * @param num_items the number of loop items
+                 * @param func the loop body function
+                 * @param chunk_size the number of items processed at once, zero
+                 *                   means the chunk size is to be computed
+                 * @throws the first exception thrown by the loop body, if any
+                 */
+                void parallel_for(const size_t num_items, const range_func & func,
+                        const size_t chunk_size = 0) {
+                    //Compute the chunk size, aim for several chunks per thread
+                    const size_t chunk = (chunk_size > 0) ? chunk_size :
+                            max(num_items / (get_num_threads() * CHUNKS_PER_THREAD), (size_t) 1);
+
+                    //Do it sequentially if there is no gain from the workers
+                    if (m_workers.empty() || (num_items <= chunk)) {
+                        func(0, num_items);
+                        return;
+                    }
+
+                    lock_guard<mutex> run_lock(m_run_mutex);
+                    {
+                        //Wait until the workers of the previous loop are done
+                        unique_lock<mutex> lock(m_mutex);
+                        m_done_cv.wait(lock, [&] {
+                            return (m_num_busy == 0); });
+
+                        //Publish the new job
+                        m_p_func = &func;
+                        m_num_items = num_items;
+                        m_chunk_size = chunk;
+                        m_next_item = 0;
+                        m_error = nullptr;
+                        ++m_job_gen;
+                    }
+                    m_job_cv.notify_all();
+
+                    //Participate in the job
+                    run_chunks();
+
+                    //Wait until all the chunks are done
+                    exception_ptr error;
+                    {
+                        unique_lock<mutex> lock(m_mutex);
+                        m_done_cv.wait(lock, [&] {
+                            return (m_num_busy == 0); });
+                        error = m_error;
+                        m_p_func = NULL;
+                    }
+
+                    //Re-throw the loop body exception if any
+                    if (error) {
+                        rethrow_exception(error);
+                    }
+                }
+
+            private:
+                //The number of chunks per thread for the automatic chunk size
+                static constexpr size_t CHUNKS_PER_THREAD = 8;
+
+                //Stores the worker threads
+                vector<thread> m_workers;
+                //Serializes the parallel loops
+                mutex m_run_mutex;
+                //Guards the job data
+                mutex m_mutex;
+                //Notifies the workers about a new job
+                condition_variable m_job_cv;
+                //Notifies the caller about the workers being done
+                condition_variable m_done_cv;
+                //Stores the current job generation
+                uint64_t m_job_gen;
+                //Stores the number of busy workers
+                size_t m_num_busy;
+                //Stores the stop flag
+                bool m_is_stop;
+                //Stores the loop body of the current job
+                const range_func * m_p_func;
+                //Stores the number of items of the current job
+                size_t m_num_items;
+                //Stores the chunk size of the current job
+                size_t m_chunk_size;
+                //Stores the next not yet taken item of the current job
+                atomic<size_t> m_next_item;
+                //Stores the first exception of the current job
+                exception_ptr m_error;
+
+                /**
+                 * Allows to start the worker threads
+                 * @param num_threads the number of threads, including the calling one,
+                 *                    zero means the number of hardware threads
+                 */
+                void start(size_t num_threads) {
+                    if (num_threads == 0) {
+                        num_threads = max(thread::hardware_concurrency(), 1u);
+                    }
+                    m_is_stop = false;
+                    for (size_t idx = 1; idx < num_threads; ++idx) {
+                        m_workers.emplace_back(&thread_pool::worker_loop, this);
+                    }
+                }
+
+                /**
+                 * Allows to stop the worker threads
+                 */
+                void stop() {
+                    {
+                        lock_guard<mutex> lock(m_mutex);
+                        m_is_stop = true;
+                    }
+                    m_job_cv.notify_all();
+                    for (auto & worker : m_workers) {
+                        worker.join();
+                    }
+                    m_workers.clear();
+                }
+
+                /**
+                 * Allows to process the chunks of the current job until there are none left
+                 */
+                void run_chunks() {
+                    //Trace the thread's share of the loop
+                    trace_span span("Parallel loop chunks");
+                    while (true) {
+                        const size_t begin = m_next_item.fetch_add(m_chunk_size);
+                        if (begin >= m_num_items) {
+                            break;
+                        }
+                        try {
+                            (*m_p_func)(begin, min(begin + m_chunk_size, m_num_items));
+                        } catch (...) {
+                            lock_guard<mutex> lock(m_mutex);
+                            if (!m_error) {
+                                m_error = current_exception();
+                            }
+                        }
+                    }
+                }
+
+                /**
+                 * The worker thread's main loop
+                 */
+                void worker_loop() {
+                    uint64_t seen_gen = 0;
+                    {
+                        //Do not pick up the jobs published before the start
+                        lock_guard<mutex> lock(m_mutex);
+                        seen_gen = m_job_gen;
+                    }
+                    while (true) {
+                        {
+                            unique_lock<mutex> lock(m_mutex);
+                            m_job_cv.wait(lock, [&] {
+                                return m_is_stop || (m_job_gen != seen_gen); });
+                            if (m_is_stop) {
+                                return;
+                            }
+                            seen_gen = m_job_gen;
+                            ++m_num_busy;
+                        }
+
+                        run_chunks();
+
+                        {
+                            lock_guard<mutex> lock(m_mutex);
+                            --m_num_busy;
+                        }
+                        m_done_cv.notify_all();
+                    }
+                }
+            };
+        }
+    }
+}
+
+#endif /* THREAD_POOL_HPP */
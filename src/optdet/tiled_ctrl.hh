@@ -0,0 +1,501 @@
+/*
+ * File:   tiled_ctrl.hh
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on April 11, 2018, 09:35 AM
+ */
+
+#ifndef TILED_CTRL_HPP
+#define TILED_CTRL_HPP
+
+#include <string>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <memory>
+#include <fstream>
+#include <unordered_map>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "scots.hh"
+
+#include "exceptions.hh"
+#include "logger.hh"
+#include "monitor.hh"
+
+#include "states_mgr.hh"
+#include "flat_bdd.hh"
+
+using namespace std;
+using namespace scots;
+
+using namespace tud::utils::exceptions;
+using namespace tud::utils::logging;
+using namespace tud::utils::monitor;
+
+namespace tud {
+    namespace ctrl {
+        namespace scots {
+            namespace optimal {
+
+                /*
+                 * The tiled controller file layout, all the values are in the host byte order:
+                 *
+                 *     tiled_ctrl_header
+                 *     flat_bdd_dim     x (ss_dim + is_dim)    the grid of each dimension
+                 *     uint64_t         x ss_dim               the tile size per dimension, in grid points
+                 *     uint64_t         x ss_dim               the number of tiles per dimension
+                 *     tiled_ctrl_entry x num_tiles            the tile blocks, in the tile id order
+                 *     the tile blocks, each one is a flat BDD image aligned to 8 bytes
+                 *
+                 * The tile id is computed from the tile's dof ids as the SCOTS state id is
+                 * computed from the state's dof ids. The tile block is the flat BDD of the
+                 * controller restricted to the tile, the tiles without domain states have
+                 * no block. Only the index is read when the file is opened, the blocks are
+                 * mapped on demand.
+                 */
+
+                //The tiled controller magic number, "TFB1"
+                static constexpr uint32_t TILED_CTRL_MAGIC = 0x31424654u;
+
+                /**
+                 * The tiled controller file header
+                 */
+                struct tiled_ctrl_header {
+                    //The magic number
+                    uint32_t m_magic;
+                    //The number of state-space dimensions
+                    uint32_t m_ss_dim;
+                    //The number of input-space dimensions
+                    uint32_t m_is_dim;
+                    //The padding to keep the following data aligned
+                    uint32_t m_unused;
+                    //The number of tiles
+                    uint64_t m_num_tiles;
+                };
+
+                /**
+                 * The tiled controller index entry
+                 */
+                struct tiled_ctrl_entry {
+                    //The block offset in the file
+                    uint64_t m_offset;
+                    //The block size in bytes, zero if the tile has no block
+                    uint64_t m_size;
+                };
+
+                /**
+                 * This class represents the tiled controller, for the controllers larger than
+                 * the memory. The tile blocks are mapped on demand and kept in the resident set
+                 * of the limited size, the least recently used tile is unmapped first. Thus the
+                 * working memory scales with the state-space region actually visited. The
+                 * lookups are thread safe, an evicted tile stays mapped while it is used.
+                 */
+                class tiled_ctrl {
+                public:
+
+                    /**
+                     * Allows to store the tiled controller
+                     * @param cudd_mgr the CUDD manager of the controller
+                     * @param ctrl_set the controller's symbolic set
+                     * @param ctrl_bdd the controller's BDD
+                     * @param ss_dim the number of state-space dimensions
+                     * @param tile_points the tile size per dimension, in grid points
+                     * @param file_name the tiled controller file name
+                     */
+                    static void store(const Cudd & cudd_mgr, const SymbolicSet & ctrl_set, const BDD & ctrl_bdd,
+                            const int32_t ss_dim, const abs_type tile_points, const string & file_name) {
+                        //Declare the statistics data
+                        DECLARE_MONITOR_STATS;
+
+                        //Get the beginning statistics data
+                        INITIALIZE_STATS;
+
+                        const int32_t is_dim = ctrl_set.get_dim() - ss_dim;
+                        ASSERT_CONDITION_THROW((ss_dim <= 0) || (is_dim <= 0),
+                                string("Improper state-space dimensionality: ") + to_string(ss_dim));
+                        ASSERT_CONDITION_THROW((tile_points == 0), "Improper tile size: 0");
+
+                        //Compute the tiling
+                        vector<flat_bdd_dim> dims;
+                        get_flat_dims(ctrl_set, ss_dim, dims);
+                        vector<uint64_t> tile_sizes(ss_dim), num_tiles(ss_dim);
+                        tiled_ctrl_header header = {TILED_CTRL_MAGIC, (uint32_t) ss_dim, (uint32_t) is_dim, 0, 1};
+                        for (int32_t dof = 0; dof < ss_dim; ++dof) {
+                            tile_sizes[dof] = min<uint64_t>(tile_points, dims[dof].m_num_points);
+                            num_tiles[dof] = (dims[dof].m_num_points + tile_sizes[dof] - 1) / tile_sizes[dof];
+                            header.m_num_tiles *= num_tiles[dof];
+                        }
+                        vector<tiled_ctrl_entry> entries(header.m_num_tiles, tiled_ctrl_entry{0, 0});
+
+                        //Write the blocks after the index, the index is written last
+                        ofstream file(file_name, ios::out | ios::binary | ios::trunc);
+                        ASSERT_CONDITION_THROW(!file.is_open(), string("Could not open the tiled controller file: ") + file_name);
+                        uint64_t offset = get_index_size(header);
+                        file.seekp(offset);
+
+                        unique_ptr<SymbolicSet> p_ss_set(states_mgr::get_states_set(ctrl_set, ss_dim));
+                        vector<abs_type> tile_dofs(ss_dim, 0), lb(ss_dim), ub(ss_dim);
+                        size_t num_blocks = 0;
+                        for (uint64_t tile_id = 0; tile_id < header.m_num_tiles; ++tile_id) {
+                            for (int32_t dof = 0; dof < ss_dim; ++dof) {
+                                lb[dof] = tile_dofs[dof] * tile_sizes[dof];
+                                ub[dof] = min<uint64_t>(lb[dof] + tile_sizes[dof], dims[dof].m_num_points) - 1;
+                            }
+                            const BDD tile_bdd = ctrl_bdd & p_ss_set->interval_to_bdd(cudd_mgr, lb, ub);
+                            if (tile_bdd != cudd_mgr.bddZero()) {
+                                const flat_bdd flat(ctrl_set, tile_bdd, ss_dim);
+                                //Keep the block aligned, the flat BDD image has doubles
+                                const uint64_t num_pad = (sizeof (uint64_t) - offset % sizeof (uint64_t)) % sizeof (uint64_t);
+                                const uint64_t zero = 0;
+                                file.write(reinterpret_cast<const char *> (&zero), num_pad);
+                                offset += num_pad;
+                                entries[tile_id] = tiled_ctrl_entry{offset, flat.get_size()};
+                                file.write(flat.get_data(), flat.get_size());
+                                offset += flat.get_size();
+                                ++num_blocks;
+                            }
+                            //Move to the next tile
+                            for (int32_t dof = 0; dof < ss_dim; ++dof) {
+                                if (++tile_dofs[dof] < num_tiles[dof]) break;
+                                tile_dofs[dof] = 0;
+                            }
+                        }
+
+                        //Write the index
+                        file.seekp(0);
+                        file.write(reinterpret_cast<const char *> (&header), sizeof (header));
+                        file.write(reinterpret_cast<const char *> (dims.data()), dims.size() * sizeof (flat_bdd_dim));
+                        file.write(reinterpret_cast<const char *> (tile_sizes.data()), ss_dim * sizeof (uint64_t));
+                        file.write(reinterpret_cast<const char *> (num_tiles.data()), ss_dim * sizeof (uint64_t));
+                        file.write(reinterpret_cast<const char *> (entries.data()), entries.size() * sizeof (tiled_ctrl_entry));
+                        ASSERT_CONDITION_THROW(!file.good(), string("Could not write the tiled controller file: ") + file_name);
+
+                        LOG_USAGE << "Stored " << num_blocks << " non-empty tiles out of " << header.m_num_tiles
+                                << " into '" << file_name << "', " << offset << " bytes" << END_LOG;
+
+                        //Get the end stats and log them
+                        REPORT_STATS(string("Storing the tiled controller"));
+                    }
+
+                    /**
+                     * The basic constructor, only reads the index
+                     * @param file_name the tiled controller file name
+                     * @param max_resident the maximum number of resident tiles, at least one
+                     */
+                    tiled_ctrl(const string & file_name, const size_t max_resident)
+                    : m_fd(-1), m_file_size(0), m_page_size(sysconf(_SC_PAGESIZE)), m_header(),
+                    m_dims(), m_tile_sizes(), m_tile_nn(), m_entries(), m_max_resident(max(max_resident, (size_t) 1)),
+                    m_mutex(), m_lru(), m_resident(), m_num_hits(0), m_num_loads(0), m_num_evicts(0) {
+                        m_fd = open(file_name.c_str(), O_RDONLY);
+                        ASSERT_CONDITION_THROW((m_fd < 0), string("Could not open the tiled controller file: ") + file_name);
+                        try {
+                            read_index();
+                        } catch (...) {
+                            close(m_fd);
+                            throw;
+                        }
+                    }
+
+                    /**
+                     * The basic destructor
+                     */
+                    virtual ~tiled_ctrl() {
+                        m_lru.clear();
+                        m_resident.clear();
+                        close(m_fd);
+                    }
+
+                    /**
+                     * Allows to get the inputs available in the state, thread safe, maps the tile if needed
+                     * @param state the state-space point, of the state-space dimensionality
+                     * @param input_ids the array to store the input ids
+                     * @param max_ids the maximum number of input ids to store
+                     * @return the number of available inputs, zero if the state is outside
+                     *         of the grid, can be larger than max_ids
+                     */
+                    size_t lookup(const double * state, abs_type * input_ids, const size_t max_ids) const {
+                        uint64_t tile_id = 0;
+                        for (uint32_t dof = 0; dof < m_header.m_ss_dim; ++dof) {
+                            const flat_bdd_dim & dim = m_dims[dof];
+                            const abs_type ss_dof = static_cast<abs_type> (state[dof] * dim.m_eta_inv - dim.m_x2a_sh);
+                            if (ss_dof >= dim.m_num_points) {
+                                return 0;
+                            }
+                            tile_id += (ss_dof / m_tile_sizes[dof]) * m_tile_nn[dof];
+                        }
+                        if (m_entries[tile_id].m_size == 0) {
+                            return 0;
+                        }
+                        const shared_ptr<const ctrl_tile> p_tile = get_tile(tile_id);
+                        return p_tile->m_ctrl->lookup(state, input_ids, max_ids);
+                    }
+
+                    /**
+                     * Allows to convert the input id into the input-space point, thread safe
+                     * @param id the input id
+                     * @param input the array to store the input-space point, of the input-space dimensionality
+                     */
+                    inline void itox_input(abs_type id, double * input) const {
+                        const flat_bdd_dim * is_dims = m_dims.data() + m_header.m_ss_dim;
+                        for (int32_t dof = m_header.m_is_dim - 1; dof >= 0; --dof) {
+                            const abs_type num = id / is_dims[dof].m_nn;
+                            id = id % is_dims[dof].m_nn;
+                            input[dof] = is_dims[dof].m_first + num * is_dims[dof].m_eta;
+                        }
+                    }
+
+                    /**
+                     * Allows to get the number of state-space dimensions
+                     * @return the number of state-space dimensions
+                     */
+                    inline int32_t get_ss_dim() const {
+                        return m_header.m_ss_dim;
+                    }
+
+                    /**
+                     * Allows to get the number of input-space dimensions
+                     * @return the number of input-space dimensions
+                     */
+                    inline int32_t get_is_dim() const {
+                        return m_header.m_is_dim;
+                    }
+
+                    /**
+                     * Allows to get the number of tiles, including the empty ones
+                     * @return the number of tiles
+                     */
+                    inline size_t get_num_tiles() const {
+                        return m_header.m_num_tiles;
+                    }
+
+                    /**
+                     * Allows to get the number of currently resident tiles
+                     * @return the number of resident tiles
+                     */
+                    inline size_t get_num_resident() const {
+                        lock_guard<mutex> lock(m_mutex);
+                        return m_resident.size();
+                    }
+
+                    /**
+                     * Allows to get the resident set statistics
+                     * @return the report on the tile hits, loads and evictions
+                     */
+                    string report() const {
+                        lock_guard<mutex> lock(m_mutex);
+                        return string("tile hits: ") + to_string(m_num_hits) + string(", loads: ") +
+                                to_string(m_num_loads) + string(", evictions: ") + to_string(m_num_evicts) +
+                                string(", resident: ") + to_string(m_resident.size()) + string("/") +
+                                to_string(m_max_resident);
+                    }
+
+                private:
+
+                    /**
+                     * This structure represents the mapped tile
+                     */
+                    struct ctrl_tile {
+                        //The mapped region, page aligned
+                        void * m_p_map;
+                        //The mapped region size
+                        size_t m_map_size;
+                        //The tile's flat BDD, viewing the mapped region
+                        unique_ptr<flat_bdd> m_ctrl;
+
+                        /**
+                         * The basic constructor, maps the tile block
+                         * @param fd the file descriptor
+                         * @param entry the tile index entry
+                         * @param page_size the page size
+                         */
+                        ctrl_tile(const int fd, const tiled_ctrl_entry & entry, const uint64_t page_size)
+                        : m_p_map(NULL), m_map_size(0), m_ctrl() {
+                            const uint64_t begin = (entry.m_offset / page_size) * page_size;
+                            m_map_size = entry.m_offset + entry.m_size - begin;
+                            m_p_map = mmap(NULL, m_map_size, PROT_READ, MAP_SHARED, fd, begin);
+                            if (m_p_map == MAP_FAILED) {
+                                m_p_map = NULL;
+                                THROW_EXCEPTION(string("Could not map the tile block at: ") + to_string(entry.m_offset));
+                            }
+                            try {
+                                m_ctrl.reset(new flat_bdd(static_cast<const char *> (m_p_map) +
+                                        (entry.m_offset - begin), entry.m_size));
+                                m_ctrl->validate();
+                            } catch (...) {
+                                munmap(m_p_map, m_map_size);
+                                throw;
+                            }
+                        }
+
+                        /**
+                         * The basic destructor, unmaps the tile block
+                         */
+                        ~ctrl_tile() {
+                            m_ctrl.reset();
+                            munmap(m_p_map, m_map_size);
+                        }
+                    };
+
+                    //The convenience type definition for the resident tiles list
+                    typedef list<pair<uint64_t, shared_ptr<const ctrl_tile>>> tile_list;
+
+                    //Stores the file descriptor
+                    int m_fd;
+                    //Stores the file size
+                    uint64_t m_file_size;
+                    //Stores the page size
+                    const uint64_t m_page_size;
+                    //Stores the file header
+                    tiled_ctrl_header m_header;
+                    //Stores the grid dimensions, the state ones and then the input ones
+                    vector<flat_bdd_dim> m_dims;
+                    //Stores the tile size per dimension
+                    vector<uint64_t> m_tile_sizes;
+                    //Stores the tile id multiplier per dimension
+                    vector<uint64_t> m_tile_nn;
+                    //Stores the tile index
+                    vector<tiled_ctrl_entry> m_entries;
+                    //Stores the maximum number of resident tiles
+                    const size_t m_max_resident;
+                    //Guards the resident set
+                    mutable mutex m_mutex;
+                    //Stores the resident tiles, the most recently used first
+                    mutable tile_list m_lru;
+                    //Stores the resident tiles per tile id
+                    mutable unordered_map<uint64_t, tile_list::iterator> m_resident;
+                    //Stores the number of lookups in the resident tiles
+                    mutable uint64_t m_num_hits;
+                    //Stores the number of tile loads
+                    mutable uint64_t m_num_loads;
+                    //Stores the number of tile evictions
+                    mutable uint64_t m_num_evicts;
+
+                    /**
+                     * Allows to get the index size, the offset of the first block
+                     * @param header the file header
+                     * @return the index size in bytes
+                     */
+                    static inline uint64_t get_index_size(const tiled_ctrl_header & header) {
+                        return sizeof (tiled_ctrl_header)
+                                + (header.m_ss_dim + header.m_is_dim) * sizeof (flat_bdd_dim)
+                                + 2 * header.m_ss_dim * sizeof (uint64_t)
+                                + header.m_num_tiles * sizeof (tiled_ctrl_entry);
+                    }
+
+                    /**
+                     * Allows to read the given number of bytes from the file
+                     * @param offset the file offset
+                     * @param data the buffer to read into
+                     * @param size the number of bytes to read
+                     */
+                    void read_data(const uint64_t offset, void * data, const size_t size) {
+                        ASSERT_CONDITION_THROW((offset + size > m_file_size) ||
+                                (pread(m_fd, data, size, offset) != (ssize_t) size),
+                                "The tiled controller file is truncated!");
+                    }
+
+                    /**
+                     * Allows to read and to check the index
+                     */
+                    void read_index() {
+                        struct stat file_stat = {};
+                        ASSERT_CONDITION_THROW((fstat(m_fd, &file_stat) != 0), "Could not stat the tiled controller file!");
+                        m_file_size = file_stat.st_size;
+
+                        read_data(0, &m_header, sizeof (m_header));
+                        ASSERT_CONDITION_THROW((m_header.m_magic != TILED_CTRL_MAGIC),
+                                "The tiled controller file has a wrong magic number!");
+                        ASSERT_CONDITION_THROW((m_header.m_ss_dim == 0) || (m_header.m_is_dim == 0) ||
+                                (m_header.m_num_tiles == 0) || (get_index_size(m_header) > m_file_size),
+                                "The tiled controller file is corrupted!");
+                        const uint32_t ss_dim = m_header.m_ss_dim;
+
+                        uint64_t offset = sizeof (m_header);
+                        m_dims.resize(ss_dim + m_header.m_is_dim);
+                        read_data(offset, m_dims.data(), m_dims.size() * sizeof (flat_bdd_dim));
+                        offset += m_dims.size() * sizeof (flat_bdd_dim);
+                        m_tile_sizes.resize(ss_dim);
+                        read_data(offset, m_tile_sizes.data(), ss_dim * sizeof (uint64_t));
+                        offset += ss_dim * sizeof (uint64_t);
+                        vector<uint64_t> num_tiles(ss_dim);
+                        read_data(offset, num_tiles.data(), ss_dim * sizeof (uint64_t));
+                        offset += ss_dim * sizeof (uint64_t);
+                        m_entries.resize(m_header.m_num_tiles);
+                        read_data(offset, m_entries.data(), m_entries.size() * sizeof (tiled_ctrl_entry));
+
+                        //Check the tiling and the blocks
+                        m_tile_nn.resize(ss_dim);
+                        uint64_t all_tiles = 1;
+                        for (uint32_t dof = 0; dof < ss_dim; ++dof) {
+                            ASSERT_CONDITION_THROW((m_tile_sizes[dof] == 0) || (num_tiles[dof] !=
+                                    (m_dims[dof].m_num_points + m_tile_sizes[dof] - 1) / m_tile_sizes[dof]),
+                                    string("The tiled controller file has a bad tiling in dimension: ") + to_string(dof));
+                            m_tile_nn[dof] = all_tiles;
+                            all_tiles *= num_tiles[dof];
+                        }
+                        ASSERT_CONDITION_THROW((all_tiles != m_header.m_num_tiles), "The tiled controller file is corrupted!");
+                        for (const auto & entry : m_entries) {
+                            ASSERT_CONDITION_THROW((entry.m_size > 0) && ((entry.m_offset % sizeof (uint64_t) != 0) ||
+                                    (entry.m_offset + entry.m_size > m_file_size)), "The tiled controller file has a bad block!");
+                        }
+                    }
+
+                    /**
+                     * Allows to get the tile, maps it if it is not resident
+                     * @param tile_id the non-empty tile id
+                     * @return the tile
+                     */
+                    shared_ptr<const ctrl_tile> get_tile(const uint64_t tile_id) const {
+                        lock_guard<mutex> lock(m_mutex);
+                        auto iter = m_resident.find(tile_id);
+                        if (iter != m_resident.end()) {
+                            //Make the tile the most recently used one
+                            m_lru.splice(m_lru.begin(), m_lru, iter->second);
+                            ++m_num_hits;
+                            return iter->second->second;
+                        }
+
+                        //Map the tile and evict the least recently used one if needed
+                        shared_ptr<const ctrl_tile> p_tile = make_shared<ctrl_tile>(m_fd, m_entries[tile_id], m_page_size);
+                        ++m_num_loads;
+                        m_lru.push_front(make_pair(tile_id, p_tile));
+                        m_resident[tile_id] = m_lru.begin();
+                        if (m_resident.size() > m_max_resident) {
+                            m_resident.erase(m_lru.back().first);
+                            m_lru.pop_back();
+                            ++m_num_evicts;
+                        }
+                        LOG_DEBUG << "Mapped tile " << tile_id << ", " << m_entries[tile_id].m_size << " bytes" << END_LOG;
+                        return p_tile;
+                    }
+                };
+            }
+        }
+    }
+}
+
+#endif /* TILED_CTRL_HPP */
@@ -4,7 +4,7 @@ BeginPackage[ "SCOTSv2`"]
 	Needs["GUIKit`"]
 
 	LoadBDDController
-	LoadBDDController::usage = "LoadBDDController[] allows to load the SCOTSv2.0 controller."
+	LoadBDDController::usage = "LoadBDDController[] allows to load the SCOTSv2.0 controller, returns the controller handle."
 
 	Begin[ "`Private`"]
 		LoadBDDController[] := Block[ {},
@@ -16,8 +16,10 @@ BeginPackage[ "SCOTSv2`"]
 				(*Remove the .scs suffix from the controller's name*)
 				fileTempl = StringTrim[fileName, RegularExpression["\\.scs$"]];
 				(*Load the controller using the WSTP application*)
-				res = Global`LoadSCOTSv2BDD[fileTempl];
+				res = Global`LoadSCOTSv2BDD[fileTempl],
+				res = 0
 			];
+			res
 		]
 	End[]
 EndPackage[]
@@ -2,12 +2,19 @@
 
 #include <stdint.h>
 
+void set_verbose(const int32_t verbose);
+int32_t set_num_workers(const int32_t num_workers);
 int32_t load_controller_bdd(const char* s);
-int32_t get_dim();
-void get_eta();
-void get_lower_left();
-void get_upper_right();
-void restriction(double * point, const long len);
+int32_t unload_controller_bdd(const int32_t handle);
+int32_t set_memory_cap(const int32_t mem_cap_mb);
+int32_t get_node_count(const int32_t handle);
+int32_t get_dim(const int32_t handle);
+void get_eta(const int32_t handle);
+void get_lower_left(const int32_t handle);
+void get_upper_right(const int32_t handle);
+void restriction(const int32_t handle, double * point, const long len);
+void restriction_batch(const int32_t handle);
+void get_controller_table(const int32_t handle, const int32_t ss_dim);
 
 #if WINDOWS_WSTP
 
@@ -35,46 +35,199 @@
 /* SCOTS header */
 #include "scots.hh"
 
+#include "ctrl_sessions.hh"
+#include "bdd_restrictor.hh"
+#include "thread_pool.hh"
+
 using namespace std;
 using namespace scots;
+using namespace tud::ctrl::scots::optimal;
+using namespace tud::utils::threads;
 
 /*Define the global variables*/
-static Cudd * pCuddMgr = NULL;
-static BDD * pBDD = NULL;
-static SymbolicSet * pCtr = NULL;
+static ctrl_sessions sessions;
+static thread_pool workers(0);
+static bool is_verbose = false;
+
+/*Data type for the per-state input ids*/
+using input_ids_list = vector<vector<abs_type>>;
 
 /**
- * Allows to load the SCOTS v2.0 BDD controller
- * @param s the C-string name of the controller file without ".scs" extention
+ * Allows to get the loaded controller by its handle
+ * @param handle the controller handle
+ * @return the pointer to the controller session or NULL if it is not loaded
+ */
+static inline ctrl_session * get_session(const int32_t handle) {
+    try {
+        return &sessions.get((ctrl_handle) handle);
+    } catch (tud_exception & ex) {
+        std::cerr << "The BDD controller " << handle << " is not loaded" << std::endl;
+        return NULL;
+    }
+}
+
+/**
+ * Allows to put the list of reals to the WSTP link
+ * @param data the list of reals
+ */
+static inline void put_real_list(const vector<double> & data) {
+    if(!WSPutReal64List(stdlink, data.data(), data.size())) {
+        //Unable to put the list to WSTP link
+        std::cerr << "Unable to put the values list to WSTP link" << std::endl;
+    }
+}
+
+/**
+ * Allows to report the failure to the WSTP link
+ */
+static inline void put_failed() {
+    if(!WSPutSymbol(stdlink, "$Failed")) {
+        //Unable to put the symbol to WSTP link
+        std::cerr << "Unable to put the failure symbol to WSTP link" << std::endl;
+    }
+}
+
+/**
+ * Allows to put the per-state inputs to the WSTP link as a list of two packed arrays:
+ * the numbers of inputs per state and the matrix of all the inputs one per row.
+ * @param restr the restrictor used to compute the inputs
+ * @param input_ids the per-state input ids
+ */
+static inline void put_inputs(const bdd_restrictor & restr, const input_ids_list & input_ids) {
+    const int32_t is_dim = restr.get_is_dim();
+    
+    //Compute the number of inputs per state and their offsets
+    vector<int> counts(input_ids.size());
+    vector<size_t> offsets(input_ids.size());
+    size_t num_inputs = 0;
+    for(size_t idx = 0; idx < input_ids.size(); ++idx) {
+        counts[idx] = input_ids[idx].size();
+        offsets[idx] = num_inputs;
+        num_inputs += counts[idx];
+    }
+    
+    //Convert the input ids into the input points
+    vector<double> inputs(num_inputs * is_dim);
+    workers.parallel_for(input_ids.size(), [&](const size_t begin, const size_t end) {
+        vector<double> input;
+        for(size_t idx = begin; idx < end; ++idx) {
+            double * p_dst = &inputs[offsets[idx] * is_dim];
+            for(auto id : input_ids[idx]) {
+                restr.itox_input(id, input);
+                p_dst = copy(input.begin(), input.end(), p_dst);
+            }
+        }
+    });
+    
+    //Put the result into the link
+    int dims[2] = {(int) num_inputs, is_dim};
+    if(!WSPutFunction(stdlink, "List", 2) ||
+       !WSPutInteger32List(stdlink, counts.data(), counts.size()) ||
+       ((num_inputs > 0) ? !WSPutReal64Array(stdlink, inputs.data(), dims, NULL, 2)
+                         : !WSPutFunction(stdlink, "List", 0))) {
+        //Unable to put the data to WSTP link
+        std::cerr << "Unable to put the inputs to WSTP link" << std::endl;
+    }
+}
+
+/**
+ * Allows to enable or disable the diagnostic printing
+ * @param verbose 0 to disable, otherwise enable
+ */
+extern "C" void set_verbose(const int32_t verbose)
+{
+    is_verbose = (verbose != 0);
+}
+
+/**
+ * Allows to set the number of worker threads used by the batch functions
+ * @param num_workers the number of workers, 0 means the number of hardware threads
  * @result 0 if everything went fine, otherwise an error
  */
+extern "C" int32_t set_num_workers(const int32_t num_workers)
+{
+    if(num_workers >= 0) {
+        workers.set_num_threads(num_workers);
+        return 0;
+    } else {
+        std::cerr << "The number of workers must not be negative" << std::endl;
+        return 1;
+    }
+}
+
+/**
+ * Allows to load the SCOTS v2.0 BDD controller, the controllers defined
+ * on the same grid share the CUDD manager. If the memory cap is set then
+ * the least recently used controllers might get unloaded.
+ * @param s the C-string name of the controller file without ".scs" extention
+ * @result the controller handle if everything went fine, otherwise 0
+ */
 extern "C" int32_t load_controller_bdd(const char* s)
 {
     //Get the file name as a string
     string file_name(s);
     
-    std::cout << "Loading the BDD controller: " << file_name << std::endl;
-
-    /*Re-allocate the data structures*/
-    if(pCtr) {
-        delete pCtr;
-    }
-    pCtr = new SymbolicSet();
-    if(pBDD) {
-        delete pBDD;
-    }
-    pBDD = new BDD();
-    if(pCuddMgr) {
-        delete pCuddMgr;
+    if(is_verbose) {
+        std::cout << "Loading the BDD controller: " << file_name << std::endl;
     }
-    pCuddMgr = new Cudd();
 
     /* read controller from file */
-    if(!read_from_file(*pCuddMgr, *pCtr, *pBDD, file_name.c_str())) {
+    try {
+        const ctrl_handle handle = sessions.load(file_name);
+        if(is_verbose) {
+            std::cout << "The BDD controller is successfully loaded, handle: "
+                      << handle << std::endl;
+        }
+        return handle;
+    } catch (tud_exception & ex) {
         std::cerr << "Could not read controller from: " << file_name << std::endl;
+        return 0;
+    }
+}
+
+/**
+ * Allows to unload the SCOTS v2.0 BDD controller
+ * @param handle the controller handle
+ * @result 0 if everything went fine, otherwise an error
+ */
+extern "C" int32_t unload_controller_bdd(const int32_t handle)
+{
+    if(sessions.unload((ctrl_handle) handle)) {
+        return 0;
+    } else {
+        std::cerr << "The BDD controller " << handle << " is not loaded" << std::endl;
+        return 1;
+    }
+}
+
+/**
+ * Allows to set the memory cap for the loaded controllers. Once the estimated
+ * size of the loaded controllers exceeds the cap, the least recently used
+ * controllers are unloaded.
+ * @param mem_cap_mb the memory cap in MB, zero means no cap
+ * @result 0 if everything went fine, otherwise an error
+ */
+extern "C" int32_t set_memory_cap(const int32_t mem_cap_mb)
+{
+    if(mem_cap_mb >= 0) {
+        sessions.set_mem_cap(((size_t) mem_cap_mb) * 1024 * 1024);
+        return 0;
+    } else {
+        std::cerr << "The memory cap must not be negative" << std::endl;
         return 1;
+    }
+}
+
+/**
+ * Allows to get the number of BDD nodes of the controller
+ * @param handle the controller handle
+ * @return 0 if the controller is not loaded, otherwise the number of BDD nodes
+ */
+extern "C" int32_t get_node_count(const int32_t handle) {
+    ctrl_session * pSes = get_session(handle);
+    if(pSes) {
+        return pSes->m_ctrl_bdd.nodeCount();
     } else {
-        std::cout << "The BDD controller is successfully loaded!" << std::endl;
         return 0;
     }
 }
@@ -83,11 +236,13 @@ extern "C" int32_t load_controller_bdd(const char* s)
  * Allows to get the number of dimensions of the controller.
  * This is the sum of the state space dimensions and input
  * signal dimensions.
+ * @param handle the controller handle
  * @return 0 if the controller is not loaded, otherwise the number of dimensions
  */
-extern "C" int32_t get_dim() {
-    if(pCtr) {
-        return pCtr->get_dim();
+extern "C" int32_t get_dim(const int32_t handle) {
+    ctrl_session * pSes = get_session(handle);
+    if(pSes) {
+        return pSes->m_ctrl_set.get_dim();
     } else {
         return 0;
     }
@@ -95,79 +250,186 @@ extern "C" int32_t get_dim() {
 
 /**
  * Allows to get the list of discretization values per dimension
+ * @param handle the controller handle
  * @return the list of discretization values
  */
-extern "C" void get_eta() {
-    if(pCtr) {
+extern "C" void get_eta(const int32_t handle) {
+    ctrl_session * pSes = get_session(handle);
+    if(pSes) {
         //Get the eta vector and then return it to Mathematica
-        auto data = pCtr->get_eta();
-        if(!WSPutReal64List(stdlink, &data[0], pCtr->get_dim())) {
-            //Unable to put the list to WSTP link
-            std::cerr << "Unable to put the eta values list to WSTP link" << std::endl;
-        }
+        put_real_list(pSes->m_ctrl_set.get_eta());
     } else {
-        std::cerr << "The BDD controller is not loaded" << std::endl;
+        put_failed();
     }
 }
 
 /**
  * Allows to get the position of the lower-left point of the grid
+ * @param handle the controller handle
  * @return the lower-left point of the grid
  */
-extern "C" void get_lower_left() {
-    if(pCtr) {
+extern "C" void get_lower_left(const int32_t handle) {
+    ctrl_session * pSes = get_session(handle);
+    if(pSes) {
         //Get the lower left vector and then return it to Mathematica
-        auto data = pCtr->get_lower_left();
-        if(!WSPutReal64List(stdlink, &data[0], pCtr->get_dim())) {
-            //Unable to put the list to WSTP link
-            std::cerr << "Unable to put the eta values list to WSTP link" << std::endl;
-        }
+        put_real_list(pSes->m_ctrl_set.get_lower_left());
     } else {
-        std::cerr << "The BDD controller is not loaded" << std::endl;
+        put_failed();
     }
 }
 
 /**
  * Allows to get the position of the upper-right point of the grid
+ * @param handle the controller handle
  * @return the upper-right point of the grid
  */
-extern "C" void get_upper_right() {
-    if(pCtr) {
+extern "C" void get_upper_right(const int32_t handle) {
+    ctrl_session * pSes = get_session(handle);
+    if(pSes) {
         //Get the upper right vector and then return it to Mathematica
-        auto data = pCtr->get_upper_right();
-        if(!WSPutReal64List(stdlink, &data[0], pCtr->get_dim())) {
-            //Unable to put the list to WSTP link
-            std::cerr << "Unable to put the eta values list to WSTP link" << std::endl;
-        }
+        put_real_list(pSes->m_ctrl_set.get_upper_right());
     } else {
-        std::cerr << "The BDD controller is not loaded" << std::endl;
+        put_failed();
     }
 }
 
 /**
  * Allows to get the available input signal values per state
+ * @param handle the controller handle
  * @param point an array of point coordinates
  * @param len the number of dimensions of the point
  * @return the list of input signal values
  */
 
-extern "C" void restriction(double * point, const long len) {
-    if(pCtr) {
+extern "C" void restriction(const int32_t handle, double * point, const long len) {
+    ctrl_session * pSes = get_session(handle);
+    if(pSes) {
         //Initialize a vector to use in restriction
         vector<double> point_x;
         point_x.assign(point, point + len);
         
-        std::cout << "Got the point, size: " << point_x.size() << std::endl;
+        if(is_verbose) {
+            std::cout << "Got the point, size: " << point_x.size() << std::endl;
+        }
+        
+        auto data = pSes->m_ctrl_set.restriction(*pSes->m_cudd_mgr, pSes->m_ctrl_bdd, point_x);
+        
+        if(is_verbose) {
+            std::cout << "Got the control inputs, size: " << data.size() << std::endl;
+        }
+
+        put_real_list(data);
+    } else {
+        put_failed();
+    }
+}
+
+/**
+ * Allows to get the available input signal values for a batch of states.
+ * The states are read from the link as a packed matrix, one state per row.
+ * The queries are answered by the worker threads.
+ * @param handle the controller handle
+ * @return the list of two packed arrays: the numbers of inputs per state
+ *         and the matrix of all the inputs, one input per row
+ */
+extern "C" void restriction_batch(const int32_t handle) {
+    //Get the packed array of states from the link
+    double * points = NULL;
+    int * dims = NULL;
+    char ** heads = NULL;
+    int depth = 0;
+    if(!WSGetReal64Array(stdlink, &points, &dims, &heads, &depth)) {
+        std::cerr << "Unable to get the states array from WSTP link" << std::endl;
+        put_failed();
+        return;
+    }
+    
+    ctrl_session * pSes = get_session(handle);
+    if(pSes && (depth == 2)) {
+        const size_t num_states = dims[0];
+        const int32_t ss_dim = dims[1];
         
-        auto data = pCtr->restriction(*pCuddMgr, *pBDD, point_x);
+        if(is_verbose) {
+            std::cout << "Got the states, count: " << num_states
+                      << ", size: " << ss_dim << std::endl;
+        }
         
-        std::cout << "Got the control inputs, size: " << data.size() << std::endl;
+        try {
+            //Compute the inputs per state in parallel
+            bdd_restrictor restr(pSes->m_ctrl_set, pSes->m_ctrl_bdd, ss_dim);
+            input_ids_list input_ids(num_states);
+            workers.parallel_for(num_states, [&](const size_t begin, const size_t end) {
+                for(size_t idx = begin; idx < end; ++idx) {
+                    restr.restrict(&points[idx * ss_dim], input_ids[idx]);
+                }
+            });
+            
+            put_inputs(restr, input_ids);
+        } catch (tud_exception & ex) {
+            std::cerr << ex.what() << std::endl;
+            put_failed();
+        }
+    } else {
+        if(pSes) {
+            std::cerr << "The states array must be a matrix" << std::endl;
+        }
+        put_failed();
+    }
+    
+    WSReleaseReal64Array(stdlink, points, dims, heads, depth);
+}
 
-        if(!WSPutReal64List(stdlink, &data[0], data.size())) {
-            //Unable to put the list to WSTP link
-            std::cerr << "Unable to put the eta values list to WSTP link" << std::endl;
+/**
+ * Allows to get the entire controller as a table.
+ * The queries are answered by the worker threads.
+ * @param handle the controller handle
+ * @param ss_dim the number of state-space dimensions
+ * @return the list of three packed arrays: the matrix of the domain
+ *         states, one state per row, the numbers of inputs per state
+ *         and the matrix of all the inputs, one input per row
+ */
+extern "C" void get_controller_table(const int32_t handle, const int32_t ss_dim) {
+    ctrl_session * pSes = get_session(handle);
+    if(pSes) {
+        try {
+            bdd_restrictor restr(pSes->m_ctrl_set, pSes->m_ctrl_bdd, ss_dim);
+            
+            //Get the controller's domain states, uses the CUDD manager so is sequential
+            const SymbolicSet & ss_set = restr.get_ss_set();
+            BDD dom_bdd = pSes->m_ctrl_bdd.ExistAbstract(restr.get_is_set().get_cube(*pSes->m_cudd_mgr));
+            abs_type num_states = 0;
+            abs_type * ss_dofs = ss_set.bdd_to_grid_point_ids(*pSes->m_cudd_mgr, dom_bdd, num_states);
+            
+            if(is_verbose) {
+                std::cout << "Got the domain states, count: " << num_states << std::endl;
+            }
+            
+            //Compute the states and the inputs per state in parallel
+            vector<double> states(((size_t) num_states) * ss_dim);
+            input_ids_list input_ids(num_states);
+            workers.parallel_for(num_states, [&](const size_t begin, const size_t end) {
+                for(size_t idx = begin; idx < end; ++idx) {
+                    double * p_state = &states[idx * ss_dim];
+                    ss_set.Itox(&ss_dofs[idx * ss_dim], p_state);
+                    restr.restrict_dofs(&ss_dofs[idx * ss_dim], input_ids[idx]);
+                }
+            });
+            delete[] ss_dofs;
+            
+            //Put the result into the link
+            int dims[2] = {(int) num_states, ss_dim};
+            if(!WSPutFunction(stdlink, "List", 3) ||
+               ((num_states > 0) ? !WSPutReal64Array(stdlink, states.data(), dims, NULL, 2)
+                                 : !WSPutFunction(stdlink, "List", 0))) {
+                //Unable to put the data to WSTP link
+                std::cerr << "Unable to put the states to WSTP link" << std::endl;
+            }
+            put_inputs(restr, input_ids);
+        } catch (tud_exception & ex) {
+            std::cerr << ex.what() << std::endl;
+            put_failed();
         }
     } else {
-        std::cerr << "The BDD controller is not loaded" << std::endl;
+        put_failed();
     }
 }
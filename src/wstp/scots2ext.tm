@@ -8,6 +8,30 @@
  *   In[1]:=link=Install["portname",LinkMode->Connect]
  */
 
+void set_verbose P((int v));
+
+:Begin:
+:Function:		set_verbose
+:Pattern:		SetVerbose[v_Integer]
+:Arguments:		{v}
+:ArgumentTypes:	{Integer32}
+:ReturnType:	Null
+:End:
+
+:Evaluate: SetVerbose::usage "SetVerbose[v] Enable, if v is not 0, or disable, if v is 0, the diagnostic printing, disabled by default"
+
+int set_num_workers P((int n));
+
+:Begin:
+:Function:		set_num_workers
+:Pattern:		SetNumWorkers[n_Integer]
+:Arguments:		{n}
+:ArgumentTypes:	{Integer32}
+:ReturnType:	Integer32
+:End:
+
+:Evaluate: SetNumWorkers::usage "SetNumWorkers[n] Set the number of worker threads used by the batch functions, 0 means the number of hardware threads"
+
 int load_controller_bdd P((const char *s));
 
 :Begin:
@@ -18,64 +42,124 @@ int load_controller_bdd P((const char *s));
 :ReturnType:	Integer32
 :End:
 
-:Evaluate: LoadSCOTSv2BDD::usage "LoadSCOTSv2BDD[s] Allows to load a SCOTSv2.0 BDD controller, returns the error code"
+:Evaluate: LoadSCOTSv2BDD::usage "LoadSCOTSv2BDD[s] Allows to load a SCOTSv2.0 BDD controller, returns the controller handle or 0 if failed"
 
-int get_dim P(());
+int unload_controller_bdd P((int h));
+
+:Begin:
+:Function:		unload_controller_bdd
+:Pattern:		UnloadSCOTSv2BDD[h_Integer]
+:Arguments:		{h}
+:ArgumentTypes:	{Integer32}
+:ReturnType:	Integer32
+:End:
+
+:Evaluate: UnloadSCOTSv2BDD::usage "UnloadSCOTSv2BDD[h] Allows to unload the SCOTSv2.0 BDD controller with handle h, returns the error code"
+
+int set_memory_cap P((int m));
+
+:Begin:
+:Function:		set_memory_cap
+:Pattern:		SetMemoryCap[m_Integer]
+:Arguments:		{m}
+:ArgumentTypes:	{Integer32}
+:ReturnType:	Integer32
+:End:
+
+:Evaluate: SetMemoryCap::usage "SetMemoryCap[m] Set the memory cap in MB for the loaded controllers, the least recently used ones get unloaded if exceeded, 0 means no cap"
+
+int get_node_count P((int h));
+
+:Begin:
+:Function:		get_node_count
+:Pattern:		GetNodeCount[h_Integer]
+:Arguments:		{h}
+:ArgumentTypes:	{Integer32}
+:ReturnType:	Integer32
+:End:
+
+:Evaluate: GetNodeCount::usage "GetNodeCount[h] Get the number of BDD nodes of the SCOTSv2.0 controller with handle h"
+
+int get_dim P((int h));
 
 :Begin:
 :Function:		get_dim
-:Pattern:		GetDim[]
-:Arguments:		{}
-:ArgumentTypes:	{}
+:Pattern:		GetDim[h_Integer]
+:Arguments:		{h}
+:ArgumentTypes:	{Integer32}
 :ReturnType:	Integer32
 :End:
 
-:Evaluate: GetDim::usage "GetDim[] Get the total number of dimensions of the SCOTSv2.0 controller"
+:Evaluate: GetDim::usage "GetDim[h] Get the total number of dimensions of the SCOTSv2.0 controller with handle h"
 
-void get_eta P(());
+void get_eta P((int h));
 
 :Begin:
 :Function:		get_eta
-:Pattern:		GetEta[]
-:Arguments:		{}
-:ArgumentTypes:	{}
+:Pattern:		GetEta[h_Integer]
+:Arguments:		{h}
+:ArgumentTypes:	{Integer32}
 :ReturnType:	Manual
 :End:
 
-:Evaluate: GetEta::usage "GetEta[] Get the vector of discretization parameters"
+:Evaluate: GetEta::usage "GetEta[h] Get the vector of discretization parameters of the controller with handle h"
 
-void get_lower_left P(());
+void get_lower_left P((int h));
 
 :Begin:
 :Function:		get_lower_left
-:Pattern:		GetLowerLeft[]
-:Arguments:		{}
-:ArgumentTypes:	{}
+:Pattern:		GetLowerLeft[h_Integer]
+:Arguments:		{h}
+:ArgumentTypes:	{Integer32}
 :ReturnType:	Manual
 :End:
 
-:Evaluate: GetLowerLeft::usage "GetLowerLeft[] Get the lower-left grid coordinate"
+:Evaluate: GetLowerLeft::usage "GetLowerLeft[h] Get the lower-left grid coordinate of the controller with handle h"
 
-void get_upper_right P(());
+void get_upper_right P((int h));
 
 :Begin:
 :Function:		get_upper_right
-:Pattern:		GetUpperRight[]
-:Arguments:		{}
-:ArgumentTypes:	{}
+:Pattern:		GetUpperRight[h_Integer]
+:Arguments:		{h}
+:ArgumentTypes:	{Integer32}
 :ReturnType:	Manual
 :End:
 
-:Evaluate: GetUpperRight::usage "GetUpperRight[] Get the upper-right grid coordinate"
+:Evaluate: GetUpperRight::usage "GetUpperRight[h] Get the upper-right grid coordinate of the controller with handle h"
 
-void restriction P((double * point, const long len));
+void restriction P((int h, double * point, const long len));
 
 :Begin:
 :Function:		restriction
-:Pattern:		Restriction[x_List]
-:Arguments:		{x}
-:ArgumentTypes:	{RealList}
+:Pattern:		Restriction[h_Integer, x_List]
+:Arguments:		{h, x}
+:ArgumentTypes:	{Integer32, RealList}
+:ReturnType:	Manual
+:End:
+
+:Evaluate: Restriction::usage "Restriction[h, x] Get the input/control signals of the controller with handle h for the given point/state/position"
+
+void restriction_batch P((int h));
+
+:Begin:
+:Function:		restriction_batch
+:Pattern:		RestrictionBatch[h_Integer, x_?(MatrixQ[#, NumericQ]&)]
+:Arguments:		{h, Developer`ToPackedArray[N[x]]}
+:ArgumentTypes:	{Integer32, Manual}
+:ReturnType:	Manual
+:End:
+
+:Evaluate: RestrictionBatch::usage "RestrictionBatch[h, x] Get the input/control signals of the controller with handle h for the matrix of states x, one state per row. Returns {c, u} where c is the list of the numbers of inputs per state and u is the matrix of inputs, one per row, use TakeList[u, c] to split them per state"
+
+void get_controller_table P((int h, int d));
+
+:Begin:
+:Function:		get_controller_table
+:Pattern:		GetControllerTable[h_Integer, d_Integer]
+:Arguments:		{h, d}
+:ArgumentTypes:	{Integer32, Integer32}
 :ReturnType:	Manual
 :End:
 
-:Evaluate: Restriction::usage "Restriction[x] Get the input/control signals for the given point/state/position"
+:Evaluate: GetControllerTable::usage "GetControllerTable[h, d] Get the controller with handle h and state-space dimensionality d as a table. Returns {x, c, u} where x is the matrix of domain states, one per row, c is the list of the numbers of inputs per state and u is the matrix of inputs, one per row, use TakeList[u, c] to split them per state"